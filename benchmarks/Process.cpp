@@ -0,0 +1,122 @@
+//===- benchmarks/Process.cpp - Helpers to run and measure processes ----------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the helpers shared by the benchmark tools to execute a program and measure
+// its wall time and the instructions it retires.
+//
+//===------------------------------------------------------------------------------------------===//
+#include "Process.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/// opens a counter of the instructions retired in user space by process \pid. The counter starts
+/// counting when the process calls exec. Returns -1 if the counter is not available (i.e. not
+/// running on Linux, perf_event_paranoid too restrictive, running inside a container, ...)
+static int openInstructionCounter(pid_t pid) {
+#ifdef __linux__
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.disabled = 1;
+  attr.enable_on_exec = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.inherit = 1;
+  return syscall(__NR_perf_event_open, &attr, pid, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+/// redirects the file descriptor \fd of the current process to the file \path
+static bool redirect(int fd, const std::string &path) {
+  int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (file < 0) {
+    return false;
+  }
+  dup2(file, fd);
+  close(file);
+  return true;
+}
+
+ProcessResult runProcess(const std::vector<std::string> &args, const std::string &directory,
+                         const std::string &outputPath, const std::string &errorPath,
+                         bool countInstructions) {
+  // The child waits for the parent to open the instruction counter before calling exec, so the
+  // counter is enabled when the program starts
+  int startPipe[2];
+  if (pipe(startPipe) != 0) {
+    return {-1, 0, llvm::None};
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    return {-1, 0, llvm::None};
+  }
+
+  if (pid == 0) {
+    close(startPipe[1]);
+    char start;
+    if (read(startPipe[0], &start, 1) != 1) {
+      _exit(127);
+    }
+    close(startPipe[0]);
+
+    if (chdir(directory.c_str()) != 0) {
+      _exit(127);
+    }
+    if (!outputPath.empty() && !redirect(STDOUT_FILENO, outputPath)) {
+      _exit(127);
+    }
+    if (!errorPath.empty() && !redirect(STDERR_FILENO, errorPath)) {
+      _exit(127);
+    }
+
+    std::vector<char *> argv;
+    for (const auto &arg : args) {
+      argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+
+  close(startPipe[0]);
+  int counter = countInstructions ? openInstructionCounter(pid) : -1;
+
+  auto start = std::chrono::steady_clock::now();
+  if (write(startPipe[1], "s", 1) != 1) {
+    kill(pid, SIGKILL);
+  }
+  close(startPipe[1]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  auto end = std::chrono::steady_clock::now();
+
+  ProcessResult result;
+  result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  result.wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+  if (counter >= 0) {
+    uint64_t instructions;
+    if (read(counter, &instructions, sizeof(instructions)) == sizeof(instructions)) {
+      result.instructions = instructions;
+    }
+    close(counter);
+  }
+  return result;
+}
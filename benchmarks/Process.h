@@ -0,0 +1,40 @@
+//===- benchmarks/Process.h - Helpers to run and measure processes ------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file declares the helpers shared by the benchmark tools to execute a program and measure
+// its wall time and the instructions it retires.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_BENCHMARKS_PROCESS_H
+#define STOC_BENCHMARKS_PROCESS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <llvm/ADT/Optional.h>
+
+/// Result of executing a process
+struct ProcessResult {
+  int exitCode;
+  double wallMs;
+  llvm::Optional<uint64_t> instructions;
+};
+
+/// executes \args[0] (looked up in PATH if it is not a path) with arguments \args inside
+/// \directory and waits until it finishes. The standard output and error are redirected to
+/// \outputPath and \errorPath unless they are empty. If \countInstructions, it also counts the
+/// instructions retired by the process in user space.
+ProcessResult runProcess(const std::vector<std::string> &args, const std::string &directory,
+                         const std::string &outputPath = "", const std::string &errorPath = "",
+                         bool countInstructions = false);
+
+template <typename T> T median(std::vector<T> values) {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+#endif // STOC_BENCHMARKS_PROCESS_H
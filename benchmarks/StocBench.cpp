@@ -0,0 +1,284 @@
+//===- benchmarks/StocBench.cpp - Runtime benchmark harness for Stoc programs -------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements stoc-bench, the tool used to track how fast the executables produced by
+// stoc run. Every benchmark program is compiled at every optimization level and then executed
+// multiple times, recording the wall time, the instructions retired (using perf_event_open when
+// the kernel allows it) and the size of the executable. The results are written as JSON and, if a
+// baseline is given, compared against it to flag regressions.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <llvm/ADT/Optional.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "Process.h"
+
+/// Result of running a benchmark program at one optimization level
+struct Measurement {
+  std::string name;
+  unsigned optLevel;
+  /// median and minimum of the wall time of all the runs (in milliseconds)
+  double wallMs;
+  double wallMsMin;
+  /// median of the instructions retired (in user space) of all the runs, if they could be counted
+  llvm::Optional<uint64_t> instructions;
+  uint64_t binarySize;
+};
+
+/// compiles \program with stoc at \optLevel and runs it \runs times
+llvm::Optional<Measurement> measure(const std::string &stoc, const std::string &program,
+                                    unsigned optLevel, unsigned runs, const std::string &workdir) {
+  std::string name = llvm::sys::path::stem(program).str();
+  llvm::SmallString<128> directory(workdir);
+  llvm::sys::path::append(directory, name + "-O" + std::to_string(optLevel));
+  llvm::sys::fs::create_directories(directory);
+
+  // stoc names the executable after the source file and writes it in the current directory
+  ProcessResult compilation = runProcess({stoc, "-O", std::to_string(optLevel), program},
+                                         std::string(directory.str()));
+  llvm::SmallString<128> executable(directory);
+  llvm::sys::path::append(executable, name);
+  if (compilation.exitCode != 0 || !llvm::sys::fs::exists(executable)) {
+    std::cerr << "Failed to compile " << program << " at -O" << optLevel << std::endl;
+    return llvm::None;
+  }
+
+  Measurement measurement;
+  measurement.name = name;
+  measurement.optLevel = optLevel;
+  llvm::sys::fs::file_size(executable, measurement.binarySize);
+
+  std::vector<double> wallTimes;
+  std::vector<uint64_t> instructions;
+  for (unsigned i = 0; i < runs; i++) {
+    ProcessResult run = runProcess({std::string(executable.str())}, std::string(directory.str()),
+                                   "/dev/null", "", true);
+    wallTimes.push_back(run.wallMs);
+    if (run.instructions) {
+      instructions.push_back(*run.instructions);
+    }
+  }
+
+  measurement.wallMs = median(wallTimes);
+  measurement.wallMsMin = *std::min_element(wallTimes.begin(), wallTimes.end());
+  if (instructions.size() == runs) {
+    measurement.instructions = median(instructions);
+  }
+  return measurement;
+}
+
+llvm::json::Value toJSON(const std::vector<Measurement> &measurements) {
+  llvm::json::Array benchmarks;
+  for (const auto &measurement : measurements) {
+    llvm::json::Object benchmark{{"name", measurement.name},
+                                 {"opt_level", measurement.optLevel},
+                                 {"wall_ms", measurement.wallMs},
+                                 {"wall_ms_min", measurement.wallMsMin},
+                                 {"binary_size", static_cast<int64_t>(measurement.binarySize)}};
+    if (measurement.instructions) {
+      benchmark["instructions"] = static_cast<int64_t>(*measurement.instructions);
+    } else {
+      benchmark["instructions"] = nullptr;
+    }
+    benchmarks.push_back(std::move(benchmark));
+  }
+  return llvm::json::Object{{"benchmarks", std::move(benchmarks)}};
+}
+
+/// returns true if \current is more than \tolerance percent bigger than \baseline
+bool isRegression(double current, double baseline, double tolerance) {
+  return current > baseline * (1.0 + tolerance / 100.0);
+}
+
+std::string percentage(double current, double baseline) {
+  std::ostringstream stream;
+  stream << std::showpos << std::fixed << std::setprecision(1)
+         << (current - baseline) / baseline * 100.0 << "%";
+  return stream.str();
+}
+
+/// compares \measurements against the results stored in \baselinePath. Returns the number of
+/// regressions found
+int compareWithBaseline(const std::vector<Measurement> &measurements,
+                        const std::string &baselinePath, double wallTolerance,
+                        double instructionsTolerance, double sizeTolerance) {
+  auto buffer = llvm::MemoryBuffer::getFile(baselinePath);
+  if (!buffer) {
+    std::cerr << "Could not read baseline " << baselinePath << std::endl;
+    return 0;
+  }
+  auto baseline = llvm::json::parse(buffer.get()->getBuffer());
+  if (!baseline) {
+    std::cerr << "Baseline " << baselinePath << " is not valid JSON: "
+              << llvm::toString(baseline.takeError()) << std::endl;
+    return 0;
+  }
+
+  const llvm::json::Array *baselineBenchmarks = nullptr;
+  if (const llvm::json::Object *root = baseline->getAsObject()) {
+    baselineBenchmarks = root->getArray("benchmarks");
+  }
+  if (baselineBenchmarks == nullptr) {
+    std::cerr << "Baseline " << baselinePath << " does not contain benchmarks" << std::endl;
+    return 0;
+  }
+
+  int regressions = 0;
+  for (const auto &measurement : measurements) {
+    const llvm::json::Object *previous = nullptr;
+    for (const auto &value : *baselineBenchmarks) {
+      const llvm::json::Object *benchmark = value.getAsObject();
+      if (benchmark == nullptr) {
+        continue;
+      }
+      auto name = benchmark->getString("name");
+      auto optLevel = benchmark->getInteger("opt_level");
+      if (name && *name == measurement.name && optLevel && *optLevel == measurement.optLevel) {
+        previous = benchmark;
+      }
+    }
+
+    std::string id = measurement.name + " -O" + std::to_string(measurement.optLevel);
+    if (previous == nullptr) {
+      std::cout << id << ": not in baseline" << std::endl;
+      continue;
+    }
+
+    // The minimum wall time is compared because it is less sensitive to noise than the median
+    if (auto wallMsMin = previous->getNumber("wall_ms_min")) {
+      if (isRegression(measurement.wallMsMin, *wallMsMin, wallTolerance)) {
+        std::cout << id << ": REGRESSION wall time "
+                  << percentage(measurement.wallMsMin, *wallMsMin) << std::endl;
+        regressions++;
+      }
+    }
+    if (auto instructions = previous->getInteger("instructions")) {
+      if (measurement.instructions &&
+          isRegression(*measurement.instructions, *instructions, instructionsTolerance)) {
+        std::cout << id << ": REGRESSION instructions retired "
+                  << percentage(*measurement.instructions, *instructions) << std::endl;
+        regressions++;
+      }
+    }
+    if (auto binarySize = previous->getInteger("binary_size")) {
+      if (isRegression(measurement.binarySize, *binarySize, sizeTolerance)) {
+        std::cout << id << ": REGRESSION binary size "
+                  << percentage(measurement.binarySize, *binarySize) << std::endl;
+        regressions++;
+      }
+    }
+  }
+  return regressions;
+}
+
+void printMeasurements(const std::vector<Measurement> &measurements) {
+  std::cout << std::left << std::setw(20) << "benchmark" << std::setw(6) << "opt" << std::right
+            << std::setw(12) << "wall(ms)" << std::setw(16) << "instructions" << std::setw(12)
+            << "size" << std::endl;
+  for (const auto &measurement : measurements) {
+    std::cout << std::left << std::setw(20) << measurement.name << std::setw(6)
+              << ("-O" + std::to_string(measurement.optLevel)) << std::right << std::setw(12)
+              << std::fixed << std::setprecision(2) << measurement.wallMs << std::setw(16)
+              << (measurement.instructions ? std::to_string(*measurement.instructions) : "n/a")
+              << std::setw(12) << measurement.binarySize << std::endl;
+  }
+}
+
+void initOptions(cxxopts::Options &options) {
+  options.positional_help("<program.st>...");
+  options.show_positional_help();
+
+  options.add_options("basic")
+      ("h,help", "Print help information")
+      ("stoc", "Path to the stoc compiler", cxxopts::value<std::string>())
+      ("programs", "Benchmark programs", cxxopts::value<std::vector<std::string>>())
+      ("levels", "Optimization levels to compile the programs with",
+          cxxopts::value<std::vector<unsigned>>()->default_value("0,1,2,3"))
+      ("runs", "Number of times every program is executed",
+          cxxopts::value<unsigned>()->default_value("5"))
+      ("workdir", "Directory where the programs are compiled",
+          cxxopts::value<std::string>()->default_value("stoc-bench"))
+      ("output", "Write the results as JSON to this file", cxxopts::value<std::string>())
+      ("baseline", "Compare the results against this JSON file", cxxopts::value<std::string>())
+      ("wall-tolerance", "Allowed increase of wall time over the baseline (%)",
+          cxxopts::value<double>()->default_value("10"))
+      ("instructions-tolerance", "Allowed increase of instructions over the baseline (%)",
+          cxxopts::value<double>()->default_value("2"))
+      ("size-tolerance", "Allowed increase of binary size over the baseline (%)",
+          cxxopts::value<double>()->default_value("0"));
+
+  options.parse_positional({"programs"});
+}
+
+int main(int argc, char *argv[]) {
+  cxxopts::Options options(argv[0], "Runtime benchmark harness for programs compiled with stoc");
+  initOptions(options);
+  auto opt = options.parse(argc, argv);
+
+  if (opt.count("help") || !opt.count("stoc") || !opt.count("programs")) {
+    std::cout << options.help() << std::endl;
+    return opt.count("help") ? 0 : 1;
+  }
+
+  // Paths are made absolute because programs are compiled and executed inside the workdir
+  llvm::SmallString<128> stoc(opt["stoc"].as<std::string>());
+  llvm::sys::fs::make_absolute(stoc);
+  llvm::SmallString<128> workdir(opt["workdir"].as<std::string>());
+  llvm::sys::fs::make_absolute(workdir);
+  unsigned runs = std::max(1u, opt["runs"].as<unsigned>());
+
+  std::vector<Measurement> measurements;
+  bool failed = false;
+  for (const auto &programPath : opt["programs"].as<std::vector<std::string>>()) {
+    llvm::SmallString<128> program(programPath);
+    llvm::sys::fs::make_absolute(program);
+    for (unsigned optLevel : opt["levels"].as<std::vector<unsigned>>()) {
+      auto measurement = measure(std::string(stoc.str()), std::string(program.str()), optLevel,
+                                 runs, std::string(workdir.str()));
+      if (measurement) {
+        measurements.push_back(*measurement);
+      } else {
+        failed = true;
+      }
+    }
+  }
+
+  printMeasurements(measurements);
+
+  if (opt.count("output")) {
+    std::error_code EC;
+    llvm::raw_fd_ostream output(opt["output"].as<std::string>(), EC);
+    if (EC) {
+      std::cerr << "Failed to write results: " << EC.message() << std::endl;
+      return 1;
+    }
+    output << llvm::formatv("{0:2}", toJSON(measurements)) << "\n";
+  }
+
+  if (opt.count("baseline")) {
+    int regressions = compareWithBaseline(
+        measurements, opt["baseline"].as<std::string>(), opt["wall-tolerance"].as<double>(),
+        opt["instructions-tolerance"].as<double>(), opt["size-tolerance"].as<double>());
+    if (regressions > 0) {
+      std::cout << regressions << " regression(s) found against the baseline" << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed ? 1 : 0;
+}
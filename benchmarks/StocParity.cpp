@@ -0,0 +1,312 @@
+//===- benchmarks/StocParity.cpp - Compare Stoc programs against equivalent C ------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements stoc-parity, the tool used to measure how far the code generated by stoc
+// lags behind plain C. Every Stoc program is paired with a C program with the same semantics (same
+// path but with extension .c). Both are compiled at every optimization level, stoc with stoc and
+// C with clang, and executed. The tool verifies that both print the same output and reports the
+// slowdown of Stoc with respect to C and the number of LLVM IR instructions of each opcode (and
+// the calls to external functions like printf or strcmp) emitted by each compiler.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <llvm/ADT/Optional.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "Process.h"
+
+/// Number of LLVM IR instructions per opcode (i.e. "alloca", "load") and per external function
+/// called (i.e. "call printf")
+using IRCounts = std::map<std::string, uint64_t>;
+
+/// Result of compiling and running a program with one of the compilers
+struct Run {
+  /// median of the wall time of all the runs (in milliseconds)
+  double wallMs;
+  std::string output;
+  llvm::Optional<IRCounts> irCounts;
+};
+
+/// Result of comparing a Stoc program against its C version at one optimization level
+struct Comparison {
+  std::string name;
+  unsigned optLevel;
+  Run stoc;
+  Run c;
+  bool sameOutput;
+};
+
+/// Opcodes shown in the summary table, the rest are only written to the JSON output
+const std::vector<std::string> summaryCounts = {"alloca", "load", "store", "call printf",
+                                                "call strcmp"};
+
+/// counts the instructions of the LLVM IR in file \path. Calls to functions declared (but not
+/// defined) in the module are also counted by callee because they are calls to the runtime
+llvm::Optional<IRCounts> countIRInstructions(const std::string &path) {
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic error;
+  std::unique_ptr<llvm::Module> module = llvm::parseIRFile(path, error, context);
+  if (!module) {
+    std::cerr << "Could not parse LLVM IR " << path << ": " << error.getMessage().str()
+              << std::endl;
+    return llvm::None;
+  }
+
+  IRCounts counts;
+  for (const auto &function : *module) {
+    for (const auto &basicBlock : function) {
+      for (const auto &instruction : basicBlock) {
+        counts[instruction.getOpcodeName()]++;
+        counts["total"]++;
+        if (auto call = llvm::dyn_cast<llvm::CallInst>(&instruction)) {
+          llvm::Function *callee = call->getCalledFunction();
+          if (callee && callee->isDeclaration() && !callee->isIntrinsic()) {
+            counts["call " + callee->getName().str()]++;
+          }
+        }
+      }
+    }
+  }
+  return counts;
+}
+
+std::string readFile(const std::string &path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  return buffer ? buffer.get()->getBuffer().str() : "";
+}
+
+/// executes \executable \runs times inside \directory and stores its output and median wall time
+/// in \run
+bool execute(const std::string &executable, const std::string &directory, unsigned runs,
+             Run &run) {
+  std::string outputPath = executable + ".out";
+  std::vector<double> wallTimes;
+  for (unsigned i = 0; i < runs; i++) {
+    ProcessResult result = runProcess({executable}, directory, outputPath);
+    if (result.exitCode != 0) {
+      std::cerr << executable << " exited with code " << result.exitCode << std::endl;
+      return false;
+    }
+    wallTimes.push_back(result.wallMs);
+  }
+  run.wallMs = median(wallTimes);
+  run.output = readFile(outputPath);
+  return true;
+}
+
+/// compiles \program with stoc and its C version with \cc at \optLevel and runs both \runs times
+llvm::Optional<Comparison> compare(const std::string &stoc, const std::string &cc,
+                                   const std::string &program, unsigned optLevel, unsigned runs,
+                                   const std::string &workdir) {
+  std::string name = llvm::sys::path::stem(program).str();
+  std::string level = "-O" + std::to_string(optLevel);
+  llvm::SmallString<128> cProgramSmall(program);
+  llvm::sys::path::replace_extension(cProgramSmall, ".c");
+  std::string cProgram(cProgramSmall.str());
+  llvm::SmallString<128> directorySmall(workdir);
+  llvm::sys::path::append(directorySmall, name + level);
+  std::string directory(directorySmall.str());
+  llvm::sys::fs::create_directories(directory);
+
+  Comparison comparison;
+  comparison.name = name;
+  comparison.optLevel = optLevel;
+
+  // stoc names the executable after the source file and writes it in the current directory. The
+  // LLVM IR is printed to the standard error with --emit-llvm
+  std::string stocExecutable = directory + "/" + name;
+  std::string stocIR = directory + "/" + name + ".stoc.ll";
+  if (runProcess({stoc, level, program}, directory).exitCode != 0 ||
+      !llvm::sys::fs::exists(stocExecutable)) {
+    std::cerr << "Failed to compile " << program << " at " << level << std::endl;
+    return llvm::None;
+  }
+  if (runProcess({stoc, level, "--emit-llvm", program}, directory, "/dev/null", stocIR)
+          .exitCode == 0) {
+    comparison.stoc.irCounts = countIRInstructions(stocIR);
+  }
+
+  // Stoc integer arithmetic wraps on overflow, so C has to be compiled with -fwrapv
+  std::string cExecutable = directory + "/" + name + ".c.out";
+  std::string cIR = directory + "/" + name + ".c.ll";
+  if (runProcess({cc, level, "-fwrapv", "-o", cExecutable, cProgram}, directory).exitCode != 0) {
+    std::cerr << "Failed to compile " << cProgram << " at " << level << std::endl;
+    return llvm::None;
+  }
+  // The LLVM IR is only available if the C compiler is clang
+  bool isClang = llvm::sys::path::filename(cc).find("clang") != llvm::StringRef::npos;
+  if (isClang && runProcess({cc, level, "-fwrapv", "-S", "-emit-llvm", "-o", cIR, cProgram},
+                            directory, "", "/dev/null")
+                         .exitCode == 0) {
+    comparison.c.irCounts = countIRInstructions(cIR);
+  }
+
+  if (!execute(stocExecutable, directory, runs, comparison.stoc) ||
+      !execute(cExecutable, directory, runs, comparison.c)) {
+    return llvm::None;
+  }
+  comparison.sameOutput = comparison.stoc.output == comparison.c.output;
+  return comparison;
+}
+
+llvm::json::Value toJSON(const Run &run) {
+  llvm::json::Object result{{"wall_ms", run.wallMs}};
+  if (run.irCounts) {
+    llvm::json::Object counts;
+    for (const auto &count : *run.irCounts) {
+      counts[count.first] = static_cast<int64_t>(count.second);
+    }
+    result["ir_instructions"] = std::move(counts);
+  } else {
+    result["ir_instructions"] = nullptr;
+  }
+  return result;
+}
+
+llvm::json::Value toJSON(const std::vector<Comparison> &comparisons) {
+  llvm::json::Array benchmarks;
+  for (const auto &comparison : comparisons) {
+    double slowdown = comparison.stoc.wallMs / comparison.c.wallMs;
+    benchmarks.push_back(llvm::json::Object{{"name", comparison.name},
+                                            {"opt_level", comparison.optLevel},
+                                            {"same_output", comparison.sameOutput},
+                                            {"slowdown", slowdown},
+                                            {"stoc", toJSON(comparison.stoc)},
+                                            {"c", toJSON(comparison.c)}});
+  }
+  return llvm::json::Object{{"benchmarks", std::move(benchmarks)}};
+}
+
+/// returns the count \name in \counts as "stoc/c", or "n/a" if it is not available
+std::string formatCounts(const Comparison &comparison, const std::string &name) {
+  auto count = [&name](const llvm::Optional<IRCounts> &counts) {
+    if (!counts) {
+      return std::string("n/a");
+    }
+    auto it = counts->find(name);
+    return std::to_string(it == counts->end() ? 0 : it->second);
+  };
+  return count(comparison.stoc.irCounts) + "/" + count(comparison.c.irCounts);
+}
+
+void printComparisons(const std::vector<Comparison> &comparisons) {
+  std::cout << std::left << std::setw(14) << "benchmark" << std::setw(5) << "opt" << std::right
+            << std::setw(11) << "stoc(ms)" << std::setw(11) << "c(ms)" << std::setw(10)
+            << "slowdown" << std::setw(8) << "output";
+  std::cout << std::setw(14) << "total";
+  for (const auto &name : summaryCounts) {
+    std::cout << std::setw(14) << name;
+  }
+  std::cout << std::endl;
+
+  for (const auto &comparison : comparisons) {
+    std::cout << std::left << std::setw(14) << comparison.name << std::setw(5)
+              << ("-O" + std::to_string(comparison.optLevel)) << std::right << std::fixed
+              << std::setprecision(2) << std::setw(11) << comparison.stoc.wallMs << std::setw(11)
+              << comparison.c.wallMs << std::setw(9)
+              << comparison.stoc.wallMs / comparison.c.wallMs << "x" << std::setw(8)
+              << (comparison.sameOutput ? "same" : "DIFF");
+    std::cout << std::setw(14) << formatCounts(comparison, "total");
+    for (const auto &name : summaryCounts) {
+      std::cout << std::setw(14) << formatCounts(comparison, name);
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "IR instruction counts are shown as stoc/c" << std::endl;
+}
+
+void initOptions(cxxopts::Options &options) {
+  options.positional_help("<program.st>...");
+  options.show_positional_help();
+
+  options.add_options("basic")
+      ("h,help", "Print help information")
+      ("stoc", "Path to the stoc compiler", cxxopts::value<std::string>())
+      ("cc", "C compiler used for the C version of the programs",
+          cxxopts::value<std::string>()->default_value("clang"))
+      ("programs", "Stoc programs, each one next to its C version",
+          cxxopts::value<std::vector<std::string>>())
+      ("levels", "Optimization levels to compile the programs with",
+          cxxopts::value<std::vector<unsigned>>()->default_value("0,1,2,3"))
+      ("runs", "Number of times every program is executed",
+          cxxopts::value<unsigned>()->default_value("3"))
+      ("workdir", "Directory where the programs are compiled",
+          cxxopts::value<std::string>()->default_value("stoc-parity"))
+      ("output", "Write the results as JSON to this file", cxxopts::value<std::string>());
+
+  options.parse_positional({"programs"});
+}
+
+int main(int argc, char *argv[]) {
+  cxxopts::Options options(argv[0], "Compare programs compiled with stoc against C equivalents");
+  initOptions(options);
+  auto opt = options.parse(argc, argv);
+
+  if (opt.count("help") || !opt.count("stoc") || !opt.count("programs")) {
+    std::cout << options.help() << std::endl;
+    return opt.count("help") ? 0 : 1;
+  }
+
+  // Paths are made absolute because programs are compiled and executed inside the workdir
+  llvm::SmallString<128> stoc(opt["stoc"].as<std::string>());
+  llvm::sys::fs::make_absolute(stoc);
+  llvm::SmallString<128> workdir(opt["workdir"].as<std::string>());
+  llvm::sys::fs::make_absolute(workdir);
+  unsigned runs = std::max(1u, opt["runs"].as<unsigned>());
+
+  std::vector<Comparison> comparisons;
+  bool failed = false;
+  for (const auto &programPath : opt["programs"].as<std::vector<std::string>>()) {
+    llvm::SmallString<128> program(programPath);
+    llvm::sys::fs::make_absolute(program);
+    for (unsigned optLevel : opt["levels"].as<std::vector<unsigned>>()) {
+      auto comparison = compare(std::string(stoc.str()), opt["cc"].as<std::string>(),
+                                std::string(program.str()), optLevel, runs,
+                                std::string(workdir.str()));
+      if (!comparison) {
+        failed = true;
+        continue;
+      }
+      if (!comparison->sameOutput) {
+        std::cerr << comparison->name << " -O" << optLevel
+                  << ": output differs between Stoc and C" << std::endl;
+        failed = true;
+      }
+      comparisons.push_back(*comparison);
+    }
+  }
+
+  printComparisons(comparisons);
+
+  if (opt.count("output")) {
+    std::error_code EC;
+    llvm::raw_fd_ostream output(opt["output"].as<std::string>(), EC);
+    if (EC) {
+      std::cerr << "Failed to write results: " << EC.message() << std::endl;
+      return 1;
+    }
+    output << llvm::formatv("{0:2}", toJSON(comparisons)) << "\n";
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+//===- benchmarks/StocStartup.cpp - Startup latency benchmark for stoc --------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements stoc-startup, the tool used to track the startup latency of stoc. Editor
+// integrations invoke stoc on every keystroke, so the time spent before compiling anything (loading
+// the process, parsing the options and setting up LLVM) matters as much as the compilation. It runs
+// `stoc --tokens-dump` on an empty file multiple times and reports the wall time.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "Process.h"
+
+void initOptions(cxxopts::Options &options) {
+  options.add_options("basic")
+      ("h,help", "Print help information")
+      ("stoc", "Path to the stoc compiler", cxxopts::value<std::string>())
+      ("runs", "Number of times stoc is executed",
+          cxxopts::value<unsigned>()->default_value("50"))
+      ("workdir", "Directory where the empty file is created",
+          cxxopts::value<std::string>()->default_value("stoc-startup"))
+      ("output", "Write the results as JSON to this file", cxxopts::value<std::string>());
+}
+
+int main(int argc, char *argv[]) {
+  cxxopts::Options options(argv[0], "Startup latency benchmark for the stoc compiler");
+  initOptions(options);
+  auto opt = options.parse(argc, argv);
+
+  if (opt.count("help") || !opt.count("stoc")) {
+    std::cout << options.help() << std::endl;
+    return opt.count("help") ? 0 : 1;
+  }
+
+  llvm::SmallString<128> stoc(opt["stoc"].as<std::string>());
+  llvm::sys::fs::make_absolute(stoc);
+  llvm::SmallString<128> workdir(opt["workdir"].as<std::string>());
+  llvm::sys::fs::make_absolute(workdir);
+  llvm::sys::fs::create_directories(workdir);
+  unsigned runs = std::max(1u, opt["runs"].as<unsigned>());
+
+  llvm::SmallString<128> emptyFile(workdir);
+  llvm::sys::path::append(emptyFile, "empty.st");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream file(emptyFile, EC);
+    if (EC) {
+      std::cerr << "Failed to create " << emptyFile.str().str() << ": " << EC.message()
+                << std::endl;
+      return 1;
+    }
+  }
+
+  // The empty file has no main function, so stoc reports it and exits with 1 after the semantic
+  // analysis. Any other exit code means that stoc did not get there
+  std::vector<double> wallTimes;
+  for (unsigned i = 0; i < runs; i++) {
+    ProcessResult run =
+        runProcess({std::string(stoc.str()), "--tokens-dump", std::string(emptyFile.str())},
+                   std::string(workdir.str()), "/dev/null", "/dev/null");
+    if (run.exitCode != 0 && run.exitCode != 1) {
+      std::cerr << "stoc failed with exit code " << run.exitCode << std::endl;
+      return 1;
+    }
+    wallTimes.push_back(run.wallMs);
+  }
+
+  double wallMs = median(wallTimes);
+  double wallMsMin = *std::min_element(wallTimes.begin(), wallTimes.end());
+  std::cout << "stoc --tokens-dump <empty file> (" << runs << " runs): " << std::fixed
+            << std::setprecision(2) << "median " << wallMs << " ms, min " << wallMsMin << " ms"
+            << std::endl;
+
+  if (opt.count("output")) {
+    std::error_code EC;
+    llvm::raw_fd_ostream output(opt["output"].as<std::string>(), EC);
+    if (EC) {
+      std::cerr << "Failed to write results: " << EC.message() << std::endl;
+      return 1;
+    }
+    llvm::json::Object results{{"runs", static_cast<int64_t>(runs)},
+                               {"wall_ms", wallMs},
+                               {"wall_ms_min", wallMsMin}};
+    output << llvm::formatv("{0:2}", llvm::json::Value(std::move(results))) << "\n";
+  }
+
+  return 0;
+}
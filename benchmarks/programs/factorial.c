@@ -0,0 +1,18 @@
+// C version of factorial.st. Stoc int is 64 bits wide and println prints it with "%d"
+#include <stdio.h>
+
+long factorial(long n) {
+  if (n <= 1) {
+    return 1;
+  }
+  return n * factorial(n - 1);
+}
+
+int main(void) {
+  long checksum = 0;
+  for (long i = 0; i < 5000000; i = i + 1) {
+    checksum = (checksum + factorial(i % 21)) % 1000000007;
+  }
+  printf("%d\n", (int)checksum);
+  return 0;
+}
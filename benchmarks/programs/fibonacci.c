@@ -0,0 +1,14 @@
+// C version of fibonacci.st. Stoc int is 64 bits wide and println prints it with "%d"
+#include <stdio.h>
+
+long fib(long n) {
+  if (n < 2) {
+    return n;
+  }
+  return fib(n - 1) + fib(n - 2);
+}
+
+int main(void) {
+  printf("%d\n", (int)fib(35));
+  return 0;
+}
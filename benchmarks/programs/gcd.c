@@ -0,0 +1,29 @@
+// C version of gcd.st. Stoc int is 64 bits wide and println prints it with "%d"
+#include <stdio.h>
+
+long modulo(long a, long b) {
+  while (a >= b) {
+    a = a - b;
+  }
+  return a;
+}
+
+long gcd(long n, long m) {
+  while (m != 0) {
+    long mod = modulo(n, m);
+    n = m;
+    m = mod;
+  }
+  return n;
+}
+
+int main(void) {
+  long sum = 0;
+  for (long i = 1; i < 3000; i = i + 1) {
+    for (long j = 1; j < 1000; j = j + 1) {
+      sum = sum + gcd(i, j);
+    }
+  }
+  printf("%d\n", (int)sum);
+  return 0;
+}
@@ -0,0 +1,23 @@
+// C version of integrate.st. Stoc float is a double and println prints it with "%f"
+#include <stdio.h>
+
+double result = 0.0;
+
+double f(double x) { return x * x + 1.0; }
+
+double integrate(double a, double b, long steps) {
+  double width = (b - a) / (double)steps;
+  double sum = 0.0;
+  double x = a + width / 2.0;
+  for (long i = 0; i < steps; i = i + 1) {
+    sum = sum + f(x) * width;
+    x = x + width;
+  }
+  return sum;
+}
+
+int main(void) {
+  result = integrate(0.0, 3.0, 100000000);
+  printf("%f\n", result);
+  return 0;
+}
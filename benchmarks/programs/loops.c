@@ -0,0 +1,14 @@
+// C version of loops.st. Stoc int is 64 bits wide and println prints it with "%d". Stoc integer
+// arithmetic wraps on overflow, so this file is compiled with -fwrapv
+#include <stdio.h>
+
+int main(void) {
+  long sum = 0;
+  for (long i = 0; i < 20000; i = i + 1) {
+    for (long j = 0; j < 20000; j = j + 1) {
+      sum = sum + i * j - (i + j) / 3;
+    }
+  }
+  printf("%d\n", (int)sum);
+  return 0;
+}
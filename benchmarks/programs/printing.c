@@ -0,0 +1,17 @@
+// C version of printing.st. Stoc print uses "%d" for ints, "%f" for floats and "%s" for strings,
+// and prints bools as true or false
+#include <stdio.h>
+
+int main(void) {
+  double x = 0.5;
+  for (long i = 0; i < 300000; i = i + 1) {
+    printf("%s", "line ");
+    printf("%d", (int)i);
+    printf("%s", " ");
+    printf("%f", x);
+    printf("%s", " ");
+    printf("%s\n", i % 2 == 0 ? "true" : "false");
+    x = x + 0.25;
+  }
+  return 0;
+}
@@ -0,0 +1,28 @@
+// C version of strings.st. Stoc compares strings with strcmp and println prints ints with "%d"
+#include <stdio.h>
+#include <string.h>
+
+long classify(const char *s) {
+  if (strcmp(s, "alpha") == 0) {
+    return 1;
+  } else if (strcmp(s, "beta") == 0) {
+    return 2;
+  } else if (strcmp(s, "gamma") == 0) {
+    return 3;
+  }
+  return 0;
+}
+
+int main(void) {
+  long sum = 0;
+  const char *word = "gamma";
+  for (long i = 0; i < 30000000; i = i + 1) {
+    sum = sum + classify(word);
+    if (sum > 1000000) {
+      sum = sum - 1000000;
+      word = "beta";
+    }
+  }
+  printf("%d\n", (int)sum);
+  return 0;
+}
@@ -12,45 +12,60 @@
 
 #include "ASTVisitor.h"
 
+#include <iostream>
 #include <memory>
 #include <string>
 
 /// Prints the AST in a pretty way with information about every node
-class ASTPrinter : public ASTVisitor {
+class ASTPrinter : public ASTVisitor<ASTPrinter> {
 private:
   /// string appended before printing a given node. It also allows to know the depth of the node
   std::string pre = "";
 
+  /// stream where the AST is printed
+  std::ostream &out;
+
   void increaseDepthLevel();
   void lastChild();
   void decreaseDepthLevel();
 
 public:
-  ASTPrinter() = default;
+  explicit ASTPrinter(std::ostream &out = std::cout) : out(out) {}
 
   /// main method to print an AST from \ast node
-  void print(const std::shared_ptr<BasicNode> &ast);
+  void print(Decl &ast);
 
   // Visitor Pattern methods
-  void visit(std::shared_ptr<VarDecl> node) override;
-  void visit(std::shared_ptr<ConstDecl> node) override;
-  void visit(std::shared_ptr<ParamDecl> node) override;
-  void visit(std::shared_ptr<FuncDecl> node) override;
-
-  void visit(std::shared_ptr<DeclarationStmt> node) override;
-  void visit(std::shared_ptr<ExpressionStmt> node) override;
-  void visit(std::shared_ptr<BlockStmt> node) override;
-  void visit(std::shared_ptr<IfStmt> node) override;
-  void visit(std::shared_ptr<ForStmt> node) override;
-  void visit(std::shared_ptr<WhileStmt> node) override;
-  void visit(std::shared_ptr<AssignmentStmt> node) override;
-  void visit(std::shared_ptr<ReturnStmt> node) override;
-
-  void visit(std::shared_ptr<BinaryExpr> node) override;
-  void visit(std::shared_ptr<UnaryExpr> node) override;
-  void visit(std::shared_ptr<LiteralExpr> node) override;
-  void visit(std::shared_ptr<IdentExpr> node) override;
-  void visit(std::shared_ptr<CallExpr> node) override;
+  using ASTVisitor<ASTPrinter>::visit;
+
+  void visit(VarDecl &node);
+  void visit(ConstDecl &node);
+  void visit(ParamDecl &node);
+  void visit(FuncDecl &node);
+  void visit(StructDecl &node);
+
+  void visit(DeclarationStmt &node);
+  void visit(ExpressionStmt &node);
+  void visit(BlockStmt &node);
+  void visit(IfStmt &node);
+  void visit(ForStmt &node);
+  void visit(WhileStmt &node);
+  void visit(AssignmentStmt &node);
+  void visit(ReturnStmt &node);
+  void visit(BreakStmt &node);
+  void visit(ContinueStmt &node);
+
+  void visit(BinaryExpr &node);
+  void visit(UnaryExpr &node);
+  void visit(LiteralExpr &node);
+  void visit(IdentExpr &node);
+  void visit(CallExpr &node);
+  void visit(IndexExpr &node);
+  void visit(FieldExpr &node);
+  void visit(ArrayLiteralExpr &node);
+  void visit(ConversionExpr &node);
+  void visit(SpawnExpr &node);
+  void visit(AwaitExpr &node);
 };
 
 #endif // STOC_ASTPRINTER_H
@@ -10,55 +10,90 @@
 #ifndef STOC_ASTVISITOR_H
 #define STOC_ASTVISITOR_H
 
-#include <memory>
-
-class BasicNode;
-class Decl;
-class VarDecl;
-class ConstDecl;
-class ParamDecl;
-class FuncDecl;
-
-class Stmt;
-class DeclarationStmt;
-class ExpressionStmt;
-class BlockStmt;
-class IfStmt;
-class ForStmt;
-class WhileStmt;
-class AssignmentStmt;
-class ReturnStmt;
-
-class Expr;
-class BinaryExpr;
-class UnaryExpr;
-class LiteralExpr;
-class IdentExpr;
-class CallExpr;
+#include "stoc/AST/Decl.h"
+#include "stoc/AST/Expr.h"
+#include "stoc/AST/Stmt.h"
 
 /// Base class from which other classes that traverse the AST will inherit.
-/// The derived class must implement all of the methods that will depend on the type of node
-class ASTVisitor {
+/// It uses the Curiously Recurring Template Pattern: \Derived inherits from ASTVisitor<Derived> and
+/// must implement a method visit(Node &node) for every type of node (VarDecl, IfStmt, CallExpr,
+/// ...). The methods of ASTVisitor for Decl, Stmt and Expr dispatch to them with a switch on the
+/// Kind of the node, so the calls are not virtual and can be inlined. The nodes are passed by
+/// reference, so traversing the AST does not increment or decrement the reference counts of the
+/// shared_ptr that own the nodes.
+///
+/// \Derived must bring the methods of ASTVisitor into scope (using ASTVisitor<Derived>::visit;)
+template <typename Derived> class ASTVisitor {
 public:
-  virtual void visit(std::shared_ptr<VarDecl> node) = 0;
-  virtual void visit(std::shared_ptr<ConstDecl> node) = 0;
-  virtual void visit(std::shared_ptr<ParamDecl> node) = 0;
-  virtual void visit(std::shared_ptr<FuncDecl> node) = 0;
+  void visit(Decl &node) {
+    switch (node.getDeclKind()) {
+    case Decl::Kind::VARDECL:
+      return derived().visit(static_cast<VarDecl &>(node));
+    case Decl::Kind::CONSTDECL:
+      return derived().visit(static_cast<ConstDecl &>(node));
+    case Decl::Kind::PARAMDECL:
+      return derived().visit(static_cast<ParamDecl &>(node));
+    case Decl::Kind::FUNCDECL:
+      return derived().visit(static_cast<FuncDecl &>(node));
+    case Decl::Kind::STRUCTDECL:
+      return derived().visit(static_cast<StructDecl &>(node));
+    }
+  }
+
+  void visit(Stmt &node) {
+    switch (node.getStmtKind()) {
+    case Stmt::Kind::DECLARATIONSTMT:
+      return derived().visit(static_cast<DeclarationStmt &>(node));
+    case Stmt::Kind::EXPRESSIONSTMT:
+      return derived().visit(static_cast<ExpressionStmt &>(node));
+    case Stmt::Kind::BLOCKSTMT:
+      return derived().visit(static_cast<BlockStmt &>(node));
+    case Stmt::Kind::IFSTMT:
+      return derived().visit(static_cast<IfStmt &>(node));
+    case Stmt::Kind::FORSTMT:
+      return derived().visit(static_cast<ForStmt &>(node));
+    case Stmt::Kind::WHILESTMT:
+      return derived().visit(static_cast<WhileStmt &>(node));
+    case Stmt::Kind::ASSIGNMENTSTMT:
+      return derived().visit(static_cast<AssignmentStmt &>(node));
+    case Stmt::Kind::RETURNSTMT:
+      return derived().visit(static_cast<ReturnStmt &>(node));
+    case Stmt::Kind::BREAKSTMT:
+      return derived().visit(static_cast<BreakStmt &>(node));
+    case Stmt::Kind::CONTINUESTMT:
+      return derived().visit(static_cast<ContinueStmt &>(node));
+    }
+  }
 
-  virtual void visit(std::shared_ptr<DeclarationStmt> node) = 0;
-  virtual void visit(std::shared_ptr<ExpressionStmt> node) = 0;
-  virtual void visit(std::shared_ptr<BlockStmt> node) = 0;
-  virtual void visit(std::shared_ptr<IfStmt> node) = 0;
-  virtual void visit(std::shared_ptr<ForStmt> node) = 0;
-  virtual void visit(std::shared_ptr<WhileStmt> node) = 0;
-  virtual void visit(std::shared_ptr<AssignmentStmt> node) = 0;
-  virtual void visit(std::shared_ptr<ReturnStmt> node) = 0;
+  void visit(Expr &node) {
+    switch (node.getExprKind()) {
+    case Expr::Kind::BINARYEXPR:
+      return derived().visit(static_cast<BinaryExpr &>(node));
+    case Expr::Kind::UNARYEXPR:
+      return derived().visit(static_cast<UnaryExpr &>(node));
+    case Expr::Kind::LITERALEXPR:
+      return derived().visit(static_cast<LiteralExpr &>(node));
+    case Expr::Kind::IDENTEXPR:
+      return derived().visit(static_cast<IdentExpr &>(node));
+    case Expr::Kind::CALLEXPR:
+      return derived().visit(static_cast<CallExpr &>(node));
+    case Expr::Kind::INDEXEXPR:
+      return derived().visit(static_cast<IndexExpr &>(node));
+    case Expr::Kind::FIELDEXPR:
+      return derived().visit(static_cast<FieldExpr &>(node));
+    case Expr::Kind::ARRAYLITERALEXPR:
+      return derived().visit(static_cast<ArrayLiteralExpr &>(node));
+    case Expr::Kind::CONVERSIONEXPR:
+      return derived().visit(static_cast<ConversionExpr &>(node));
+    case Expr::Kind::SPAWNEXPR:
+      return derived().visit(static_cast<SpawnExpr &>(node));
+    case Expr::Kind::AWAITEXPR:
+      return derived().visit(static_cast<AwaitExpr &>(node));
+    }
+  }
 
-  virtual void visit(std::shared_ptr<BinaryExpr> node) = 0;
-  virtual void visit(std::shared_ptr<UnaryExpr> node) = 0;
-  virtual void visit(std::shared_ptr<LiteralExpr> node) = 0;
-  virtual void visit(std::shared_ptr<IdentExpr> node) = 0;
-  virtual void visit(std::shared_ptr<CallExpr> node) = 0;
+private:
+  Derived &derived() { return *static_cast<Derived *>(this); }
 };
 
 #endif // STOC_ASTPVISITOR_H
@@ -12,14 +12,40 @@
 
 #include <iostream>
 
-#include "stoc/AST/ASTVisitor.h"
+class BasicNode;
+class Decl;
+class VarDecl;
+class ConstDecl;
+class ParamDecl;
+class FuncDecl;
+
+class Stmt;
+class DeclarationStmt;
+class ExpressionStmt;
+class BlockStmt;
+class IfStmt;
+class ForStmt;
+class WhileStmt;
+class AssignmentStmt;
+class ReturnStmt;
+class BreakStmt;
+class ContinueStmt;
+
+class Expr;
+class BinaryExpr;
+class UnaryExpr;
+class LiteralExpr;
+class IdentExpr;
+class CallExpr;
+class IndexExpr;
+class ArrayLiteralExpr;
+class ConversionExpr;
+class SpawnExpr;
+class AwaitExpr;
 
 /// Base class from which other nodes of the AST will inherit.
-/// It implements the Visitor Pattern for adding new operations to the AST nodes
-class BasicNode {
-public:
-  /// method needed for the Visitor Pattern
-  virtual void accept(ASTVisitor *visitor) = 0;
-};
+/// The nodes do not implement a virtual accept method: the AST is traversed with ASTVisitor (see
+/// stoc/AST/ASTVisitor.h), which dispatches on the Kind of Decl, Stmt and Expr nodes.
+class BasicNode {};
 
 #endif // STOC_BASICNODE_H
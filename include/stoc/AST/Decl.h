@@ -5,7 +5,7 @@
 // This file defines the classes of nodes related to Declarations in AST.
 // The declaration nodes inherit from Decl, like VarDecl, ConstDecl, ParamDecl, FuncDecl ....
 // A declaration is a node in the AST that specifies properties of an identifier: variable,
-// function, ...
+// function, struct, ...
 //
 // To add an Decl node in the AST, define it here and make it inherit from Decl. Also, add the
 // declaration in stoc/AST/ASTVisitor.h
@@ -19,20 +19,21 @@
 #include <vector>
 
 #include "stoc/AST/BasicNode.h"
+#include "stoc/AST/TypeSpec.h"
 #include "stoc/Scanner/Token.h"
 #include "stoc/SemanticAnalysis/Type.h"
 
-/// A declaration is a node in the AST that declares a new name (variable, constant, function)
+/// A declaration is a node in the AST that declares a new name (variable, constant, function,
+/// struct)
 class Decl : public BasicNode, public std::enable_shared_from_this<Decl> {
-  // It needs to inherit from std::enable_shared_from_this<Decl> to be able to create a shared_ptr
-  // from inside the class (return this) without creating a new shared_ptr (which would copy
-  // the content of the class) and, when updating the instance of class, the changes are applied
-  // everywhere. [see src/AST/Expr.cpp:VarDecl::accept() for example] Useful when traversing
-  // the AST and modifying it.
+  // It needs to inherit from std::enable_shared_from_this<Decl> because the AST is traversed by
+  // reference, but the symbol table (and IdentExpr) keep a shared_ptr to the declaration of every
+  // symbol. shared_from_this() returns a shared_ptr that shares the ownership with the existing
+  // ones (a new shared_ptr created from \this would delete the node twice).
 
 public:
   /// Type of the declaration of the node in the AST
-  enum class Kind { VARDECL, CONSTDECL, PARAMDECL, FUNCDECL };
+  enum class Kind { VARDECL, CONSTDECL, PARAMDECL, FUNCDECL, STRUCTDECL };
 
 protected:
   Kind declKind;
@@ -48,7 +49,7 @@ class VarDecl : public Decl {
 private:
   /// keyword VAR for declaring a variable (needed for printing AST)
   Token varKeywordToken;
-  Token typeToken;
+  TypeSpec typeSpec;
   Token identifierToken;
 
   std::shared_ptr<Expr> value;
@@ -59,17 +60,15 @@ private:
                                  // custom identifier used inside compiler (not used)
 
 public:
-  VarDecl(Token varKeywordToken, Token typeToken, Token identifierToken,
+  VarDecl(Token varKeywordToken, TypeSpec typeSpec, Token identifierToken,
           std::shared_ptr<Expr> value);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getVarKeywordToken() const;
-  [[nodiscard]] const Token &getTypeToken() const;
+  [[nodiscard]] const TypeSpec &getTypeSpec() const;
   [[nodiscard]] const Token &getIdentifierToken() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getValue() const;
+  void setValue(const std::shared_ptr<Expr> &value);
 
   [[nodiscard]] bool isGlobal() const;
   void setIsGlobal(bool isGlobal);
@@ -85,7 +84,7 @@ class ConstDecl : public Decl {
 private:
   /// keyword CONST for declaring a constant (needed for printing AST)
   Token constKeywordToken;
-  Token typeToken;
+  TypeSpec typeSpec;
   Token identifierToken;
 
   std::shared_ptr<Expr> value;
@@ -96,17 +95,15 @@ private:
                                  // custom identifier used inside compiler (not used)
 
 public:
-  ConstDecl(Token varKeywordToken, Token typeToken, Token identifierToken,
+  ConstDecl(Token varKeywordToken, TypeSpec typeSpec, Token identifierToken,
             std::shared_ptr<Expr> value);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getConstKeywordToken() const;
-  [[nodiscard]] const Token &getTypeToken() const;
+  [[nodiscard]] const TypeSpec &getTypeSpec() const;
   [[nodiscard]] const Token &getIdentifierToken() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getValue() const;
+  void setValue(const std::shared_ptr<Expr> &value);
 
   [[nodiscard]] bool isGlobal() const;
   void setIsGlobal(bool isGlobal);
@@ -121,7 +118,7 @@ class ParamDecl : public Decl {
 private:
   /// keyword VAR/CONST for declaring a variable/constant as a parameter
   Token keywordToken;
-  Token typeToken;
+  TypeSpec typeSpec;
   Token identifierToken;
 
   std::shared_ptr<Type> type;
@@ -129,14 +126,11 @@ private:
                                  // custom identifier used inside compiler (not used)
 
 public:
-  ParamDecl(Token keywordToken, Token typeToken, Token identifierToken);
-
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
+  ParamDecl(Token keywordToken, TypeSpec typeSpec, Token identifierToken);
 
   // Getters
   [[nodiscard]] const Token &getKeywordToken() const;
-  [[nodiscard]] const Token &getTypeToken() const;
+  [[nodiscard]] const TypeSpec &getTypeSpec() const;
   [[nodiscard]] const Token &getIdentifierToken() const;
 
   const std::shared_ptr<Type> &getType() const;
@@ -145,47 +139,119 @@ public:
   void setIdentifierMangled(const std::string &identifierMangled);
 };
 
+/// Attribute of a declaration, written after its name (e.g. packed, align(16))
+struct Attribute {
+  Token name;
+  /// true if the attribute has an argument between parentheses
+  bool hasArgument;
+  Token argument;
+};
+
 /// A function declaration is a node in the AST that declares and defines a function
-///  (e.g. func identifier(param, param) returnType body)
+///  (e.g. func identifier attribute(param, param) returnType body). A const function (e.g. const
+///  func identifier(param) returnType body) is evaluated at compile time when its arguments are
+///  known (see CompileTimeEvaluation)
 class FuncDecl : public Decl {
+public:
+  /// Memory visible to the caller (globals, dynamic arrays, and arrays and atomics received by
+  /// reference) that a call to the function can access
+  enum class Memory { NONE, READ, WRITE };
+
 private:
   /// keyword FUNC for declaring a function
   Token funcKeywordToken;
   Token identifierToken;
+  std::vector<Attribute> attributes;
   std::vector<std::shared_ptr<ParamDecl>> params;
-  Token returnTypeToken;
+  TypeSpec returnTypeSpec;
   /// true if function returns something, false otherwise
   bool hasReturnType;
   std::shared_ptr<BlockStmt> body;
+  /// true if the function is declared with const func
+  bool constant;
 
   std::shared_ptr<Type> type;
   std::string identifierMangled; // mangling is changing identifier from the program source to
                                  // custom identifier used inside compiler. Used to allow for
                                  // function overloading.
 
-public:
-  FuncDecl(Token funcKeywordToken, Token identifierToken,
-           std::vector<std::shared_ptr<ParamDecl>> params, Token returnTypeToken,
-           std::shared_ptr<BlockStmt> body);
+  /// true if the result of a call only depends on its arguments and the call has no effect that
+  /// can be observed (it does not print nor use globals, ...), inferred by the Semantic Analysis
+  bool pure;
+
+  // Effects of a call to the function, inferred after the optimizations of the AST (see
+  // FunctionEffects). Until then, a call can do anything
+  Memory memory;
+  /// true if a call always returns (i.e. there are no loops nor runtime errors)
+  bool willReturn;
+  /// true if the function can call itself, directly or through other functions
+  bool recursive;
 
-  FuncDecl(Token funcKeywordToken, Token identifierToken,
-           std::vector<std::shared_ptr<ParamDecl>> params, std::shared_ptr<BlockStmt> body);
+public:
+  FuncDecl(Token funcKeywordToken, Token identifierToken, std::vector<Attribute> attributes,
+           std::vector<std::shared_ptr<ParamDecl>> params, TypeSpec returnTypeSpec,
+           std::shared_ptr<BlockStmt> body, bool constant = false);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
+  FuncDecl(Token funcKeywordToken, Token identifierToken, std::vector<Attribute> attributes,
+           std::vector<std::shared_ptr<ParamDecl>> params, std::shared_ptr<BlockStmt> body,
+           bool constant = false);
 
   // Getters
   [[nodiscard]] const Token &getFuncKeywordToken() const;
   [[nodiscard]] const Token &getIdentifierToken() const;
+  [[nodiscard]] const std::vector<Attribute> &getAttributes() const;
+  /// returns true if the function has the attribute \name (i.e. fastmath)
+  [[nodiscard]] bool hasAttribute(const std::string &name) const;
   [[nodiscard]] const std::vector<std::shared_ptr<ParamDecl>> &getParams() const;
-  [[nodiscard]] const Token &getReturnTypeToken() const;
+  [[nodiscard]] const TypeSpec &getReturnTypeSpec() const;
   [[nodiscard]] bool isHasReturnType() const;
   [[nodiscard]] const std::shared_ptr<BlockStmt> &getBody() const;
+  [[nodiscard]] bool isConst() const;
 
   const std::shared_ptr<Type> &getType() const;
   void setType(const std::shared_ptr<Type> &type);
   const std::string &getIdentifierMangled() const;
   void setIdentifierMangled(const std::string &identifierMangled);
+  [[nodiscard]] bool isPure() const;
+  void setPure(bool pure);
+  [[nodiscard]] Memory getMemory() const;
+  void setMemory(Memory memory);
+  [[nodiscard]] bool isWillReturn() const;
+  void setWillReturn(bool willReturn);
+  [[nodiscard]] bool isRecursive() const;
+  void setRecursive(bool recursive);
+};
+
+/// Field of a struct declaration (e.g. var type name;)
+struct FieldDecl {
+  TypeSpec typeSpec;
+  Token identifierToken;
+};
+
+/// A struct declaration is a node in the AST that declares a new type made of named fields
+///  (e.g. struct identifier attribute { var type name; var type name; })
+class StructDecl : public Decl {
+private:
+  /// keyword STRUCT for declaring a struct
+  Token structKeywordToken;
+  Token identifierToken;
+  std::vector<Attribute> attributes;
+  std::vector<FieldDecl> fields;
+
+  std::shared_ptr<Type> type;
+
+public:
+  StructDecl(Token structKeywordToken, Token identifierToken, std::vector<Attribute> attributes,
+             std::vector<FieldDecl> fields);
+
+  // Getters
+  [[nodiscard]] const Token &getStructKeywordToken() const;
+  [[nodiscard]] const Token &getIdentifierToken() const;
+  [[nodiscard]] const std::vector<Attribute> &getAttributes() const;
+  [[nodiscard]] const std::vector<FieldDecl> &getFields() const;
+
+  const std::shared_ptr<Type> &getType() const;
+  void setType(const std::shared_ptr<Type> &type);
 };
 
 #endif // STOC_DECL_H
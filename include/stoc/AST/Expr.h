@@ -18,20 +18,27 @@
 #include <vector>
 
 #include "stoc/AST/BasicNode.h"
+#include "stoc/AST/TypeSpec.h"
 #include "stoc/Scanner/Token.h"
 #include "stoc/SemanticAnalysis/Type.h"
 
 /// An expression is a node in the AST that produces a value
-class Expr : public BasicNode, public std::enable_shared_from_this<Expr> {
-  // It needs to inherit from std::enable_shared_from_this<Expr> to be able to create a shared_ptr
-  // from inside the class (return this) without creating a new shared_ptr (which would copy
-  // the content of the class) and, when updating the instance of class, the changes are applied
-  // everywhere. [see src/AST/Expr.cpp:BinaryExpr::accept() for example] Useful when traversing
-  // the AST and modifying it.
-
+class Expr : public BasicNode {
 public:
   /// Type of the expression of the node in the AST
-  enum class Kind { BINARYEXPR, UNARYEXPR, LITERALEXPR, IDENTEXPR, CALLEXPR };
+  enum class Kind {
+    BINARYEXPR,
+    UNARYEXPR,
+    LITERALEXPR,
+    IDENTEXPR,
+    CALLEXPR,
+    INDEXEXPR,
+    FIELDEXPR,
+    ARRAYLITERALEXPR,
+    CONVERSIONEXPR,
+    SPAWNEXPR,
+    AWAITEXPR
+  };
 
   enum class ValueKind {
     Mod_LVal,  // Modifiable LValue: locator value (object that occupies memory) and can be modified
@@ -69,14 +76,15 @@ private:
 public:
   BinaryExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs, Token &op);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const std::shared_ptr<Expr> &getLhs() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getRhs() const;
   [[nodiscard]] const Token &getOp() const;
 
+  // Setters (used to replace subtrees when transforming the AST)
+  void setLhs(const std::shared_ptr<Expr> &lhs);
+  void setRhs(const std::shared_ptr<Expr> &rhs);
+
   // Getters and setters
   const std::shared_ptr<Type> &getType() const override;
   void setType(const std::shared_ptr<Type> &type) override;
@@ -98,13 +106,13 @@ private:
 public:
   UnaryExpr(std::shared_ptr<Expr> rhs, Token &op);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const std::shared_ptr<Expr> &getRhs() const;
   [[nodiscard]] const Token &getOp() const;
 
+  // Setters (used to replace subtrees when transforming the AST)
+  void setRhs(const std::shared_ptr<Expr> &rhs);
+
   // Getters and setters
   const std::shared_ptr<Type> &getType() const override;
   void setType(const std::shared_ptr<Type> &type) override;
@@ -123,9 +131,6 @@ private:
 public:
   explicit LiteralExpr(Token lit);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getToken() const;
 
@@ -149,9 +154,6 @@ private:
 public:
   explicit IdentExpr(Token ident);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getIdent() const;
   [[nodiscard]] const std::string &getName() const;
@@ -165,6 +167,12 @@ public:
 
 /// A call expression is a node in the AST that represents calling a function
 class CallExpr : public Expr {
+public:
+  /// Position of the call (see Semantic). A call in tail position is the value returned by a
+  /// return statement, so the callee can reuse the frame of the caller. A guaranteed tail call
+  /// (MUST_TAIL) always reuses it, so the recursion does not grow the stack
+  enum class TailCall { NONE, TAIL, MUST_TAIL };
+
 private:
   std::shared_ptr<Expr> func;
   std::vector<std::shared_ptr<Expr>> args;
@@ -172,16 +180,200 @@ private:
   /// Expression's type for type checking
   std::shared_ptr<Type> type;
 
+  TailCall tailCall;
+
 public:
   CallExpr(std::shared_ptr<Expr> func, std::vector<std::shared_ptr<Expr>> args);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const std::shared_ptr<Expr> &getFunc() const;
   [[nodiscard]] const std::vector<std::shared_ptr<Expr>> &getArgs() const;
 
+  // Setters (used to replace subtrees when transforming the AST)
+  void setArg(std::size_t idx, const std::shared_ptr<Expr> &arg);
+
+  // Getters and setters
+  const std::shared_ptr<Type> &getType() const override;
+  void setType(const std::shared_ptr<Type> &type) override;
+  [[nodiscard]] TailCall getTailCall() const;
+  void setTailCall(TailCall tailCall);
+};
+
+/// An index expression is a node in the AST that represents accessing an element of an array
+/// (e.g. a[i] -> node(a), node(i))
+class IndexExpr : public Expr {
+private:
+  std::shared_ptr<Expr> array;
+  std::shared_ptr<Expr> index;
+
+  /// '[' and ']' around the index (needed for reporting errors and printing the AST)
+  Token lbrack;
+  Token rbrack;
+
+  /// Expression's type for type checking
+  std::shared_ptr<Type> type;
+
+  /// false if it has been proved that the index is always inside the bounds of the array, so it
+  /// does not have to be checked at runtime (see BoundsCheckElimination)
+  bool boundsCheck;
+
+public:
+  IndexExpr(std::shared_ptr<Expr> array, std::shared_ptr<Expr> index, Token lbrack, Token rbrack);
+
+  // Getters
+  [[nodiscard]] const std::shared_ptr<Expr> &getArray() const;
+  [[nodiscard]] const std::shared_ptr<Expr> &getIndex() const;
+  [[nodiscard]] const Token &getLbrack() const;
+  [[nodiscard]] const Token &getRbrack() const;
+  [[nodiscard]] bool isBoundsCheck() const;
+  void setBoundsCheck(bool boundsCheck);
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setArray(const std::shared_ptr<Expr> &array);
+  void setIndex(const std::shared_ptr<Expr> &index);
+
+  // Getters and setters
+  const std::shared_ptr<Type> &getType() const override;
+  void setType(const std::shared_ptr<Type> &type) override;
+};
+
+/// A field expression is a node in the AST that represents accessing a field of a struct
+/// (e.g. p.x -> node(p), x)
+class FieldExpr : public Expr {
+private:
+  std::shared_ptr<Expr> operand;
+  /// '.' between the struct and the field (needed for reporting errors and printing the AST)
+  Token period;
+  Token field;
+
+  /// Expression's type for type checking
+  std::shared_ptr<Type> type;
+  /// position of the field in the struct, found in Semantic Analysis
+  int fieldIndex;
+
+public:
+  FieldExpr(std::shared_ptr<Expr> operand, Token period, Token field);
+
+  // Getters
+  [[nodiscard]] const std::shared_ptr<Expr> &getOperand() const;
+  [[nodiscard]] const Token &getPeriod() const;
+  [[nodiscard]] const Token &getField() const;
+  [[nodiscard]] int getFieldIndex() const;
+  void setFieldIndex(int fieldIndex);
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setOperand(const std::shared_ptr<Expr> &operand);
+
+  // Getters and setters
+  const std::shared_ptr<Type> &getType() const override;
+  void setType(const std::shared_ptr<Type> &type) override;
+};
+
+/// An array literal expression is a node in the AST that represents an array with the values of
+/// its elements (e.g. [4]int{1, 2, 3} -> node(1), node(2), node(3), the rest of the elements are 0).
+/// It also represents vector literals, with a value for every lane or one value for all the lanes
+/// (e.g. <4>float{1.0, 2.0, 3.0, 4.0} or <4>float{0.5})
+class ArrayLiteralExpr : public Expr {
+private:
+  /// type of the array
+  TypeSpec typeSpec;
+  std::vector<std::shared_ptr<Expr>> elements;
+  Token rbrace;
+
+  /// Expression's type for type checking
+  std::shared_ptr<Type> type;
+
+public:
+  ArrayLiteralExpr(TypeSpec typeSpec, std::vector<std::shared_ptr<Expr>> elements, Token rbrace);
+
+  // Getters
+  [[nodiscard]] const TypeSpec &getTypeSpec() const;
+  [[nodiscard]] const std::vector<std::shared_ptr<Expr>> &getElements() const;
+  [[nodiscard]] const Token &getRbrace() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setElement(std::size_t idx, const std::shared_ptr<Expr> &element);
+
+  // Getters and setters
+  const std::shared_ptr<Type> &getType() const override;
+  void setType(const std::shared_ptr<Type> &type) override;
+};
+
+/// A conversion expression is a node in the AST that represents the explicit conversion of a
+/// numeric value to another numeric type (e.g. int32(x) -> node(x))
+class ConversionExpr : public Expr {
+private:
+  /// keyword of the type the value is converted to (i.e. int32)
+  Token typeToken;
+  std::shared_ptr<Expr> value;
+  Token rparen;
+
+  /// Expression's type for type checking
+  std::shared_ptr<Type> type;
+
+public:
+  ConversionExpr(Token typeToken, std::shared_ptr<Expr> value, Token rparen);
+
+  // Getters
+  [[nodiscard]] const Token &getTypeToken() const;
+  [[nodiscard]] const std::shared_ptr<Expr> &getValue() const;
+  [[nodiscard]] const Token &getRparen() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setValue(const std::shared_ptr<Expr> &value);
+
+  // Getters and setters
+  const std::shared_ptr<Type> &getType() const override;
+  void setType(const std::shared_ptr<Type> &type) override;
+};
+
+/// A spawn expression is a node in the AST that represents a function call that runs in another
+/// thread. Its value is the handle of the task to await its result (e.g. spawn f(x) -> node(f(x)))
+class SpawnExpr : public Expr {
+private:
+  /// keyword SPAWN (needed for reporting errors and printing the AST)
+  Token spawnKeyword;
+  std::shared_ptr<Expr> call;
+
+  /// Expression's type for type checking
+  std::shared_ptr<Type> type;
+
+public:
+  SpawnExpr(Token spawnKeyword, std::shared_ptr<Expr> call);
+
+  // Getters
+  [[nodiscard]] const Token &getSpawnKeyword() const;
+  [[nodiscard]] const std::shared_ptr<Expr> &getCall() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setCall(const std::shared_ptr<Expr> &call);
+
+  // Getters and setters
+  const std::shared_ptr<Type> &getType() const override;
+  void setType(const std::shared_ptr<Type> &type) override;
+};
+
+/// An await expression is a node in the AST that represents waiting for a task spawned to finish.
+/// Its value is the result of the function call (e.g. await h -> node(h))
+class AwaitExpr : public Expr {
+private:
+  /// keyword AWAIT (needed for reporting errors and printing the AST)
+  Token awaitKeyword;
+  std::shared_ptr<Expr> task;
+
+  /// Expression's type for type checking
+  std::shared_ptr<Type> type;
+
+public:
+  AwaitExpr(Token awaitKeyword, std::shared_ptr<Expr> task);
+
+  // Getters
+  [[nodiscard]] const Token &getAwaitKeyword() const;
+  [[nodiscard]] const std::shared_ptr<Expr> &getTask() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setTask(const std::shared_ptr<Expr> &task);
+
   // Getters and setters
   const std::shared_ptr<Type> &getType() const override;
   void setType(const std::shared_ptr<Type> &type) override;
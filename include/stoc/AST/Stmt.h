@@ -20,13 +20,7 @@
 #include "stoc/Scanner/Token.h"
 
 /// An statement is a node in the AST that expresses some action (controlling flow, ...)
-class Stmt : public BasicNode, public std::enable_shared_from_this<Stmt> {
-  // It needs to inherit from std::enable_shared_from_this<Stmt> to be able to create a shared_ptr
-  // from inside the class (return this) without creating a new shared_ptr (which would copy
-  // the content of the class) and, when updating the instance of class, the changes are applied
-  // everywhere. [see src/AST/Expr.cpp:AssignmentStmt::accept() for example]. Useful when traversing
-  // the AST and modifying it.
-
+class Stmt : public BasicNode {
 public:
   enum class Kind {
     DECLARATIONSTMT,
@@ -36,7 +30,9 @@ public:
     FORSTMT,
     WHILESTMT,
     ASSIGNMENTSTMT,
-    RETURNSTMT
+    RETURNSTMT,
+    BREAKSTMT,
+    CONTINUESTMT
   };
 
 protected:
@@ -55,11 +51,11 @@ private:
 public:
   explicit ExpressionStmt(std::shared_ptr<Expr> expr);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const std::shared_ptr<Expr> &getExpr() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setExpr(const std::shared_ptr<Expr> &expr);
 };
 
 /// A declaration statement is a node in the AST that represents a declaration in a block statement
@@ -70,9 +66,6 @@ private:
 public:
   explicit DeclarationStmt(std::shared_ptr<Decl> decl);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const std::shared_ptr<Decl> &getDecl() const;
 };
@@ -90,13 +83,13 @@ private:
 public:
   AssignmentStmt(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs, Token equalToken);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getEqualToken() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getLhs() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getRhs() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setRhs(const std::shared_ptr<Expr> &rhs);
 };
 
 /// A block assignment is a node in the AST that represents a list of statements that goes between
@@ -110,13 +103,13 @@ private:
 public:
   BlockStmt(Token lbrace, std::vector<std::shared_ptr<Stmt>> stmts, Token rbrace);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getLbrace() const;
   [[nodiscard]] const Token &getRbrace() const;
   [[nodiscard]] const std::vector<std::shared_ptr<Stmt>> &getStmts() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setStmts(const std::vector<std::shared_ptr<Stmt>> &stmts);
 };
 
 /// An if statement is a node in the AST that represents the if conditional control flow structure
@@ -135,19 +128,29 @@ public:
 
   IfStmt(Token ifKeyword, std::shared_ptr<Expr> condition, std::shared_ptr<BlockStmt> thenBranch);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getIfKeyword() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getCondition() const;
   [[nodiscard]] const std::shared_ptr<BlockStmt> &getThenBranch() const;
   [[nodiscard]] const std::shared_ptr<Stmt> &getElseBranch() const;
   [[nodiscard]] bool isHasElse() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setCondition(const std::shared_ptr<Expr> &condition);
+  /// sets the else branch of the if statement. If \elseBranch is nullptr, it has no else branch
+  void setElseBranch(const std::shared_ptr<Stmt> &elseBranch);
 };
 
 /// A for statement is a node in the AST that represents the for loop control flow structure
 class ForStmt : public Stmt {
+public:
+  /// Reduction of a parallel for (i.e. sum total): every thread accumulates in its own copy of the
+  /// variable, and the copies are combined with the variable when the loop ends
+  struct Reduction {
+    Token op; /// IDENTIFIER sum, min or max
+    std::shared_ptr<IdentExpr> variable;
+  };
+
 private:
   /// keyword FOR (needed for printing AST)
   Token forKeyword;
@@ -156,19 +159,38 @@ private:
   std::shared_ptr<Stmt> post;
   std::shared_ptr<BlockStmt> body;
 
+  /// A parallel for (parallel(sum s) for ...) runs its iterations in several threads
+  bool parallel;
+  /// keyword PARALLEL (needed for printing AST)
+  Token parallelKeyword;
+  std::vector<Reduction> reductions;
+  /// Local variables declared outside a parallel for and used inside it (set in Semantic
+  /// Analysis). The function in which the body is outlined accesses them through their address
+  std::vector<std::shared_ptr<Decl>> capturedVariables;
+
 public:
   ForStmt(Token forKeyword, std::shared_ptr<Stmt> init, std::shared_ptr<Expr> cond,
           std::shared_ptr<Stmt> post, std::shared_ptr<BlockStmt> body);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getForKeyword() const;
   [[nodiscard]] const std::shared_ptr<Stmt> &getInit() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getCond() const;
   [[nodiscard]] const std::shared_ptr<Stmt> &getPost() const;
   [[nodiscard]] const std::shared_ptr<BlockStmt> &getBody() const;
+  [[nodiscard]] bool isParallel() const;
+  [[nodiscard]] const Token &getParallelKeyword() const;
+  [[nodiscard]] const std::vector<Reduction> &getReductions() const;
+  [[nodiscard]] const std::vector<std::shared_ptr<Decl>> &getCapturedVariables() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setCond(const std::shared_ptr<Expr> &cond);
+
+  /// makes the for statement a parallel for with \reductions
+  void setParallel(Token parallelKeyword, std::vector<Reduction> reductions);
+
+  /// adds \variable to the captured variables of a parallel for (only once)
+  void addCapturedVariable(const std::shared_ptr<Decl> &variable);
 };
 
 /// A while statement is a node in the AST that represents the while loop control flow structure
@@ -182,13 +204,13 @@ private:
 public:
   WhileStmt(Token whileKeyword, std::shared_ptr<Expr> cond, std::shared_ptr<BlockStmt> body);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getWhileKeyword() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getCond() const;
   [[nodiscard]] const std::shared_ptr<BlockStmt> &getBody() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setCond(const std::shared_ptr<Expr> &cond);
 };
 
 /// A return statement is a node in the AST that represents the return value of a function
@@ -201,12 +223,39 @@ private:
 public:
   ReturnStmt(Token returnKeyword, std::shared_ptr<Expr> value);
 
-  /// method needed for the Visitor Pattern
-  void accept(ASTVisitor *visitor) override;
-
   // Getters
   [[nodiscard]] const Token &getReturnKeyword() const;
   [[nodiscard]] const std::shared_ptr<Expr> &getValue() const;
+
+  // Setters (used to replace subtrees when transforming the AST)
+  void setValue(const std::shared_ptr<Expr> &value);
+};
+
+/// A break statement is a node in the AST that represents the exit of the innermost loop
+class BreakStmt : public Stmt {
+private:
+  /// keyword BREAK (needed for printing the AST)
+  Token breakKeyword;
+
+public:
+  explicit BreakStmt(Token breakKeyword);
+
+  // Getters
+  [[nodiscard]] const Token &getBreakKeyword() const;
+};
+
+/// A continue statement is a node in the AST that represents the jump to the next iteration of the
+/// innermost loop
+class ContinueStmt : public Stmt {
+private:
+  /// keyword CONTINUE (needed for printing the AST)
+  Token continueKeyword;
+
+public:
+  explicit ContinueStmt(Token continueKeyword);
+
+  // Getters
+  [[nodiscard]] const Token &getContinueKeyword() const;
 };
 
 // TODO: (improvement) add EmptyStmt
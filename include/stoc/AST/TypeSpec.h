@@ -0,0 +1,70 @@
+//===- stoc/AST/TypeSpec.h - Defintion of the TypeSpec class ------------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the TypeSpec class.
+// A TypeSpec is a type as it is written in the source code of a declaration (i.e. int, [4]float,
+// []int, <4>float or Point). It is resolved into a Type during the semantic analysis.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_TYPESPEC_H
+#define STOC_TYPESPEC_H
+
+#include <memory>
+#include <string>
+
+#include "stoc/Scanner/Token.h"
+
+/// Type written in the source code of a declaration
+class TypeSpec {
+public:
+  enum class Kind {
+    BASIC,       // bool, int, float, string
+    ARRAY,       // [N]type: array of fixed size N
+    DYNAMICARRAY, // []type: array that can grow
+    VECTOR,       // <N>type: SIMD vector of N lanes
+    TASK,         // task type: handle of a function call spawned that returns type
+    ATOMIC,       // atomic type: integer or bool accessed atomically
+    STRUCT        // name of a struct type
+  };
+
+private:
+  Kind typeSpecKind;
+
+  /// keyword of a basic type (i.e. INT), '[' of an array type, '<' of a vector type, TASK, ATOMIC
+  /// or the name of a struct type (IDENTIFIER)
+  Token token;
+
+  /// size of a fixed-size array or number of lanes of a vector (LIT_INT)
+  Token size;
+
+  /// type of the elements of an array, of the lanes of a vector, of the result of a task or of the
+  /// value of an atomic
+  std::shared_ptr<TypeSpec> element;
+
+public:
+  TypeSpec() = default;
+
+  /// basic type or struct type, depending on \basicType (keyword of the type or IDENTIFIER)
+  explicit TypeSpec(Token basicType);
+
+  /// fixed-size array, [size]element, or vector, <size>element, depending on \open ('[' or '<')
+  TypeSpec(Token open, Token size, std::shared_ptr<TypeSpec> element);
+
+  /// dynamic array, []element, task, task element, or atomic, atomic element, depending on \open
+  /// ('[', TASK or ATOMIC)
+  TypeSpec(Token open, std::shared_ptr<TypeSpec> element);
+
+  // Getters
+  [[nodiscard]] Kind getKind() const;
+  /// returns the first token of the type, used to report errors
+  [[nodiscard]] const Token &getToken() const;
+  [[nodiscard]] const Token &getSize() const;
+  [[nodiscard]] const std::shared_ptr<TypeSpec> &getElement() const;
+
+  /// returns the type as it is written in the source code (i.e. [4]int)
+  [[nodiscard]] std::string getName() const;
+};
+
+#endif // STOC_TYPESPEC_H
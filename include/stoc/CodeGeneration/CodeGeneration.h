@@ -13,12 +13,14 @@
 #ifndef STOC_CODEGENERATION_H
 #define STOC_CODEGENERATION_H
 
+#include <functional>
 #include <memory>
 #include <unordered_set>
 
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
 
 #include "stoc/AST/Decl.h"
 #include "stoc/AST/Expr.h"
@@ -26,13 +28,22 @@
 #include "stoc/SemanticAnalysis/Type.h"
 #include "stoc/SrcFile/SrcFile.h"
 
+/// Semantics of the integer operations +, -, * and the negation when the result does not fit in the
+/// type (set with --overflow)
+enum class OverflowMode {
+  WRAP, /// the result wraps around (two's complement), the default
+  NSW,  /// overflow is undefined, so the optimizer can assume it never happens (nsw/nuw flags)
+  TRAP  /// overflow is checked and stops the program with a runtime error
+};
+
 /// Phase of the compiler that translates the AST (after Semantic Analysis) into Intermediate
 /// Representation. Because the LLVM tools are used, the output of this phase is LLVM IR.
 class CodeGeneration {
   // This class will visit every AST node and generate the code of that node. It will traverse
   // the AST nodes recursively but without implementing the visitor pattern used in other parts of
   // the stoc compiler, because for this phase, some of the methods have to return some value when
-  // visiting a node.
+  // visiting a node. Like in the ASTVisitor, nodes are passed by reference and the methods for
+  // Decl, Stmt and Expr dispatch on the Kind of the node.
 private:
   std::shared_ptr<SrcFile> file; /// stoc source file, list of tokens and AST
 
@@ -41,6 +52,37 @@ private:
   llvm::LLVMContext context;
   std::shared_ptr<llvm::Module> module;
   std::shared_ptr<llvm::IRBuilder<>> builder;
+  std::unique_ptr<llvm::TargetMachine> targetMachine;
+
+  /// Optimization level (0-3) requested with -O. If it is negative, no optimization level was
+  /// requested: the LLVM IR is not optimized and the backend uses its default optimization level.
+  int optimizationLevel;
+
+  /// Maximum number of threads used to generate the object files (set with -j)
+  unsigned jobs;
+
+  /// Target triple of the code generated (set with --target). If it is empty, the host is the
+  /// target
+  std::string targetTriple;
+
+  /// CPU of the code generated (set with --mcpu): generic, a CPU of the target (i.e. skylake) or
+  /// native, the CPU of the host. It decides the vector registers used by the vectors of Stoc
+  std::string cpu;
+
+  /// Semantics of the integer operations that overflow (set with --overflow)
+  OverflowMode overflow;
+
+  /// Fast-math flags of the floating-point operations (set with --ffast-math, --fp-contract=fast
+  /// and --fno-honor-nans). The functions with the attribute fastmath use every fast-math flag
+  llvm::FastMathFlags fastMath;
+
+  /// When generating incrementally (i.e. one module per input of the REPL), the globals have
+  /// external linkage and they are initialized by a function called explicitly instead of a global
+  /// constructor
+  bool incremental;
+
+  /// Functions that initialize the globals, when generating incrementally
+  std::vector<llvm::Function *> initializationFunctions;
 
   /// Map that relates a global variable's string identifier with the LLVM value
   std::unordered_map<std::string, llvm::Value *> globalVariables;
@@ -51,12 +93,26 @@ private:
 
   std::unordered_set<std::string> builtinFunctions;
 
+  /// Map that relates the name of a struct with its LLVM type, created the first time it is used
+  std::unordered_map<std::string, llvm::StructType *> structTypes;
+
   // This basic block is used if a function has multiple returns. In that case, for every return
   // statement, a store to a special return variable is generated and in the end of the function
   // this basic block is appended to return the value of the special variable only once inside the
   // generated LLVM IR function.
   llvm::BasicBlock *exitBB;
 
+  /// Basic blocks where the break and continue statements of a loop jump to: the continuation of
+  /// the loop and the block that starts the next iteration (the post statement of a for loop or
+  /// the condition of a while loop)
+  struct LoopTargets {
+    llvm::BasicBlock *breakBB;
+    llvm::BasicBlock *continueBB;
+  };
+
+  /// Loops (nested) whose body is being generated. The innermost loop is the last one
+  std::vector<LoopTargets> loopTargets;
+
   // HELPER METHODS
   /// prints the error \error_msg with information about line and column of the error
   void reportError(std::string error_msg, int line, int column);
@@ -64,120 +120,320 @@ private:
   /// prints the error \error_msg
   void reportError(std::string error_msg);
 
-  /// initializes LLVM with information about the target machine for better optimization
+  /// gets the target machine for the target (the host by default) from the cache, to have
+  /// information about the target for better optimization
   void initialization();
 
+  /// returns the number of partitions in which the module is split to generate the object files in
+  /// parallel: one per job, but never more than the number of functions with body
+  unsigned getNumberOfPartitions();
+
   /// declares the builtin function used to compare strings (strcmp from the C string library)
   void declareStringBuiltinFunctions();
 
-  /// declares the builtin functions print and println (printf from the C stdio library)
+  /// declares the builtin functions print and println (printf from the C stdio library) and the
+  /// builtin functions on vectors
   void declareBuiltinFunctions();
 
+  /// declares the builtin functions len and append for dynamic arrays, and the functions of the C
+  /// library used by arrays (malloc and realloc from stdlib to allocate dynamic arrays and exit to
+  /// stop the program when an index is out of range)
+  void declareArrayBuiltinFunctions();
+
+  /// returns the function called when the index of an array is out of range. It prints the error
+  /// and exits. It is generated the first time it is needed
+  llvm::Function *getIndexOutOfRangeFunction();
+
+  /// returns the function called when an integer operation overflows with --overflow=trap. It
+  /// prints the error and exits. It is generated the first time it is needed
+  llvm::Function *getIntegerOverflowFunction();
+
   /// returns true if the identifier \functionName is a builtin function in Stoc
   bool isBuiltinFunction(std::string functionName);
 
   /// generates LLVM IR for calling print/println builtin function in Stoc
   llvm::Value *generateCallBuiltinFunction(std::string functionName,
-                                           const std::shared_ptr<CallExpr> &node);
+                                           const CallExpr &node);
+
+  /// returns \value of type \type as it is passed to printf (i.e. an int8 is extended to 64 bits)
+  llvm::Value *generatePrintfArgument(llvm::Value *value, const std::shared_ptr<BasicType> &type);
 
   /// generates LLVM IR for calling print builtin function in Stoc
-  llvm::Value *generateCallPrint(const std::shared_ptr<CallExpr> &node);
+  llvm::Value *generateCallPrint(const CallExpr &node);
+
+  /// generates LLVM IR for calling print or println (if \newline) with a vector, printed as
+  /// <lane0, lane1, ...> with a single call to printf
+  llvm::Value *generateCallPrintVector(const CallExpr &node, bool newline);
 
   /// generates LLVM IR for calling println builtin function in Stoc
-  llvm::Value *generateCallPrintln(const std::shared_ptr<CallExpr> &node);
+  llvm::Value *generateCallPrintln(const CallExpr &node);
+
+  /// generates LLVM IR for calling len builtin function in Stoc (number of elements of a dynamic
+  /// array)
+  llvm::Value *generateCallLen(const CallExpr &node);
+
+  /// generates LLVM IR for calling append builtin function in Stoc. If the dynamic array is full,
+  /// its capacity is doubled (realloc) before appending the element
+  llvm::Value *generateCallAppend(const CallExpr &node);
+
+  /// generates LLVM IR for calling the builtin functions on vectors in Stoc (select, shuffle,
+  /// reduce_add, reduce_min, reduce_max, any and all). They are instructions, not calls
+  llvm::Value *generateCallVectorBuiltin(const std::string &functionName, const CallExpr &node);
+
+  /// generates LLVM IR for calling the builtin functions on atomics in Stoc (load, store, exchange,
+  /// compare_exchange and the fetch operations): atomic load and store, atomicrmw and cmpxchg
+  /// with the memory ordering of the last argument (seq_cst if there is none)
+  llvm::Value *generateCallAtomicBuiltin(const std::string &functionName, const CallExpr &node);
+
+  /// generates LLVM IR for calling the builtin functions on the bits of integers in Stoc (popcount,
+  /// clz, ctz, bswap and rotl). They are calls to LLVM intrinsics (ctpop, ctlz, cttz, bswap and
+  /// fshl), which are a single instruction on most targets
+  llvm::Value *generateCallBitBuiltin(const std::string &functionName, const CallExpr &node);
+
+  /// combines the lanes of \vector with \combine and returns the result. The upper half of the
+  /// lanes is combined with the lower half until one lane is left (log2(lanes) steps), so the
+  /// reduction is done in vector registers
+  llvm::Value *
+  generateReduction(llvm::Value *vector, std::int64_t lanes,
+                    const std::function<llvm::Value *(llvm::Value *, llvm::Value *)> &combine);
+
+  /// declares the functions of the runtime of the parallel for loops (see Runtime/Parallel.h),
+  /// the first time a parallel for is generated
+  void declareParallelRuntimeFunctions();
+
+  /// declares the functions of the runtime of the tasks (see Runtime/Task.h), the first time a
+  /// task is spawned or awaited
+  void declareTaskRuntimeFunctions();
+
+  /// Returns the type of the box of a task that calls \callee: { state, result, arguments... }.
+  /// The state is used by the runtime to know if the task has finished
+  llvm::StructType *getTaskBoxType(llvm::Function *callee);
+
+  /// Returns the function run by the runtime for a task that calls \callee. It reads the arguments
+  /// from the box, calls \callee and stores the result in the box. It is generated the first time
+  /// it is needed
+  llvm::Function *getTaskFunction(llvm::Function *callee);
+
+  /// Returns the value with which every thread starts the reduction \op (sum, min or max) of type
+  /// \type: 0 for sum and the greatest (for min) or lowest (for max) value of the type
+  llvm::Constant *getReductionIdentity(const std::string &op, const std::shared_ptr<Type> &type);
+
+  /// Generates LLVM IR for a parallel for. The body of the loop is outlined in a function that
+  /// runs a range of iterations, which receives the addresses of the captured variables in an
+  /// array. The range of iterations is split between threads by the runtime (stoc_parallel_for)
+  void generateParallelFor(const ForStmt &node);
 
   /// If Expr is an IdentExpr, it return the string of the identifier. If Expr is not an IdentExpr
   /// it ...
-  std::string getIdentifier(const std::shared_ptr<Expr> &node);
+  std::string getIdentifier(const Expr &node);
+
+  /// Returns the mangled identifier of a declaration of a variable, constant, parameter or
+  /// function, or the name of a struct
+  std::string getIdentifier(const Decl &node);
 
   /// Returns the LLVM type corresponding to the type of stoc: int (Int64Ty), float (DoubleTy),
   /// bool (Int1Ty), ...
   llvm::Type *getLLVMType(std::shared_ptr<Type> type);
 
+  /// Returns the LLVM type of a struct (%struct.Name), created the first time it is used. A packed
+  /// struct has no padding and a struct aligned to N bytes ends with an empty array of a vector
+  /// of N bytes, so LLVM aligns it (and rounds its size) to N wherever it is stored
+  llvm::StructType *getLLVMStructType(const std::shared_ptr<StructType> &type);
+
   /// Returns the default value used to initialize a variable in LLVM IR (0 for int, 0.0 for float,
-  /// "" for string, false(0) for bool)
+  /// "" for string, false(0) for bool, all elements to their default value for arrays)
   llvm::Constant *getLLVMInit(std::shared_ptr<Type> type);
 
+  /// Returns \type if it is a basic type or the type of the lanes if it is a vector. The operators
+  /// on vectors use the same instructions as on the type of the lanes
+  static std::shared_ptr<BasicType> getScalarType(const std::shared_ptr<Type> &type);
+
+  /// Returns true if \type is a fixed-size array. The value of an expression of a fixed-size array
+  /// is the address of the array ([N x T]*), so it is copied instead of stored (see storeValue)
+  static bool isFixedSizeArray(const std::shared_ptr<Type> &type);
+
+  /// Returns true if \type is an atomic. Like a fixed-size array, the value of an expression of an
+  /// atomic is its address, so it can only be accessed with the atomic operations
+  static bool isAtomic(const std::shared_ptr<Type> &type);
+
+  /// Returns true if \type is a fixed-size array of a struct with the attribute soa. It is stored
+  /// as a struct of arrays, one for every field ({[N x field0], [N x field1], ...}), so the
+  /// elements have no address and they are read and written field by field
+  static bool isStructOfArrays(const std::shared_ptr<Type> &type);
+
+  /// Returns true if the values of \type are passed to a function by reference: fixed-size arrays
+  /// (copied by the function) and atomics (shared with the caller)
+  static bool isPassedByReference(const std::shared_ptr<Type> &type);
+
+  /// Stores \value of type \type in \address. Fixed-size arrays are copied with memcpy
+  void storeValue(llvm::Value *value, llvm::Value *address, const std::shared_ptr<Type> &type);
+
+  /// Creates an alloca in the entry block of the current function, so the stack does not grow if
+  /// it is executed inside a loop and it can be promoted to registers
+  llvm::AllocaInst *createEntryBlockAlloca(llvm::Type *type, const std::string &name = "");
+
+  /// Returns the LLVM constant for an array literal whose elements are literals, to initialize a
+  /// global statically. Returns nullptr if it can not be a constant (i.e. dynamic arrays)
+  llvm::Constant *generateConstantArray(const Expr &node);
+
+  /// Generates the address of a variable, of an element of an array or of a field of a struct, the
+  /// expressions that can be assigned
+  llvm::Value *generateAddress(const Expr &node);
+
+  /// Generates the array (\array) and the index of an index expression on an array, and returns
+  /// the index. Unless the bounds check has been eliminated (see BoundsCheckElimination), the index
+  /// is checked to be in range
+  llvm::Value *generateIndex(const IndexExpr &node, llvm::Value *&array);
+
+  /// Generates the address of the element accessed by an index expression
+  llvm::Value *generateElementAddress(const IndexExpr &node);
+
+  /// Generates the addresses of the fields of the element accessed by an index expression on a
+  /// struct of arrays (see isStructOfArrays), one in the array of every field
+  std::vector<llvm::Value *> generateFieldAddresses(const IndexExpr &node);
+
+  /// Generates LLVM IR for a call to the name of a struct, that creates a value of the struct
+  llvm::Value *generateStructLiteral(const CallExpr &node);
+
+  /// Generates LLVM IR for the declarations of the AST, first the globals and the prototypes of
+  /// the functions and then the bodies of the functions
+  void generateDeclarations();
+
+  /// Declares a function or global of a previous input (generated in another module) when
+  /// generating incrementally
+  void declareExternal(const Decl &node);
+
+  /// Adds \function to the functions that initialize the globals: a global constructor or, when
+  /// generating incrementally, the initialization function of the input
+  void addInitializationFunction(llvm::Function *function);
+
+  /// Returns the linkage of global variables and constants: private, or external when generating
+  /// incrementally
+  llvm::GlobalValue::LinkageTypes getGlobalLinkage();
+
   /// Generates function to initialize global variables
-  void generateFunctionForInitialization(const std::shared_ptr<VarDecl> &node, llvm::Value *GV);
+  void generateFunctionForInitialization(const VarDecl &node, llvm::Value *GV);
 
   /// Generates function to initialize global constants
-  void generateFunctionForInitialization(const std::shared_ptr<ConstDecl> &node, llvm::Value *GV);
+  void generateFunctionForInitialization(const ConstDecl &node, llvm::Value *GV);
+
+  /// Generates the LLVM IR function (without body) for a function declaration in Stoc, so it can be
+  /// called before its body is generated
+  void declareFunction(const FuncDecl &node);
 
   /// Generates LLVM IR for global variable declarations in Stoc
-  void generateGlobalVariableDecl(const std::shared_ptr<VarDecl> &node);
+  void generateGlobalVariableDecl(const VarDecl &node);
 
   /// Generates LLVM IR for variable declarations inside functions in Stoc
-  void generateLocalVariableDecl(const std::shared_ptr<VarDecl> &node);
+  void generateLocalVariableDecl(const VarDecl &node);
 
   /// Generates LLVM IR for global constants declarations in Stoc
-  void generateGlobalConstantDecl(const std::shared_ptr<ConstDecl> &node);
+  void generateGlobalConstantDecl(const ConstDecl &node);
 
   /// Generates LLVM IR for constants declarations inside functions in Stoc
-  void generateLocalConstantDecl(const std::shared_ptr<ConstDecl> &node);
+  void generateLocalConstantDecl(const ConstDecl &node);
 
-  /// Generates LLVM IR for binary expressions on integer operands
-  llvm::Value *generateBinaryExprInt(const std::shared_ptr<BinaryExpr> &node, llvm::Value *lhs,
+  /// Generates LLVM IR for binary expressions on integer operands (signed or unsigned)
+  llvm::Value *generateBinaryExprInt(const BinaryExpr &node, llvm::Value *lhs,
                                      llvm::Value *rhs);
 
+  /// Generates LLVM IR for the integer operation \opcode (add, sub or mul) with the semantics of
+  /// \overflow: a plain instruction (wrap), an instruction with the nsw (or nuw if \isUnsigned)
+  /// flag, or a call to the *.with.overflow intrinsic followed by a check that branches to a cold
+  /// block that reports the error in the line of \op (trap)
+  llvm::Value *generateIntArithmetic(llvm::Instruction::BinaryOps opcode, llvm::Value *lhs,
+                                     llvm::Value *rhs, bool isUnsigned, const Token &op,
+                                     const std::string &name);
+
   /// Generates LLVM IR for binary expressions on float operands
-  llvm::Value *generateBinaryExprFloat(const std::shared_ptr<BinaryExpr> &node, llvm::Value *lhs,
+  llvm::Value *generateBinaryExprFloat(const BinaryExpr &node, llvm::Value *lhs,
                                        llvm::Value *rhs);
 
   /// Generates LLVM IR for binary expressions on bool operands
-  llvm::Value *generateBinaryExprBool(const std::shared_ptr<BinaryExpr> &node, llvm::Value *lhs,
+  llvm::Value *generateBinaryExprBool(const BinaryExpr &node, llvm::Value *lhs,
                                       llvm::Value *rhs);
 
   /// Generates LLVM IR for binary expressions on string operands
-  llvm::Value *generateBinaryExprString(const std::shared_ptr<BinaryExpr> &node, llvm::Value *lhs,
+  llvm::Value *generateBinaryExprString(const BinaryExpr &node, llvm::Value *lhs,
                                         llvm::Value *rhs);
 
   /// Generates LLVM IR for unary expressions on integer operand
-  llvm::Value *generateUnaryExprInt(const std::shared_ptr<UnaryExpr> &node, llvm::Value *rhs);
+  llvm::Value *generateUnaryExprInt(const UnaryExpr &node, llvm::Value *rhs);
 
   /// Generates LLVM IR for unary expressions on float operand
-  llvm::Value *generateUnaryExprFloat(const std::shared_ptr<UnaryExpr> &node, llvm::Value *rhs);
+  llvm::Value *generateUnaryExprFloat(const UnaryExpr &node, llvm::Value *rhs);
 
   /// Generates LLVM IR for bool expressions on bool operands
-  llvm::Value *generateUnaryExprBool(const std::shared_ptr<UnaryExpr> &node, llvm::Value *rhs);
+  llvm::Value *generateUnaryExprBool(const UnaryExpr &node, llvm::Value *rhs);
 
   // MAIN METHODS
-  llvm::Value *generate(const std::shared_ptr<Expr> &node);
-  void generate(const std::shared_ptr<Decl> &node);
-  void generate(const std::shared_ptr<Stmt> &node);
-
-  void generate(const std::shared_ptr<VarDecl> &node);
-  void generate(const std::shared_ptr<ConstDecl> &node);
-  void generate(const std::shared_ptr<ParamDecl> &node);
-  void generate(const std::shared_ptr<FuncDecl> &node);
-
-  void generate(const std::shared_ptr<DeclarationStmt> &node);
-  void generate(const std::shared_ptr<ExpressionStmt> &node);
-  void generate(const std::shared_ptr<BlockStmt> &node);
-  void generate(const std::shared_ptr<IfStmt> &node);
-  void generate(const std::shared_ptr<ForStmt> &node);
-  void generate(const std::shared_ptr<WhileStmt> &node);
-  void generate(const std::shared_ptr<AssignmentStmt> &node);
-  void generate(const std::shared_ptr<ReturnStmt> &node);
-
-  llvm::Value *generate(const std::shared_ptr<BinaryExpr> &node);
-  llvm::Value *generate(const std::shared_ptr<UnaryExpr> &node);
-  llvm::Value *generate(const std::shared_ptr<LiteralExpr> &node);
-  llvm::Value *generate(const std::shared_ptr<IdentExpr> &node);
-  llvm::Value *generate(const std::shared_ptr<CallExpr> &node);
+  llvm::Value *generate(const Expr &node);
+  void generate(const Decl &node);
+  void generate(const Stmt &node);
+
+  void generate(const VarDecl &node);
+  void generate(const ConstDecl &node);
+  void generate(const ParamDecl &node);
+  void generate(const FuncDecl &node);
+  void generate(const StructDecl &node);
+
+  void generate(const DeclarationStmt &node);
+  void generate(const ExpressionStmt &node);
+  void generate(const BlockStmt &node);
+  void generate(const IfStmt &node);
+  void generate(const ForStmt &node);
+  void generate(const WhileStmt &node);
+  void generate(const AssignmentStmt &node);
+  void generate(const ReturnStmt &node);
+  void generate(const BreakStmt &node);
+  void generate(const ContinueStmt &node);
+
+  llvm::Value *generate(const BinaryExpr &node);
+  llvm::Value *generate(const UnaryExpr &node);
+  llvm::Value *generate(const LiteralExpr &node);
+  llvm::Value *generate(const IdentExpr &node);
+  llvm::Value *generate(const CallExpr &node);
+  llvm::Value *generate(const IndexExpr &node);
+  llvm::Value *generate(const FieldExpr &node);
+  llvm::Value *generate(const ArrayLiteralExpr &node);
+  llvm::Value *generate(const ConversionExpr &node);
+  llvm::Value *generate(const SpawnExpr &node);
+  llvm::Value *generate(const AwaitExpr &node);
 
 public:
-  explicit CodeGeneration(std::shared_ptr<SrcFile> &file);
+  explicit CodeGeneration(std::shared_ptr<SrcFile> &file, unsigned jobs = 1,
+                          std::string targetTriple = "", std::string cpu = "generic",
+                          OverflowMode overflow = OverflowMode::WRAP,
+                          llvm::FastMathFlags fastMath = llvm::FastMathFlags());
+
+  /// gives the target machine back to the cache (see TargetMachineCache.h)
+  ~CodeGeneration();
 
   /// main method: generates LLVM IR code
   void generate();
 
+  /// generates LLVM IR code for one input of a program compiled incrementally (i.e. the REPL).
+  /// \previousDeclarations are the declarations of previous inputs, generated in other modules, and
+  /// the globals of this input are initialized by the function \initializationFunctionName
+  void generateIncremental(const std::vector<std::shared_ptr<Decl>> &previousDeclarations,
+                           const std::string &initializationFunctionName);
+
+  /// returns the LLVM module generated
+  llvm::Module &getModule();
+
+  /// runs the LLVM optimization pipeline for \optLevel (0-3) on the LLVM IR generated. The same
+  /// level is later used by the backend when generating the executable
+  void optimize(unsigned optLevel);
+
   /// prints the LLVM IR generated
   void printLLVM();
 
-  /// must call after generating the LLVM IR. Transfoms LLVM IR into an executable by invoking other
-  /// programs like the llc (LLVM static compiler) and gcc (GNU C Compiler that invokes the linker)
-  void getExecutable();
+  /// must call after generating the LLVM IR. Transfoms LLVM IR into object files, splitting the
+  /// module in partitions that are compiled in parallel, and links them into an executable with gcc
+  /// (GNU C Compiler that invokes the linker). The object files and the executable are written in
+  /// \outputDirectory (the current directory if it is empty). If the target is not the host, the
+  /// object files are not linked
+  void getExecutable(const std::string &outputDirectory = "");
 };
 
 #endif // STOC_CODEGENERATION_H
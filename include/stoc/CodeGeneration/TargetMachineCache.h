@@ -0,0 +1,62 @@
+//===- stoc/CodeGeneration/TargetMachineCache.h - Defintion of the cache ------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the TargetMachineCache class.
+// Initializing the LLVM targets and creating a TargetMachine is expensive compared with compiling a
+// small Stoc file. The target machines are kept in a cache so the compilations served by the stoc
+// server (see Server.h) reuse the ones created by previous compilations.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_TARGETMACHINECACHE_H
+#define STOC_TARGETMACHINECACHE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <llvm/Target/TargetMachine.h>
+
+/// Cache of the target machines used in Code Generation, shared by all the compilations of the
+/// process. A TargetMachine can only be used by one compilation at a time, so they are acquired
+/// and then released back to the cache.
+class TargetMachineCache {
+private:
+  std::mutex mutex;
+  std::once_flag nativeTargetInitialized;
+  std::once_flag allTargetsInitialized;
+  /// targets other than the native one already initialized, by name of the LLVM target (i.e. X86)
+  std::unordered_map<std::string, std::once_flag> targetInitialized;
+
+  /// target machines not used by any compilation, by target triple, CPU and features (see getKey)
+  std::unordered_map<std::string, std::vector<std::unique_ptr<llvm::TargetMachine>>> available;
+
+  TargetMachineCache() = default;
+
+  /// initializes the LLVM target for \triple (only once per process and target). Only the target
+  /// of the architecture of \triple is initialized, unless the architecture is not known
+  void initializeTarget(const std::string &triple);
+
+  /// returns the key of the target machines for \triple, \cpu and \features in the cache
+  static std::string getKey(const std::string &triple, const std::string &cpu,
+                            const std::string &features);
+
+public:
+  /// returns the cache of the process
+  static TargetMachineCache &getInstance();
+
+  /// returns a target machine for \triple and \cpu, reusing one of the cache if there is one
+  /// available. The \cpu native is the CPU of the host with all the features it supports (i.e.
+  /// AVX2). If there is no target for \triple or it has no \cpu, it returns nullptr and the reason
+  /// is written in \error
+  std::unique_ptr<llvm::TargetMachine> acquire(const std::string &triple, const std::string &cpu,
+                                               std::string &error);
+
+  /// gives \targetMachine back to the cache so other compilations can reuse it
+  void release(std::unique_ptr<llvm::TargetMachine> targetMachine);
+};
+
+#endif // STOC_TARGETMACHINECACHE_H
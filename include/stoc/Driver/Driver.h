@@ -0,0 +1,43 @@
+//===- stoc/Driver/Driver.h - Defintion of the Driver class -------------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the Driver class.
+// The driver reads the command line arguments of one invocation of the compiler and runs the
+// phases (scanning, parsing, semantic analysis, code generation) on the source file. It is used by
+// main for the command line of the process and by the stoc server for the command line that every
+// client forwards.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_DRIVER_H
+#define STOC_DRIVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// Runs the compiler for one command line
+class Driver {
+private:
+  std::ostream &output; /// stream where the tokens, the AST and the help are printed
+  std::ostream &error;  /// stream where the diagnostics and the LLVM IR are printed
+
+  /// directory of the client against which relative paths are resolved and where the executable is
+  /// written. It is empty when the command line is the one of the process (current directory)
+  std::string workingDirectory;
+
+public:
+  /// driver for the command line of the process, printing to the standard output and error
+  Driver();
+
+  /// driver for the command line of a client of the stoc server running in \workingDirectory,
+  /// printing to \output and \error (that are sent back to the client)
+  Driver(std::ostream &output, std::ostream &error, std::string workingDirectory);
+
+  /// main method: parses the command line \arguments (the first one is the name of the program)
+  /// and compiles the source file. Returns the exit code of the compiler
+  int run(std::vector<std::string> arguments);
+};
+
+#endif // STOC_DRIVER_H
@@ -0,0 +1,102 @@
+//===- stoc/Optimization/BoundsCheckElimination.h - Defintion of the class ----------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the BoundsCheckElimination class.
+// Bounds check elimination is an optimization done on the AST after constant folding. Every index
+// expression (a[i]) is checked at runtime to be inside the bounds of the array, unless it can be
+// proved at compile time that the index is always in range. Then, the check is removed, so the
+// loops that traverse arrays have no branches and can be vectorized.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_BOUNDSCHECKELIMINATION_H
+#define STOC_BOUNDSCHECKELIMINATION_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "stoc/AST/ASTVisitor.h"
+#include "stoc/SrcFile/SrcFile.h"
+
+/// Optimization of the AST (after Constant Folding) that removes the bounds checks of the index
+/// expressions whose index is always in range. The AST is modified in place.
+class BoundsCheckElimination : public ASTVisitor<BoundsCheckElimination> {
+  // The index is known to be in range if it is a literal inside the bounds of a fixed-size array
+  // or if it is the induction variable of a loop like:
+  //   for var int i = <literal >= 0>; i < <bound>; i = i + <literal > 0> { ... a[i] ... }
+  // where i is not assigned in the body and <bound> is:
+  //   - a literal not greater than the size of a fixed-size array a (also i <= <literal>)
+  //   - len(a), for a dynamic array a that is a local variable or parameter not assigned in the
+  //     body of the loop
+private:
+  std::shared_ptr<SrcFile> file; /// stoc source file, list of tokens and AST
+
+  /// Range [0, bound) of the induction variable of a loop being visited
+  struct InductionVariable {
+    const Decl *variable;
+    /// exclusive upper bound if it is a literal, or 0 if it is the length of \lengthOf
+    std::int64_t bound;
+    /// dynamic array whose length is the bound, or nullptr if the bound is a literal
+    const Decl *lengthOf;
+  };
+
+  /// Induction variables of the loops that contain the node being visited
+  std::vector<InductionVariable> inductionVariables;
+
+  // HELPER METHODS
+
+  /// returns the declaration of \node if it is an identifier of a variable, nullptr otherwise
+  static const Decl *getVariable(const Expr &node);
+
+  /// returns true if \node is an int literal and stores its value in \value
+  static bool getIntLiteral(const Expr &node, std::int64_t &value);
+
+  /// returns true if the variable \variable is assigned in \node (or in any statement inside it)
+  static bool isAssigned(const Decl *variable, const Stmt &node);
+
+  /// returns true if \node is a loop over an induction variable with a known range (see above),
+  /// which is returned in \inductionVariable
+  static bool getInductionVariable(const ForStmt &node, InductionVariable &inductionVariable);
+
+public:
+  explicit BoundsCheckElimination(std::shared_ptr<SrcFile> file);
+
+  /// main method: removes the bounds checks of the AST (in \file) that are not needed
+  void eliminate();
+
+  // Methods for ASTVisitor
+  using ASTVisitor<BoundsCheckElimination>::visit;
+
+  void visit(VarDecl &node);
+  void visit(ConstDecl &node);
+  void visit(ParamDecl &node);
+  void visit(FuncDecl &node);
+  void visit(StructDecl &node);
+
+  void visit(DeclarationStmt &node);
+  void visit(ExpressionStmt &node);
+  void visit(BlockStmt &node);
+  void visit(IfStmt &node);
+  void visit(ForStmt &node);
+  void visit(WhileStmt &node);
+  void visit(AssignmentStmt &node);
+  void visit(ReturnStmt &node);
+  void visit(BreakStmt &node);
+  void visit(ContinueStmt &node);
+
+  void visit(BinaryExpr &node);
+  void visit(UnaryExpr &node);
+  void visit(LiteralExpr &node);
+  void visit(IdentExpr &node);
+  void visit(CallExpr &node);
+  void visit(IndexExpr &node);
+  void visit(FieldExpr &node);
+  void visit(ArrayLiteralExpr &node);
+  void visit(ConversionExpr &node);
+  void visit(SpawnExpr &node);
+  void visit(AwaitExpr &node);
+};
+
+#endif // STOC_BOUNDSCHECKELIMINATION_H
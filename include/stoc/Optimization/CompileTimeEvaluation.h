@@ -0,0 +1,118 @@
+//===- stoc/Optimization/CompileTimeEvaluation.h - Defintion of the class -----------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the CompileTimeEvaluation class.
+// Compile-time evaluation is an interpreter of the AST used by constant folding. It executes the
+// calls to const functions whose arguments are literals (i.e. factorial(10)), so they are replaced
+// by the literal of the result before code generation. The evaluation is limited in the number of
+// steps and in the depth of the recursion, and a call that can not be evaluated (i.e. it divides by
+// zero) is left to be executed at runtime.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_COMPILETIMEEVALUATION_H
+#define STOC_COMPILETIMEEVALUATION_H
+
+#include <cstdint>
+#include <exception>
+#include <unordered_map>
+#include <vector>
+
+#include "stoc/AST/Decl.h"
+#include "stoc/AST/Expr.h"
+#include "stoc/AST/Stmt.h"
+#include "stoc/SemanticAnalysis/Type.h"
+
+/// Interpreter of the AST (after Semantic Analysis) that evaluates calls to functions whose
+/// arguments are known at compile time. It only evaluates values of type int, float and bool, with
+/// the same semantics as the generated code.
+class CompileTimeEvaluation {
+  // This class will traverse the AST nodes recursively, like ConstantFolding, without implementing
+  // the visitor pattern because the methods for expressions return the value computed.
+public:
+  /// Value of type int, float or bool computed at compile time
+  struct Value {
+    BasicType::Kind kind;
+    int64_t intValue = 0;
+    double floatValue = 0.0;
+    bool boolValue = false;
+  };
+
+  /// Limits of an evaluation by default: statements executed and nested calls
+  static constexpr uint64_t defaultMaxSteps = 1000000;
+  static constexpr std::size_t defaultMaxDepth = 256;
+
+private:
+  /// Exception thrown when the call can not be evaluated at compile time (i.e. the limits are
+  /// exceeded, an integer overflows or an expression can not be evaluated)
+  class EvaluationError : public std::exception {};
+
+  /// What happens after executing a statement: the next one is executed, or the innermost loop is
+  /// exited (break) or continued, or the function returns
+  enum class Flow { NEXT, BREAK, CONTINUE, RETURN };
+
+  /// Call being evaluated: values of the parameters and the local variables and constants (by
+  /// declaration, since the identifiers have already been resolved), and the value returned
+  struct Frame {
+    std::unordered_map<const Decl *, Value> variables;
+    Value result;
+  };
+
+  uint64_t maxSteps;
+  std::size_t maxDepth;
+
+  /// Statements executed and calls made in the current evaluation
+  uint64_t steps;
+
+  /// Calls being evaluated (nested)
+  std::vector<Frame> frames;
+
+  // HELPER METHODS
+
+  /// counts a step of the evaluation, which fails if there are too many
+  void step();
+
+  /// evaluates the call to \function with the values \args of its parameters
+  Value call(const FuncDecl &function, const std::vector<Value> &args);
+
+  /// returns the value of the variable, parameter or constant declared in \decl. A global constant
+  /// has a value if it has been folded to a literal
+  Value lookup(const Decl &decl);
+
+  /// returns the value of the literal \node of type int, float or bool
+  static Value fromLiteral(const LiteralExpr &node);
+
+  /// Evaluate binary expressions like the generated code (see ConstantFolding)
+  static Value evaluateBinaryExprInt(const BinaryExpr &node, const Value &lhs, const Value &rhs);
+  static Value evaluateBinaryExprFloat(const BinaryExpr &node, const Value &lhs, const Value &rhs);
+  static Value evaluateBinaryExprBool(const BinaryExpr &node, const Value &lhs, const Value &rhs);
+
+  // Methods for Statements
+  Flow execute(const Stmt &node);
+  Flow execute(const DeclarationStmt &node);
+  Flow execute(const BlockStmt &node);
+  Flow execute(const IfStmt &node);
+  Flow execute(const ForStmt &node);
+  Flow execute(const WhileStmt &node);
+  Flow execute(const AssignmentStmt &node);
+  Flow execute(const ReturnStmt &node);
+
+  // Methods for Expressions
+  Value evaluate(const Expr &node);
+  Value evaluate(const BinaryExpr &node);
+  Value evaluate(const UnaryExpr &node);
+  Value evaluate(const IdentExpr &node);
+  Value evaluate(const CallExpr &node);
+  Value evaluate(const ConversionExpr &node);
+
+public:
+  explicit CompileTimeEvaluation(uint64_t maxSteps = defaultMaxSteps,
+                                 std::size_t maxDepth = defaultMaxDepth);
+
+  /// main method: evaluates the call \node, whose arguments are literals. It returns true and the
+  /// value returned by the call in \result if it can be evaluated within the limits
+  bool evaluateCall(const CallExpr &node, Value &result);
+};
+
+#endif // STOC_COMPILETIMEEVALUATION_H
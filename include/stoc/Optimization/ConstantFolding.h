@@ -0,0 +1,130 @@
+//===- stoc/Optimization/ConstantFolding.h - Defintion of ConstantFolding class -----*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the ConstantFolding class.
+// Constant folding is an optimization done on the AST after the semantic analysis. It evaluates at
+// compile time the expressions whose operands are literals (i.e. 5 + 5 * (7 - 4) / 3 -> 10),
+// replaces the uses of constants initialized with a literal by the literal (constant propagation)
+// and removes the branches of if and while statements whose condition is a constant. The calls to
+// const functions whose arguments are literals are evaluated (see CompileTimeEvaluation), so the
+// initial values of globals and the bounds of loops become literals.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_CONSTANTFOLDING_H
+#define STOC_CONSTANTFOLDING_H
+
+#include <memory>
+
+#include "stoc/AST/ASTVisitor.h"
+#include "stoc/Optimization/CompileTimeEvaluation.h"
+#include "stoc/SrcFile/SrcFile.h"
+
+/// Optimization of the AST (after Semantic Analysis) that folds constant expressions and
+/// propagates constants. The AST is modified in place.
+class ConstantFolding : public ASTVisitor<ConstantFolding> {
+  // The methods of the visitor can not return the node that replaces the visited one, so they leave
+  // it in \replacementExpr or \replacementStmt. The parent only replaces its child (copying a
+  // shared_ptr) when there is a replacement, so the nodes that are kept are visited by reference.
+private:
+  std::shared_ptr<SrcFile> file; /// stoc source file, list of tokens and AST
+
+  /// Interpreter of the calls to const functions
+  CompileTimeEvaluation evaluation;
+
+  /// Expression that replaces the expression visited last, or nullptr if it is kept
+  std::shared_ptr<Expr> replacementExpr;
+
+  /// Statement that replaces the statement visited last if \stmtReplaced, or nullptr if the
+  /// statement is removed (i.e. while statement whose condition is false)
+  std::shared_ptr<Stmt> replacementStmt;
+  bool stmtReplaced;
+
+  // HELPER METHODS
+  /// creates a literal expression of type \type with value \value, located at \position
+  static std::shared_ptr<LiteralExpr> makeLiteral(TokenType tokenType, const std::string &value,
+                                                  const Token &position,
+                                                  const std::shared_ptr<Type> &type);
+
+  /// creates a literal expression of type int (LIT_INT), float (LIT_FLOAT) or bool (LIT_TRUE,
+  /// LIT_FALSE) located at \position
+  static std::shared_ptr<LiteralExpr> makeIntLiteral(int64_t value, const Token &position);
+  static std::shared_ptr<LiteralExpr> makeFloatLiteral(double value, const Token &position);
+  static std::shared_ptr<LiteralExpr> makeBoolLiteral(bool value, const Token &position);
+
+  /// returns the value of the literal \node of type int, float or bool
+  static int64_t getIntValue(const LiteralExpr &node);
+  static double getFloatValue(const LiteralExpr &node);
+  static bool getBoolValue(const LiteralExpr &node);
+
+  /// returns the literal expression if \node is a literal, nullptr otherwise
+  static const LiteralExpr *asLiteral(const Expr &node);
+
+  /// visits the expression \node and returns the expression that replaces it, or nullptr if it is
+  /// kept
+  std::shared_ptr<Expr> foldExpr(Expr &node);
+
+  /// visits the statement \node and returns true if it is replaced by \replacement (nullptr if it
+  /// is removed)
+  bool foldStmt(Stmt &node, std::shared_ptr<Stmt> &replacement);
+
+  /// folds the arguments of the call \node
+  void foldArgs(CallExpr &node);
+
+  /// Folds binary expressions whose operands are literals. They return the literal with the result
+  /// or nullptr if the expression can not be evaluated at compile time (i.e. division by zero)
+  static std::shared_ptr<Expr> foldBinaryExprInt(const BinaryExpr &node, const LiteralExpr &lhs,
+                                                 const LiteralExpr &rhs);
+  static std::shared_ptr<Expr> foldBinaryExprFloat(const BinaryExpr &node, const LiteralExpr &lhs,
+                                                   const LiteralExpr &rhs);
+  static std::shared_ptr<Expr> foldBinaryExprBool(const BinaryExpr &node, const LiteralExpr &lhs,
+                                                  const LiteralExpr &rhs);
+  static std::shared_ptr<Expr> foldBinaryExprString(const BinaryExpr &node,
+                                                    const LiteralExpr &lhs,
+                                                    const LiteralExpr &rhs);
+
+  /// Folds unary expressions whose operand is a literal. It returns the expression with the result
+  /// or nullptr if it can not be folded
+  static std::shared_ptr<Expr> foldUnaryExpr(const UnaryExpr &node, const LiteralExpr &rhs);
+
+public:
+  explicit ConstantFolding(std::shared_ptr<SrcFile> file);
+
+  /// main method: folds the constant expressions of the AST (in \file)
+  void fold();
+
+  // Methods for ASTVisitor
+  using ASTVisitor<ConstantFolding>::visit;
+
+  void visit(VarDecl &node);
+  void visit(ConstDecl &node);
+  void visit(ParamDecl &node);
+  void visit(FuncDecl &node);
+  void visit(StructDecl &node);
+
+  void visit(DeclarationStmt &node);
+  void visit(ExpressionStmt &node);
+  void visit(BlockStmt &node);
+  void visit(IfStmt &node);
+  void visit(ForStmt &node);
+  void visit(WhileStmt &node);
+  void visit(AssignmentStmt &node);
+  void visit(ReturnStmt &node);
+  void visit(BreakStmt &node);
+  void visit(ContinueStmt &node);
+
+  void visit(BinaryExpr &node);
+  void visit(UnaryExpr &node);
+  void visit(LiteralExpr &node);
+  void visit(IdentExpr &node);
+  void visit(CallExpr &node);
+  void visit(IndexExpr &node);
+  void visit(FieldExpr &node);
+  void visit(ArrayLiteralExpr &node);
+  void visit(ConversionExpr &node);
+  void visit(SpawnExpr &node);
+  void visit(AwaitExpr &node);
+};
+
+#endif // STOC_CONSTANTFOLDING_H
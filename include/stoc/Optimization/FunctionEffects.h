@@ -0,0 +1,107 @@
+//===- stoc/Optimization/FunctionEffects.h - Defintion of FunctionEffects class -----*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the FunctionEffects class.
+// Function effects is an analysis done on the AST after bounds check elimination. It infers, for
+// every function, the memory of the caller that a call can access, whether it always returns and
+// whether it can call itself. Code Generation turns them into attributes of the LLVM functions
+// (readnone, readonly, willreturn and norecurse), which LLVM can not always infer by itself once
+// the functions have been optimized and inlined.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_FUNCTIONEFFECTS_H
+#define STOC_FUNCTIONEFFECTS_H
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "stoc/AST/ASTVisitor.h"
+#include "stoc/SrcFile/SrcFile.h"
+
+/// Analysis of the AST (after Bounds Check Elimination) that infers the effects of a call to every
+/// function and stores them in the FuncDecl. The effects of a function are the ones of its body
+/// and of the functions it calls.
+class FunctionEffects : public ASTVisitor<FunctionEffects> {
+  // The body of a function:
+  //   - reads memory of the caller if it reads a global, an element of a dynamic array (whose
+  //     elements are shared) or receives a fixed-size array (copied from the caller)
+  //   - writes memory of the caller if it assigns a global or an element of a dynamic array,
+  //     allocates a dynamic array, prints, spawns or awaits a task or uses an atomic
+  //   - may not return if it has a loop, a runtime check (an index out of range or, with
+  //     \checkedOverflow, an integer overflow stops the program) or an integer division whose
+  //     divisor may be zero
+private:
+  std::shared_ptr<SrcFile> file; /// stoc source file, list of tokens and AST
+
+  /// true if the integer operations are checked for overflow (--overflow=trap)
+  bool checkedOverflow;
+
+  /// Effects of the body of a function, without the effects of the functions it calls
+  struct Summary {
+    FuncDecl::Memory memory = FuncDecl::Memory::NONE;
+    bool willReturn = true;
+    /// functions called by the body
+    std::unordered_set<FuncDecl *> callees;
+  };
+
+  /// Summaries of the functions of the AST
+  std::unordered_map<FuncDecl *, Summary> summaries;
+
+  /// Summary of the function whose body is being visited
+  Summary *current;
+
+  // HELPER METHODS
+
+  /// raises the memory accessed by the function being visited to \memory
+  void access(FuncDecl::Memory memory);
+
+  /// marks the function being visited as one that writes memory and may not return (i.e. it
+  /// prints or stops the program with a runtime error)
+  void sideEffect();
+
+  /// returns true if \function can be reached from the functions called by \from
+  bool reaches(FuncDecl *from, FuncDecl *function);
+
+public:
+  explicit FunctionEffects(std::shared_ptr<SrcFile> file, bool checkedOverflow = false);
+
+  /// main method: infers the effects of the functions of the AST (in \file)
+  void infer();
+
+  // Methods for ASTVisitor
+  using ASTVisitor<FunctionEffects>::visit;
+
+  void visit(VarDecl &node);
+  void visit(ConstDecl &node);
+  void visit(ParamDecl &node);
+  void visit(FuncDecl &node);
+  void visit(StructDecl &node);
+
+  void visit(DeclarationStmt &node);
+  void visit(ExpressionStmt &node);
+  void visit(BlockStmt &node);
+  void visit(IfStmt &node);
+  void visit(ForStmt &node);
+  void visit(WhileStmt &node);
+  void visit(AssignmentStmt &node);
+  void visit(ReturnStmt &node);
+  void visit(BreakStmt &node);
+  void visit(ContinueStmt &node);
+
+  void visit(BinaryExpr &node);
+  void visit(UnaryExpr &node);
+  void visit(LiteralExpr &node);
+  void visit(IdentExpr &node);
+  void visit(CallExpr &node);
+  void visit(IndexExpr &node);
+  void visit(FieldExpr &node);
+  void visit(ArrayLiteralExpr &node);
+  void visit(ConversionExpr &node);
+  void visit(SpawnExpr &node);
+  void visit(AwaitExpr &node);
+};
+
+#endif // STOC_FUNCTIONEFFECTS_H
@@ -3,14 +3,17 @@
 //===---------------------------------------------------------------------===//
 //
 // This file defines the Parser class.
-// Parsing is the second phase of a compiler and transforms the list of
-// tokens into a abstract syntax tree (AST)
+// Parsing is the second phase of a compiler and transforms the stream of
+// tokens into a abstract syntax tree (AST). The tokens are pulled on demand
+// from the Scanner and only a small window of them is kept in a ring buffer.
 //
 //===--------------------------------------------------------------------===//
 
 #ifndef STOC_PARSER_H
 #define STOC_PARSER_H
 
+#include <array>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -18,13 +21,15 @@
 #include "stoc/AST/Decl.h"
 #include "stoc/AST/Expr.h"
 #include "stoc/AST/Stmt.h"
+#include "stoc/Scanner/Scanner.h"
 #include "stoc/Scanner/Token.h"
 #include "stoc/SrcFile/SrcFile.h"
 
-/// A Parser takes a list of tokens and parses it into an AST
+/// A Parser takes a stream of tokens and parses it into an AST
 class Parser {
 private:
-  std::shared_ptr<SrcFile> file; /// stoc source file and list of tokens
+  std::shared_ptr<SrcFile> file; /// stoc source file
+  Scanner scanner;               /// produces the tokens on demand
 
   /// abstract syntax tree composed of a list of top-level declarations
   std::vector<std::shared_ptr<Decl>> ast;
@@ -33,7 +38,19 @@ private:
 
   // The parser is a recursive descendent parser similar to a Pratts Parser (uses precedence
   // numbers)
-  int current; /// current token being analyzed
+  int current; /// position in the stream of the current token being analyzed
+
+  // Lookahead of the parser
+  // The tokens pulled from the scanner are stored in a ring buffer: the token at position \pos of
+  // the stream is in tokens[pos % LOOKAHEAD_SIZE]. The parser looks at \current-1, \current and
+  // \current+1 (i.e. to tell a const function from a const declaration), so at most three
+  // consecutive tokens are in use and four slots always hold them.
+  static constexpr int LOOKAHEAD_SIZE = 4;
+  std::array<Token, LOOKAHEAD_SIZE> tokens; /// window of the stream of tokens
+  int scanned;                               /// number of tokens pulled from the scanner
+
+  /// called with every token pulled from the scanner, up to the first T_EOF (i.e. to dump them)
+  std::function<void(const Token &)> tokenListener;
 
   // Exception if there is an error while parsing
   class ParsingError : public std::exception {};
@@ -48,13 +65,17 @@ private:
   /// first error during parsing.
   void synchronize();
 
-  /// true if \current token is T_EOF (end of file) or \current is equal to length of list of tokens
+  /// returns the token at position \pos of the stream, pulling tokens from the scanner if needed
+  ///   \pos can not be older than LOOKAHEAD_SIZE tokens from the last token pulled
+  const Token &tokenAt(int pos);
+
+  /// true if \current token is T_EOF (end of file)
   bool isAtEnd();
 
-  /// returns the token at \current position in list of tokens
+  /// returns the token at \current position in the stream of tokens
   Token currentToken();
 
-  /// returns the token at \current-1 position in list of tokens
+  /// returns the token at \current-1 position in the stream of tokens
   ///   If \current == 0 returns first token
   Token previousToken();
 
@@ -73,14 +94,18 @@ private:
   ///    if its type is not equal to \type, it reports an \error_msg
   Token consume(TokenType type, std::string error_msg);
 
-  /// parses the type of a declaration
-  Token parseType();
+  /// parses the type of a declaration: a basic type, [N]type, []type, <N>type, task type, atomic
+  /// type or the name of a struct
+  TypeSpec parseType();
+
+  /// parses an attribute of a declaration (i.e. packed or align(16))
+  Attribute parseAttribute();
 
   /// parses the parameters of a function
   std::vector<std::shared_ptr<ParamDecl>> parseParameters();
 
   /// parses the return type of a function
-  Token parseReturnType();
+  TypeSpec parseReturnType();
 
   /// parses the arguments of a call expression
   std::vector<std::shared_ptr<Expr>> parseArgs();
@@ -88,6 +113,12 @@ private:
   /// parses an operand in an expression
   std::shared_ptr<Expr> parseOperand();
 
+  /// parses an array or vector literal (i.e. [3]int{1, 2, 3} or <4>float{1.0, 2.0, 3.0, 4.0})
+  std::shared_ptr<Expr> parseArrayLiteral();
+
+  /// parses a conversion to a numeric type (i.e. int32(x))
+  std::shared_ptr<Expr> parseConversion();
+
   // MAIN PARSING METHODS
 
   //------- Declarations -------
@@ -98,9 +129,12 @@ private:
   /// parses a variable or constant declaration
   std::shared_ptr<Decl> parseVarConstDecl();
 
-  /// parses a function declaration
+  /// parses a function declaration, or a const function declaration (const func)
   std::shared_ptr<Decl> parseFuncDecl();
 
+  /// parses a struct declaration
+  std::shared_ptr<Decl> parseStructDecl();
+
   //------- Statements -------
 
   /// parses any type of statement
@@ -118,12 +152,22 @@ private:
   /// parses a for statement
   std::shared_ptr<Stmt> parseForStmt();
 
+  /// parses a parallel for statement: parallel, optionally followed by the reductions (i.e.
+  /// parallel(sum total, max best)), and a for statement
+  std::shared_ptr<Stmt> parseParallelForStmt();
+
   /// parses a while statement
   std::shared_ptr<Stmt> parseWhileStmt();
 
   /// parses a return statement
   std::shared_ptr<Stmt> parseReturnStmt();
 
+  /// parses a break statement
+  std::shared_ptr<Stmt> parseBreakStmt();
+
+  /// parses a continue statement
+  std::shared_ptr<Stmt> parseContinueStmt();
+
   //------- Expressions -------
 
   /// parses any type of expression
@@ -132,7 +176,7 @@ private:
   /// parses a binary expression with higher precedence than \prec
   std::shared_ptr<Expr> parseBinaryExpr(int prec);
 
-  /// parses a unary expression
+  /// parses a unary expression, including spawn and await expressions
   std::shared_ptr<Expr> parseUnaryExpr();
 
   /// parses a primary expression
@@ -141,8 +185,12 @@ private:
 public:
   explicit Parser(const std::shared_ptr<SrcFile> &file);
 
-  /// main method: parses the list of tokens (in \file) and transforms it into an AST
-  ///  (the AST is stored in SrcFile \file)
+  /// calls \listener with every token of the stream, in order, when it is pulled from the scanner
+  /// while parsing, so the tokens can be dumped without scanning the source code twice
+  void setTokenListener(std::function<void(const Token &)> listener);
+
+  /// main method: parses the tokens (pulled from the scanner of \file) and transforms them into an
+  /// AST (the AST is moved into SrcFile \file)
   void parse();
 };
 
@@ -0,0 +1,72 @@
+//===- include/stoc/Repl/Repl.h - Definition of the Repl class ----------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the Repl class.
+// The REPL (stoc --repl) compiles and executes Stoc code one input at a time. Every input is
+// scanned, parsed and analysed against the globals of the previous inputs, generated as a new LLVM
+// module and compiled and executed at once by an ORC JIT, where the functions and globals of the
+// previous inputs are still alive.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_REPL_H
+#define STOC_REPL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "stoc/AST/Decl.h"
+#include "stoc/SemanticAnalysis/SymbolTable.h"
+
+namespace llvm {
+namespace orc {
+class LLJIT;
+}
+} // namespace llvm
+
+/// Read-Eval-Print Loop for Stoc
+class Repl {
+  // An input can be:
+  // - declarations (func, var, const): they are kept for the next inputs
+  // - statements (i.e. for i = 0; i < 3; i = i + 1 { println(i); }): they are wrapped in a
+  //   function that is executed at once
+  // - an expression (i.e. fib(10)): it is printed
+private:
+  unsigned jobs; /// number of threads used by the compiler
+
+  /// Global symbol table shared by all the inputs
+  std::shared_ptr<SymbolTable> globalSymbolTable;
+
+  /// Declarations of the previous inputs, already compiled in the JIT
+  std::vector<std::shared_ptr<Decl>> declarations;
+
+  /// Number of inputs compiled, used to name the functions generated for every input
+  unsigned inputs;
+
+  std::unique_ptr<llvm::orc::LLJIT> jit;
+
+  /// returns true if \input is complete (the braces are balanced) or more lines are needed
+  static bool isComplete(const std::string &input);
+
+  /// returns the Stoc source code for \input. If \input are statements or an expression, they are
+  /// wrapped in the function \statementsFunction
+  static std::string toSourceCode(const std::string &input, const std::string &statementsFunction,
+                                  bool &hasStatements);
+
+  /// compiles and executes \input. Returns false if there is an error
+  bool evaluate(const std::string &input);
+
+public:
+  /// \jobs is the number of threads used by the compiler
+  explicit Repl(unsigned jobs);
+
+  ~Repl();
+
+  /// main method: reads inputs from the standard input until the end of file or :quit. Returns
+  /// the exit code
+  int run();
+};
+
+#endif // STOC_REPL_H
@@ -0,0 +1,39 @@
+//===- stoc/Runtime/Parallel.h - Runtime of parallel for loops ----------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file declares the runtime of the parallel for loops.
+// The body of a parallel for is outlined by Code Generation into a function that runs a range of
+// iterations. The runtime splits the iteration space between a pool of threads that steal work
+// from each other, so the iterations are balanced even if some of them are more expensive. The
+// runtime is a static library linked into the executables that use parallel for.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_RUNTIME_PARALLEL_H
+#define STOC_RUNTIME_PARALLEL_H
+
+#include <cstdint>
+
+extern "C" {
+
+/// Body of a parallel for outlined in a function: it runs the iterations [begin, end) with the
+/// addresses of the variables captured by the loop in \context
+typedef void (*stoc_parallel_body)(void *context, std::int64_t begin, std::int64_t end);
+
+/// runs the iterations [begin, end) of the parallel for \body in the pool of threads and returns
+/// when all of them have finished. The calling thread also runs iterations. A parallel for nested
+/// in another one runs in the calling thread
+void stoc_parallel_for(std::int64_t begin, std::int64_t end, stoc_parallel_body body,
+                       void *context);
+
+/// Lock used by the threads to combine their partial results of the reductions
+void stoc_parallel_lock();
+void stoc_parallel_unlock();
+
+/// returns the number of threads used by the runtime (the parallel for loops and the tasks): the
+/// number of cores or the value of the environment variable STOC_NUM_THREADS
+unsigned stoc_number_of_threads();
+}
+
+#endif // STOC_RUNTIME_PARALLEL_H
@@ -0,0 +1,32 @@
+//===- stoc/Runtime/Task.h - Runtime of tasks ---------------------------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file declares the runtime of the tasks (spawn and await).
+// Code Generation stores the arguments of a function call spawned in a box allocated in the heap
+// and generates a function that calls the function with them and stores the result in the box,
+// which is freed after awaiting the task.
+// The runtime runs these functions in a pool of threads that steal tasks from each other. The
+// runtime is a static library linked into the executables that use tasks.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_RUNTIME_TASK_H
+#define STOC_RUNTIME_TASK_H
+
+extern "C" {
+
+/// Function run by a task: it calls a function with the arguments in \box and stores its result in
+/// \box
+typedef void (*stoc_task_function)(void *box);
+
+/// runs \function with \box in the pool of threads. The first 8 bytes of \box are used by the
+/// runtime to know if the task has finished
+void stoc_spawn(stoc_task_function function, void *box);
+
+/// returns when the task of \box has finished. While it has not, the calling thread runs other
+/// tasks. The runtime does not use \box after it returns, so the caller can free it
+void stoc_await(void *box);
+}
+
+#endif // STOC_RUNTIME_TASK_H
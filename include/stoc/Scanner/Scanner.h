@@ -3,8 +3,9 @@
 //===------------------------------------------------------------------------------------------===//
 //
 // This file defines the Scanner class.
-// Scanning is the first phase of a compiler and transforms the raw source code into a list of
-// tokens such as ADD, SUB, IDENTIFIER, ...
+// Scanning is the first phase of a compiler and transforms the raw source code into a stream of
+// tokens such as ADD, SUB, IDENTIFIER, ... The tokens are produced on demand (the Parser pulls
+// them one by one) so the whole list of tokens does not need to be kept in memory.
 //
 //===------------------------------------------------------------------------------------------===//
 
@@ -22,7 +23,6 @@
 class Scanner {
 private:
   std::shared_ptr<SrcFile> file; /// stoc source file
-  std::vector<Token> tokens;     /// list of tokens
 
   // State of the scanner
 
@@ -83,29 +83,23 @@ private:
   // Main scanning methods
 
   /// scans a literal number token (LIT_INT or LIT_FLOAT)
-  void scanNumber();
+  Token scanNumber();
 
   /// scans an identifier token
-  void scanIdentifier();
+  Token scanIdentifier();
 
   /// scans a line comment (only one line)
   void scanLineComment();
 
   /// scans a literal string token (LIT_STRING)
-  void scanString();
-
-  /// main private method: the source code is scanned through repeated calls to scanNextToken()
-  void scanNextToken();
+  Token scanString();
 
 public:
   explicit Scanner(std::shared_ptr<SrcFile> file);
 
-  /// main method: scans the source code and transforms it into a list of tokens
-  ///  (the list of tokens is stored in SrcFile file)
-  void scan();
-
-  /// prints the scanned tokens
-  void printTokens();
+  /// main method: scans and returns the next token of the source code (skipping blank characters
+  /// and comments). Once the end of the source code is reached it always returns T_EOF
+  Token nextToken();
 };
 
 #endif // STOC_SCANNER_H
@@ -17,15 +17,23 @@ enum TokenType {
   // the same relative order to other token) to store the string representation
 
   // Operators
-  ADD,   // +
-  SUB,   // -
-  STAR,  // *
-  SLASH, // /
+  ADD,     // +
+  SUB,     // -
+  STAR,    // *
+  SLASH,   // /
+  PERCENT, // % (remainder)
 
   LAND, // && (logical AND)
   LOR,  // || (logical OR)
   NOT,  // !
 
+  AMPERSAND,   // & (bitwise AND)
+  PIPE,        // | (bitwise OR)
+  CARET,       // ^ (bitwise XOR)
+  TILDE,       // ~ (bitwise NOT)
+  SHIFT_LEFT,  // <<
+  SHIFT_RIGHT, // >>
+
   ASSIGN,        // =
   EQUAL,         // == (logical EQUAL)
   NOT_EQUAL,     // !=
@@ -39,8 +47,11 @@ enum TokenType {
   RPAREN,    // )
   LBRACE,    // {
   RBRACE,    // }
+  LBRACK,    // [
+  RBRACK,    // ]
   SEMICOLON, // ;
   COMMA,     // ,
+  PERIOD,    // .
 
   // Keywords
   VAR,   //
@@ -51,7 +62,14 @@ enum TokenType {
   FOR,    // for
   WHILE,  // while
   FUNC,   // func
-  RETURN, // return
+  RETURN,   // return
+  BREAK,    // break
+  CONTINUE, // continue
+  STRUCT,   // struct
+
+  PARALLEL, // parallel
+  SPAWN,    // spawn
+  AWAIT,    // await
 
   // Basic types keywords
   BOOL,   // bool
@@ -59,6 +77,22 @@ enum TokenType {
   FLOAT,  // float
   STRING, // string
 
+  // Fixed-width numeric types keywords (int and float are 64 bits wide)
+  INT8,    // int8
+  INT16,   // int16
+  INT32,   // int32
+  UINT8,   // uint8
+  UINT16,  // uint16
+  UINT32,  // uint32
+  UINT64,  // uint64
+  FLOAT32, // float32
+
+  // Task type keyword (task int: handle of a function call spawned)
+  TASK, // task
+
+  // Atomic type keyword (atomic int: integer or bool shared between threads without locks)
+  ATOMIC, // atomic
+
   // Basic type literals
   LIT_TRUE,   // true
   LIT_FALSE,  // false
@@ -83,14 +117,20 @@ std::ostream &operator<<(std::ostream &os, TokenType type);
 /// e.g. A FACTOR (*, /) binds tighter than a TERM(+,/) so it has higher precedence
 /// Important: all equality and comparison have the same precedence (different from C precedence).
 ///            This implies that parenthesis is mandatory to indicate the precedence correctly.
+///            The bitwise operators bind tighter than the comparisons (also different from C), so
+///            a & 1 == 0 is (a & 1) == 0
 enum Prec {
   PREC_LOWEST,   // 0 (non operators)
   PREC_OR,       // 1 Token: LOR
   PREC_AND,      // 2 Token: LAND
   PREC_EQUALITY, // 3 Token: EQUAL, NOT_EQUAL, LESS, GREATER, LESS_EQUAL, GREATER_EQUAL
-  PREC_TERM,     // 4 Token: ADD, SUB
-  PREC_FACTOR,   // 5 Token: STAR, SLASH
-  PREC_UNARY,    // 6 Token: NOT, unary SUB, unary ADD
+  PREC_BITOR,    // 4 Token: PIPE
+  PREC_BITXOR,   // 5 Token: CARET
+  PREC_BITAND,   // 6 Token: AMPERSAND
+  PREC_SHIFT,    // 7 Token: SHIFT_LEFT, SHIFT_RIGHT
+  PREC_TERM,     // 8 Token: ADD, SUB
+  PREC_FACTOR,   // 9 Token: STAR, SLASH, PERCENT
+  PREC_UNARY,    // 10 Token: NOT, TILDE, unary SUB, unary ADD
 };
 
 /// returns the precedence of \param type (as a binary operator)
@@ -20,6 +20,8 @@ namespace mangler {
 /// returns the identifier of the function modified with format:
 /// (functionName)_(numberofparameters)p_[typeparameter]*_r(typereturn)
 /// i.e. func foo(var int a, var float b) bool -> foo_2p_intfloat_rbool
+/// The fixed-width types keep their width, so functions overloaded on the width of their parameters
+/// have different identifiers (i.e. func foo(var int8 a) -> foo_1p_int8_rvoid)
 std::string mangle(std::string functionName, std::shared_ptr<FunctionType> functionType);
 
 }
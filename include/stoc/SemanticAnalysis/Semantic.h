@@ -9,11 +9,21 @@
 // the program. In a statically typed languagelike Stoc, semantic analysis consists on building a
 // symbol table to connect variables definition and their use, and also doing type checking.
 //
+// The analysis is done in two passes. The first one declares the global variables and constants and
+// the signatures of the functions in the global symbol table, which is then frozen (read-only). The
+// second one analyses the bodies of the functions: since they only read the global symbol table,
+// they are independent and are analysed in parallel by a pool of threads. Finally, the purity of
+// the functions is inferred from the functions they call.
+//
 //===------------------------------------------------------------------------------------------===//
 #ifndef STOC_SEMANTICANALYSIS_H
 #define STOC_SEMANTICANALYSIS_H
 
 #include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "stoc/AST/ASTVisitor.h"
 #include "stoc/SemanticAnalysis/SymbolTable.h"
@@ -22,7 +32,7 @@
 /// Phase of the compiler after parsing. It takes the AST and gathers information about the meaning
 /// of the program. The information gathered includes type checking, ensuring that all the variables
 /// are declared before being used, ...
-class Semantic : public ASTVisitor {
+class Semantic : public ASTVisitor<Semantic> {
   // It has been implemented as a subclass of the ASTVisitor, so the semantic analysis is done in
   // in every node
 public:
@@ -30,6 +40,27 @@ public:
   /// check that a return statement only appears inside a function
   enum class ScopeType { NONE, FUNCTION };
 
+  /// Parallel for whose body is being analysed. The iterations run in several threads, so the body
+  /// can only modify the variables private to an iteration (the induction variable is not
+  /// modified), the reduction variables and the elements of a shared array indexed by the
+  /// induction variable (i.e. a[i] = ...)
+  struct ParallelLoop {
+    ForStmt *loop;
+    const Decl *inductionVariable;
+    std::vector<const Decl *> reductions;
+    /// variables declared inside the body, private to an iteration
+    std::unordered_set<const Decl *> privates;
+  };
+
+  /// What the body of a function does that depends on the functions it calls: why the body is not
+  /// pure (i.e. it prints), empty if it is, the functions it calls, which also have to be pure,
+  /// and the calls to them, which are recursive if the callee can call the function again
+  struct BodySummary {
+    std::string impurity;
+    std::unordered_set<FuncDecl *> callees;
+    std::vector<CallExpr *> calls;
+  };
+
 private:
   std::shared_ptr<SrcFile> file; /// stoc source file, list of tokens and AST
 
@@ -51,17 +82,97 @@ private:
   /// Use for semantic analysis that return is last instruction in statement block
   bool returnStatementInBlockStmt;
 
+  /// Parallel for statements (nested) whose body is being analysed
+  std::vector<ParallelLoop> parallelLoops;
+
+  /// Loops (nested) whose body is being analysed, to check the break and continue statements
+  std::vector<const Stmt *> loops;
+
+  /// Summary of the body of the function being analysed
+  BodySummary bodySummary;
+
+  /// Number of threads used to analyse the bodies of the functions
+  unsigned jobs;
+
+  /// true if every recursive call of a function with the attribute tailrec has to be a guaranteed
+  /// tail call (--require-tailcall)
+  bool requireTailCall;
+
+  /// When the program is analysed incrementally (see createGlobalSymbolTable), the global symbol
+  /// table is kept between analyses and a main function is not required
+  bool incremental;
+
+  /// Errors found while analysing. They are printed once the analysis ends, in source order,
+  /// because the bodies of the functions can be analysed in parallel
+  std::vector<std::string> diagnostics;
+
+  /// Constructor used to analyse the body of a function in the second pass, from a thread of the
+  /// pool. \globalSymbolTable is the frozen symbol table of the first pass
+  Semantic(std::shared_ptr<SrcFile> file, std::shared_ptr<SymbolTable> globalSymbolTable);
+
   // WRAPPER METHODS for ASTVisitor methods
-  void analyse(const std::shared_ptr<Decl> &decl);
-  void analyse(const std::shared_ptr<Expr> &expr);
-  void analyse(const std::shared_ptr<Stmt> &stmt);
+  void analyse(Decl &decl);
+  void analyse(Expr &expr);
+  void analyse(Stmt &stmt);
   void analyse(const std::vector<std::shared_ptr<Stmt>> &stmts);
 
+  /// First pass for functions: inserts the signature of the function and mangles its identifier
+  void declareFunction(FuncDecl &node);
+
+  /// Second pass for functions: analyses the parameters and the body of the function
+  void analyseFunctionBody(FuncDecl &node);
+
+  /// analyses the bodies of \functions (the position of the function in the AST and the function)
+  /// with a pool of \jobs threads. The errors found are appended to \diagnosticsOfDecl (indexed by
+  /// the position of the declaration in the AST) and the summary of every body is stored in
+  /// \bodies (indexed like \functions)
+  void analyseFunctionBodies(const std::vector<std::pair<std::size_t, FuncDecl *>> &functions,
+                             std::vector<std::vector<std::string>> &diagnosticsOfDecl,
+                             std::vector<BodySummary> &bodies);
+
+  /// Third pass for functions: a function is pure if its body is pure and it only calls pure
+  /// functions. It checks the functions with the attribute pure and the const functions, whose
+  /// errors are appended to \diagnosticsOfDecl
+  void inferPurity(const std::vector<std::pair<std::size_t, FuncDecl *>> &functions,
+                   const std::vector<BodySummary> &bodies,
+                   std::vector<std::vector<std::string>> &diagnosticsOfDecl);
+
+  /// Third pass for functions: the recursive calls in tail position of a function with the
+  /// attribute tailrec become guaranteed tail calls if the callee has the same signature. With
+  /// \requireTailCall, the rest of recursive calls of these functions are reported as errors,
+  /// appended to \diagnosticsOfDecl
+  void checkTailCalls(const std::vector<std::pair<std::size_t, FuncDecl *>> &functions,
+                      const std::vector<BodySummary> &bodies,
+                      std::vector<std::vector<std::string>> &diagnosticsOfDecl);
+
   // HELPER METHODS
 
-  /// declares print and println builtin functions for all basic types
+  /// declares print and println builtin functions for all basic types, len and append for dynamic
+  /// arrays of all basic and vector types, and the builtin functions on vectors and atomics
   void declareBuiltinFunctions();
 
+  /// returns the fixed-width numeric types (i.e. int8, uint32 or float32)
+  static std::vector<std::shared_ptr<BasicType>> fixedWidthTypes();
+
+  /// returns the vector types of every type of lane (numeric and bool) and every number of lanes
+  /// (i.e. <2>int, <4>float or <64>uint8)
+  static std::vector<std::shared_ptr<VectorType>> vectorTypes();
+
+  /// declares the builtin functions on vectors: print, println, select, shuffle, the reductions
+  /// (reduce_add, reduce_min and reduce_max) and any and all for vectors of bool
+  void declareVectorBuiltinFunctions();
+
+  /// declares the builtin functions on atomics: load, store, exchange, compare_exchange and the
+  /// fetch operations (i.e. fetch_add), with an optional last argument for the memory ordering
+  void declareAtomicBuiltinFunctions();
+
+  /// declares the builtin functions on the bits of integers and vectors of integers: popcount, clz,
+  /// ctz, bswap and rotl
+  void declareBitBuiltinFunctions();
+
+  /// returns true if \functionName is a builtin function on atomics
+  static bool isAtomicBuiltinFunction(const std::string &functionName);
+
   /// It creates a new scope by creating a new symbol table
   void beginScope();
 
@@ -85,35 +196,127 @@ private:
   /// returns the type of the token (i.e. TOKEN(1) -> int, TOKEN("string") -> string)
   std::shared_ptr<Type> tokenTypeToType(Token token);
 
+  /// returns the type written in a declaration (i.e. int, [4]float, []int, <4>float or Point)
+  std::shared_ptr<Type> typeSpecToType(const TypeSpec &typeSpec);
+
+  /// returns the type of a vector written in a declaration (i.e. <4>float), checking the type and
+  /// the number of the lanes
+  std::shared_ptr<Type> vectorTypeSpecToType(const TypeSpec &typeSpec);
+
+  /// returns the literal of \expr if it is an integer or float literal, optionally with a sign
+  /// (i.e. 5, -5 or 2.5), and nullptr otherwise. \negated is true if the sign is -
+  static LiteralExpr *asNumericLiteral(Expr &expr, bool &negated);
+
+  /// returns true if the literal \expr can take the numeric type \type (i.e. 5 can be an int8 and
+  /// 2.5 a float32), without checking that the value fits in \type
+  static bool isConvertibleLiteral(Expr &expr, const std::shared_ptr<Type> &type);
+
+  /// gives the numeric type \type to the literal \expr if it can take it (see
+  /// isConvertibleLiteral), so literals can be used with the fixed-width types (i.e.
+  /// var int8 a = -5;). It reports an error if the value does not fit in \type
+  void convertLiteral(Expr &expr, const std::shared_ptr<Type> &type);
+
+  /// checks that \value is not a copy of a task (i.e. var task int b = a;): await frees the task,
+  /// so a copy would be freed twice. A task can only be taken from a spawn or a call. \token is
+  /// the position of the error
+  void checkTaskNotCopied(const Expr &value, const Token &token);
+
+  /// checks that the indices of a call to the builtin shuffle are known at compile time: a vector
+  /// literal of integer literals that select a lane of one of the two vectors shuffled
+  void checkShuffleIndices(CallExpr &node);
+
+  /// checks the memory ordering of a call to a builtin function on atomics, if it has one: a
+  /// string literal (relaxed, acquire, release, acq_rel or seq_cst) valid for the operation (i.e.
+  /// a load can not be release)
+  void checkAtomicOrdering(CallExpr &node);
+
+  /// analyses the reductions of a parallel for (i.e. parallel(sum total)): the variables have to
+  /// be numeric variables declared outside the loop. Returns the declarations of the variables
+  std::vector<const Decl *> analyseReductions(ForStmt &node);
+
+  /// checks that a parallel for has the form for var int i = start; i < end; i = i + 1, so its
+  /// range can be split between threads. Returns the declaration of the induction variable
+  const Decl *getParallelInductionVariable(ForStmt &node);
+
+  /// checks that the variable modified by \node can be modified inside the parallel for
+  /// statements being analysed (see ParallelLoop)
+  void checkParallelAssignment(AssignmentStmt &node);
+
   /// returns the type of the function being declared
-  std::shared_ptr<FunctionType> createSignature(std::shared_ptr<FuncDecl> node);
+  std::shared_ptr<FunctionType> createSignature(const FuncDecl &node);
+
+  /// checks that the parameters and the result of the const function \node (with type
+  /// \signature) can be literals: int, float or bool. A const function also has to be pure (see
+  /// inferPurity)
+  void checkConstFunction(const FuncDecl &node, FunctionType &signature);
+
+  /// records that the body of the function being analysed is not pure because of \reason (i.e.
+  /// it prints), found in \line. Only the first reason is kept
+  void markImpure(const std::string &reason, int line);
+
+  /// checks the attributes of a function declaration (fastmath, pure and tailrec), which have no
+  /// arguments
+  void checkFunctionAttributes(const FuncDecl &node);
+
+  /// returns the struct type declared with the attributes \node (packed, align(N) and soa) and
+  /// the fields \fields, checking the attributes
+  std::shared_ptr<StructType> createStructType(const StructDecl &node,
+                                               std::vector<StructType::Field> fields);
+
+  /// analyses a call to the name of a struct (i.e. Point(1.0, 2.0)), that creates a value of
+  /// the struct with a value for every field, or with every field zero if there are no arguments
+  void analyseStructLiteral(CallExpr &node, const Symbol &structSymbol);
 
 public:
-  explicit Semantic(std::shared_ptr<SrcFile> file);
+  /// \jobs is the number of threads used to analyse the bodies of the functions. With
+  /// \requireTailCall, the recursive calls of the functions with the attribute tailrec have to be
+  /// guaranteed tail calls
+  explicit Semantic(std::shared_ptr<SrcFile> file, unsigned jobs = 1,
+                    bool requireTailCall = false);
+
+  /// Constructor used to analyse a program incrementally (i.e. one input at a time in the REPL).
+  /// The globals are declared in \globalSymbolTable, that keeps the globals of previous analyses
+  Semantic(std::shared_ptr<SrcFile> file, std::shared_ptr<SymbolTable> globalSymbolTable,
+           unsigned jobs);
+
+  /// returns a global symbol table with the builtin functions declared, to analyse a program
+  /// incrementally
+  static std::shared_ptr<SymbolTable> createGlobalSymbolTable();
 
   /// main method: analyses the AST (in \file)
   void analyse();
 
   // Methods for ASTVisitor
-  void visit(std::shared_ptr<VarDecl> node) override;
-  void visit(std::shared_ptr<ConstDecl> node) override;
-  void visit(std::shared_ptr<ParamDecl> node) override;
-  void visit(std::shared_ptr<FuncDecl> node) override;
-
-  void visit(std::shared_ptr<DeclarationStmt> node) override;
-  void visit(std::shared_ptr<ExpressionStmt> node) override;
-  void visit(std::shared_ptr<BlockStmt> node) override;
-  void visit(std::shared_ptr<IfStmt> node) override;
-  void visit(std::shared_ptr<ForStmt> node) override;
-  void visit(std::shared_ptr<WhileStmt> node) override;
-  void visit(std::shared_ptr<AssignmentStmt> node) override;
-  void visit(std::shared_ptr<ReturnStmt> node) override;
-
-  void visit(std::shared_ptr<BinaryExpr> node) override;
-  void visit(std::shared_ptr<UnaryExpr> node) override;
-  void visit(std::shared_ptr<LiteralExpr> node) override;
-  void visit(std::shared_ptr<IdentExpr> node) override;
-  void visit(std::shared_ptr<CallExpr> node) override;
+  using ASTVisitor<Semantic>::visit;
+
+  void visit(VarDecl &node);
+  void visit(ConstDecl &node);
+  void visit(ParamDecl &node);
+  void visit(FuncDecl &node);
+  void visit(StructDecl &node);
+
+  void visit(DeclarationStmt &node);
+  void visit(ExpressionStmt &node);
+  void visit(BlockStmt &node);
+  void visit(IfStmt &node);
+  void visit(ForStmt &node);
+  void visit(WhileStmt &node);
+  void visit(AssignmentStmt &node);
+  void visit(ReturnStmt &node);
+  void visit(BreakStmt &node);
+  void visit(ContinueStmt &node);
+
+  void visit(BinaryExpr &node);
+  void visit(UnaryExpr &node);
+  void visit(LiteralExpr &node);
+  void visit(IdentExpr &node);
+  void visit(CallExpr &node);
+  void visit(IndexExpr &node);
+  void visit(FieldExpr &node);
+  void visit(ArrayLiteralExpr &node);
+  void visit(ConversionExpr &node);
+  void visit(SpawnExpr &node);
+  void visit(AwaitExpr &node);
 };
 
 #endif // STOC_SEMANTICANALYSIS_H
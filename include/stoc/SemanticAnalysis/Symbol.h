@@ -22,7 +22,7 @@
 class Symbol {
 public:
   /// Types of symbols in source code
-  enum class Kind { VARIABLE, CONSTANT, PARAMETER, FUNCTION };
+  enum class Kind { VARIABLE, CONSTANT, PARAMETER, FUNCTION, STRUCT };
 
 private:
   /// string representation of the symbol. It is the name by which the symbol will be looked up
@@ -30,6 +30,9 @@ private:
   /// Depth level of the scope associated with this SymbolTable
   int level;
 
+  /// A frozen SymbolTable is read-only: it can be looked up concurrently from multiple threads
+  bool frozen;
+
   /// use to insert function
   void insertFunction(std::string identifier, Symbol symbol);
 
@@ -48,11 +51,18 @@ public:
   /// Looks \identifier up in the current SymbolTable and, if not found, looks up in previous table.
   ///  If it is found, it returns the Symbol associated with the identifier.
   ///  If \identifier is not found in any SymbolTable, it raises an exception.
-  std::vector<Symbol> lookup(std::string identifier);
+  std::vector<Symbol> lookup(std::string identifier) const;
 
   /// It inserts \symbol associated with \identifier in the current scope/SymbolTable.
   ///  If there is already a \symbol associated with \identifier in the current scope/SymbolTable
   ///  it raises an exception.
   void insert(std::string identifier, Symbol symbol);
+
+  /// Makes the SymbolTable read-only. Inserting in a frozen SymbolTable raises an exception.
+  void freeze();
+
+  /// Makes the SymbolTable writable again (i.e. to declare the globals of the next input in the
+  /// REPL)
+  void unfreeze();
 };
 #endif // STOC_SYMBOLTABLE_H
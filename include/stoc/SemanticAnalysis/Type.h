@@ -10,6 +10,7 @@
 #ifndef STOC_TYPE_H
 #define STOC_TYPE_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -17,7 +18,15 @@
 /// Represents a data Type
 class Type {
 public:
-  enum class Kind { BasicType, Signature };
+  enum class Kind {
+    BasicType,
+    ArrayType,
+    VectorType,
+    TaskType,
+    AtomicType,
+    StructType,
+    Signature
+  };
 
 protected:
   Type::Kind typeKind;
@@ -38,9 +47,17 @@ class BasicType : public Type {
 public:
   enum class Kind {
     BOOL,
-    INT,
-    FLOAT,
+    INT,   // 64 bits
+    FLOAT, // 64 bits
     STRING,
+    INT8,
+    INT16,
+    INT32,
+    UINT8,
+    UINT16,
+    UINT32,
+    UINT64,
+    FLOAT32,
     VOID, // only use internally but not in the language
     INVALID
   };
@@ -58,6 +75,14 @@ public:
   static std::shared_ptr<BasicType> getIntType();
   static std::shared_ptr<BasicType> getFloatType();
   static std::shared_ptr<BasicType> getStringType();
+  static std::shared_ptr<BasicType> getInt8Type();
+  static std::shared_ptr<BasicType> getInt16Type();
+  static std::shared_ptr<BasicType> getInt32Type();
+  static std::shared_ptr<BasicType> getUint8Type();
+  static std::shared_ptr<BasicType> getUint16Type();
+  static std::shared_ptr<BasicType> getUint32Type();
+  static std::shared_ptr<BasicType> getUint64Type();
+  static std::shared_ptr<BasicType> getFloat32Type();
   static std::shared_ptr<BasicType> getVoidType();
   static std::shared_ptr<BasicType> getInvalidType();
 
@@ -66,6 +91,11 @@ public:
   std::string getName() override;
 
   bool isNumeric();
+  bool isInteger(); /// int, intN or uintN
+  bool isFloat();   /// float or float32
+  bool isUnsigned();
+  /// number of bits of a numeric type (i.e. 8 for int8, 64 for int and float)
+  unsigned getBitWidth();
   bool isString();
   bool isBoolean();
   bool isInvalid() override;
@@ -75,31 +105,156 @@ public:
   friend bool typeIsEqual(std::shared_ptr<BasicType> lhs, std::shared_ptr<BasicType> rhs);
 };
 
+/// Represents an array type, composed of the type of the elements and, for fixed-size arrays, the
+/// number of elements. A dynamic array ([]int) has no fixed size and can grow with append.
+class ArrayType : public Type {
+private:
+  // for now, the elements have to be of basic, vector or struct type (there are not arrays of
+  // arrays)
+  std::shared_ptr<Type> element;
+  bool dynamic;
+  std::int64_t size; /// number of elements of a fixed-size array
+
+public:
+  /// fixed-size array: [size]element
+  ArrayType(std::shared_ptr<Type> element, std::int64_t size);
+
+  /// dynamic array: []element
+  explicit ArrayType(std::shared_ptr<Type> element);
+
+  // Getters
+  std::shared_ptr<Type> getElement();
+  bool isDynamic();
+  std::int64_t getSize();
+  std::string getName() override;
+  bool isInvalid() override;
+
+  /// compares the type of the elements and the size of the arrays
+  friend bool typeIsEqual(std::shared_ptr<ArrayType> lhs, std::shared_ptr<ArrayType> rhs);
+};
+
+/// Represents a SIMD vector type, composed of the basic type of the lanes and the number of lanes
+/// (i.e. <4>float). The operators are applied lane by lane and it is kept in a vector register.
+class VectorType : public Type {
+private:
+  std::shared_ptr<BasicType> element;
+  std::int64_t lanes;
+
+public:
+  /// maximum number of lanes of a vector (64 lanes of 8 bits fill a register of AVX-512)
+  static constexpr std::int64_t maxLanes = 64;
+
+  VectorType(std::shared_ptr<BasicType> element, std::int64_t lanes);
+
+  // Getters
+  std::shared_ptr<BasicType> getElement();
+  std::int64_t getLanes();
+  std::string getName() override;
+  bool isInvalid() override;
+
+  /// compares the type and the number of the lanes
+  friend bool typeIsEqual(std::shared_ptr<VectorType> lhs, std::shared_ptr<VectorType> rhs);
+};
+
+/// Represents the handle of a function call spawned (a task), composed of the type of the result
+/// of the function (i.e. task int). Awaiting the handle gives the result.
+class TaskType : public Type {
+private:
+  std::shared_ptr<Type> result;
+
+public:
+  explicit TaskType(std::shared_ptr<Type> result);
+
+  // Getters
+  std::shared_ptr<Type> getResult();
+  std::string getName() override;
+  bool isInvalid() override;
+
+  /// compares the type of the results
+  friend bool typeIsEqual(std::shared_ptr<TaskType> lhs, std::shared_ptr<TaskType> rhs);
+};
+
+/// Represents an integer or bool shared between threads that is only accessed with atomic
+/// operations (i.e. atomic int), composed of the basic type of its value.
+class AtomicType : public Type {
+private:
+  std::shared_ptr<BasicType> element;
+
+public:
+  explicit AtomicType(std::shared_ptr<BasicType> element);
+
+  // Getters
+  std::shared_ptr<BasicType> getElement();
+  std::string getName() override;
+  bool isInvalid() override;
+
+  /// compares the type of the values
+  friend bool typeIsEqual(std::shared_ptr<AtomicType> lhs, std::shared_ptr<AtomicType> rhs);
+};
+
+/// Represents a struct type declared in the program, composed of its name, its fields and its
+/// layout (i.e. struct Point packed { var float x; var float y; }). Two struct types are the same
+/// type only if they have the same name.
+class StructType : public Type {
+public:
+  /// Field of a struct: its name and its type
+  struct Field {
+    std::string name;
+    std::shared_ptr<Type> type;
+  };
+
+private:
+  std::string name;
+  std::vector<Field> fields;
+  /// true if the fields are stored without padding between them (attribute packed)
+  bool packed;
+  /// alignment in bytes of the struct (attribute align(N)), 0 if it has the default alignment
+  std::int64_t alignment;
+  /// true if fixed-size arrays of the struct store every field in its own array (attribute soa)
+  bool soa;
+
+public:
+  StructType(std::string name, std::vector<Field> fields, bool packed, std::int64_t alignment,
+             bool soa);
+
+  // Getters
+  const std::vector<Field> &getFields();
+  /// returns the position of the field \fieldName in the struct, -1 if it does not exist
+  int getFieldIndex(const std::string &fieldName);
+  bool isPacked();
+  std::int64_t getAlignment();
+  bool isSoa();
+  std::string getName() override;
+  bool isInvalid() override;
+
+  /// compares the names of the structs
+  friend bool typeIsEqual(std::shared_ptr<StructType> lhs, std::shared_ptr<StructType> rhs);
+};
+
 /// Represents a function type, composed of the types of the parameters and the return type.
 class FunctionType : public Type {
 private:
-  // for now, all the parameters have to be of basic type because there are not other types
-  std::vector<std::shared_ptr<BasicType>> params;
-  std::shared_ptr<BasicType> result;
+  std::vector<std::shared_ptr<Type>> params;
+  std::shared_ptr<Type> result;
 
 public:
-  FunctionType(std::vector<std::shared_ptr<BasicType>> params, std::shared_ptr<BasicType> result);
+  FunctionType(std::vector<std::shared_ptr<Type>> params, std::shared_ptr<Type> result);
 
   // Getters
-  std::vector<std::shared_ptr<BasicType>> getParams();
-  std::shared_ptr<BasicType> getResult();
+  std::vector<std::shared_ptr<Type>> getParams();
+  std::shared_ptr<Type> getResult();
   std::string getName() override;
   bool isInvalid() override;
 
   /// compares the number and types of the parameters
-  friend bool areParametersEqual(std::vector<std::shared_ptr<BasicType>> lhs,
-                                 std::vector<std::shared_ptr<BasicType>> rhs);
+  friend bool areParametersEqual(std::vector<std::shared_ptr<Type>> lhs,
+                                 std::vector<std::shared_ptr<Type>> rhs);
   /// compares function types, which includes number and tyeps of the parameters, and the return
   /// type
   friend bool typeIsEqual(std::shared_ptr<FunctionType> lhs, std::shared_ptr<FunctionType> rhs);
 };
 
-bool areParametersEqual(std::vector<std::shared_ptr<BasicType>> lhs,
-                        std::vector<std::shared_ptr<BasicType>> rhs);
+bool areParametersEqual(std::vector<std::shared_ptr<Type>> lhs,
+                        std::vector<std::shared_ptr<Type>> rhs);
 
 #endif // STOC_TYPE_H
@@ -0,0 +1,47 @@
+//===- stoc/Server/Protocol.h - Defintion of the client-server protocol -------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the protocol used by stoc-client and the stoc server to communicate through a
+// Unix domain socket. The client sends its working directory and its command line in one message
+// and the server answers with the output and diagnostics of the compilation while it is running
+// and, in the end, the exit code.
+// It only depends on the C++ and POSIX libraries, so stoc-client starts fast.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_PROTOCOL_H
+#define STOC_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace protocol {
+
+/// Kinds of messages. Every message is sent as its kind (1 byte), the length of the payload
+/// (4 bytes, little endian) and the payload
+enum class MessageKind : uint8_t {
+  COMPILE, /// client -> server: working directory and command line of the client
+  OUTPUT,  /// server -> client: text printed by the compiler in the standard output
+  ERROR,   /// server -> client: text printed by the compiler in the standard error
+  EXIT     /// server -> client: exit code of the compiler, it is the last message
+};
+
+/// returns the path of the socket used when none is given: the environment variable STOC_SOCKET
+/// or /tmp/stoc-<uid>.socket
+std::string getDefaultSocketPath();
+
+/// sends the message of kind \kind with \payload through \socket. Returns false if it fails
+bool sendMessage(int socket, MessageKind kind, const std::string &payload);
+
+/// receives a message through \socket. Returns false if the connection is closed or it fails
+bool receiveMessage(int socket, MessageKind &kind, std::string &payload);
+
+/// encodes \strings as the payload of a message (strings terminated by '\0') and decodes it
+std::string encodeStrings(const std::vector<std::string> &strings);
+std::vector<std::string> decodeStrings(const std::string &payload);
+
+} // namespace protocol
+
+#endif // STOC_PROTOCOL_H
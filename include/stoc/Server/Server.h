@@ -0,0 +1,47 @@
+//===- stoc/Server/Server.h - Defintion of the Server class -------------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file defines the Server class.
+// The compilation server (stoc --server) avoids paying, for every file compiled, the start of the
+// process and the initialization of the LLVM targets and target machines. It listens on a Unix
+// domain socket and compiles the command lines forwarded by stoc-client, streaming the output and
+// the diagnostics back to the client.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#ifndef STOC_SERVER_H
+#define STOC_SERVER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+
+/// Compilation server that serves the compilations requested by the clients from a pool of threads
+class Server {
+private:
+  std::string socketPath; /// path of the Unix domain socket where the server listens
+  unsigned workers;       /// number of threads compiling the requests of the clients
+
+  // Connections accepted waiting for a worker to serve them
+  std::mutex mutex;
+  std::condition_variable connectionAccepted;
+  std::queue<int> connections;
+
+  /// loop of every worker: takes a connection and serves it
+  void work();
+
+  /// receives the command line of a client through \connection, compiles it and sends back the
+  /// output, the diagnostics and the exit code
+  void serve(int connection);
+
+public:
+  Server(std::string socketPath, unsigned workers);
+
+  /// main method: listens and serves the clients. It only returns if the server can not listen
+  /// on the socket or stops accepting connections. Returns the exit code of the server
+  int run();
+};
+
+#endif // STOC_SERVER_H
@@ -10,6 +10,7 @@
 #ifndef STOC_SRCFILE_H
 #define STOC_SRCFILE_H
 
+#include <iostream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -33,9 +34,8 @@ public:
   int length;       /// length of the source file
 
   // Fields for storing data after the scanning phase
-  std::vector<Token> tokens; /// list of tokens of the source file
-  bool errorInScanning;      /// represents if an error has occurred during the scanning phase
-                             /// (e.g a character was not recognized, quotes (") missing, ...)
+  bool errorInScanning; /// represents if an error has occurred during the scanning phase
+                        /// (e.g a character was not recognized, quotes (") missing, ...)
 
   // Fields for storing data after the parsing phase
   std::vector<std::shared_ptr<Decl>> ast; /// Abstract Syntax Tree representation
@@ -56,23 +56,33 @@ public:
   std::shared_ptr<llvm::Module> module;
   std::shared_ptr<llvm::IRBuilder<>> builder; /// offers C++ API to create IR
 
+  // Streams where the phases write their output (i.e. the tokens or the AST dumped) and their
+  // diagnostics. By default, the standard output and error, but the stoc server sends them to the
+  // client that requested the compilation.
+  std::ostream *outputStream;
+  std::ostream *errorStream;
+
 public:
   /// Constructor
   /// \field path - path where the source file is stored
   explicit SrcFile(std::string &path);
 
+  /// Constructor for source code that is not stored in a file (i.e. an input of the REPL)
+  /// \field filename - name used to refer to the source code in the diagnostics
+  /// \field data - source code
+  SrcFile(std::string filename, std::string data);
+
   [[nodiscard]] const std::string &getPath() const;
   [[nodiscard]] const std::string &getDirectory() const;
   [[nodiscard]] const std::string &getFilename() const;
   [[nodiscard]] const std::string &getData() const;
   [[nodiscard]] int getLength() const;
 
-  [[nodiscard]] const std::vector<Token> &getTokens() const;
-  void setTokens(const std::vector<Token> &t);
   [[nodiscard]] bool isErrorInScanning() const;
   void setErrorInScanning(bool error);
   [[nodiscard]] const std::vector<std::shared_ptr<Decl>> &getAst() const;
-  void setAst(const std::vector<std::shared_ptr<Decl>> &ast_nodes);
+  /// \ast_nodes is moved into SrcFile (call it with std::move to avoid copying the AST)
+  void setAst(std::vector<std::shared_ptr<Decl>> ast_nodes);
   [[nodiscard]] bool isErrorInParsing() const;
   void setErrorInParsing(bool error);
   [[nodiscard]] bool isErrorInSemanticAnalysis() const;
@@ -85,6 +95,9 @@ public:
   void setModule(const std::shared_ptr<llvm::Module> &module);
   [[nodiscard]] const std::shared_ptr<llvm::IRBuilder<>> &getBuilder() const;
   void setBuilder(const std::shared_ptr<llvm::IRBuilder<>> &builder);
+  [[nodiscard]] std::ostream &getOutputStream() const;
+  [[nodiscard]] std::ostream &getErrorStream() const;
+  void setStreams(std::ostream &output, std::ostream &error);
 };
 
 #endif // STOC_SRCFILE_H
@@ -3,7 +3,7 @@
 //===------------------------------------------------------------------------------------------===//
 //
 // This file implements the ASTPrinter class.
-// It prints the AST in a pretty way with information about every node->
+// It prints the AST in a pretty way with information about every node.
 //
 //===------------------------------------------------------------------------------------------===//
 
@@ -35,232 +35,352 @@ void ASTPrinter::decreaseDepthLevel() {
   pre = pre.substr(0, pre.size() - 2); // restore pre string
 }
 
-void ASTPrinter::print(const std::shared_ptr<BasicNode> &ast) { ast->accept(this); }
+void ASTPrinter::print(Decl &ast) { visit(ast); }
 
-void ASTPrinter::visit(std::shared_ptr<VarDecl> node) {
+void ASTPrinter::visit(VarDecl &node) {
   // print variable declaration token
-  std::cout << pre << "-VarDecl <l." << node->getVarKeywordToken().line << ":c."
-            << node->getVarKeywordToken().column << "> '" << node->getIdentifierToken().value
-            << "' " << node->getTypeToken().tokenType << std::endl;
+  out << pre << "-VarDecl <l." << node.getVarKeywordToken().line << ":c."
+      << node.getVarKeywordToken().column << "> '" << node.getIdentifierToken().value
+      << "' " << node.getTypeSpec().getName() << std::endl;
 
   increaseDepthLevel();
   lastChild();
-  node->getValue()->accept(this);
+  visit(*node.getValue());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<ConstDecl> node) {
+void ASTPrinter::visit(ConstDecl &node) {
   // print constant declaration token
-  std::cout << pre << "-ConstDecl <l." << node->getConstKeywordToken().line << ":c."
-            << node->getConstKeywordToken().column << "> '" << node->getIdentifierToken().value
-            << "' " << node->getTypeToken().tokenType << std::endl;
+  out << pre << "-ConstDecl <l." << node.getConstKeywordToken().line << ":c."
+      << node.getConstKeywordToken().column << "> '" << node.getIdentifierToken().value
+      << "' " << node.getTypeSpec().getName() << std::endl;
 
   increaseDepthLevel();
   lastChild();
-  node->getValue()->accept(this);
+  visit(*node.getValue());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<ParamDecl> node) {
-  std::cout << pre << "-ParamDecl <l." << node->getKeywordToken().line << ":c."
-            << node->getKeywordToken().column << "> '" << node->getIdentifierToken().value << "' "
-            << node->getTypeToken().tokenType << std::endl;
+void ASTPrinter::visit(ParamDecl &node) {
+  out << pre << "-ParamDecl <l." << node.getKeywordToken().line << ":c."
+      << node.getKeywordToken().column << "> '" << node.getIdentifierToken().value << "' "
+      << node.getTypeSpec().getName() << std::endl;
 }
 
-void ASTPrinter::visit(std::shared_ptr<FuncDecl> node) {
-  std::cout << pre << "-FuncDecl <l." << node->getFuncKeywordToken().line << ":c"
-            << node->getFuncKeywordToken().column << "> '" << node->getIdentifierToken().value
-            << "' ";
+void ASTPrinter::visit(FuncDecl &node) {
+  out << pre << "-FuncDecl <l." << node.getFuncKeywordToken().line << ":c"
+      << node.getFuncKeywordToken().column << "> '" << node.getIdentifierToken().value
+      << "' ";
+  if (node.isConst()) {
+    out << "const ";
+  }
+  for (const auto &attribute : node.getAttributes()) {
+    out << attribute.name.value;
+    if (attribute.hasArgument) {
+      out << "(" << attribute.argument.value << ")";
+    }
+    out << " ";
+  }
 
-  if (node->isHasReturnType()) {
-    std::cout << node->getReturnTypeToken().tokenType;
+  if (node.isHasReturnType()) {
+    out << node.getReturnTypeSpec().getName();
   }
-  std::cout << std::endl;
+  out << std::endl;
 
   increaseDepthLevel();
 
-  int size = node->getParams().size();
+  int size = node.getParams().size();
   for (int i = 0; i < size; i++) {
-    node->getParams().at(i)->accept(this);
+    visit(*node.getParams().at(i));
   }
 
   lastChild();
-  node->getBody()->accept(this);
+  visit(*node.getBody());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<BinaryExpr> node) {
-  std::cout << pre << "-BinaryExpr <l." << node->getOp().line << ":c." << node->getOp().column
-            << "> " << node->getOp().tokenType << " " << node->getType() << std::endl;
+void ASTPrinter::visit(StructDecl &node) {
+  out << pre << "-StructDecl <l." << node.getStructKeywordToken().line << ":c."
+      << node.getStructKeywordToken().column << "> '" << node.getIdentifierToken().value << "'";
+  for (const auto &attribute : node.getAttributes()) {
+    out << " " << attribute.name.value;
+    if (attribute.hasArgument) {
+      out << "(" << attribute.argument.value << ")";
+    }
+  }
+  out << std::endl;
 
   increaseDepthLevel();
-  node->getLhs()->accept(this);
+  int size = node.getFields().size();
+  for (int i = 0; i < size; i++) {
+    if (i == size - 1) {
+      lastChild();
+    }
+    const auto &field = node.getFields().at(i);
+    out << pre << "-Field <l." << field.identifierToken.line << ":c."
+        << field.identifierToken.column << "> '" << field.identifierToken.value << "' "
+        << field.typeSpec.getName() << std::endl;
+  }
+  decreaseDepthLevel();
+}
+
+void ASTPrinter::visit(BinaryExpr &node) {
+  out << pre << "-BinaryExpr <l." << node.getOp().line << ":c." << node.getOp().column
+      << "> " << node.getOp().tokenType << " " << node.getType() << std::endl;
+
+  increaseDepthLevel();
+  visit(*node.getLhs());
   lastChild();
-  node->getRhs()->accept(this);
+  visit(*node.getRhs());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<UnaryExpr> node) {
-  std::cout << pre << "-UnaryExpr <l." << node->getOp().line << ":c." << node->getOp().column
-            << "> " << node->getOp().tokenType << " " << node->getType() << std::endl;
+void ASTPrinter::visit(UnaryExpr &node) {
+  out << pre << "-UnaryExpr <l." << node.getOp().line << ":c." << node.getOp().column
+      << "> " << node.getOp().tokenType << " " << node.getType() << std::endl;
 
   increaseDepthLevel();
   lastChild();
-  node->getRhs()->accept(this);
+  visit(*node.getRhs());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<LiteralExpr> node) {
-  std::cout << pre << "-LiteralExpr <l." << node->getToken().line << ":c."
-            << node->getToken().column << "> " << node->getToken().tokenType
-            << " '" <<  node->getToken().value << "' " << node->getType() << std::endl;
+void ASTPrinter::visit(LiteralExpr &node) {
+  out << pre << "-LiteralExpr <l." << node.getToken().line << ":c."
+      << node.getToken().column << "> " << node.getToken().tokenType
+      << " '" <<  node.getToken().value << "' " << node.getType() << std::endl;
 }
 
-void ASTPrinter::visit(std::shared_ptr<IdentExpr> node) {
-  std::cout << pre << "-IdentExpr <l." << node->getIdent().line << ":c." << node->getIdent().column
-            << "> '" << node->getName() << "'"
-            << " " << node->getType() << std::endl;
+void ASTPrinter::visit(IdentExpr &node) {
+  out << pre << "-IdentExpr <l." << node.getIdent().line << ":c." << node.getIdent().column
+      << "> '" << node.getName() << "'"
+      << " " << node.getType() << std::endl;
 }
 
-void ASTPrinter::visit(std::shared_ptr<CallExpr> node) {
-  std::cout << pre << "-CallExpr " << node->getType() << std::endl;
+void ASTPrinter::visit(CallExpr &node) {
+  out << pre << "-CallExpr " << node.getType() << std::endl;
 
-  int size = node->getArgs().size();
+  int size = node.getArgs().size();
   if (size > 0) {
     increaseDepthLevel();
-    node->getFunc()->accept(this);
+    visit(*node.getFunc());
 
     for (int i = 0; i < size - 1; i++) {
-      node->getArgs().at(i)->accept(this);
+      visit(*node.getArgs().at(i));
     }
 
     lastChild();
-    node->getArgs().at(size - 1)->accept(this);
+    visit(*node.getArgs().at(size - 1));
     decreaseDepthLevel();
   } else {
     increaseDepthLevel();
     lastChild();
-    node->getFunc()->accept(this);
+    visit(*node.getFunc());
+    decreaseDepthLevel();
+  }
+}
+
+void ASTPrinter::visit(IndexExpr &node) {
+  out << pre << "-IndexExpr <l." << node.getLbrack().line << ":c." << node.getLbrack().column
+      << "> " << node.getType() << (node.isBoundsCheck() ? "" : " (no bounds check)") << std::endl;
+
+  increaseDepthLevel();
+  visit(*node.getArray());
+  lastChild();
+  visit(*node.getIndex());
+  decreaseDepthLevel();
+}
+
+void ASTPrinter::visit(FieldExpr &node) {
+  out << pre << "-FieldExpr <l." << node.getPeriod().line << ":c." << node.getPeriod().column
+      << "> '" << node.getField().value << "' " << node.getType() << std::endl;
+
+  increaseDepthLevel();
+  lastChild();
+  visit(*node.getOperand());
+  decreaseDepthLevel();
+}
+
+void ASTPrinter::visit(ArrayLiteralExpr &node) {
+  out << pre << "-ArrayLiteralExpr <l." << node.getTypeSpec().getToken().line << ":c."
+      << node.getTypeSpec().getToken().column << "> " << node.getType() << std::endl;
+
+  int size = node.getElements().size();
+  if (size > 0) {
+    increaseDepthLevel();
+    for (int i = 0; i < size - 1; i++) {
+      visit(*node.getElements().at(i));
+    }
+
+    lastChild();
+    visit(*node.getElements().at(size - 1));
     decreaseDepthLevel();
   }
 }
 
-void ASTPrinter::visit(std::shared_ptr<ExpressionStmt> node) {
-  std::cout << pre << "-ExpressionStmt" << std::endl;
+void ASTPrinter::visit(ConversionExpr &node) {
+  out << pre << "-ConversionExpr <l." << node.getTypeToken().line << ":c."
+      << node.getTypeToken().column << "> " << node.getType() << std::endl;
+
+  increaseDepthLevel();
+  lastChild();
+  visit(*node.getValue());
+  decreaseDepthLevel();
+}
+
+void ASTPrinter::visit(SpawnExpr &node) {
+  out << pre << "-SpawnExpr <l." << node.getSpawnKeyword().line << ":c."
+      << node.getSpawnKeyword().column << "> " << node.getType() << std::endl;
+
+  increaseDepthLevel();
+  lastChild();
+  visit(*node.getCall());
+  decreaseDepthLevel();
+}
+
+void ASTPrinter::visit(AwaitExpr &node) {
+  out << pre << "-AwaitExpr <l." << node.getAwaitKeyword().line << ":c."
+      << node.getAwaitKeyword().column << "> " << node.getType() << std::endl;
 
   increaseDepthLevel();
   lastChild();
-  node->getExpr()->accept(this);
+  visit(*node.getTask());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<DeclarationStmt> node) {
-  std::cout << pre << "-DeclarationStmt" << std::endl;
+void ASTPrinter::visit(ExpressionStmt &node) {
+  out << pre << "-ExpressionStmt" << std::endl;
 
   increaseDepthLevel();
   lastChild();
-  node->getDecl()->accept(this);
+  visit(*node.getExpr());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<BlockStmt> node) {
-  std::cout << pre << "-BlockStmt <l." << node->getLbrace().line << ":c."
-            << node->getLbrace().column << "> - <l." << node->getRbrace().line << ":c."
-            << node->getRbrace().column << ">" << std::endl;
+void ASTPrinter::visit(DeclarationStmt &node) {
+  out << pre << "-DeclarationStmt" << std::endl;
+
+  increaseDepthLevel();
+  lastChild();
+  visit(*node.getDecl());
+  decreaseDepthLevel();
+}
 
-  int size = node->getStmts().size();
+void ASTPrinter::visit(BlockStmt &node) {
+  out << pre << "-BlockStmt <l." << node.getLbrace().line << ":c."
+      << node.getLbrace().column << "> - <l." << node.getRbrace().line << ":c."
+      << node.getRbrace().column << ">" << std::endl;
+
+  int size = node.getStmts().size();
   if (size > 0) {
     increaseDepthLevel();
     for (int i = 0; i < size - 1; i++) {
-      node->getStmts().at(i)->accept(this);
+      visit(*node.getStmts().at(i));
     }
 
     lastChild();
-    node->getStmts().at(node->getStmts().size() - 1)->accept(this);
+    visit(*node.getStmts().at(node.getStmts().size() - 1));
     decreaseDepthLevel();
   }
 }
 
-void ASTPrinter::visit(std::shared_ptr<IfStmt> node) {
-  std::cout << pre << "-IfStmt <l." << node->getIfKeyword().line << ":c."
-            << node->getIfKeyword().column << ">" << std::endl;
+void ASTPrinter::visit(IfStmt &node) {
+  out << pre << "-IfStmt <l." << node.getIfKeyword().line << ":c."
+      << node.getIfKeyword().column << ">" << std::endl;
 
   increaseDepthLevel();
 
-  node->getCondition()->accept(this);
+  visit(*node.getCondition());
 
-  if (node->isHasElse()) {
-    node->getThenBranch()->accept(this);
+  if (node.isHasElse()) {
+    visit(*node.getThenBranch());
     lastChild();
-    node->getElseBranch()->accept(this);
+    visit(*node.getElseBranch());
     decreaseDepthLevel();
   } else {
     lastChild();
-    node->getThenBranch()->accept(this);
+    visit(*node.getThenBranch());
     decreaseDepthLevel();
   }
 }
 
-void ASTPrinter::visit(std::shared_ptr<ForStmt> node) {
-  std::cout << pre << "-ForStmt <l." << node->getForKeyword().line << ":c."
-            << node->getForKeyword().column << ">" << std::endl;
+void ASTPrinter::visit(ForStmt &node) {
+  out << pre << "-ForStmt <l." << node.getForKeyword().line << ":c."
+      << node.getForKeyword().column << ">";
+  if (node.isParallel()) {
+    out << " parallel";
+    for (const auto &reduction : node.getReductions()) {
+      out << " " << reduction.op.value << "(" << reduction.variable->getName() << ")";
+    }
+  }
+  out << std::endl;
 
   increaseDepthLevel();
 
-  if (node->getInit() != nullptr) {
-    node->getInit()->accept(this);
+  if (node.getInit() != nullptr) {
+    visit(*node.getInit());
   } else {
-    std::cout << pre << "- <<no initialization>>" << std::endl;
+    out << pre << "- <<no initialization>>" << std::endl;
   }
 
-  if (node->getCond() != nullptr) {
-    node->getCond()->accept(this);
+  if (node.getCond() != nullptr) {
+    visit(*node.getCond());
   } else {
-    std::cout << pre << "- <<no condition>>" << std::endl;
+    out << pre << "- <<no condition>>" << std::endl;
   }
 
-  if (node->getPost() != nullptr) {
-    node->getPost()->accept(this);
+  if (node.getPost() != nullptr) {
+    visit(*node.getPost());
   } else {
-    std::cout << pre << "- <<no post statement>>" << std::endl;
+    out << pre << "- <<no post statement>>" << std::endl;
   }
 
   lastChild();
-  node->getBody()->accept(this);
+  visit(*node.getBody());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<WhileStmt> node) {
-  std::cout << pre << "-WhileStmt <l." << node->getWhileKeyword().line << ":c."
-            << node->getWhileKeyword().column << ">" << std::endl;
+void ASTPrinter::visit(WhileStmt &node) {
+  out << pre << "-WhileStmt <l." << node.getWhileKeyword().line << ":c."
+      << node.getWhileKeyword().column << ">" << std::endl;
 
   increaseDepthLevel();
 
-  node->getCond()->accept(this);
+  visit(*node.getCond());
   lastChild();
-  node->getBody()->accept(this);
+  visit(*node.getBody());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<AssignmentStmt> node) {
-  std::cout << pre << "-AssignmentStmt <l." << node->getEqualToken().line << ":c."
-            << node->getEqualToken().column << ">" << std::endl;
+void ASTPrinter::visit(AssignmentStmt &node) {
+  out << pre << "-AssignmentStmt <l." << node.getEqualToken().line << ":c."
+      << node.getEqualToken().column << ">" << std::endl;
 
   increaseDepthLevel();
-  node->getLhs()->accept(this);
+  visit(*node.getLhs());
   lastChild();
-  node->getRhs()->accept(this);
+  visit(*node.getRhs());
   decreaseDepthLevel();
 }
 
-void ASTPrinter::visit(std::shared_ptr<ReturnStmt> node) {
-  std::cout << pre << "-ReturnStmt <l." << node->getReturnKeyword().line << ":c."
-            << node->getReturnKeyword().column << ">" << std::endl;
+void ASTPrinter::visit(ReturnStmt &node) {
+  out << pre << "-ReturnStmt <l." << node.getReturnKeyword().line << ":c."
+      << node.getReturnKeyword().column << ">" << std::endl;
 
-  if (node->getValue() != nullptr) {
+  if (node.getValue() != nullptr) {
     increaseDepthLevel();
     lastChild();
-    node->getValue()->accept(this);
+    visit(*node.getValue());
     decreaseDepthLevel();
   }
 }
+
+void ASTPrinter::visit(BreakStmt &node) {
+  out << pre << "-BreakStmt <l." << node.getBreakKeyword().line << ":c."
+      << node.getBreakKeyword().column << ">" << std::endl;
+}
+
+void ASTPrinter::visit(ContinueStmt &node) {
+  out << pre << "-ContinueStmt <l." << node.getContinueKeyword().line << ":c."
+      << node.getContinueKeyword().column << ">" << std::endl;
+}
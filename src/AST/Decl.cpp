@@ -8,24 +8,23 @@
 
 #include "stoc/AST/Decl.h"
 
+#include <algorithm>
+
 // Decl node
 Decl::Decl(Decl::Kind declKind) : declKind(declKind) {}
 Decl::Kind Decl::getDeclKind() const { return declKind; }
 
 // Variable Declaration node
-VarDecl::VarDecl(Token varKeywordToken, Token typeToken, Token identifierToken,
+VarDecl::VarDecl(Token varKeywordToken, TypeSpec typeSpec, Token identifierToken,
                  std::shared_ptr<Expr> value)
-    : varKeywordToken(varKeywordToken), typeToken(typeToken), identifierToken(identifierToken),
+    : varKeywordToken(varKeywordToken), typeSpec(std::move(typeSpec)), identifierToken(identifierToken),
       value(value), identifierMangled(identifierToken.value), Decl(Decl::Kind::VARDECL) {}
 
-void VarDecl::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<VarDecl>(Decl::shared_from_this()));
-}
-
 const Token &VarDecl::getVarKeywordToken() const { return varKeywordToken; }
-const Token &VarDecl::getTypeToken() const { return typeToken; }
+const TypeSpec &VarDecl::getTypeSpec() const { return typeSpec; }
 const Token &VarDecl::getIdentifierToken() const { return identifierToken; }
 const std::shared_ptr<Expr> &VarDecl::getValue() const { return value; }
+void VarDecl::setValue(const std::shared_ptr<Expr> &value) { this->value = value; }
 bool VarDecl::isGlobal() const { return isGlobalVariable; }
 void VarDecl::setIsGlobal(bool isGlobal) { this->isGlobalVariable = isGlobal; }
 const std::shared_ptr<Type> &VarDecl::getType() const { return type; }
@@ -36,19 +35,16 @@ void VarDecl::setIdentifierMangled(const std::string &identifierMangled) {
 }
 
 // Constant Declaration node
-ConstDecl::ConstDecl(Token constKeywordToken, Token typeToken, Token identifierToken,
+ConstDecl::ConstDecl(Token constKeywordToken, TypeSpec typeSpec, Token identifierToken,
                      std::shared_ptr<Expr> value)
-    : constKeywordToken(constKeywordToken), identifierToken(identifierToken), typeToken(typeToken),
+    : constKeywordToken(constKeywordToken), identifierToken(identifierToken), typeSpec(std::move(typeSpec)),
       value(value), identifierMangled(identifierToken.value), Decl(Decl::Kind::CONSTDECL) {}
 
-void ConstDecl::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<ConstDecl>(Decl::shared_from_this()));
-}
-
 const Token &ConstDecl::getConstKeywordToken() const { return constKeywordToken; }
-const Token &ConstDecl::getTypeToken() const { return typeToken; }
+const TypeSpec &ConstDecl::getTypeSpec() const { return typeSpec; }
 const Token &ConstDecl::getIdentifierToken() const { return identifierToken; }
 const std::shared_ptr<Expr> &ConstDecl::getValue() const { return value; }
+void ConstDecl::setValue(const std::shared_ptr<Expr> &value) { this->value = value; }
 bool ConstDecl::isGlobal() const { return isGlobalConstant; }
 void ConstDecl::setIsGlobal(bool isGlobal) { this->isGlobalConstant = isGlobal; }
 const std::shared_ptr<Type> &ConstDecl::getType() const { return type; }
@@ -59,16 +55,12 @@ void ConstDecl::setIdentifierMangled(const std::string &identifierMangled) {
 }
 
 // Parameter Declaration node
-ParamDecl::ParamDecl(Token keywordToken, Token typeToken, Token identifierToken)
-    : keywordToken(keywordToken), typeToken(typeToken), identifierToken(identifierToken),
+ParamDecl::ParamDecl(Token keywordToken, TypeSpec typeSpec, Token identifierToken)
+    : keywordToken(keywordToken), typeSpec(std::move(typeSpec)), identifierToken(identifierToken),
       identifierMangled(identifierToken.value), Decl(Decl::Kind::PARAMDECL) {}
 
-void ParamDecl::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<ParamDecl>(Decl::shared_from_this()));
-}
-
 const Token &ParamDecl::getKeywordToken() const { return keywordToken; }
-const Token &ParamDecl::getTypeToken() const { return typeToken; }
+const TypeSpec &ParamDecl::getTypeSpec() const { return typeSpec; }
 const Token &ParamDecl::getIdentifierToken() const { return identifierToken; }
 const std::shared_ptr<Type> &ParamDecl::getType() const { return type; }
 void ParamDecl::setType(const std::shared_ptr<Type> &type) { this->type = type; }
@@ -79,30 +71,60 @@ void ParamDecl::setIdentifierMangled(const std::string &identifierMangled) {
 
 // Function Declaration node
 FuncDecl::FuncDecl(Token funcKeywordToken, Token identifierToken,
-                   std::vector<std::shared_ptr<ParamDecl>> params, Token returnTypeToken,
-                   std::shared_ptr<BlockStmt> body)
-    : funcKeywordToken(funcKeywordToken), identifierToken(identifierToken), params(params),
-      returnTypeToken(returnTypeToken), body(body), hasReturnType(true),
-      identifierMangled(identifierToken.value), Decl(Decl::Kind::FUNCDECL) {}
+                   std::vector<Attribute> attributes,
+                   std::vector<std::shared_ptr<ParamDecl>> params, TypeSpec returnTypeSpec,
+                   std::shared_ptr<BlockStmt> body, bool constant)
+    : funcKeywordToken(funcKeywordToken), identifierToken(identifierToken),
+      attributes(std::move(attributes)), params(params),
+      returnTypeSpec(std::move(returnTypeSpec)), body(body), hasReturnType(true),
+      constant(constant), identifierMangled(identifierToken.value), pure(false),
+      memory(Memory::WRITE), willReturn(false), recursive(true), Decl(Decl::Kind::FUNCDECL) {}
 
 FuncDecl::FuncDecl(Token funcKeywordToken, Token identifierToken,
-                   std::vector<std::shared_ptr<ParamDecl>> params, std::shared_ptr<BlockStmt> body)
-    : funcKeywordToken(funcKeywordToken), identifierToken(identifierToken), params(params),
-      body(body), hasReturnType(false), Decl(Decl::Kind::FUNCDECL) {}
-
-void FuncDecl::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<FuncDecl>(Decl::shared_from_this()));
-}
+                   std::vector<Attribute> attributes,
+                   std::vector<std::shared_ptr<ParamDecl>> params, std::shared_ptr<BlockStmt> body,
+                   bool constant)
+    : funcKeywordToken(funcKeywordToken), identifierToken(identifierToken),
+      attributes(std::move(attributes)), params(params),
+      body(body), hasReturnType(false), constant(constant), pure(false), memory(Memory::WRITE),
+      willReturn(false), recursive(true), Decl(Decl::Kind::FUNCDECL) {}
 
 const Token &FuncDecl::getFuncKeywordToken() const { return funcKeywordToken; };
 const Token &FuncDecl::getIdentifierToken() const { return identifierToken; }
+const std::vector<Attribute> &FuncDecl::getAttributes() const { return attributes; }
+bool FuncDecl::hasAttribute(const std::string &name) const {
+  return std::any_of(attributes.begin(), attributes.end(),
+                     [&name](const Attribute &attribute) { return attribute.name.value == name; });
+}
 const std::vector<std::shared_ptr<ParamDecl>> &FuncDecl::getParams() const { return params; }
-const Token &FuncDecl::getReturnTypeToken() const { return returnTypeToken; }
+const TypeSpec &FuncDecl::getReturnTypeSpec() const { return returnTypeSpec; }
 bool FuncDecl::isHasReturnType() const { return hasReturnType; }
 const std::shared_ptr<BlockStmt> &FuncDecl::getBody() const { return body; }
+bool FuncDecl::isConst() const { return constant; }
 const std::shared_ptr<Type> &FuncDecl::getType() const { return type; }
 void FuncDecl::setType(const std::shared_ptr<Type> &type) { this->type = type; }
 const std::string &FuncDecl::getIdentifierMangled() const { return identifierMangled; }
 void FuncDecl::setIdentifierMangled(const std::string &identifierMangled) {
   FuncDecl::identifierMangled = identifierMangled;
 }
+bool FuncDecl::isPure() const { return pure; }
+void FuncDecl::setPure(bool pure) { this->pure = pure; }
+FuncDecl::Memory FuncDecl::getMemory() const { return memory; }
+void FuncDecl::setMemory(Memory memory) { this->memory = memory; }
+bool FuncDecl::isWillReturn() const { return willReturn; }
+void FuncDecl::setWillReturn(bool willReturn) { this->willReturn = willReturn; }
+bool FuncDecl::isRecursive() const { return recursive; }
+void FuncDecl::setRecursive(bool recursive) { this->recursive = recursive; }
+
+// Struct Declaration node
+StructDecl::StructDecl(Token structKeywordToken, Token identifierToken,
+                       std::vector<Attribute> attributes, std::vector<FieldDecl> fields)
+    : structKeywordToken(structKeywordToken), identifierToken(identifierToken),
+      attributes(std::move(attributes)), fields(std::move(fields)), Decl(Decl::Kind::STRUCTDECL) {}
+
+const Token &StructDecl::getStructKeywordToken() const { return structKeywordToken; }
+const Token &StructDecl::getIdentifierToken() const { return identifierToken; }
+const std::vector<Attribute> &StructDecl::getAttributes() const { return attributes; }
+const std::vector<FieldDecl> &StructDecl::getFields() const { return fields; }
+const std::shared_ptr<Type> &StructDecl::getType() const { return type; }
+void StructDecl::setType(const std::shared_ptr<Type> &type) { this->type = type; }
@@ -18,13 +18,11 @@ void Expr::setExprValueKind(Expr::ValueKind exprValueKind) { Expr::exprValueKind
 BinaryExpr::BinaryExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs, Token &op)
     : lhs(std::move(lhs)), rhs(std::move(rhs)), op(op), Expr(Expr::Kind::BINARYEXPR) {}
 
-void BinaryExpr::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<BinaryExpr>(Expr::shared_from_this()));
-}
-
 const std::shared_ptr<Expr> &BinaryExpr::getLhs() const { return lhs; }
 const std::shared_ptr<Expr> &BinaryExpr::getRhs() const { return rhs; }
 const Token &BinaryExpr::getOp() const { return op; }
+void BinaryExpr::setLhs(const std::shared_ptr<Expr> &lhs) { this->lhs = lhs; }
+void BinaryExpr::setRhs(const std::shared_ptr<Expr> &rhs) { this->rhs = rhs; }
 const std::shared_ptr<Type> &BinaryExpr::getType() const { return type; }
 void BinaryExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
 
@@ -32,22 +30,15 @@ void BinaryExpr::setType(const std::shared_ptr<Type> &type) { this->type = type;
 UnaryExpr::UnaryExpr(std::shared_ptr<Expr> rhs, Token &op)
     : rhs(std::move(rhs)), op(op), Expr(Expr::Kind::UNARYEXPR) {}
 
-void UnaryExpr::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<UnaryExpr>(Expr::shared_from_this()));
-}
-
 const std::shared_ptr<Expr> &UnaryExpr::getRhs() const { return rhs; }
 const Token &UnaryExpr::getOp() const { return op; }
+void UnaryExpr::setRhs(const std::shared_ptr<Expr> &rhs) { this->rhs = rhs; }
 const std::shared_ptr<Type> &UnaryExpr::getType() const { return type; }
 void UnaryExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
 
 // Literal Expression node
 LiteralExpr::LiteralExpr(Token token) : token(token), Expr(Expr::Kind::LITERALEXPR) {}
 
-void LiteralExpr::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<LiteralExpr>(Expr::shared_from_this()));
-}
-
 const Token &LiteralExpr::getToken() const { return token; }
 const std::shared_ptr<Type> &LiteralExpr::getType() const { return type; }
 void LiteralExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
@@ -55,10 +46,6 @@ void LiteralExpr::setType(const std::shared_ptr<Type> &type) { this->type = type
 // Identifier Expression node
 IdentExpr::IdentExpr(Token ident) : ident(ident), Expr(Expr::Kind::IDENTEXPR) {}
 
-void IdentExpr::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<IdentExpr>(Expr::shared_from_this()));
-}
-
 const Token &IdentExpr::getIdent() const { return ident; }
 const std::string &IdentExpr::getName() const { return ident.value; }
 const std::shared_ptr<Type> &IdentExpr::getType() const { return type; }
@@ -70,13 +57,91 @@ void IdentExpr::setDeclOfIdentifier(const std::shared_ptr<Decl> &declOfIdentifie
 
 // Call Expression node
 CallExpr::CallExpr(std::shared_ptr<Expr> func, std::vector<std::shared_ptr<Expr>> args)
-    : func(func), args(args), Expr(Expr::Kind::CALLEXPR) {}
-
-void CallExpr::accept(ASTVisitor *visitor) {
-  visitor->visit(std::dynamic_pointer_cast<CallExpr>(Expr::shared_from_this()));
-}
+    : func(func), args(args), tailCall(TailCall::NONE), Expr(Expr::Kind::CALLEXPR) {}
 
 const std::shared_ptr<Expr> &CallExpr::getFunc() const { return func; }
 const std::vector<std::shared_ptr<Expr>> &CallExpr::getArgs() const { return args; }
+void CallExpr::setArg(std::size_t idx, const std::shared_ptr<Expr> &arg) { args[idx] = arg; }
 const std::shared_ptr<Type> &CallExpr::getType() const { return type; }
 void CallExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
+CallExpr::TailCall CallExpr::getTailCall() const { return tailCall; }
+void CallExpr::setTailCall(TailCall tailCall) { this->tailCall = tailCall; }
+
+// Index Expression node
+IndexExpr::IndexExpr(std::shared_ptr<Expr> array, std::shared_ptr<Expr> index, Token lbrack,
+                     Token rbrack)
+    : array(std::move(array)), index(std::move(index)), lbrack(lbrack), rbrack(rbrack),
+      boundsCheck(true), Expr(Expr::Kind::INDEXEXPR) {}
+
+const std::shared_ptr<Expr> &IndexExpr::getArray() const { return array; }
+const std::shared_ptr<Expr> &IndexExpr::getIndex() const { return index; }
+const Token &IndexExpr::getLbrack() const { return lbrack; }
+const Token &IndexExpr::getRbrack() const { return rbrack; }
+bool IndexExpr::isBoundsCheck() const { return boundsCheck; }
+void IndexExpr::setBoundsCheck(bool boundsCheck) { this->boundsCheck = boundsCheck; }
+void IndexExpr::setArray(const std::shared_ptr<Expr> &array) { this->array = array; }
+void IndexExpr::setIndex(const std::shared_ptr<Expr> &index) { this->index = index; }
+const std::shared_ptr<Type> &IndexExpr::getType() const { return type; }
+void IndexExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
+
+// Field Expression node
+FieldExpr::FieldExpr(std::shared_ptr<Expr> operand, Token period, Token field)
+    : operand(std::move(operand)), period(period), field(field), fieldIndex(-1),
+      Expr(Expr::Kind::FIELDEXPR) {}
+
+const std::shared_ptr<Expr> &FieldExpr::getOperand() const { return operand; }
+const Token &FieldExpr::getPeriod() const { return period; }
+const Token &FieldExpr::getField() const { return field; }
+int FieldExpr::getFieldIndex() const { return fieldIndex; }
+void FieldExpr::setFieldIndex(int fieldIndex) { this->fieldIndex = fieldIndex; }
+void FieldExpr::setOperand(const std::shared_ptr<Expr> &operand) { this->operand = operand; }
+const std::shared_ptr<Type> &FieldExpr::getType() const { return type; }
+void FieldExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
+
+// Array Literal Expression node
+ArrayLiteralExpr::ArrayLiteralExpr(TypeSpec typeSpec, std::vector<std::shared_ptr<Expr>> elements,
+                                   Token rbrace)
+    : typeSpec(std::move(typeSpec)), elements(std::move(elements)), rbrace(rbrace),
+      Expr(Expr::Kind::ARRAYLITERALEXPR) {}
+
+const TypeSpec &ArrayLiteralExpr::getTypeSpec() const { return typeSpec; }
+const std::vector<std::shared_ptr<Expr>> &ArrayLiteralExpr::getElements() const {
+  return elements;
+}
+const Token &ArrayLiteralExpr::getRbrace() const { return rbrace; }
+void ArrayLiteralExpr::setElement(std::size_t idx, const std::shared_ptr<Expr> &element) {
+  elements[idx] = element;
+}
+const std::shared_ptr<Type> &ArrayLiteralExpr::getType() const { return type; }
+void ArrayLiteralExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
+
+ConversionExpr::ConversionExpr(Token typeToken, std::shared_ptr<Expr> value, Token rparen)
+    : typeToken(typeToken), value(std::move(value)), rparen(rparen),
+      Expr(Expr::Kind::CONVERSIONEXPR) {}
+
+const Token &ConversionExpr::getTypeToken() const { return typeToken; }
+const std::shared_ptr<Expr> &ConversionExpr::getValue() const { return value; }
+const Token &ConversionExpr::getRparen() const { return rparen; }
+void ConversionExpr::setValue(const std::shared_ptr<Expr> &value) { this->value = value; }
+const std::shared_ptr<Type> &ConversionExpr::getType() const { return type; }
+void ConversionExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
+
+// Spawn Expression node
+SpawnExpr::SpawnExpr(Token spawnKeyword, std::shared_ptr<Expr> call)
+    : spawnKeyword(spawnKeyword), call(std::move(call)), Expr(Expr::Kind::SPAWNEXPR) {}
+
+const Token &SpawnExpr::getSpawnKeyword() const { return spawnKeyword; }
+const std::shared_ptr<Expr> &SpawnExpr::getCall() const { return call; }
+void SpawnExpr::setCall(const std::shared_ptr<Expr> &call) { this->call = call; }
+const std::shared_ptr<Type> &SpawnExpr::getType() const { return type; }
+void SpawnExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
+
+// Await Expression node
+AwaitExpr::AwaitExpr(Token awaitKeyword, std::shared_ptr<Expr> task)
+    : awaitKeyword(awaitKeyword), task(std::move(task)), Expr(Expr::Kind::AWAITEXPR) {}
+
+const Token &AwaitExpr::getAwaitKeyword() const { return awaitKeyword; }
+const std::shared_ptr<Expr> &AwaitExpr::getTask() const { return task; }
+void AwaitExpr::setTask(const std::shared_ptr<Expr> &task) { this->task = task; }
+const std::shared_ptr<Type> &AwaitExpr::getType() const { return type; }
+void AwaitExpr::setType(const std::shared_ptr<Type> &type) { this->type = type; }
@@ -0,0 +1,48 @@
+//===- src/AST/TypeSpec.cpp - Implementation of the TypeSpec class ------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the TypeSpec class, the types written in the source code.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "stoc/AST/TypeSpec.h"
+
+TypeSpec::TypeSpec(Token basicType)
+    : typeSpecKind(basicType.tokenType == IDENTIFIER ? Kind::STRUCT : Kind::BASIC),
+      token(std::move(basicType)) {}
+
+TypeSpec::TypeSpec(Token open, Token size, std::shared_ptr<TypeSpec> element)
+    : typeSpecKind(open.tokenType == LESS ? Kind::VECTOR : Kind::ARRAY), token(std::move(open)),
+      size(std::move(size)), element(std::move(element)) {}
+
+TypeSpec::TypeSpec(Token open, std::shared_ptr<TypeSpec> element)
+    : typeSpecKind(open.tokenType == TASK     ? Kind::TASK
+                   : open.tokenType == ATOMIC ? Kind::ATOMIC
+                                              : Kind::DYNAMICARRAY),
+      token(std::move(open)), element(std::move(element)) {}
+
+TypeSpec::Kind TypeSpec::getKind() const { return typeSpecKind; }
+const Token &TypeSpec::getToken() const { return token; }
+const Token &TypeSpec::getSize() const { return size; }
+const std::shared_ptr<TypeSpec> &TypeSpec::getElement() const { return element; }
+
+std::string TypeSpec::getName() const {
+  switch (typeSpecKind) {
+  case Kind::BASIC:
+    return to_string(token.tokenType);
+  case Kind::ARRAY:
+    return "[" + size.value + "]" + element->getName();
+  case Kind::DYNAMICARRAY:
+    return "[]" + element->getName();
+  case Kind::VECTOR:
+    return "<" + size.value + ">" + element->getName();
+  case Kind::TASK:
+    return "task " + element->getName();
+  case Kind::ATOMIC:
+    return "atomic " + element->getName();
+  case Kind::STRUCT:
+    return token.value;
+  }
+  return "";
+}
@@ -8,22 +8,29 @@
 //===------------------------------------------------------------------------------------------===//
 #include "stoc/CodeGeneration/CodeGeneration.h"
 
-#include <llvm/Transforms/Utils/ModuleUtils.h>
+#include <llvm/IR/CFG.h>
 
-void CodeGeneration::generate(const std::shared_ptr<Decl> &node) {
-  switch (node->getDeclKind()) {
+void CodeGeneration::generate(const Decl &node) {
+  switch (node.getDeclKind()) {
   case Decl::Kind::VARDECL:
-    return generate(std::static_pointer_cast<VarDecl>(node));
+    return generate(static_cast<const VarDecl &>(node));
   case Decl::Kind::CONSTDECL:
-    return generate(std::static_pointer_cast<ConstDecl>(node));
+    return generate(static_cast<const ConstDecl &>(node));
   case Decl::Kind::PARAMDECL:
-    return generate(std::static_pointer_cast<ParamDecl>(node));
+    return generate(static_cast<const ParamDecl &>(node));
   case Decl::Kind::FUNCDECL:
-    return generate(std::static_pointer_cast<FuncDecl>(node));
+    return generate(static_cast<const FuncDecl &>(node));
+  case Decl::Kind::STRUCTDECL:
+    return generate(static_cast<const StructDecl &>(node));
   }
 }
 
-void CodeGeneration::generateFunctionForInitialization(const std::shared_ptr<VarDecl> &node,
+llvm::GlobalValue::LinkageTypes CodeGeneration::getGlobalLinkage() {
+  // When generating incrementally, the globals are used from the modules of the next inputs
+  return incremental ? llvm::GlobalValue::ExternalLinkage : llvm::GlobalValue::PrivateLinkage;
+}
+
+void CodeGeneration::generateFunctionForInitialization(const VarDecl &node,
                                                        llvm::Value *GV) {
   // Define function signature
   // 1. No parameters
@@ -39,12 +46,12 @@ void CodeGeneration::generateFunctionForInitialization(const std::shared_ptr<Var
   builder->SetInsertPoint(entryBB);
 
   // 5. Code Generation for the initialization
-  llvm::Value *initializer = generate(node->getValue());
-  builder->CreateStore(initializer, GV);
+  llvm::Value *initializer = generate(*node.getValue());
+  storeValue(initializer, GV, node.getType());
   builder->CreateRetVoid();
 
   // 6. Add initializer function
-  llvm::appendToGlobalCtors(*module, function, 0, nullptr);
+  addInitializationFunction(function);
 
   // NOTE that could be implemented to improve similarity to Clang: to make CodeGen more similar to
   // clang, every constructor function is called by a general constructor function
@@ -52,66 +59,88 @@ void CodeGeneration::generateFunctionForInitialization(const std::shared_ptr<Var
   // llvm.global_ctors
 }
 
-void CodeGeneration::generateGlobalVariableDecl(const std::shared_ptr<VarDecl> &node) {
-  llvm::Type *LLVMtype = getLLVMType(node->getType());
-  llvm::Constant *constant0 = getLLVMInit(node->getType());
-  auto *GV = new llvm::GlobalVariable(*module, LLVMtype, false, llvm::GlobalValue::PrivateLinkage,
-                                      constant0, node->getIdentifierMangled(), nullptr);
+void CodeGeneration::generateGlobalVariableDecl(const VarDecl &node) {
+  llvm::Type *LLVMtype = getLLVMType(node.getType());
+  llvm::Constant *constant0 = getLLVMInit(node.getType());
+  auto *GV = new llvm::GlobalVariable(*module, LLVMtype, false, getGlobalLinkage(), constant0,
+                                      node.getIdentifierMangled(), nullptr);
 
-  globalVariables[node->getIdentifierMangled()] = GV;
+  globalVariables[node.getIdentifierMangled()] = GV;
   // Because global variable declarations might have a complex initialization (not just a simple
   // constant expression):
   // var int a = 5 + 4 * 3 - 2;
   // var int b = 10 + a;
-  // and constant folding is not implemented, it is necessary to build a function that initializes
-  // every global variable
-  generateFunctionForInitialization(node, GV);
+  // it is necessary to build a function that initializes every global variable. If constant
+  // folding has reduced the initialization to a literal, the global variable is initialized
+  // statically instead
+  if (node.getValue()->getExprKind() == Expr::Kind::LITERALEXPR) {
+    // the value of an atomic bool is stored in a byte (see getLLVMType)
+    auto literal = llvm::cast<llvm::Constant>(generate(*node.getValue()));
+    GV->setInitializer(llvm::ConstantExpr::getZExtOrBitCast(literal, LLVMtype));
+  } else if (llvm::Constant *constantArray = generateConstantArray(*node.getValue())) {
+    GV->setInitializer(constantArray);
+  } else {
+    generateFunctionForInitialization(node, GV);
+  }
 }
 
-void CodeGeneration::generateLocalVariableDecl(const std::shared_ptr<VarDecl> &node) {
-  llvm::Type *LLVMtype = getLLVMType(node->getType());
+void CodeGeneration::generateLocalVariableDecl(const VarDecl &node) {
+  llvm::Type *LLVMtype = getLLVMType(node.getType());
   // TODO: (improvement) put alloca in the entry block of the function (see:
   //       http://lists.llvm.org/pipermail/llvm-dev/2017-January/108730.html)
-  auto *allocaInst = builder->CreateAlloca(LLVMtype, nullptr, node->getIdentifierMangled());
+  // Arrays are already allocated in the entry block, so the stack does not grow in loops
+  auto *allocaInst = node.getType()->getTypeKind() == Type::Kind::ArrayType
+                         ? createEntryBlockAlloca(LLVMtype, node.getIdentifierMangled())
+                         : builder->CreateAlloca(LLVMtype, nullptr, node.getIdentifierMangled());
   // Generate code to calculate the initializer value
-  llvm::Value *value = generate(node->getValue());
+  llvm::Value *value = generate(*node.getValue());
   // Store the initializer value in the variable
-  builder->CreateStore(value, allocaInst);
+  storeValue(value, allocaInst, node.getType());
   // The reference to the variable is stored to access it later
-  localVariables[node->getIdentifierMangled()] = allocaInst;
+  localVariables[node.getIdentifierMangled()] = allocaInst;
 }
 
-void CodeGeneration::generate(const std::shared_ptr<VarDecl> &node) {
-  if (node->isGlobal()) {
-    switch (node->getType()->getTypeKind()) {
+void CodeGeneration::generate(const VarDecl &node) {
+  if (node.isGlobal()) {
+    switch (node.getType()->getTypeKind()) {
     case Type::Kind::BasicType:
+    case Type::Kind::ArrayType:
+    case Type::Kind::VectorType:
+    case Type::Kind::TaskType:
+    case Type::Kind::AtomicType:
+    case Type::Kind::StructType:
       generateGlobalVariableDecl(node);
       break;
     case Type::Kind::Signature:
       reportError("Internal Error - Global Variable Declaration can not be of type function",
-                  node->getVarKeywordToken().line, node->getVarKeywordToken().column);
+                  node.getVarKeywordToken().line, node.getVarKeywordToken().column);
       break;
     default:
       reportError("Internal Error - Global Variable Declaration of type not known",
-                  node->getVarKeywordToken().line, node->getVarKeywordToken().column);
+                  node.getVarKeywordToken().line, node.getVarKeywordToken().column);
     }
   } else {
-    switch (node->getType()->getTypeKind()) {
+    switch (node.getType()->getTypeKind()) {
     case Type::Kind::BasicType:
+    case Type::Kind::ArrayType:
+    case Type::Kind::VectorType:
+    case Type::Kind::TaskType:
+    case Type::Kind::AtomicType:
+    case Type::Kind::StructType:
       generateLocalVariableDecl(node);
       break;
     case Type::Kind::Signature:
       reportError("Internal Error - Local Variable Declaration can not be of type function",
-                  node->getVarKeywordToken().line, node->getVarKeywordToken().column);
+                  node.getVarKeywordToken().line, node.getVarKeywordToken().column);
       break;
     default:
       reportError("Internal Error - Local Variable Declaration of type not known",
-                  node->getVarKeywordToken().line, node->getVarKeywordToken().column);
+                  node.getVarKeywordToken().line, node.getVarKeywordToken().column);
     }
   }
 }
 
-void CodeGeneration::generateFunctionForInitialization(const std::shared_ptr<ConstDecl> &node,
+void CodeGeneration::generateFunctionForInitialization(const ConstDecl &node,
                                                        llvm::Value *GV) {
   // Define function signature
   // 1. No parameters
@@ -127,12 +156,12 @@ void CodeGeneration::generateFunctionForInitialization(const std::shared_ptr<Con
   builder->SetInsertPoint(entryBB);
 
   // 5. Code Generation for the initialization
-  auto initializer = generate(node->getValue());
-  builder->CreateStore(initializer, GV);
+  auto initializer = generate(*node.getValue());
+  storeValue(initializer, GV, node.getType());
   builder->CreateRetVoid();
 
   // 6. Add initializer function
-  llvm::appendToGlobalCtors(*module, function, 0, nullptr);
+  addInitializationFunction(function);
 
   // NOTE that could be implemented to improve similarity to Clang: to make CodeGen more similar to
   // clang, every constructor function is called by a general constructor function
@@ -140,83 +169,110 @@ void CodeGeneration::generateFunctionForInitialization(const std::shared_ptr<Con
   // llvm.global_ctors
 }
 
-void CodeGeneration::generateGlobalConstantDecl(const std::shared_ptr<ConstDecl> &node) {
-  llvm::Type *LLVMtype = getLLVMType(node->getType());
-  llvm::Constant *constant0 = getLLVMInit(node->getType());
-  auto *GV = new llvm::GlobalVariable(*module, LLVMtype, true, llvm::GlobalValue::PrivateLinkage,
-                                      constant0, node->getIdentifierMangled(), nullptr);
+void CodeGeneration::generateGlobalConstantDecl(const ConstDecl &node) {
+  llvm::Type *LLVMtype = getLLVMType(node.getType());
+  llvm::Constant *constant0 = getLLVMInit(node.getType());
+  auto *GV = new llvm::GlobalVariable(*module, LLVMtype, false, getGlobalLinkage(), constant0,
+                                      node.getIdentifierMangled(), nullptr);
 
-  globalVariables[node->getIdentifierMangled()] = GV;
+  globalVariables[node.getIdentifierMangled()] = GV;
   // Because global variable declarations might have a complex initialization (not just a simple
   // constant expression):
   // var int a = 5 + 4 * 3 - 2;
   // var int b = 10 + a;
-  // and constant folding is not implemented, it is necessary to build a function that initializes
-  // every global variable
-  generateFunctionForInitialization(node, GV);
+  // it is necessary to build a function that initializes every global variable. If constant
+  // folding has reduced the initialization to a literal, the global variable is initialized
+  // statically instead. Only then it is an LLVM constant, since the initialization function stores
+  // into it (i.e. a call to a const function that is left to runtime)
+  if (node.getValue()->getExprKind() == Expr::Kind::LITERALEXPR) {
+    GV->setInitializer(llvm::cast<llvm::Constant>(generate(*node.getValue())));
+    GV->setConstant(true);
+  } else if (llvm::Constant *constantArray = generateConstantArray(*node.getValue())) {
+    GV->setInitializer(constantArray);
+    GV->setConstant(true);
+  } else {
+    generateFunctionForInitialization(node, GV);
+  }
 }
 
-void CodeGeneration::generateLocalConstantDecl(const std::shared_ptr<ConstDecl> &node) {
-  llvm::Type *LLVMtype = getLLVMType(node->getType());
+void CodeGeneration::generateLocalConstantDecl(const ConstDecl &node) {
+  llvm::Type *LLVMtype = getLLVMType(node.getType());
   // TODO: (improvement) put alloca in the entry block of the function (see:
   //       http://lists.llvm.org/pipermail/llvm-dev/2017-January/108730.html)
-  auto *allocaInst = builder->CreateAlloca(LLVMtype, nullptr, node->getIdentifierMangled());
+  // Arrays are already allocated in the entry block, so the stack does not grow in loops
+  auto *allocaInst = node.getType()->getTypeKind() == Type::Kind::ArrayType
+                         ? createEntryBlockAlloca(LLVMtype, node.getIdentifierMangled())
+                         : builder->CreateAlloca(LLVMtype, nullptr, node.getIdentifierMangled());
   // Generate code to calculate the initializer value
-  llvm::Value *value = generate(node->getValue());
+  llvm::Value *value = generate(*node.getValue());
   // Store the initializer value in the variable
-  builder->CreateStore(value, allocaInst);
+  storeValue(value, allocaInst, node.getType());
   // The reference to the variable is stored to access it later
-  localVariables[node->getIdentifierMangled()] = allocaInst;
+  localVariables[node.getIdentifierMangled()] = allocaInst;
 }
 
-void CodeGeneration::generate(const std::shared_ptr<ConstDecl> &node) {
-  if (node->isGlobal()) {
-    switch (node->getType()->getTypeKind()) {
+void CodeGeneration::generate(const ConstDecl &node) {
+  if (node.isGlobal()) {
+    switch (node.getType()->getTypeKind()) {
     case Type::Kind::BasicType:
+    case Type::Kind::ArrayType:
+    case Type::Kind::VectorType:
+    case Type::Kind::StructType:
       generateGlobalConstantDecl(node);
       break;
     case Type::Kind::Signature:
       reportError("Internal Error - Global Variable Declaration can not be of type function",
-                  node->getConstKeywordToken().line, node->getConstKeywordToken().column);
+                  node.getConstKeywordToken().line, node.getConstKeywordToken().column);
       break;
     default:
       reportError("Internal Error - Global Variable Declaration of type not known",
-                  node->getConstKeywordToken().line, node->getConstKeywordToken().column);
+                  node.getConstKeywordToken().line, node.getConstKeywordToken().column);
     }
   } else {
-    switch (node->getType()->getTypeKind()) {
+    switch (node.getType()->getTypeKind()) {
     case Type::Kind::BasicType:
+    case Type::Kind::ArrayType:
+    case Type::Kind::VectorType:
+    case Type::Kind::StructType:
       generateLocalConstantDecl(node);
       break;
     case Type::Kind::Signature:
       reportError("Internal Error - Local Variable Declaration can not be of type function",
-                  node->getConstKeywordToken().line, node->getConstKeywordToken().column);
+                  node.getConstKeywordToken().line, node.getConstKeywordToken().column);
       break;
     default:
       reportError("Internal Error - Local Variable Declaration of type not known",
-                  node->getConstKeywordToken().line, node->getConstKeywordToken().column);
+                  node.getConstKeywordToken().line, node.getConstKeywordToken().column);
     }
   }
 }
 
-void CodeGeneration::generate(const std::shared_ptr<ParamDecl> &node) {
+void CodeGeneration::generate(const ParamDecl &node) {
   // Code Generation for parameters is handled in the method for FuncDecl
 }
 
-void CodeGeneration::generate(const std::shared_ptr<FuncDecl> &node) {
+void CodeGeneration::generate(const StructDecl &node) {
+  // The LLVM type of a struct is created the first time it is used (see getLLVMStructType)
+}
+
+void CodeGeneration::declareFunction(const FuncDecl &node) {
   // 1. Define function signature
   // 1.1 Parameters
   std::vector<llvm::Type *> params;
 
-  for (const auto &param : node->getParams()) {
-    params.push_back(getLLVMType(param->getType()));
+  for (const auto &param : node.getParams()) {
+    // fixed-size arrays are passed by reference and copied by the function, and atomics are passed
+    // by reference and shared with the caller
+    llvm::Type *paramType = getLLVMType(param->getType());
+    params.push_back(isPassedByReference(param->getType()) ? paramType->getPointerTo()
+                                                           : paramType);
   }
 
   // 1.2 Return Type and Parameters
   llvm::Type *returnType;
-  if(node->isHasReturnType()) {
+  if(node.isHasReturnType()) {
     returnType =
-        getLLVMType(std::dynamic_pointer_cast<FunctionType>(node->getType())->getResult());
+        getLLVMType(std::dynamic_pointer_cast<FunctionType>(node.getType())->getResult());
   } else {
     returnType = llvm::Type::getVoidTy(context);
   }
@@ -224,15 +280,66 @@ void CodeGeneration::generate(const std::shared_ptr<FuncDecl> &node) {
   llvm::FunctionType *functionType = llvm::FunctionType::get(returnType, params, false);
 
   // 2. Create Function
-  llvm::Function *function = llvm::Function::Create(functionType, llvm::Function::ExternalLinkage,
-                                                    node->getIdentifierMangled(), module.get());
+  // A program is a closed world except for main, so the rest of functions are internal: LLVM can
+  // change their signature and remove them when they are not called, and they use the fast calling
+  // convention. When generating incrementally, the functions are called from other modules
+  bool exported = incremental || node.getIdentifierMangled() == "main";
+  llvm::Function *function = llvm::Function::Create(
+      functionType, exported ? llvm::Function::ExternalLinkage : llvm::Function::InternalLinkage,
+      node.getIdentifierMangled(), module.get());
+  if (!exported) {
+    function->setCallingConv(llvm::CallingConv::Fast);
+  }
+
+  // Effects of a call to the function, inferred on the AST (see FunctionEffects). Stoc has no
+  // exceptions, so no function unwinds
+  function->setDoesNotThrow();
+  if (!node.isRecursive()) {
+    function->setDoesNotRecurse();
+  }
+  if (node.getMemory() == FuncDecl::Memory::NONE) {
+    function->setDoesNotAccessMemory();
+  } else if (node.getMemory() == FuncDecl::Memory::READ) {
+    function->setOnlyReadsMemory();
+  }
+  // Only a function known to return makes progress: a loop without side effects that never
+  // finishes is valid in Stoc, while it would be undefined behaviour in a mustprogress function
+  if (node.isWillReturn()) {
+    function->addFnAttr(llvm::Attribute::WillReturn);
+    function->addFnAttr(llvm::Attribute::MustProgress);
+  }
+  // A call that always returns without accessing memory can be executed speculatively (i.e. hoisted
+  // out of a branch). With nsw, an overflow is a poison value that could reach a branch in the body
+  if (node.isPure() && node.isWillReturn() && node.getMemory() == FuncDecl::Memory::NONE &&
+      overflow == OverflowMode::WRAP) {
+    function->addFnAttr(llvm::Attribute::Speculatable);
+  }
 
   // 2.1 Set name for all parameters
   int idx = 0;
   for (auto &arg : function->args()) {
-    arg.setName(node->getParams()[idx]->getIdentifierMangled());
+    arg.setName(node.getParams()[idx]->getIdentifierMangled());
+    // the array passed by reference is only read to be copied
+    if (isFixedSizeArray(node.getParams()[idx]->getType())) {
+      function->addParamAttr(idx, llvm::Attribute::ReadOnly);
+      function->addParamAttr(idx, llvm::Attribute::NoCapture);
+    }
     idx++;
   }
+}
+
+void CodeGeneration::generate(const FuncDecl &node) {
+  // 1-2. The function has been declared (with its signature) before generating any body
+  llvm::Function *function = module->getFunction(node.getIdentifierMangled());
+
+  // A function with the attribute fastmath allows every fast-math optimization (reassociation,
+  // contraction into fma, no NaNs...) in its body, whatever the options of the compiler
+  llvm::IRBuilderBase::FastMathFlagGuard fastMathGuard(*builder);
+  if (node.hasAttribute("fastmath")) {
+    llvm::FastMathFlags fast;
+    fast.setFast();
+    builder->setFastMathFlags(fast);
+  }
 
   // 3. Create basic blocks for the function
   llvm::BasicBlock *entryBB = llvm::BasicBlock::Create(context, "entry", function);
@@ -243,7 +350,7 @@ void CodeGeneration::generate(const std::shared_ptr<FuncDecl> &node) {
   // unconditionally to the "exit" block where it will load the special variable and return it.
   // Like this, there will be only one return statement in the LLVM IR even if there are multiple
   // return statements in source code
-  if (node->isHasReturnType()) {
+  if (node.isHasReturnType()) {
     this->exitBB = llvm::BasicBlock::Create(context, "exit");
   }
 
@@ -251,32 +358,40 @@ void CodeGeneration::generate(const std::shared_ptr<FuncDecl> &node) {
   // To do this, we generate local variables (alloca instructions) and store the value of the
   // parameters in the local variables
   localVariables.clear();
-  for (const auto &param : node->getParams()) {
-    localVariables[param->getIdentifierMangled()] =
-        builder->CreateAlloca(getLLVMType(param->getType()), nullptr);
+  for (const auto &param : node.getParams()) {
+    if (!isAtomic(param->getType())) {
+      localVariables[param->getIdentifierMangled()] =
+          builder->CreateAlloca(getLLVMType(param->getType()), nullptr);
+    }
   }
 
   // If there is return type, there will be return statement so we create the special variable
-  if (node->isHasReturnType()) {
+  if (node.isHasReturnType()) {
     localVariables["return"] = builder->CreateAlloca(
-        getLLVMType(std::dynamic_pointer_cast<FunctionType>(node->getType())->getResult()), nullptr,
+        getLLVMType(std::dynamic_pointer_cast<FunctionType>(node.getType())->getResult()), nullptr,
         "return");
   }
 
   for (auto &arg : function->args()) {
-    builder->CreateStore(&arg, localVariables[arg.getName()]);
+    // an atomic is used through the address received
+    if (isAtomic(node.getParams()[arg.getArgNo()]->getType())) {
+      localVariables[arg.getName().str()] = &arg;
+    } else {
+      storeValue(&arg, localVariables[arg.getName().str()],
+                 node.getParams()[arg.getArgNo()]->getType());
+    }
   }
 
   // 5. Code generation for body of the function
   // If we want to check if variable already exists:
   // https://prereleases.llvm.org/6.0.0/rc2/docs/tutorial/LangImpl03.html in 3.4 Function Code
   // Generation
-  generate(node->getBody());
+  generate(*node.getBody());
 
   // 6. Return
   // Every basic block in llvm must be terminated with a control flow instruction like return or
   // branch. For this reason, if the function has void return type we have to state it explicitly
-  if (!node->isHasReturnType()) {
+  if (!node.isHasReturnType()) {
     builder->CreateRetVoid();
   } else {
     // If function has return type, it is generated:
@@ -289,11 +404,17 @@ void CodeGeneration::generate(const std::shared_ptr<FuncDecl> &node) {
       builder->CreateBr(this->exitBB);
     }
 
+    // If every return statement returns a call in tail position, nothing jumps to the exit block
+    if (llvm::pred_empty(this->exitBB)) {
+      delete this->exitBB;
+      return;
+    }
+
     // Code generation for the return statement of the exit block
     function->getBasicBlockList().push_back(this->exitBB);
     builder->SetInsertPoint(this->exitBB);
     auto load = builder->CreateLoad(
-        getLLVMType(std::dynamic_pointer_cast<FunctionType>(node->getType())->getResult()),
+        getLLVMType(std::dynamic_pointer_cast<FunctionType>(node.getType())->getResult()),
         localVariables["return"]);
     builder->CreateRet(load);
   }
@@ -8,57 +8,170 @@
 //===------------------------------------------------------------------------------------------===//
 #include "stoc/CodeGeneration/CodeGeneration.h"
 
-llvm::Value *CodeGeneration::generate(const std::shared_ptr<Expr> &node) {
-  switch (node->getExprKind()) {
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
+
+llvm::Value *CodeGeneration::generate(const Expr &node) {
+  switch (node.getExprKind()) {
   case Expr::Kind::BINARYEXPR:
-    return generate(std::static_pointer_cast<BinaryExpr>(node));
+    return generate(static_cast<const BinaryExpr &>(node));
   case Expr::Kind::UNARYEXPR:
-    return generate(std::static_pointer_cast<UnaryExpr>(node));
+    return generate(static_cast<const UnaryExpr &>(node));
   case Expr::Kind::LITERALEXPR:
-    return generate(std::static_pointer_cast<LiteralExpr>(node));
+    return generate(static_cast<const LiteralExpr &>(node));
   case Expr::Kind::IDENTEXPR:
-    return generate(std::static_pointer_cast<IdentExpr>(node));
+    return generate(static_cast<const IdentExpr &>(node));
   case Expr::Kind::CALLEXPR:
-    return generate(std::static_pointer_cast<CallExpr>(node));
+    return generate(static_cast<const CallExpr &>(node));
+  case Expr::Kind::INDEXEXPR:
+    return generate(static_cast<const IndexExpr &>(node));
+  case Expr::Kind::FIELDEXPR:
+    return generate(static_cast<const FieldExpr &>(node));
+  case Expr::Kind::ARRAYLITERALEXPR:
+    return generate(static_cast<const ArrayLiteralExpr &>(node));
+  case Expr::Kind::CONVERSIONEXPR:
+    return generate(static_cast<const ConversionExpr &>(node));
+  case Expr::Kind::SPAWNEXPR:
+    return generate(static_cast<const SpawnExpr &>(node));
+  case Expr::Kind::AWAITEXPR:
+    return generate(static_cast<const AwaitExpr &>(node));
   default:
     reportError("Internal Error - Expression kind not allowed");
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generateBinaryExprInt(const std::shared_ptr<BinaryExpr> &node,
+llvm::Value *CodeGeneration::generateBinaryExprInt(const BinaryExpr &node,
                                                    llvm::Value *lhs, llvm::Value *rhs) {
-  switch (node->getOp().tokenType) {
+  // The division and the order operators depend on the signedness of the operands
+  bool isUnsigned = getScalarType(node.getLhs()->getType())->isUnsigned();
+  switch (node.getOp().tokenType) {
   case ADD:
-    return builder->CreateAdd(lhs, rhs, "addtemp");
+    return generateIntArithmetic(llvm::Instruction::Add, lhs, rhs, isUnsigned, node.getOp(),
+                                 "addtemp");
   case SUB:
-    return builder->CreateSub(lhs, rhs, "subtemp");
+    return generateIntArithmetic(llvm::Instruction::Sub, lhs, rhs, isUnsigned, node.getOp(),
+                                 "subtemp");
   case STAR:
-    return builder->CreateMul(lhs, rhs, "multemp");
+    return generateIntArithmetic(llvm::Instruction::Mul, lhs, rhs, isUnsigned, node.getOp(),
+                                 "multemp");
   case SLASH:
-    return builder->CreateSDiv(lhs, rhs, "divtemp");
+    return isUnsigned ? builder->CreateUDiv(lhs, rhs, "divtemp")
+                      : builder->CreateSDiv(lhs, rhs, "divtemp");
+  case PERCENT:
+    return isUnsigned ? builder->CreateURem(lhs, rhs, "remtemp")
+                      : builder->CreateSRem(lhs, rhs, "remtemp");
+  case AMPERSAND:
+    return builder->CreateAnd(lhs, rhs, "andtemp");
+  case PIPE:
+    return builder->CreateOr(lhs, rhs, "ortemp");
+  case CARET:
+    return builder->CreateXor(lhs, rhs, "xortemp");
+  case SHIFT_LEFT:
+  case SHIFT_RIGHT: {
+    // The shift amount is taken modulo the width of the operand (a shift by the width or more
+    // would be poison in LLVM IR). The mask is free on x86, where the shifts already do it
+    unsigned width = lhs->getType()->getScalarSizeInBits();
+    llvm::Value *amount =
+        builder->CreateAnd(rhs, llvm::ConstantInt::get(rhs->getType(), width - 1), "shiftamount");
+    if (node.getOp().tokenType == SHIFT_LEFT) {
+      return builder->CreateShl(lhs, amount, "shltemp");
+    }
+    // logical shift for unsigned integers and arithmetic shift (the sign is kept) for signed ones
+    return isUnsigned ? builder->CreateLShr(lhs, amount, "shrtemp")
+                      : builder->CreateAShr(lhs, amount, "shrtemp");
+  }
   case EQUAL:
     return builder->CreateICmpEQ(lhs, rhs, "equaltmp");
   case NOT_EQUAL:
     return builder->CreateICmpNE(lhs, rhs, "nequaltmp");
   case LESS:
-    return builder->CreateICmpSLT(lhs, rhs, "lesstmp");
+    return isUnsigned ? builder->CreateICmpULT(lhs, rhs, "lesstmp")
+                      : builder->CreateICmpSLT(lhs, rhs, "lesstmp");
   case GREATER:
-    return builder->CreateICmpSGT(lhs, rhs, "greatertmp");
+    return isUnsigned ? builder->CreateICmpUGT(lhs, rhs, "greatertmp")
+                      : builder->CreateICmpSGT(lhs, rhs, "greatertmp");
   case LESS_EQUAL:
-    return builder->CreateICmpSLE(lhs, rhs, "lesseqtmp");
+    return isUnsigned ? builder->CreateICmpULE(lhs, rhs, "lesseqtmp")
+                      : builder->CreateICmpSLE(lhs, rhs, "lesseqtmp");
   case GREATER_EQUAL:
-    return builder->CreateICmpSGE(lhs, rhs, "greatereqtmp");
+    return isUnsigned ? builder->CreateICmpUGE(lhs, rhs, "greatereqtmp")
+                      : builder->CreateICmpSGE(lhs, rhs, "greatereqtmp");
   default:
-    reportError("Internal Error - Binary Operator not allowed for int type", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator not allowed for int type", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generateBinaryExprFloat(const std::shared_ptr<BinaryExpr> &node,
+llvm::Value *CodeGeneration::generateIntArithmetic(llvm::Instruction::BinaryOps opcode,
+                                                   llvm::Value *lhs, llvm::Value *rhs,
+                                                   bool isUnsigned, const Token &op,
+                                                   const std::string &name) {
+  switch (overflow) {
+  case OverflowMode::WRAP:
+    return builder->CreateBinOp(opcode, lhs, rhs, name);
+  case OverflowMode::NSW: {
+    // The operation is folded if both operands are constants, so it may not be an instruction
+    llvm::Value *result = builder->CreateBinOp(opcode, lhs, rhs, name);
+    if (auto instruction = llvm::dyn_cast<llvm::BinaryOperator>(result)) {
+      if (isUnsigned) {
+        instruction->setHasNoUnsignedWrap();
+      } else {
+        instruction->setHasNoSignedWrap();
+      }
+    }
+    return result;
+  }
+  case OverflowMode::TRAP:
+    break;
+  }
+
+  llvm::Intrinsic::ID id;
+  switch (opcode) {
+  case llvm::Instruction::Add:
+    id = isUnsigned ? llvm::Intrinsic::uadd_with_overflow : llvm::Intrinsic::sadd_with_overflow;
+    break;
+  case llvm::Instruction::Sub:
+    id = isUnsigned ? llvm::Intrinsic::usub_with_overflow : llvm::Intrinsic::ssub_with_overflow;
+    break;
+  default:
+    id = isUnsigned ? llvm::Intrinsic::umul_with_overflow : llvm::Intrinsic::smul_with_overflow;
+    break;
+  }
+  llvm::Function *intrinsic = llvm::Intrinsic::getDeclaration(module.get(), id, {lhs->getType()});
+  llvm::Value *pair = builder->CreateCall(intrinsic, {lhs, rhs});
+  llvm::Value *overflowed = builder->CreateExtractValue(pair, 1, "overflow");
+  if (lhs->getType()->isVectorTy()) {
+    // A vector overflows if any of its lanes does, and the lanes of a vector of i1 are the bits of
+    // an integer
+    unsigned lanes =
+        lhs->getType()->getPrimitiveSizeInBits() / lhs->getType()->getScalarSizeInBits();
+    llvm::Value *bits = builder->CreateBitCast(overflowed, builder->getIntNTy(lanes));
+    overflowed = builder->CreateICmpNE(bits, llvm::Constant::getNullValue(bits->getType()),
+                                       "overflow");
+  }
+
+  // Like the bounds checks, the path where the operation overflows is cold
+  llvm::Function *function = builder->GetInsertBlock()->getParent();
+  llvm::BasicBlock *noOverflowBB = llvm::BasicBlock::Create(context, "nooverflow", function);
+  llvm::BasicBlock *overflowBB = llvm::BasicBlock::Create(context, "overflow", function);
+  llvm::MDBuilder weights(context);
+  builder->CreateCondBr(overflowed, overflowBB, noOverflowBB,
+                        weights.createBranchWeights(1, 1 << 20));
+
+  builder->SetInsertPoint(overflowBB);
+  builder->CreateCall(getIntegerOverflowFunction(),
+                      {llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), op.line)});
+  builder->CreateUnreachable();
+
+  builder->SetInsertPoint(noOverflowBB);
+  return builder->CreateExtractValue(pair, 0, name);
+}
+
+llvm::Value *CodeGeneration::generateBinaryExprFloat(const BinaryExpr &node,
                                                      llvm::Value *lhs, llvm::Value *rhs) {
-  switch (node->getOp().tokenType) {
+  switch (node.getOp().tokenType) {
   case ADD:
     return builder->CreateFAdd(lhs, rhs, "addtemp");
   case SUB:
@@ -80,16 +193,16 @@ llvm::Value *CodeGeneration::generateBinaryExprFloat(const std::shared_ptr<Binar
   case GREATER_EQUAL:
     return builder->CreateFCmpOGE(lhs, rhs, "greatereqtmp");
   default:
-    reportError("Internal Error - Binary Operator not allowed for float type", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator not allowed for float type", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generateBinaryExprBool(const std::shared_ptr<BinaryExpr> &node,
+llvm::Value *CodeGeneration::generateBinaryExprBool(const BinaryExpr &node,
                                                     llvm::Value *lhs, llvm::Value *rhs) {
   // TODO: (improvement) see how to do it for shortcircuit logical operators
-  switch (node->getOp().tokenType) {
+  switch (node.getOp().tokenType) {
   case EQUAL:
     return builder->CreateICmpEQ(lhs, rhs, "cmpeqtmp");
   case NOT_EQUAL:
@@ -99,15 +212,15 @@ llvm::Value *CodeGeneration::generateBinaryExprBool(const std::shared_ptr<Binary
   case LOR:
     return builder->CreateOr(lhs, rhs, "ortemp");
   default:
-    reportError("Internal Error - Binary Operator not allowed for bool type", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator not allowed for bool type", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generateBinaryExprString(const std::shared_ptr<BinaryExpr> &node,
+llvm::Value *CodeGeneration::generateBinaryExprString(const BinaryExpr &node,
                                                       llvm::Value *lhs, llvm::Value *rhs) {
-  switch (node->getOp().tokenType) {
+  switch (node.getOp().tokenType) {
   case EQUAL: {
     std::vector<llvm::Value *> args{lhs, rhs};
     llvm::Function *callee = module->getFunction("strcmp");
@@ -122,25 +235,35 @@ llvm::Value *CodeGeneration::generateBinaryExprString(const std::shared_ptr<Bina
                                  llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), 0));
   }
   default:
-    reportError("Internal Error - Binary Operator not allowed for string type", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator not allowed for string type", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generate(const std::shared_ptr<BinaryExpr> &node) {
-  llvm::Value *lhs = CodeGeneration::generate(node->getLhs());
-  llvm::Value *rhs = CodeGeneration::generate(node->getRhs());
+llvm::Value *CodeGeneration::generate(const BinaryExpr &node) {
+  llvm::Value *lhs = CodeGeneration::generate(*node.getLhs());
+  llvm::Value *rhs = CodeGeneration::generate(*node.getRhs());
 
   // To decide the type, we use one of the child's type because that is the type of the operands
-  // The type of the node is the type after applying the binary operator
-  switch (node->getLhs()->getType()->getTypeKind()) {
-  case Type::Kind::BasicType: {
-    auto type = std::dynamic_pointer_cast<BasicType>(node->getLhs()->getType());
+  // The type of the node is the type after applying the binary operator. The operators on vectors
+  // are applied lane by lane with the same instructions as on the type of the lanes
+  switch (node.getLhs()->getType()->getTypeKind()) {
+  case Type::Kind::BasicType:
+  case Type::Kind::VectorType: {
+    auto type = getScalarType(node.getLhs()->getType());
     switch (type->getKind()) {
     case BasicType::Kind::INT:
+    case BasicType::Kind::INT8:
+    case BasicType::Kind::INT16:
+    case BasicType::Kind::INT32:
+    case BasicType::Kind::UINT8:
+    case BasicType::Kind::UINT16:
+    case BasicType::Kind::UINT32:
+    case BasicType::Kind::UINT64:
       return generateBinaryExprInt(node, lhs, rhs);
     case BasicType::Kind::FLOAT:
+    case BasicType::Kind::FLOAT32:
       return generateBinaryExprFloat(node, lhs, rhs);
     case BasicType::Kind::BOOL:
       return generateBinaryExprBool(node, lhs, rhs);
@@ -148,114 +271,147 @@ llvm::Value *CodeGeneration::generate(const std::shared_ptr<BinaryExpr> &node) {
       return generateBinaryExprString(node, lhs, rhs);
     default:
       reportError("Internal Error - Binary Operator not allowed for type not known",
-                  node->getOp().line, node->getOp().column);
+                  node.getOp().line, node.getOp().column);
       return nullptr;
     }
   }
   case Type::Kind::Signature:
-    reportError("Internal Error - Binary Operator can not be of type function", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator can not be of type function", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   default:
-    reportError("Internal Error - Binary Operator of type not known", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator of type not known", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generateUnaryExprInt(const std::shared_ptr<UnaryExpr> &node,
+llvm::Value *CodeGeneration::generateUnaryExprInt(const UnaryExpr &node,
                                                   llvm::Value *rhs) {
-  switch (node->getOp().tokenType) {
+  switch (node.getOp().tokenType) {
   case ADD:
     return rhs; // if +Expr is the same as Expr
   case SUB:
-    return builder->CreateNeg(rhs);
+    // The negation of an unsigned integer is always modular, as in C
+    if (getScalarType(node.getRhs()->getType())->isUnsigned()) {
+      return builder->CreateNeg(rhs);
+    }
+    return generateIntArithmetic(llvm::Instruction::Sub,
+                                 llvm::Constant::getNullValue(rhs->getType()), rhs, false,
+                                 node.getOp(), "negtemp");
+  case TILDE:
+    return builder->CreateNot(rhs, "nottemp");
   default:
-    reportError("Internal Error - Unary Operator not allowed for int type", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Unary Operator not allowed for int type", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generateUnaryExprFloat(const std::shared_ptr<UnaryExpr> &node,
+llvm::Value *CodeGeneration::generateUnaryExprFloat(const UnaryExpr &node,
                                                     llvm::Value *rhs) {
-  switch (node->getOp().tokenType) {
+  switch (node.getOp().tokenType) {
   case ADD:
     return rhs; // if +Expr is the same as Expr
   case SUB:
     return builder->CreateFNeg(rhs);
   default:
-    reportError("Internal Error - Unary Operator not allowed for float type", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Unary Operator not allowed for float type", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generateUnaryExprBool(const std::shared_ptr<UnaryExpr> &node,
+llvm::Value *CodeGeneration::generateUnaryExprBool(const UnaryExpr &node,
                                                    llvm::Value *rhs) {
-  switch (node->getOp().tokenType) {
+  switch (node.getOp().tokenType) {
   case NOT:
     return builder->CreateNot(rhs, "nottemp");
   default:
-    reportError("Internal Error - Unary Operator not allowed for bool type", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Unary Operator not allowed for bool type", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generate(const std::shared_ptr<UnaryExpr> &node) {
-  llvm::Value *rhs = CodeGeneration::generate(node->getRhs());
+llvm::Value *CodeGeneration::generate(const UnaryExpr &node) {
+  llvm::Value *rhs = CodeGeneration::generate(*node.getRhs());
 
   // To decide the type, we use the child's type because that is the type of the operand
   // The type of the node is the type after applying the unary operator
-  switch (node->getRhs()->getType()->getTypeKind()) {
-  case Type::Kind::BasicType: {
-    auto type = std::dynamic_pointer_cast<BasicType>(node->getType());
+  switch (node.getRhs()->getType()->getTypeKind()) {
+  case Type::Kind::BasicType:
+  case Type::Kind::VectorType: {
+    auto type = getScalarType(node.getType());
     switch (type->getKind()) {
     case BasicType::Kind::INT:
+    case BasicType::Kind::INT8:
+    case BasicType::Kind::INT16:
+    case BasicType::Kind::INT32:
+    case BasicType::Kind::UINT8:
+    case BasicType::Kind::UINT16:
+    case BasicType::Kind::UINT32:
+    case BasicType::Kind::UINT64:
       return generateUnaryExprInt(node, rhs);
     case BasicType::Kind::FLOAT:
+    case BasicType::Kind::FLOAT32:
       return generateUnaryExprFloat(node, rhs);
     case BasicType::Kind::BOOL:
       return generateUnaryExprBool(node, rhs);
     case BasicType::Kind::STRING:
       reportError("Internal Error - Binary Operator not allowed for string type",
-                  node->getOp().line, node->getOp().column);
+                  node.getOp().line, node.getOp().column);
+      [[fallthrough]];
     default:
       reportError("Internal Error - Binar Operator not allowed for type not known",
-                  node->getOp().line, node->getOp().column);
+                  node.getOp().line, node.getOp().column);
       return nullptr;
     }
   }
   case Type::Kind::Signature:
-    reportError("Internal Error - Binary Operator can not be of type function", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator can not be of type function", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   default:
-    reportError("Internal Error - Binary Operator of type not known", node->getOp().line,
-                node->getOp().column);
+    reportError("Internal Error - Binary Operator of type not known", node.getOp().line,
+                node.getOp().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generate(const std::shared_ptr<LiteralExpr> &node) {
-  if (node->getType()->getTypeKind() == Type::Kind::BasicType) {
-    auto type = std::dynamic_pointer_cast<BasicType>(node->getType());
+llvm::Value *CodeGeneration::generate(const LiteralExpr &node) {
+  if (node.getType()->getTypeKind() == Type::Kind::BasicType) {
+    auto type = std::dynamic_pointer_cast<BasicType>(node.getType());
     switch (type->getKind()) {
     case BasicType::Kind::INT: {
-      int v = std::stoi(node->getToken().value);
+      int64_t v = std::stoll(node.getToken().value);
       return llvm::ConstantInt::get(builder->getInt64Ty(), v);
     }
     case BasicType::Kind::FLOAT: {
-      double v = std::stod(node->getToken().value);
+      double v = std::stod(node.getToken().value);
       return llvm::ConstantFP::get(builder->getDoubleTy(), v);
     }
+    case BasicType::Kind::INT8:
+    case BasicType::Kind::INT16:
+    case BasicType::Kind::INT32:
+    case BasicType::Kind::UINT8:
+    case BasicType::Kind::UINT16:
+    case BasicType::Kind::UINT32:
+    case BasicType::Kind::UINT64: {
+      // the value has been checked to fit in the type (the sign is in the UnaryExpr)
+      uint64_t v = std::stoull(node.getToken().value);
+      return llvm::ConstantInt::get(getLLVMType(type), v);
+    }
+    case BasicType::Kind::FLOAT32: {
+      double v = std::stod(node.getToken().value);
+      return llvm::ConstantFP::get(builder->getFloatTy(), v);
+    }
     case BasicType::Kind::BOOL: {
-      int v = node->getToken().value == "true" ? 1 : 0;
+      int v = node.getToken().value == "true" ? 1 : 0;
       return llvm::ConstantInt::get(builder->getInt1Ty(), v);
     }
     case BasicType::Kind::STRING: {
-      std::string v = node->getToken().value;
+      std::string v = node.getToken().value;
       auto ty = llvm::ArrayType::get(llvm::Type::getInt8Ty(context),
                                      v.size() + 1); // because null terminator
       auto index0 = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0);
@@ -263,35 +419,43 @@ llvm::Value *CodeGeneration::generate(const std::shared_ptr<LiteralExpr> &node)
       auto *var =
           new llvm::GlobalVariable(*module, ty, true, llvm::GlobalValue::InternalLinkage, constant);
 
-      return builder->CreateGEP(var, {index0, index0});
+      return builder->CreateGEP(ty, var, {index0, index0});
     }
     default:
-      reportError("Internal Error - Literal Expr with basic type not known", node->getToken().line,
-                  node->getToken().column);
+      reportError("Internal Error - Literal Expr with basic type not known", node.getToken().line,
+                  node.getToken().column);
       return nullptr;
     }
   } else {
-    reportError("Internal Error - Literal Expr can not be of type function", node->getToken().line,
-                node->getToken().column);
+    reportError("Internal Error - Literal Expr can not be of type function", node.getToken().line,
+                node.getToken().column);
     return nullptr;
   }
 }
 
-llvm::Value *CodeGeneration::generate(const std::shared_ptr<IdentExpr> &node) {
-  auto localvariable = localVariables.find(node->getName());
+llvm::Value *CodeGeneration::generate(const IdentExpr &node) {
+  auto localvariable = localVariables.find(node.getName());
+  // The value of a fixed-size array (see storeValue) and of an atomic is its address
+  bool isAddress = isFixedSizeArray(node.getType()) || isAtomic(node.getType());
   if (localvariable != localVariables.end()) {
+    if (isAddress) {
+      return localvariable->second;
+    }
     llvm::Value *v =
-        builder->CreateLoad(getLLVMType(node->getType()), localvariable->second, "tempload");
+        builder->CreateLoad(getLLVMType(node.getType()), localvariable->second, "tempload");
     return v;
   } else {
     // Variable is not local, check if it is global
-    auto globalvariable = globalVariables.find(node->getName());
+    auto globalvariable = globalVariables.find(node.getName());
     if (globalvariable != globalVariables.end()) {
-      llvm::Value *v = builder->CreateLoad(getLLVMType(node->getType()), globalvariable->second);
+      if (isAddress) {
+        return globalvariable->second;
+      }
+      llvm::Value *v = builder->CreateLoad(getLLVMType(node.getType()), globalvariable->second);
       return v;
     } else {
-      reportError("Internal Error - Variable referenced does not exist", node->getIdent().line,
-                  node->getIdent().column);
+      reportError("Internal Error - Variable referenced does not exist", node.getIdent().line,
+                  node.getIdent().column);
       return nullptr;
     }
   }
@@ -303,39 +467,75 @@ bool CodeGeneration::isBuiltinFunction(std::string functionName) {
 }
 
 llvm::Value *CodeGeneration::generateCallBuiltinFunction(std::string functionName,
-                                                         const std::shared_ptr<CallExpr> &node) {
+                                                         const CallExpr &node) {
   if (functionName == "print") {
     return generateCallPrint(node);
   } else if (functionName == "println") {
     return generateCallPrintln(node);
+  } else if (functionName == "len") {
+    return generateCallLen(node);
+  } else if (functionName == "append") {
+    return generateCallAppend(node);
+  } else if (functionName == "popcount" || functionName == "clz" || functionName == "ctz" ||
+             functionName == "bswap" || functionName == "rotl") {
+    return generateCallBitBuiltin(functionName, node);
+  } else if (isAtomic(node.getArgs()[0]->getType())) {
+    return generateCallAtomicBuiltin(functionName, node);
   } else {
-    reportError("Internal Error - Builtin function " + functionName + " does not exist");
-    return nullptr;
+    return generateCallVectorBuiltin(functionName, node);
+  }
+}
+
+llvm::Value *CodeGeneration::generatePrintfArgument(llvm::Value *value,
+                                                    const std::shared_ptr<BasicType> &type) {
+  // The arguments of a variadic function are promoted: the fixed-width integers are extended to
+  // 64 bits (printed with %ld or %lu) and float32 to double
+  if (type->isInteger() && type->getBitWidth() < 64) {
+    return builder->CreateIntCast(value, builder->getInt64Ty(), !type->isUnsigned());
+  } else if (type->getKind() == BasicType::Kind::FLOAT32) {
+    return builder->CreateFPExt(value, builder->getDoubleTy());
   }
+  return value;
 }
 
-llvm::Value *CodeGeneration::generateCallPrint(const std::shared_ptr<CallExpr> &node) {
+llvm::Value *CodeGeneration::generateCallPrint(const CallExpr &node) {
   std::vector<llvm::Value *> args;
 
   // Choose which format are we going to print it depending on the type of the argument
-  if (node->getArgs().size() > 1) {
+  if (node.getArgs().size() > 1) {
     reportError("Internal Error - Must call print with 1 argument");
     return nullptr;
   }
 
-  if (node->getArgs()[0]->getType()->getTypeKind() == Type::Kind::BasicType) {
-    auto type = std::dynamic_pointer_cast<BasicType>(node->getArgs()[0]->getType());
+  if (node.getArgs()[0]->getType()->getTypeKind() == Type::Kind::VectorType) {
+    return generateCallPrintVector(node, false);
+  } else if (node.getArgs()[0]->getType()->getTypeKind() == Type::Kind::BasicType) {
+    auto type = std::dynamic_pointer_cast<BasicType>(node.getArgs()[0]->getType());
     // size = 3 -> %_\00
     auto tyOfStringFormat = llvm::ArrayType::get(llvm::Type::getInt8Ty(context), 3);
-    llvm::Value *gvar;
+    llvm::GlobalVariable *gvar;
 
     switch (type->getKind()) {
-    case BasicType::Kind::INT: {
-      llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%d", true);
-      gvar = new llvm::GlobalVariable(*module, tyOfStringFormat, true,
-                                      llvm::GlobalValue::InternalLinkage, constant);
+    case BasicType::Kind::INT:
+    case BasicType::Kind::INT8:
+    case BasicType::Kind::INT16:
+    case BasicType::Kind::INT32: {
+      // int is 64 bits wide (the narrower types are extended, see generatePrintfArgument)
+      llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%ld", true);
+      gvar = new llvm::GlobalVariable(*module, llvm::ArrayType::get(builder->getInt8Ty(), 4),
+                                      true, llvm::GlobalValue::InternalLinkage, constant);
+      break;
+    }
+    case BasicType::Kind::UINT8:
+    case BasicType::Kind::UINT16:
+    case BasicType::Kind::UINT32:
+    case BasicType::Kind::UINT64: {
+      llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%lu", true);
+      gvar = new llvm::GlobalVariable(*module, llvm::ArrayType::get(builder->getInt8Ty(), 4),
+                                      true, llvm::GlobalValue::InternalLinkage, constant);
       break;
     }
+    case BasicType::Kind::FLOAT32:
     case BasicType::Kind::FLOAT: {
       llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%f", true);
       gvar = new llvm::GlobalVariable(*module, tyOfStringFormat, true,
@@ -360,10 +560,10 @@ llvm::Value *CodeGeneration::generateCallPrint(const std::shared_ptr<CallExpr> &
     }
 
     auto index0 = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0);
-    auto *gepInst = builder->CreateGEP(gvar, {index0, index0});
+    auto *gepInst = builder->CreateGEP(gvar->getValueType(), gvar, {index0, index0});
     args.push_back(gepInst);
 
-    if (node->getArgs().size() > 1) {
+    if (node.getArgs().size() > 1) {
       reportError("Internal Error - Can not call print with more than 1 argument");
       return nullptr;
     }
@@ -378,24 +578,24 @@ llvm::Value *CodeGeneration::generateCallPrint(const std::shared_ptr<CallExpr> &
       llvm::Constant *constantFalse = llvm::ConstantDataArray::getString(context, "false", true);
       auto *varTrue = new llvm::GlobalVariable(*module, tyOfStringTrue, true,
                                                llvm::GlobalValue::InternalLinkage, constantTrue);
-      auto *gepTrue = builder->CreateGEP(varTrue, {index0, index0});
+      auto *gepTrue = builder->CreateGEP(tyOfStringTrue, varTrue, {index0, index0});
       auto *varFalse = new llvm::GlobalVariable(*module, tyOfStringFalse, true,
                                                 llvm::GlobalValue::InternalLinkage, constantFalse);
-      auto *gepFalse = builder->CreateGEP(varFalse, {index0, index0});
-      auto arg = generate(node->getArgs()[0]);
+      auto *gepFalse = builder->CreateGEP(tyOfStringFalse, varFalse, {index0, index0});
+      auto arg = generate(*node.getArgs()[0]);
       // Now we have to compare it to check if it is false or true
       auto *cmpInst =
           builder->CreateICmpNE(arg, llvm::ConstantInt::get(llvm::Type::getInt1Ty(context), 0));
       auto *selectInst = builder->CreateSelect(cmpInst, gepTrue, gepFalse);
       args.push_back(selectInst);
     } else {
-      args.push_back(generate(node->getArgs()[0]));
+      args.push_back(generatePrintfArgument(generate(*node.getArgs()[0]), type));
     }
 
     // The function that we are really calling is "printf" from the std library of c
     llvm::Function *callee = module->getFunction("printf");
     return builder->CreateCall(callee, args, "calltmp");
-  } else if (node->getType()->getTypeKind() == Type::Kind::Signature) {
+  } else if (node.getType()->getTypeKind() == Type::Kind::Signature) {
     reportError("Internal Error - Signature type for builtin function print");
     return nullptr;
   } else {
@@ -404,28 +604,44 @@ llvm::Value *CodeGeneration::generateCallPrint(const std::shared_ptr<CallExpr> &
   }
 }
 
-llvm::Value *CodeGeneration::generateCallPrintln(const std::shared_ptr<CallExpr> &node) {
+llvm::Value *CodeGeneration::generateCallPrintln(const CallExpr &node) {
   std::vector<llvm::Value *> args;
 
   // Choose which format are we going to print it depending on the type of the argument
-  if (node->getArgs().size() > 1) {
+  if (node.getArgs().size() > 1) {
     reportError("Internal Error - Must call print with 1 argument");
     return nullptr;
   }
 
-  if (node->getArgs()[0]->getType()->getTypeKind() == Type::Kind::BasicType) {
-    auto type = std::dynamic_pointer_cast<BasicType>(node->getArgs()[0]->getType());
+  if (node.getArgs()[0]->getType()->getTypeKind() == Type::Kind::VectorType) {
+    return generateCallPrintVector(node, true);
+  } else if (node.getArgs()[0]->getType()->getTypeKind() == Type::Kind::BasicType) {
+    auto type = std::dynamic_pointer_cast<BasicType>(node.getArgs()[0]->getType());
     // size = 4 -> %_\n\00
     auto tyOfStringFormat = llvm::ArrayType::get(llvm::Type::getInt8Ty(context), 4);
-    llvm::Value *gvar;
+    llvm::GlobalVariable *gvar;
 
     switch (type->getKind()) {
-    case BasicType::Kind::INT: {
-      llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%d\n", true);
-      gvar = new llvm::GlobalVariable(*module, tyOfStringFormat, true,
-                                      llvm::GlobalValue::InternalLinkage, constant);
+    case BasicType::Kind::INT:
+    case BasicType::Kind::INT8:
+    case BasicType::Kind::INT16:
+    case BasicType::Kind::INT32: {
+      // int is 64 bits wide (the narrower types are extended, see generatePrintfArgument)
+      llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%ld\n", true);
+      gvar = new llvm::GlobalVariable(*module, llvm::ArrayType::get(builder->getInt8Ty(), 5),
+                                      true, llvm::GlobalValue::InternalLinkage, constant);
+      break;
+    }
+    case BasicType::Kind::UINT8:
+    case BasicType::Kind::UINT16:
+    case BasicType::Kind::UINT32:
+    case BasicType::Kind::UINT64: {
+      llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%lu\n", true);
+      gvar = new llvm::GlobalVariable(*module, llvm::ArrayType::get(builder->getInt8Ty(), 5),
+                                      true, llvm::GlobalValue::InternalLinkage, constant);
       break;
     }
+    case BasicType::Kind::FLOAT32:
     case BasicType::Kind::FLOAT: {
       llvm::Constant *constant = llvm::ConstantDataArray::getString(context, "%f\n", true);
       gvar = new llvm::GlobalVariable(*module, tyOfStringFormat, true,
@@ -450,10 +666,10 @@ llvm::Value *CodeGeneration::generateCallPrintln(const std::shared_ptr<CallExpr>
     }
 
     auto index0 = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0);
-    auto *gepInst = builder->CreateGEP(gvar, {index0, index0});
+    auto *gepInst = builder->CreateGEP(gvar->getValueType(), gvar, {index0, index0});
     args.push_back(gepInst);
 
-    if (node->getArgs().size() > 1) {
+    if (node.getArgs().size() > 1) {
       reportError("Internal Error - Can not call print with more than 1 argument");
       return nullptr;
     }
@@ -468,24 +684,24 @@ llvm::Value *CodeGeneration::generateCallPrintln(const std::shared_ptr<CallExpr>
       llvm::Constant *constantFalse = llvm::ConstantDataArray::getString(context, "false", true);
       auto *varTrue = new llvm::GlobalVariable(*module, tyOfStringTrue, true,
                                                llvm::GlobalValue::InternalLinkage, constantTrue);
-      auto *gepTrue = builder->CreateGEP(varTrue, {index0, index0});
+      auto *gepTrue = builder->CreateGEP(tyOfStringTrue, varTrue, {index0, index0});
       auto *varFalse = new llvm::GlobalVariable(*module, tyOfStringFalse, true,
                                                 llvm::GlobalValue::InternalLinkage, constantFalse);
-      auto *gepFalse = builder->CreateGEP(varFalse, {index0, index0});
-      auto arg = generate(node->getArgs()[0]);
+      auto *gepFalse = builder->CreateGEP(tyOfStringFalse, varFalse, {index0, index0});
+      auto arg = generate(*node.getArgs()[0]);
       // Now we have to compare it to check if it is false or true
       auto *cmpInst =
           builder->CreateICmpNE(arg, llvm::ConstantInt::get(llvm::Type::getInt1Ty(context), 0));
       auto *selectInst = builder->CreateSelect(cmpInst, gepTrue, gepFalse);
       args.push_back(selectInst);
     } else {
-      args.push_back(generate(node->getArgs()[0]));
+      args.push_back(generatePrintfArgument(generate(*node.getArgs()[0]), type));
     }
 
     // The function that we are really calling is "printf" from the std library of c
     llvm::Function *callee = module->getFunction("printf");
     return builder->CreateCall(callee, args, "calltmp");
-  } else if (node->getType()->getTypeKind() == Type::Kind::Signature) {
+  } else if (node.getType()->getTypeKind() == Type::Kind::Signature) {
     reportError("Internal Error - Signature type for builtin function print");
     return nullptr;
   } else {
@@ -494,8 +710,252 @@ llvm::Value *CodeGeneration::generateCallPrintln(const std::shared_ptr<CallExpr>
   }
 }
 
-llvm::Value *CodeGeneration::generate(const std::shared_ptr<CallExpr> &node) {
-  std::string functionName = getIdentifier(node->getFunc());
+llvm::Value *CodeGeneration::generateCallPrintVector(const CallExpr &node, bool newline) {
+  auto vectorType = std::dynamic_pointer_cast<VectorType>(node.getArgs()[0]->getType());
+  auto element = vectorType->getElement();
+  llvm::Value *vector = generate(*node.getArgs()[0]);
+
+  // The format of every lane is the format of its type in print (see generateCallPrint)
+  std::string laneFormat = "%ld";
+  if (element->isBoolean()) {
+    laneFormat = "%s";
+  } else if (element->isFloat()) {
+    laneFormat = "%f";
+  } else if (element->isUnsigned()) {
+    laneFormat = "%lu";
+  }
+
+  llvm::Value *stringTrue = nullptr;
+  llvm::Value *stringFalse = nullptr;
+  if (element->isBoolean()) {
+    stringTrue = builder->CreateGlobalStringPtr("true");
+    stringFalse = builder->CreateGlobalStringPtr("false");
+  }
+
+  std::string format = "<";
+  std::vector<llvm::Value *> args{nullptr}; // the format goes first
+  for (std::int64_t lane = 0; lane < vectorType->getLanes(); lane++) {
+    format += (lane == 0 ? "" : ", ") + laneFormat;
+    llvm::Value *value = builder->CreateExtractElement(vector, lane, "lane");
+    if (element->isBoolean()) {
+      args.push_back(builder->CreateSelect(value, stringTrue, stringFalse));
+    } else {
+      args.push_back(generatePrintfArgument(value, element));
+    }
+  }
+  format += newline ? ">\n" : ">";
+  args[0] = builder->CreateGlobalStringPtr(format);
+
+  // The function that we are really calling is "printf" from the std library of c
+  return builder->CreateCall(module->getFunction("printf"), args, "calltmp");
+}
+
+llvm::Value *CodeGeneration::generateCallVectorBuiltin(const std::string &functionName,
+                                                       const CallExpr &node) {
+  const auto &args = node.getArgs();
+  auto vectorType = std::dynamic_pointer_cast<VectorType>(args[0]->getType());
+  std::int64_t lanes = vectorType->getLanes();
+
+  if (functionName == "select") {
+    return builder->CreateSelect(generate(*args[0]), generate(*args[1]), generate(*args[2]),
+                                 "selecttmp");
+  }
+
+  if (functionName == "shuffle") {
+    // The indices are integer literals (checked in Semantic Analysis), written for every lane, once
+    // for all of them or not written (all 0)
+    const auto &indices = static_cast<const ArrayLiteralExpr &>(*args[2]).getElements();
+    std::vector<llvm::Constant *> mask;
+    for (std::int64_t lane = 0; lane < lanes; lane++) {
+      int index = 0;
+      if (!indices.empty()) {
+        const auto &literal =
+            static_cast<const LiteralExpr &>(*indices[indices.size() == 1 ? 0 : lane]);
+        index = std::stoi(literal.getToken().value);
+      }
+      mask.push_back(builder->getInt32(index));
+    }
+    return builder->CreateShuffleVector(generate(*args[0]), generate(*args[1]),
+                                        llvm::ConstantVector::get(mask), "shuffletmp");
+  }
+
+  llvm::Value *vector = generate(*args[0]);
+  if (functionName == "any" || functionName == "all") {
+    // The lanes of a vector of bool are the bits of an integer
+    llvm::Value *bits = builder->CreateBitCast(vector, builder->getIntNTy(lanes));
+    if (functionName == "any") {
+      return builder->CreateICmpNE(bits, llvm::Constant::getNullValue(bits->getType()), "anytmp");
+    }
+    return builder->CreateICmpEQ(bits, llvm::Constant::getAllOnesValue(bits->getType()),
+                                 "alltmp");
+  }
+
+  auto element = vectorType->getElement();
+  bool isFloat = element->isFloat();
+  bool isUnsigned = element->isUnsigned();
+  if (functionName == "reduce_add") {
+    return generateReduction(vector, lanes, [&](llvm::Value *lhs, llvm::Value *rhs) {
+      return isFloat ? builder->CreateFAdd(lhs, rhs, "addtemp")
+                     : builder->CreateAdd(lhs, rhs, "addtemp");
+    });
+  } else if (functionName == "reduce_min") {
+    return generateReduction(vector, lanes, [&](llvm::Value *lhs, llvm::Value *rhs) {
+      llvm::Value *less = isFloat      ? builder->CreateFCmpOLT(lhs, rhs, "lesstmp")
+                          : isUnsigned ? builder->CreateICmpULT(lhs, rhs, "lesstmp")
+                                       : builder->CreateICmpSLT(lhs, rhs, "lesstmp");
+      return builder->CreateSelect(less, lhs, rhs, "mintmp");
+    });
+  } else if (functionName == "reduce_max") {
+    return generateReduction(vector, lanes, [&](llvm::Value *lhs, llvm::Value *rhs) {
+      llvm::Value *greater = isFloat      ? builder->CreateFCmpOGT(lhs, rhs, "greatertmp")
+                             : isUnsigned ? builder->CreateICmpUGT(lhs, rhs, "greatertmp")
+                                          : builder->CreateICmpSGT(lhs, rhs, "greatertmp");
+      return builder->CreateSelect(greater, lhs, rhs, "maxtmp");
+    });
+  }
+
+  reportError("Internal Error - Builtin function " + functionName + " does not exist");
+  return nullptr;
+}
+
+llvm::Value *CodeGeneration::generateCallBitBuiltin(const std::string &functionName,
+                                                    const CallExpr &node) {
+  llvm::Value *value = generate(*node.getArgs()[0]);
+  llvm::Type *type = value->getType();
+
+  if (functionName == "popcount") {
+    llvm::Function *ctpop = llvm::Intrinsic::getDeclaration(module.get(), llvm::Intrinsic::ctpop,
+                                                            {type});
+    return builder->CreateCall(ctpop, {value}, "popcounttmp");
+  } else if (functionName == "clz" || functionName == "ctz") {
+    // the second argument (false) makes the result defined for 0: the width of the integer
+    llvm::Function *count = llvm::Intrinsic::getDeclaration(
+        module.get(), functionName == "clz" ? llvm::Intrinsic::ctlz : llvm::Intrinsic::cttz,
+        {type});
+    return builder->CreateCall(count, {value, builder->getFalse()}, functionName + "tmp");
+  } else if (functionName == "bswap") {
+    llvm::Function *bswap = llvm::Intrinsic::getDeclaration(module.get(), llvm::Intrinsic::bswap,
+                                                            {type});
+    return builder->CreateCall(bswap, {value}, "bswaptmp");
+  } else if (functionName == "rotl") {
+    // a funnel shift of a value with itself is a rotation (the amount is taken modulo the width)
+    llvm::Function *fshl = llvm::Intrinsic::getDeclaration(module.get(), llvm::Intrinsic::fshl,
+                                                           {type});
+    return builder->CreateCall(fshl, {value, value, generate(*node.getArgs()[1])}, "rotltmp");
+  }
+
+  reportError("Internal Error - Builtin function " + functionName + " does not exist");
+  return nullptr;
+}
+
+llvm::Value *CodeGeneration::generateCallAtomicBuiltin(const std::string &functionName,
+                                                      const CallExpr &node) {
+  const auto &args = node.getArgs();
+  auto element = std::dynamic_pointer_cast<AtomicType>(args[0]->getType())->getElement();
+  llvm::Type *type = getLLVMType(args[0]->getType());
+  llvm::Value *address = generate(*args[0]);
+
+  // The memory ordering is the last argument, if it is a string (see checkAtomicOrdering)
+  std::size_t operands = args.size();
+  llvm::AtomicOrdering ordering = llvm::AtomicOrdering::SequentiallyConsistent;
+  if (args.back()->getType()->getTypeKind() == Type::Kind::BasicType &&
+      std::dynamic_pointer_cast<BasicType>(args.back()->getType())->isString()) {
+    const std::string &name = static_cast<const LiteralExpr &>(*args.back()).getToken().value;
+    if (name == "relaxed") {
+      ordering = llvm::AtomicOrdering::Monotonic;
+    } else if (name == "acquire") {
+      ordering = llvm::AtomicOrdering::Acquire;
+    } else if (name == "release") {
+      ordering = llvm::AtomicOrdering::Release;
+    } else if (name == "acq_rel") {
+      ordering = llvm::AtomicOrdering::AcquireRelease;
+    }
+    operands--;
+  }
+
+  // The operands are stored in the type of the atomic (a bool in a byte, see getLLVMType)
+  std::vector<llvm::Value *> values;
+  for (std::size_t i = 1; i < operands; i++) {
+    values.push_back(builder->CreateZExt(generate(*args[i]), type));
+  }
+  auto toValue = [&](llvm::Value *value) {
+    return element->isBoolean() ? builder->CreateTrunc(value, builder->getInt1Ty()) : value;
+  };
+  llvm::Align alignment(module->getDataLayout().getTypeStoreSize(type));
+
+  if (functionName == "load") {
+    llvm::LoadInst *load = builder->CreateAlignedLoad(type, address, alignment, "atomicload");
+    load->setAtomic(ordering);
+    return toValue(load);
+  } else if (functionName == "store") {
+    llvm::StoreInst *store = builder->CreateAlignedStore(values[0], address, alignment);
+    store->setAtomic(ordering);
+    return store;
+  } else if (functionName == "compare_exchange") {
+    // the ordering when the value is not the expected one can not release (there is no store)
+    llvm::AtomicOrdering failure = ordering;
+    if (ordering == llvm::AtomicOrdering::Release) {
+      failure = llvm::AtomicOrdering::Monotonic;
+    } else if (ordering == llvm::AtomicOrdering::AcquireRelease) {
+      failure = llvm::AtomicOrdering::Acquire;
+    }
+    llvm::Value *expected = values[0];
+    llvm::Value *desired = values[1];
+    llvm::Value *result =
+        builder->CreateAtomicCmpXchg(address, expected, desired, alignment, ordering, failure);
+    return builder->CreateExtractValue(result, 1, "exchanged");
+  }
+
+  llvm::AtomicRMWInst::BinOp op = llvm::AtomicRMWInst::Xchg;
+  if (functionName == "fetch_add") {
+    op = llvm::AtomicRMWInst::Add;
+  } else if (functionName == "fetch_sub") {
+    op = llvm::AtomicRMWInst::Sub;
+  } else if (functionName == "fetch_and") {
+    op = llvm::AtomicRMWInst::And;
+  } else if (functionName == "fetch_or") {
+    op = llvm::AtomicRMWInst::Or;
+  } else if (functionName == "fetch_xor") {
+    op = llvm::AtomicRMWInst::Xor;
+  } else if (functionName == "fetch_min") {
+    op = element->isUnsigned() ? llvm::AtomicRMWInst::UMin : llvm::AtomicRMWInst::Min;
+  } else if (functionName == "fetch_max") {
+    op = element->isUnsigned() ? llvm::AtomicRMWInst::UMax : llvm::AtomicRMWInst::Max;
+  }
+  llvm::Value *value = values[0];
+  return toValue(builder->CreateAtomicRMW(op, address, value, alignment, ordering));
+}
+
+llvm::Value *CodeGeneration::generateReduction(
+    llvm::Value *vector, std::int64_t lanes,
+    const std::function<llvm::Value *(llvm::Value *, llvm::Value *)> &combine) {
+  for (std::int64_t width = lanes / 2; width >= 1; width /= 2) {
+    // The lanes [width, 2 * width) are moved to [0, width) and combined with them. The lanes from
+    // width on are not used anymore
+    std::vector<llvm::Constant *> mask;
+    for (std::int64_t lane = 0; lane < lanes; lane++) {
+      if (lane < width) {
+        mask.push_back(builder->getInt32(lane + width));
+      } else {
+        mask.push_back(llvm::UndefValue::get(builder->getInt32Ty()));
+      }
+    }
+    llvm::Value *upper =
+        builder->CreateShuffleVector(vector, llvm::UndefValue::get(vector->getType()),
+                                     llvm::ConstantVector::get(mask), "upperhalf");
+    vector = combine(vector, upper);
+  }
+  return builder->CreateExtractElement(vector, static_cast<uint64_t>(0), "reducetmp");
+}
+
+llvm::Value *CodeGeneration::generate(const CallExpr &node) {
+  const auto &func = static_cast<const IdentExpr &>(*node.getFunc());
+  if (func.getDeclOfIdentifier() != nullptr &&
+      func.getDeclOfIdentifier()->getDeclKind() == Decl::Kind::STRUCTDECL) {
+    return generateStructLiteral(node);
+  }
+
+  std::string functionName = getIdentifier(*node.getFunc());
 
   if (isBuiltinFunction(functionName)) {
     return generateCallBuiltinFunction(functionName, node);
@@ -508,10 +968,370 @@ llvm::Value *CodeGeneration::generate(const std::shared_ptr<CallExpr> &node) {
     }
 
     std::vector<llvm::Value *> args;
-    for (const auto &arg : node->getArgs()) {
-      args.push_back(generate(arg));
+    for (const auto &arg : node.getArgs()) {
+      args.push_back(generate(*arg));
+    }
+
+    // the calling convention of the call must be the one of the function (see declareFunction)
+    llvm::CallInst *call = builder->CreateCall(callee, args);
+    call->setCallingConv(callee->getCallingConv());
+    // a call in tail position is returned right after it (see generate(ReturnStmt))
+    if (node.getTailCall() == CallExpr::TailCall::TAIL) {
+      call->setTailCallKind(llvm::CallInst::TCK_Tail);
+    } else if (node.getTailCall() == CallExpr::TailCall::MUST_TAIL) {
+      call->setTailCallKind(llvm::CallInst::TCK_MustTail);
     }
+    return call;
+  }
+}
+llvm::Value *CodeGeneration::generateStructLiteral(const CallExpr &node) {
+  // With no values every field is 0, otherwise there is a value for every field (checked in
+  // Semantic Analysis)
+  if (node.getArgs().empty()) {
+    return getLLVMInit(node.getType());
+  }
+  llvm::Value *value = llvm::UndefValue::get(getLLVMType(node.getType()));
+  for (std::size_t idx = 0; idx < node.getArgs().size(); idx++) {
+    value = builder->CreateInsertValue(value, generate(*node.getArgs()[idx]), idx, "structliteral");
+  }
+  return value;
+}
+
+llvm::Value *CodeGeneration::generateCallLen(const CallExpr &node) {
+  llvm::Value *array = generate(*node.getArgs()[0]);
+  return builder->CreateExtractValue(array, 1, "len");
+}
+
+llvm::Value *CodeGeneration::generateCallAppend(const CallExpr &node) {
+  llvm::Function *function = builder->GetInsertBlock()->getParent();
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getArgs()[0]->getType());
+  llvm::Type *elementType = getLLVMType(arrayType->getElement());
+  auto i64 = llvm::Type::getInt64Ty(context);
+
+  llvm::Value *array = generate(*node.getArgs()[0]);
+  llvm::Value *element = generate(*node.getArgs()[1]);
+  llvm::Value *data = builder->CreateExtractValue(array, 0, "data");
+  llvm::Value *length = builder->CreateExtractValue(array, 1, "len");
+  llvm::Value *capacity = builder->CreateExtractValue(array, 2, "cap");
+
+  // If the array is full, the capacity is doubled (with a minimum of 4 elements). The elements are
+  // copied to a new buffer because the old one is shared with the copies of the array (i.e. an
+  // array assigned to another variable), which keep using it
+  llvm::BasicBlock *currentBB = builder->GetInsertBlock();
+  llvm::BasicBlock *growBB = llvm::BasicBlock::Create(context, "growappend", function);
+  llvm::BasicBlock *appendBB = llvm::BasicBlock::Create(context, "append", function);
+  llvm::Value *isFull = builder->CreateICmpEQ(length, capacity, "isfull");
+  builder->CreateCondBr(isFull, growBB, appendBB);
+
+  builder->SetInsertPoint(growBB);
+  llvm::Value *doubled = builder->CreateMul(capacity, llvm::ConstantInt::get(i64, 2));
+  llvm::Value *newCapacity =
+      builder->CreateSelect(builder->CreateICmpULT(doubled, llvm::ConstantInt::get(i64, 4)),
+                            llvm::ConstantInt::get(i64, 4), doubled, "newcap");
+  uint64_t elementSize = module->getDataLayout().getTypeAllocSize(elementType);
+  llvm::Value *newSize = builder->CreateMul(newCapacity, llvm::ConstantInt::get(i64, elementSize));
+  llvm::Value *newRawData =
+      builder->CreateCall(module->getFunction("malloc"), {newSize}, "newdata");
+  llvm::Value *oldSize = builder->CreateMul(length, llvm::ConstantInt::get(i64, elementSize));
+  llvm::Align alignment = module->getDataLayout().getABITypeAlign(elementType);
+  builder->CreateMemCpy(newRawData, alignment, data, alignment, oldSize);
+  llvm::Value *newData = builder->CreateBitCast(newRawData, elementType->getPointerTo());
+  builder->CreateBr(appendBB);
+
+  builder->SetInsertPoint(appendBB);
+  llvm::PHINode *phiData = builder->CreatePHI(elementType->getPointerTo(), 2, "data");
+  phiData->addIncoming(data, currentBB);
+  phiData->addIncoming(newData, growBB);
+  llvm::PHINode *phiCapacity = builder->CreatePHI(i64, 2, "cap");
+  phiCapacity->addIncoming(capacity, currentBB);
+  phiCapacity->addIncoming(newCapacity, growBB);
+
+  builder->CreateStore(element, builder->CreateInBoundsGEP(elementType, phiData, length));
+  llvm::Value *result = llvm::UndefValue::get(getLLVMType(arrayType));
+  result = builder->CreateInsertValue(result, phiData, 0);
+  result = builder->CreateInsertValue(
+      result, builder->CreateAdd(length, llvm::ConstantInt::get(i64, 1)), 1);
+  return builder->CreateInsertValue(result, phiCapacity, 2);
+}
+
+llvm::Value *CodeGeneration::generateAddress(const Expr &node) {
+  if (node.getExprKind() == Expr::Kind::INDEXEXPR) {
+    return generateElementAddress(static_cast<const IndexExpr &>(node));
+  } else if (node.getExprKind() == Expr::Kind::FIELDEXPR) {
+    const auto &fieldExpr = static_cast<const FieldExpr &>(node);
+    const auto &operand = *fieldExpr.getOperand();
+    // The field of an element of a struct of arrays is in the array of the field
+    if (operand.getExprKind() == Expr::Kind::INDEXEXPR &&
+        isStructOfArrays(static_cast<const IndexExpr &>(operand).getArray()->getType())) {
+      const auto &indexExpr = static_cast<const IndexExpr &>(operand);
+      return generateFieldAddresses(indexExpr)[fieldExpr.getFieldIndex()];
+    }
+    return builder->CreateStructGEP(getLLVMType(operand.getType()), generateAddress(operand),
+                                    fieldExpr.getFieldIndex(), "fieldaddr");
+  }
 
-    return builder->CreateCall(callee, args);
+  std::string name = getIdentifier(node);
+  auto localVariable = localVariables.find(name);
+  if (localVariable != localVariables.end()) {
+    return localVariable->second;
   }
-}
\ No newline at end of file
+  auto globalVariable = globalVariables.find(name);
+  if (globalVariable != globalVariables.end()) {
+    return globalVariable->second;
+  }
+  reportError("Internal Error - Variable referenced does not exist");
+  return nullptr;
+}
+
+llvm::Value *CodeGeneration::generateIndex(const IndexExpr &node, llvm::Value *&array) {
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getArray()->getType());
+  auto i64 = llvm::Type::getInt64Ty(context);
+
+  array = generate(*node.getArray());
+  llvm::Value *index = generate(*node.getIndex());
+
+  // A fixed-size array is an address and its length is known, a dynamic array is a value with
+  // the address of the elements and the length
+  llvm::Value *length;
+  if (arrayType->isDynamic()) {
+    length = builder->CreateExtractValue(array, 1, "len");
+  } else {
+    length = llvm::ConstantInt::get(i64, arrayType->getSize());
+  }
+
+  // Bounds check: 0 <= index < length (unsigned comparison). The out of range path is cold
+  if (node.isBoundsCheck()) {
+    llvm::Function *function = builder->GetInsertBlock()->getParent();
+    llvm::BasicBlock *inRangeBB = llvm::BasicBlock::Create(context, "inrange", function);
+    llvm::BasicBlock *outOfRangeBB = llvm::BasicBlock::Create(context, "outofrange", function);
+    llvm::Value *inRange = builder->CreateICmpULT(index, length, "inrange");
+    llvm::MDBuilder weights(context);
+    builder->CreateCondBr(inRange, inRangeBB, outOfRangeBB,
+                          weights.createBranchWeights(1 << 20, 1));
+
+    builder->SetInsertPoint(outOfRangeBB);
+    builder->CreateCall(getIndexOutOfRangeFunction(),
+                        {index, length, llvm::ConstantInt::get(i64, node.getLbrack().line)});
+    builder->CreateUnreachable();
+
+    builder->SetInsertPoint(inRangeBB);
+  }
+  return index;
+}
+
+llvm::Value *CodeGeneration::generateElementAddress(const IndexExpr &node) {
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getArray()->getType());
+  auto i64 = llvm::Type::getInt64Ty(context);
+
+  llvm::Value *array;
+  llvm::Value *index = generateIndex(node, array);
+  if (arrayType->isDynamic()) {
+    llvm::Value *data = builder->CreateExtractValue(array, 0, "data");
+    return builder->CreateInBoundsGEP(getLLVMType(arrayType->getElement()), data, index,
+                                      "elementaddr");
+  }
+  return builder->CreateInBoundsGEP(getLLVMType(arrayType), array,
+                                    {llvm::ConstantInt::get(i64, 0), index}, "elementaddr");
+}
+
+std::vector<llvm::Value *> CodeGeneration::generateFieldAddresses(const IndexExpr &node) {
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getArray()->getType());
+  auto structType = std::dynamic_pointer_cast<StructType>(arrayType->getElement());
+  llvm::Type *LLVMtype = getLLVMType(arrayType);
+  auto i32 = llvm::Type::getInt32Ty(context);
+
+  llvm::Value *array;
+  llvm::Value *index = generateIndex(node, array);
+  std::vector<llvm::Value *> addresses;
+  for (std::size_t field = 0; field < structType->getFields().size(); field++) {
+    addresses.push_back(builder->CreateInBoundsGEP(
+        LLVMtype, array,
+        {llvm::ConstantInt::get(i32, 0), llvm::ConstantInt::get(i32, field), index},
+        "fieldaddr"));
+  }
+  return addresses;
+}
+
+llvm::Value *CodeGeneration::generate(const IndexExpr &node) {
+  // The lane of a vector is an integer literal (checked in Semantic Analysis)
+  if (node.getArray()->getType()->getTypeKind() == Type::Kind::VectorType) {
+    const auto &lane = static_cast<const LiteralExpr &>(*node.getIndex()).getToken().value;
+    return builder->CreateExtractElement(generate(*node.getArray()), std::stoull(lane), "lane");
+  }
+
+  // An element of a struct of arrays is gathered from the arrays of its fields
+  if (isStructOfArrays(node.getArray()->getType())) {
+    auto structType = std::dynamic_pointer_cast<StructType>(node.getType());
+    std::vector<llvm::Value *> addresses = generateFieldAddresses(node);
+    llvm::Value *element = llvm::UndefValue::get(getLLVMType(structType));
+    for (std::size_t field = 0; field < addresses.size(); field++) {
+      llvm::Value *value = builder->CreateLoad(getLLVMType(structType->getFields()[field].type),
+                                               addresses[field], "field");
+      element = builder->CreateInsertValue(element, value, field, "element");
+    }
+    return element;
+  }
+
+  llvm::Value *address = generateElementAddress(node);
+  return builder->CreateLoad(getLLVMType(node.getType()), address, "element");
+}
+
+llvm::Value *CodeGeneration::generate(const FieldExpr &node) {
+  // The field of a variable (or of an element of an array) is loaded from its address, without
+  // loading the whole struct
+  if (node.getOperand()->getExprValueKind() != Expr::ValueKind::RVal) {
+    return builder->CreateLoad(getLLVMType(node.getType()), generateAddress(node), "field");
+  }
+  return builder->CreateExtractValue(generate(*node.getOperand()), node.getFieldIndex(), "field");
+}
+
+llvm::Value *CodeGeneration::generate(const ArrayLiteralExpr &node) {
+  // A vector literal is built in a register: with no values every lane is 0 and with one value it
+  // is copied to every lane
+  if (node.getType()->getTypeKind() == Type::Kind::VectorType) {
+    auto vectorType = std::dynamic_pointer_cast<VectorType>(node.getType());
+    const auto &elements = node.getElements();
+    if (elements.empty()) {
+      return getLLVMInit(vectorType);
+    } else if (elements.size() == 1) {
+      return builder->CreateVectorSplat(vectorType->getLanes(), generate(*elements[0]),
+                                        "splattmp");
+    }
+    llvm::Value *vector = llvm::UndefValue::get(getLLVMType(vectorType));
+    for (std::size_t idx = 0; idx < elements.size(); idx++) {
+      vector = builder->CreateInsertElement(vector, generate(*elements[idx]), idx, "vectorliteral");
+    }
+    return vector;
+  }
+
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getType());
+  llvm::Type *elementType = getLLVMType(arrayType->getElement());
+  auto i64 = llvm::Type::getInt64Ty(context);
+  const auto &elements = node.getElements();
+
+  if (!arrayType->isDynamic()) {
+    // The array is built in a temporary in the stack and its address is the value (see storeValue)
+    llvm::Type *LLVMtype = getLLVMType(arrayType);
+    llvm::AllocaInst *array = createEntryBlockAlloca(LLVMtype, "arrayliteral");
+    if (static_cast<int64_t>(elements.size()) < arrayType->getSize()) {
+      builder->CreateStore(getLLVMInit(arrayType), array);
+    }
+    auto i32 = llvm::Type::getInt32Ty(context);
+    for (std::size_t idx = 0; idx < elements.size(); idx++) {
+      llvm::Value *element = generate(*elements[idx]);
+      if (isStructOfArrays(arrayType)) {
+        // Every field of the element is stored in the array of the field
+        std::size_t fields = llvm::cast<llvm::StructType>(LLVMtype)->getNumElements();
+        for (std::size_t field = 0; field < fields; field++) {
+          builder->CreateStore(builder->CreateExtractValue(element, field),
+                               builder->CreateInBoundsGEP(LLVMtype, array,
+                                                          {llvm::ConstantInt::get(i32, 0),
+                                                           llvm::ConstantInt::get(i32, field),
+                                                           llvm::ConstantInt::get(i64, idx)}));
+        }
+        continue;
+      }
+      builder->CreateStore(element, builder->CreateInBoundsGEP(
+                                        LLVMtype, array, {llvm::ConstantInt::get(i64, 0),
+                                                          llvm::ConstantInt::get(i64, idx)}));
+    }
+    return array;
+  }
+
+  // The elements of a dynamic array are allocated in the heap
+  llvm::Value *data = llvm::ConstantPointerNull::get(elementType->getPointerTo());
+  if (!elements.empty()) {
+    uint64_t elementSize = module->getDataLayout().getTypeAllocSize(elementType);
+    llvm::Value *rawData =
+        builder->CreateCall(module->getFunction("malloc"),
+                            {llvm::ConstantInt::get(i64, elementSize * elements.size())}, "data");
+    data = builder->CreateBitCast(rawData, elementType->getPointerTo());
+    for (std::size_t idx = 0; idx < elements.size(); idx++) {
+      llvm::Value *element = generate(*elements[idx]);
+      builder->CreateStore(element, builder->CreateInBoundsGEP(elementType, data,
+                                                               llvm::ConstantInt::get(i64, idx)));
+    }
+  }
+
+  llvm::Value *array = llvm::UndefValue::get(getLLVMType(arrayType));
+  array = builder->CreateInsertValue(array, data, 0);
+  array = builder->CreateInsertValue(array, llvm::ConstantInt::get(i64, elements.size()), 1);
+  return builder->CreateInsertValue(array, llvm::ConstantInt::get(i64, elements.size()), 2);
+}
+
+llvm::Value *CodeGeneration::generate(const ConversionExpr &node) {
+  llvm::Value *value = generate(*node.getValue());
+  auto from = std::dynamic_pointer_cast<BasicType>(node.getValue()->getType());
+  auto to = std::dynamic_pointer_cast<BasicType>(node.getType());
+  llvm::Type *type = getLLVMType(to);
+
+  // Every conversion is a single instruction (or none if the types are represented the same way)
+  if (from->isInteger() && to->isInteger()) {
+    // trunc, sext or zext depending on the width and the signedness of the value
+    return builder->CreateIntCast(value, type, !from->isUnsigned(), "convtmp");
+  } else if (from->isInteger()) {
+    return from->isUnsigned() ? builder->CreateUIToFP(value, type, "convtmp")
+                              : builder->CreateSIToFP(value, type, "convtmp");
+  } else if (to->isInteger()) {
+    return to->isUnsigned() ? builder->CreateFPToUI(value, type, "convtmp")
+                            : builder->CreateFPToSI(value, type, "convtmp");
+  } else {
+    // fptrunc or fpext
+    return builder->CreateFPCast(value, type, "convtmp");
+  }
+}
+
+llvm::Value *CodeGeneration::generate(const SpawnExpr &node) {
+  declareTaskRuntimeFunctions();
+  const auto &call = static_cast<const CallExpr &>(*node.getCall());
+  llvm::Function *callee = module->getFunction(getIdentifier(*call.getFunc()));
+
+  if (callee == nullptr) {
+    reportError("Internal Error - Function name for spawn was not found");
+    return nullptr;
+  }
+
+  // The arguments are evaluated by the thread that spawns the task and stored in a box allocated
+  // in the heap, where the task stores its result. The box is the handle of the task
+  llvm::StructType *boxType = getTaskBoxType(callee);
+  auto i32 = llvm::Type::getInt32Ty(context);
+  uint64_t boxSize = module->getDataLayout().getTypeAllocSize(boxType);
+  llvm::Value *size = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), boxSize);
+  llvm::Value *handle = builder->CreateCall(module->getFunction("malloc"), {size}, "task");
+  llvm::Value *box = builder->CreateBitCast(handle, boxType->getPointerTo(), "box");
+  llvm::Value *zero = llvm::ConstantInt::get(i32, 0);
+  for (std::size_t i = 0; i < call.getArgs().size(); i++) {
+    llvm::Value *position = llvm::ConstantInt::get(i32, i + 2);
+    llvm::Value *address = builder->CreateGEP(boxType, box, {zero, position});
+    builder->CreateStore(generate(*call.getArgs()[i]), address);
+  }
+
+  builder->CreateCall(module->getFunction("stoc_spawn"), {getTaskFunction(callee), handle});
+  return handle;
+}
+
+llvm::Value *CodeGeneration::generate(const AwaitExpr &node) {
+  declareTaskRuntimeFunctions();
+  llvm::Value *handle = generate(*node.getTask());
+  builder->CreateCall(module->getFunction("stoc_await"), {handle});
+
+  // The result is the second field of the box, after the state (see getTaskBoxType)
+  llvm::Type *resultType = getLLVMType(node.getType());
+  llvm::StructType *boxType =
+      llvm::StructType::get(context, {llvm::Type::getInt64Ty(context), resultType});
+  llvm::Value *box = builder->CreateBitCast(handle, boxType->getPointerTo(), "box");
+  auto i32 = llvm::Type::getInt32Ty(context);
+  llvm::Value *zero = llvm::ConstantInt::get(i32, 0);
+  llvm::Value *one = llvm::ConstantInt::get(i32, 1);
+  llvm::Value *address = builder->CreateGEP(boxType, box, {zero, one});
+  llvm::Value *result = builder->CreateLoad(resultType, address, "result");
+
+  // The box is not used after the result is read, so a task is awaited once. The handle in a
+  // variable is cleared, so awaiting it again is a runtime error instead of a use after free
+  builder->CreateCall(module->getFunction("free"), {handle});
+  if (node.getTask()->getExprKind() == Expr::Kind::IDENTEXPR) {
+    builder->CreateStore(llvm::ConstantPointerNull::get(llvm::Type::getInt8PtrTy(context)),
+                         generateAddress(*node.getTask()));
+  }
+  return result;
+}
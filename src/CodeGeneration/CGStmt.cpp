@@ -8,52 +8,65 @@
 //===------------------------------------------------------------------------------------------===//
 #include "stoc/CodeGeneration/CodeGeneration.h"
 
-void CodeGeneration::generate(const std::shared_ptr<Stmt> &node) {
-  switch (node->getStmtKind()) {
+#include <algorithm>
+
+void CodeGeneration::generate(const Stmt &node) {
+  switch (node.getStmtKind()) {
   case Stmt::Kind::DECLARATIONSTMT:
-    return generate(std::static_pointer_cast<DeclarationStmt>(node));
+    return generate(static_cast<const DeclarationStmt &>(node));
   case Stmt::Kind::EXPRESSIONSTMT:
-    return generate(std::static_pointer_cast<ExpressionStmt>(node));
+    return generate(static_cast<const ExpressionStmt &>(node));
   case Stmt::Kind::BLOCKSTMT:
-    return generate(std::static_pointer_cast<BlockStmt>(node));
+    return generate(static_cast<const BlockStmt &>(node));
   case Stmt::Kind::IFSTMT:
-    return generate(std::static_pointer_cast<IfStmt>(node));
+    return generate(static_cast<const IfStmt &>(node));
   case Stmt::Kind::FORSTMT:
-    return generate(std::static_pointer_cast<ForStmt>(node));
+    return generate(static_cast<const ForStmt &>(node));
   case Stmt::Kind::WHILESTMT:
-    return generate(std::static_pointer_cast<WhileStmt>(node));
+    return generate(static_cast<const WhileStmt &>(node));
   case Stmt::Kind::ASSIGNMENTSTMT:
-    return generate(std::static_pointer_cast<AssignmentStmt>(node));
+    return generate(static_cast<const AssignmentStmt &>(node));
   case Stmt::Kind::RETURNSTMT:
-    return generate(std::static_pointer_cast<ReturnStmt>(node));
+    return generate(static_cast<const ReturnStmt &>(node));
+  case Stmt::Kind::BREAKSTMT:
+    return generate(static_cast<const BreakStmt &>(node));
+  case Stmt::Kind::CONTINUESTMT:
+    return generate(static_cast<const ContinueStmt &>(node));
   }
 }
 
-void CodeGeneration::generate(const std::shared_ptr<DeclarationStmt> &node) {
-  generate(node->getDecl());
+void CodeGeneration::generate(const DeclarationStmt &node) {
+  generate(*node.getDecl());
 }
 
-void CodeGeneration::generate(const std::shared_ptr<ExpressionStmt> &node) {
-  generate(node->getExpr());
+void CodeGeneration::generate(const ExpressionStmt &node) {
+  generate(*node.getExpr());
 }
 
-void CodeGeneration::generate(const std::shared_ptr<BlockStmt> &node) {
+void CodeGeneration::generate(const BlockStmt &node) {
   // IMPORTANT: the llvm notion of basic block where the stmts will be generated has to be defined
   //           before calling this method
 
-  for (const auto &stmt : node->getStmts()) {
-    generate(stmt);
+  for (const auto &stmt : node.getStmts()) {
+    generate(*stmt);
+
+    // After constant folding, a block may contain a nested block ending with a return statement
+    // followed by other statements. They are unreachable and no code is generated for them because
+    // the basic block has already been terminated
+    if (builder->GetInsertBlock()->getTerminator()) {
+      break;
+    }
   }
 };
 
-void CodeGeneration::generate(const std::shared_ptr<IfStmt> &node) {
+void CodeGeneration::generate(const IfStmt &node) {
   // Get current function where the code is being generated
   llvm::Function *function = builder->GetInsertBlock()->getParent();
 
   // Code Generation for the condition of the ifStmt
-  llvm::Value *condition = generate(node->getCondition());
+  llvm::Value *condition = generate(*node.getCondition());
 
-  if (node->isHasElse()) {
+  if (node.isHasElse()) {
     // Create Basic Blocks for the then and else cases
     llvm::BasicBlock *thenBB = llvm::BasicBlock::Create(context, "then");
     llvm::BasicBlock *elseBB = llvm::BasicBlock::Create(context, "else");
@@ -65,7 +78,7 @@ void CodeGeneration::generate(const std::shared_ptr<IfStmt> &node) {
     // Code generation for the then branch
     function->getBasicBlockList().push_back(thenBB);
     builder->SetInsertPoint(thenBB);
-    generate(node->getThenBranch());
+    generate(*node.getThenBranch());
 
     // If this BasicBlock has not been terminated (i.e with a return statement), an inconditional
     // branch to the continuation of the ifStmt is added
@@ -74,7 +87,7 @@ void CodeGeneration::generate(const std::shared_ptr<IfStmt> &node) {
     }
 
     // In addition to that block, we look at the current block we are inserting because maybe the
-    // node->getThenBranch() has generated other basic blocks
+    // node.getThenBranch() has generated other basic blocks
     if (!builder->GetInsertBlock()->getTerminator()) {
       builder->CreateBr(mergeBB);
     }
@@ -82,7 +95,7 @@ void CodeGeneration::generate(const std::shared_ptr<IfStmt> &node) {
     // Code generation for the else branch
     function->getBasicBlockList().push_back(elseBB);
     builder->SetInsertPoint(elseBB);
-    generate(node->getElseBranch());
+    generate(*node.getElseBranch());
 
     // If this BasicBlock has not been terminated (i.e with a return statement), an inconditional
     // branch to the continuation of the ifStmt is added
@@ -91,7 +104,7 @@ void CodeGeneration::generate(const std::shared_ptr<IfStmt> &node) {
     }
 
     // In addition to that block, we look at the current block we are inserting because maybe the
-    // node->getElseBranch() has generated other basic blocks
+    // node.getElseBranch() has generated other basic blocks
     if (!builder->GetInsertBlock()->getTerminator()) {
       builder->CreateBr(mergeBB);
     }
@@ -110,7 +123,7 @@ void CodeGeneration::generate(const std::shared_ptr<IfStmt> &node) {
     // Code generation for the then branch
     function->getBasicBlockList().push_back(thenBB);
     builder->SetInsertPoint(thenBB);
-    generate(node->getThenBranch());
+    generate(*node.getThenBranch());
 
     // If this BasicBlock has not been terminated (i.e with a return statement), an inconditional
     // branch to the continuation of the ifStmt is added
@@ -118,13 +131,23 @@ void CodeGeneration::generate(const std::shared_ptr<IfStmt> &node) {
       builder->CreateBr(mergeBB);
     }
 
+    // In addition to that block, we look at the current block we are inserting because maybe the
+    // node.getThenBranch() has generated other basic blocks
+    if (!builder->GetInsertBlock()->getTerminator()) {
+      builder->CreateBr(mergeBB);
+    }
+
     // Code generation for the merge basic block
     function->getBasicBlockList().push_back(mergeBB);
     builder->SetInsertPoint(mergeBB);
   }
 }
 
-void CodeGeneration::generate(const std::shared_ptr<ForStmt> &node) {
+void CodeGeneration::generate(const ForStmt &node) {
+  if (node.isParallel()) {
+    return generateParallelFor(node);
+  }
+
   // Get current function where the code is being generated
   llvm::Function *function = builder->GetInsertBlock()->getParent();
 
@@ -135,29 +158,41 @@ void CodeGeneration::generate(const std::shared_ptr<ForStmt> &node) {
   llvm::BasicBlock *continuationBB = llvm::BasicBlock::Create(context, "continuationfor");
 
   // Code Generation for the initialization
-  generate(node->getInit());
+  if (node.getInit() != nullptr) {
+    generate(*node.getInit());
+  }
 
   // Code Generation for the condition of the forstmt
   builder->CreateBr(conditionBB);
   function->getBasicBlockList().push_back(conditionBB);
   builder->SetInsertPoint(conditionBB);
-  llvm::Value *condition = generate(node->getCond());
-  builder->CreateCondBr(condition, bodyBB, continuationBB);
+  if (node.getCond() != nullptr) {
+    llvm::Value *condition = generate(*node.getCond());
+    builder->CreateCondBr(condition, bodyBB, continuationBB);
+  } else {
+    builder->CreateBr(bodyBB);
+  }
 
-  // Code Generation for the body of the forstmt
+  // Code Generation for the body of the forstmt. A break jumps to the continuation and a continue
+  // to the post statement
   function->getBasicBlockList().push_back(bodyBB);
   builder->SetInsertPoint(bodyBB);
-  generate(node->getBody());
-  // If this BasicBlock has not been terminated (i.e with a return statement), an inconditional
-  // branch to the continuation of the ifStmt is added
-  if(!bodyBB->getTerminator()) {
+  loopTargets.push_back({continuationBB, postBB});
+  generate(*node.getBody());
+  loopTargets.pop_back();
+  // If the current BasicBlock has not been terminated (i.e with a return statement), an
+  // inconditional branch is added. The current block is not bodyBB if node.getBody() has
+  // generated other basic blocks (i.e. a nested loop)
+  if (!builder->GetInsertBlock()->getTerminator()) {
     builder->CreateBr(postBB);
   }
 
   // Code Generation for the post of the forstmt
   function->getBasicBlockList().push_back(postBB);
   builder->SetInsertPoint(postBB);
-  generate(node->getPost());
+  if (node.getPost() != nullptr) {
+    generate(*node.getPost());
+  }
   builder->CreateBr(conditionBB);
 
   // Code Generation for the continuation of the for stmt
@@ -165,7 +200,167 @@ void CodeGeneration::generate(const std::shared_ptr<ForStmt> &node) {
   builder->SetInsertPoint(continuationBB);
 }
 
-void CodeGeneration::generate(const std::shared_ptr<WhileStmt> &node) {
+void CodeGeneration::generateParallelFor(const ForStmt &node) {
+  declareParallelRuntimeFunctions();
+  auto i8ptr = llvm::Type::getInt8PtrTy(context);
+  auto i64 = llvm::Type::getInt64Ty(context);
+  auto i32 = llvm::Type::getInt32Ty(context);
+  llvm::Value *zero = llvm::ConstantInt::get(i32, 0);
+
+  // 1. Range of iterations. Semantic Analysis has checked that the loop has the form
+  // for var int i = begin; i < end; i = i + 1, so the end is computed once, with i = begin
+  generate(*node.getInit());
+  const auto &init = static_cast<const DeclarationStmt &>(*node.getInit());
+  std::string inductionVariable = getIdentifier(*init.getDecl());
+  llvm::Value *begin = builder->CreateLoad(i64, localVariables[inductionVariable], "begin");
+  llvm::Value *end = generate(*static_cast<const BinaryExpr &>(*node.getCond()).getRhs());
+
+  // 2. Captured variables: the addresses of the local variables used in the body and of the
+  // local reduction variables are passed to the outlined function in an array of i8*
+  std::vector<std::string> captured;
+  for (const auto &variable : node.getCapturedVariables()) {
+    captured.push_back(getIdentifier(*variable));
+  }
+  for (const auto &reduction : node.getReductions()) {
+    std::string name = getIdentifier(*reduction.variable);
+    if (localVariables.count(name) != 0 &&
+        std::find(captured.begin(), captured.end(), name) == captured.end()) {
+      captured.push_back(name);
+    }
+  }
+
+  llvm::ArrayType *contextType = llvm::ArrayType::get(i8ptr, captured.size());
+  llvm::AllocaInst *contextArray = createEntryBlockAlloca(contextType, "context");
+  std::vector<llvm::Type *> capturedTypes;
+  for (std::size_t i = 0; i < captured.size(); i++) {
+    llvm::Value *address = localVariables[captured[i]];
+    capturedTypes.push_back(address->getType());
+    llvm::Value *position = llvm::ConstantInt::get(i32, i);
+    llvm::Value *element = builder->CreateGEP(contextType, contextArray, {zero, position});
+    builder->CreateStore(builder->CreateBitCast(address, i8ptr), element);
+  }
+
+  // 3. Outlined function: void body(i8* context, i64 begin, i64 end). The state of the function
+  // being generated is saved and restored after generating it
+  llvm::Function *function = builder->GetInsertBlock()->getParent();
+  llvm::FunctionType *bodyType =
+      llvm::FunctionType::get(llvm::Type::getVoidTy(context), {i8ptr, i64, i64}, false);
+  llvm::Function *body = llvm::Function::Create(bodyType, llvm::Function::InternalLinkage,
+                                                function->getName() + ".parallelfor",
+                                                module.get());
+  llvm::BasicBlock *insertBlock = builder->GetInsertBlock();
+  auto enclosingLocalVariables = localVariables;
+
+  builder->SetInsertPoint(llvm::BasicBlock::Create(context, "entry", body));
+  auto args = body->arg_begin();
+  llvm::Value *contextArgument = &*args++;
+  llvm::Value *lowerBound = &*args++;
+  llvm::Value *upperBound = &*args;
+
+  localVariables.clear();
+  llvm::Value *contextPointer =
+      builder->CreateBitCast(contextArgument, contextType->getPointerTo());
+  for (std::size_t i = 0; i < captured.size(); i++) {
+    llvm::Value *position = llvm::ConstantInt::get(i32, i);
+    llvm::Value *element = builder->CreateGEP(contextType, contextPointer, {zero, position});
+    llvm::Value *address = builder->CreateLoad(i8ptr, element);
+    localVariables[captured[i]] = builder->CreateBitCast(address, capturedTypes[i], captured[i]);
+  }
+
+  // Every thread accumulates the reductions in its own variables, initialized to the identity of
+  // the reduction
+  std::vector<llvm::Value *> sharedReductions;
+  std::vector<llvm::Value *> partialReductions;
+  for (const auto &reduction : node.getReductions()) {
+    std::string name = getIdentifier(*reduction.variable);
+    const auto &type = reduction.variable->getType();
+    auto local = localVariables.find(name);
+    sharedReductions.push_back(local != localVariables.end() ? local->second
+                                                             : globalVariables[name]);
+    llvm::AllocaInst *partial = builder->CreateAlloca(getLLVMType(type), nullptr, name);
+    builder->CreateStore(getReductionIdentity(reduction.op.value, type), partial);
+    partialReductions.push_back(partial);
+    localVariables[name] = partial;
+  }
+
+  llvm::AllocaInst *induction = builder->CreateAlloca(i64, nullptr, inductionVariable);
+  builder->CreateStore(lowerBound, induction);
+  localVariables[inductionVariable] = induction;
+
+  // Loop over the iterations [lowerBound, upperBound)
+  llvm::BasicBlock *conditionBB = llvm::BasicBlock::Create(context, "conditionfor");
+  llvm::BasicBlock *bodyBB = llvm::BasicBlock::Create(context, "bodyfor");
+  llvm::BasicBlock *postBB = llvm::BasicBlock::Create(context, "postfor");
+  llvm::BasicBlock *continuationBB = llvm::BasicBlock::Create(context, "continuationfor");
+
+  builder->CreateBr(conditionBB);
+  body->getBasicBlockList().push_back(conditionBB);
+  builder->SetInsertPoint(conditionBB);
+  llvm::Value *index = builder->CreateLoad(i64, induction);
+  builder->CreateCondBr(builder->CreateICmpSLT(index, upperBound), bodyBB, continuationBB);
+
+  // A continue jumps to the next iteration of the thread (a break is not allowed, it is checked in
+  // Semantic Analysis)
+  body->getBasicBlockList().push_back(bodyBB);
+  builder->SetInsertPoint(bodyBB);
+  loopTargets.push_back({nullptr, postBB});
+  generate(*node.getBody());
+  loopTargets.pop_back();
+  if (!builder->GetInsertBlock()->getTerminator()) {
+    builder->CreateBr(postBB);
+  }
+
+  body->getBasicBlockList().push_back(postBB);
+  builder->SetInsertPoint(postBB);
+  generate(*node.getPost());
+  builder->CreateBr(conditionBB);
+
+  // The partial results of the reductions are combined with the variables, one thread at a time
+  body->getBasicBlockList().push_back(continuationBB);
+  builder->SetInsertPoint(continuationBB);
+  if (!node.getReductions().empty()) {
+    builder->CreateCall(module->getFunction("stoc_parallel_lock"));
+    for (std::size_t i = 0; i < node.getReductions().size(); i++) {
+      const auto &reduction = node.getReductions()[i];
+      auto type = std::dynamic_pointer_cast<BasicType>(reduction.variable->getType());
+      llvm::Type *llvmType = getLLVMType(type);
+      llvm::Value *shared = builder->CreateLoad(llvmType, sharedReductions[i]);
+      llvm::Value *partial = builder->CreateLoad(llvmType, partialReductions[i]);
+
+      llvm::Value *combined;
+      if (reduction.op.value == "sum") {
+        combined = type->isFloat() ? builder->CreateFAdd(shared, partial)
+                                   : builder->CreateAdd(shared, partial);
+      } else {
+        bool isMin = reduction.op.value == "min";
+        llvm::Value *isPartial;
+        if (type->isFloat()) {
+          isPartial = isMin ? builder->CreateFCmpOLT(partial, shared)
+                            : builder->CreateFCmpOGT(partial, shared);
+        } else if (type->isUnsigned()) {
+          isPartial = isMin ? builder->CreateICmpULT(partial, shared)
+                            : builder->CreateICmpUGT(partial, shared);
+        } else {
+          isPartial = isMin ? builder->CreateICmpSLT(partial, shared)
+                            : builder->CreateICmpSGT(partial, shared);
+        }
+        combined = builder->CreateSelect(isPartial, partial, shared);
+      }
+      builder->CreateStore(combined, sharedReductions[i]);
+    }
+    builder->CreateCall(module->getFunction("stoc_parallel_unlock"));
+  }
+  builder->CreateRetVoid();
+
+  localVariables = enclosingLocalVariables;
+  builder->SetInsertPoint(insertBlock);
+
+  // 4. The runtime runs the iterations in the threads of the pool
+  builder->CreateCall(module->getFunction("stoc_parallel_for"),
+                      {begin, end, body, builder->CreateBitCast(contextArray, i8ptr)});
+}
+
+void CodeGeneration::generate(const WhileStmt &node) {
   // Get current function where the code is being generated
   llvm::Function *function = builder->GetInsertBlock()->getParent();
 
@@ -178,16 +373,20 @@ void CodeGeneration::generate(const std::shared_ptr<WhileStmt> &node) {
   builder->CreateBr(conditionBB);
   function->getBasicBlockList().push_back(conditionBB);
   builder->SetInsertPoint(conditionBB);
-  llvm::Value *condition = generate(node->getCond());
+  llvm::Value *condition = generate(*node.getCond());
   builder->CreateCondBr(condition, bodyBB, continuationBB);
 
-  // Code Generation for the body
+  // Code Generation for the body. A break jumps to the continuation and a continue to the
+  // condition
   function->getBasicBlockList().push_back(bodyBB);
   builder->SetInsertPoint(bodyBB);
-  generate(node->getBody());
-  // If this BasicBlock has not been terminated (i.e with a return statement), an inconditional
-  // branch to the continuation of the ifStmt is added
-  if(!bodyBB->getTerminator()) {
+  loopTargets.push_back({continuationBB, conditionBB});
+  generate(*node.getBody());
+  loopTargets.pop_back();
+  // If the current BasicBlock has not been terminated (i.e with a return statement), an
+  // inconditional branch is added. The current block is not bodyBB if node.getBody() has
+  // generated other basic blocks (i.e. a nested loop)
+  if (!builder->GetInsertBlock()->getTerminator()) {
     builder->CreateBr(conditionBB);
   }
 
@@ -196,30 +395,90 @@ void CodeGeneration::generate(const std::shared_ptr<WhileStmt> &node) {
   builder->SetInsertPoint(continuationBB);
 }
 
-void CodeGeneration::generate(const std::shared_ptr<AssignmentStmt> &node) {
-  llvm::Value *rhs = generate(node->getRhs());
-  std::string lhsName = getIdentifier(node->getLhs());
+void CodeGeneration::generate(const AssignmentStmt &node) {
+  llvm::Value *rhs = generate(*node.getRhs());
+  if (node.getLhs()->getExprKind() == Expr::Kind::INDEXEXPR) {
+    const auto &indexExpr = static_cast<const IndexExpr &>(*node.getLhs());
+    // assignment to a lane of a vector: the vector is loaded, the lane is inserted and the vector
+    // is stored back
+    if (indexExpr.getArray()->getType()->getTypeKind() == Type::Kind::VectorType) {
+      llvm::Value *address = generateAddress(*indexExpr.getArray());
+      const auto &lane = static_cast<const LiteralExpr &>(*indexExpr.getIndex()).getToken().value;
+      llvm::Value *vector =
+          builder->CreateLoad(getLLVMType(indexExpr.getArray()->getType()), address, "vector");
+      builder->CreateStore(builder->CreateInsertElement(vector, rhs, std::stoull(lane)), address);
+      return;
+    }
+
+    // assignment to an element of a struct of arrays: every field is stored in its array
+    if (isStructOfArrays(indexExpr.getArray()->getType())) {
+      std::vector<llvm::Value *> addresses = generateFieldAddresses(indexExpr);
+      for (std::size_t field = 0; field < addresses.size(); field++) {
+        builder->CreateStore(builder->CreateExtractValue(rhs, field), addresses[field]);
+      }
+      return;
+    }
+
+    // assignment to an element of an array
+    llvm::Value *address = generateElementAddress(indexExpr);
+    builder->CreateStore(rhs, address);
+    return;
+  } else if (node.getLhs()->getExprKind() == Expr::Kind::FIELDEXPR) {
+    // assignment to a field of a struct
+    builder->CreateStore(rhs, generateAddress(*node.getLhs()));
+    return;
+  }
+
+  std::string lhsName = getIdentifier(*node.getLhs());
   // TODO: refactor how to look for lhs name (maybe its not a IdentExpr)
   auto lhslocal = localVariables.find(lhsName);
   if (lhslocal != localVariables.end()) {
     // assignment to local variable
-    builder->CreateStore(rhs, lhslocal->second);
+    storeValue(rhs, lhslocal->second, node.getLhs()->getType());
   } else {
     // LHS is not local variable, check if it is global
     auto lhsglobal = globalVariables.find(lhsName);
     if (lhsglobal != globalVariables.end()) {
-      builder->CreateStore(rhs, lhsglobal->second);
+      storeValue(rhs, lhsglobal->second, node.getLhs()->getType());
     } else {
       // TODO: handle what happens if lhs does not exist
     }
   }
 }
 
-void CodeGeneration::generate(const std::shared_ptr<ReturnStmt> &node) {
-  llvm::Value *ret = generate(node->getValue());
+void CodeGeneration::generate(const ReturnStmt &node) {
+  llvm::Value *ret = generate(*node.getValue());
+
+  // A call in tail position (see Semantic) is returned directly, so nothing is between the call
+  // and the return and the callee can reuse the frame of the function
+  if (node.getValue()->getExprKind() == Expr::Kind::CALLEXPR &&
+      static_cast<const CallExpr &>(*node.getValue()).getTailCall() != CallExpr::TailCall::NONE) {
+    builder->CreateRet(ret);
+    return;
+  }
 
   // Instead of return the value, we store it in the special variable "return" and jump to exit
   // basic block
   builder->CreateStore(ret, localVariables["return"]);
   builder->CreateBr(this->exitBB);
+}
+
+void CodeGeneration::generate(const BreakStmt &node) {
+  // Semantic Analysis only allows break inside of a loop
+  if (loopTargets.empty()) {
+    reportError("Internal Error - break outside of a loop", node.getBreakKeyword().line,
+                node.getBreakKeyword().column);
+    return;
+  }
+  // The statements after the break are not generated (see generate(BlockStmt))
+  builder->CreateBr(loopTargets.back().breakBB);
+}
+
+void CodeGeneration::generate(const ContinueStmt &node) {
+  if (loopTargets.empty()) {
+    reportError("Internal Error - continue outside of a loop", node.getContinueKeyword().line,
+                node.getContinueKeyword().column);
+    return;
+  }
+  builder->CreateBr(loopTargets.back().continueBB);
 }
\ No newline at end of file
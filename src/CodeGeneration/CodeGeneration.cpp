@@ -13,67 +13,90 @@
 //===------------------------------------------------------------------------------------------===//
 #include "stoc/CodeGeneration/CodeGeneration.h"
 
+#include <algorithm>
+#include <utility>
+
 #include <llvm/ADT/SmallVector.h>
-#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/CodeGen/ParallelCG.h>
+#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
 #include <llvm/Support/Path.h>
 #include <llvm/Support/Program.h>
-#include <llvm/Support/TargetRegistry.h>
-#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_os_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+
+#include "stoc/CodeGeneration/TargetMachineCache.h"
 
-CodeGeneration::CodeGeneration(std::shared_ptr<SrcFile> &file) : file(file) {
+CodeGeneration::CodeGeneration(std::shared_ptr<SrcFile> &file, unsigned jobs,
+                               std::string targetTriple, std::string cpu, OverflowMode overflow,
+                               llvm::FastMathFlags fastMath)
+    : file(file), optimizationLevel(-1), jobs(std::max(1u, jobs)),
+      targetTriple(std::move(targetTriple)), cpu(std::move(cpu)), overflow(overflow),
+      fastMath(fastMath), incremental(false) {
   module = std::make_shared<llvm::Module>(file->getFilename(), this->context);
   builder = std::make_shared<llvm::IRBuilder<>>(context);
+  // Every floating-point operation created by the builder (arithmetic, comparisons and calls) gets
+  // the fast-math flags
+  builder->setFastMathFlags(fastMath);
   initialization();
   declareBuiltinFunctions();
   declareStringBuiltinFunctions();
+  declareArrayBuiltinFunctions();
+}
+
+CodeGeneration::~CodeGeneration() {
+  TargetMachineCache::getInstance().release(std::move(targetMachine));
 }
 
 void CodeGeneration::reportError(std::string error_msg) {
-  std::cerr << "<" << this->file->getFilename() << "> Code Generation: " << error_msg << std::endl;
+  this->file->getErrorStream() << "<" << this->file->getFilename()
+                                << "> Code Generation: " << error_msg << std::endl;
   this->file->setErrorInCodeGeneration(true);
   throw std::runtime_error("Error in Code Generation. Could not recover.");
 }
 
 void CodeGeneration::reportError(std::string error_msg, int line, int column) {
-  std::cerr << "<" << this->file->getFilename() << ":l" << line << ":c" << column
-            << "> Code Generation: " << error_msg << std::endl;
+  this->file->getErrorStream() << "<" << this->file->getFilename() << ":l" << line << ":c"
+                                << column << "> Code Generation: " << error_msg << std::endl;
   this->file->setErrorInCodeGeneration(true);
   throw std::runtime_error("Error in Code Generation. Could not recover.");
 }
 
 void CodeGeneration::initialization() {
-  // Initialize the target registry etc.
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmParsers();
-  llvm::InitializeAllAsmPrinters();
-
-  auto TargetTriple = llvm::sys::getDefaultTargetTriple();
-  module->setTargetTriple(TargetTriple);
+  if (targetTriple.empty()) {
+    targetTriple = llvm::sys::getDefaultTargetTriple();
+  }
+  targetTriple = llvm::Triple::normalize(targetTriple);
+  module->setTargetTriple(targetTriple);
 
+  // The target machine is taken from the cache, so when several files are compiled by the same
+  // process (i.e. by the stoc server) the targets are only initialized once
   std::string Error;
-  auto Target = llvm::TargetRegistry::lookupTarget(TargetTriple, Error);
-
-  // Print an error and exit if we couldn't find the requested target.
-  // This generally occurs if we've forgotten to initialise the
-  // TargetRegistry or we have a bogus target triple.
-  if (!Target) {
-    llvm::errs() << Error;
+  targetMachine = TargetMachineCache::getInstance().acquire(targetTriple, cpu, Error);
+  if (!targetMachine) {
+    reportError(Error);
   }
 
-  auto CPU = "generic";
-  auto Features = "";
-
-  llvm::TargetOptions opt;
-  auto RM = llvm::Optional<llvm::Reloc::Model>();
-  auto TheTargetMachine = Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
+  module->setDataLayout(targetMachine->createDataLayout());
 
-  module->setDataLayout(TheTargetMachine->createDataLayout());
+  // The semantics of integer overflow are recorded in the module, so linking modules generated
+  // with different semantics is an error
+  const char *overflowName = overflow == OverflowMode::WRAP  ? "wrap"
+                             : overflow == OverflowMode::NSW ? "nsw"
+                                                             : "trap";
+  module->addModuleFlag(llvm::Module::Error, "stoc.overflow",
+                        llvm::MDString::get(context, overflowName));
 }
 
 void CodeGeneration::declareStringBuiltinFunctions() {
@@ -108,70 +131,465 @@ void CodeGeneration::declareBuiltinFunctions() {
   llvm::FunctionType *functionType_printf = llvm::FunctionType::get(i8ptr, {i8ptr}, true);
   llvm::Function::Create(functionType_printf, llvm::Function::ExternalLinkage, "printf",
                          module.get());
+
+  // builtin functions on vectors in stoc, generated as LLVM IR instructions
+  for (const std::string name :
+       {"select", "shuffle", "reduce_add", "reduce_min", "reduce_max", "any", "all"}) {
+    builtinFunctions.insert(name);
+  }
+
+  // builtin functions on the bits of integers in stoc, generated as calls to LLVM intrinsics
+  for (const std::string name : {"popcount", "clz", "ctz", "bswap", "rotl"}) {
+    builtinFunctions.insert(name);
+  }
+
+  // builtin functions on atomics in stoc, generated as LLVM IR atomic instructions
+  for (const std::string name :
+       {"load", "store", "exchange", "compare_exchange", "fetch_and", "fetch_or", "fetch_xor",
+        "fetch_add", "fetch_sub", "fetch_min", "fetch_max"}) {
+    builtinFunctions.insert(name);
+  }
+}
+
+void CodeGeneration::declareArrayBuiltinFunctions() {
+  // len and append builtin functions in stoc
+  builtinFunctions.insert("len");
+  builtinFunctions.insert("append");
+
+  // uses malloc and exit from std library in c
+  auto i8ptr = llvm::Type::getInt8PtrTy(context);
+  auto i64 = llvm::Type::getInt64Ty(context);
+  llvm::FunctionType *functionType_malloc = llvm::FunctionType::get(i8ptr, {i64}, false);
+  llvm::Function::Create(functionType_malloc, llvm::Function::ExternalLinkage, "malloc",
+                         module.get());
+
+  llvm::FunctionType *functionType_exit =
+      llvm::FunctionType::get(llvm::Type::getVoidTy(context), {llvm::Type::getInt32Ty(context)},
+                              false);
+  llvm::Function *exitFunction = llvm::Function::Create(
+      functionType_exit, llvm::Function::ExternalLinkage, "exit", module.get());
+  exitFunction->setDoesNotReturn();
+}
+
+llvm::Function *CodeGeneration::getIndexOutOfRangeFunction() {
+  const std::string name = "__stoc_index_out_of_range";
+  if (llvm::Function *function = module->getFunction(name)) {
+    return function;
+  }
+
+  // void __stoc_index_out_of_range(i64 index, i64 length, i64 line): it is cold and never returns,
+  // so the checks are laid out as a branch that is never taken in the hot path of the loops
+  auto i64 = llvm::Type::getInt64Ty(context);
+  llvm::FunctionType *functionType =
+      llvm::FunctionType::get(llvm::Type::getVoidTy(context), {i64, i64, i64}, false);
+  llvm::Function *function = llvm::Function::Create(functionType, llvm::Function::PrivateLinkage,
+                                                    name, module.get());
+  function->setDoesNotReturn();
+  function->addFnAttr(llvm::Attribute::Cold);
+  function->addFnAttr(llvm::Attribute::NoInline);
+
+  llvm::IRBuilder<> functionBuilder(llvm::BasicBlock::Create(context, "entry", function));
+  auto format = functionBuilder.CreateGlobalStringPtr(
+      "Runtime error: index %ld out of range [0, %ld) in line %ld\n");
+  auto args = function->arg_begin();
+  llvm::Value *index = &*args++;
+  llvm::Value *length = &*args++;
+  llvm::Value *line = &*args;
+  functionBuilder.CreateCall(module->getFunction("printf"), {format, index, length, line});
+  functionBuilder.CreateCall(module->getFunction("exit"),
+                             {llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 1)});
+  functionBuilder.CreateUnreachable();
+  return function;
+}
+
+llvm::Function *CodeGeneration::getIntegerOverflowFunction() {
+  const std::string name = "__stoc_integer_overflow";
+  if (llvm::Function *function = module->getFunction(name)) {
+    return function;
+  }
+
+  // void __stoc_integer_overflow(i64 line): like __stoc_index_out_of_range, it is cold and never
+  // returns
+  auto i64 = llvm::Type::getInt64Ty(context);
+  llvm::FunctionType *functionType =
+      llvm::FunctionType::get(llvm::Type::getVoidTy(context), {i64}, false);
+  llvm::Function *function = llvm::Function::Create(functionType, llvm::Function::PrivateLinkage,
+                                                    name, module.get());
+  function->setDoesNotReturn();
+  function->addFnAttr(llvm::Attribute::Cold);
+  function->addFnAttr(llvm::Attribute::NoInline);
+
+  llvm::IRBuilder<> functionBuilder(llvm::BasicBlock::Create(context, "entry", function));
+  auto format =
+      functionBuilder.CreateGlobalStringPtr("Runtime error: integer overflow in line %ld\n");
+  functionBuilder.CreateCall(module->getFunction("printf"), {format, &*function->arg_begin()});
+  functionBuilder.CreateCall(module->getFunction("exit"),
+                             {llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 1)});
+  functionBuilder.CreateUnreachable();
+  return function;
+}
+
+void CodeGeneration::declareParallelRuntimeFunctions() {
+  if (module->getFunction("stoc_parallel_for") != nullptr) {
+    return;
+  }
+
+  // void stoc_parallel_for(i64 begin, i64 end, void (i8*, i64, i64)* body, i8* context)
+  auto voidType = llvm::Type::getVoidTy(context);
+  auto i8ptr = llvm::Type::getInt8PtrTy(context);
+  auto i64 = llvm::Type::getInt64Ty(context);
+  llvm::FunctionType *bodyType = llvm::FunctionType::get(voidType, {i8ptr, i64, i64}, false);
+  llvm::FunctionType *parallelForType =
+      llvm::FunctionType::get(voidType, {i64, i64, bodyType->getPointerTo(), i8ptr}, false);
+  llvm::Function::Create(parallelForType, llvm::Function::ExternalLinkage, "stoc_parallel_for",
+                         module.get());
+
+  // void stoc_parallel_lock() and void stoc_parallel_unlock()
+  llvm::FunctionType *lockType = llvm::FunctionType::get(voidType, false);
+  llvm::Function::Create(lockType, llvm::Function::ExternalLinkage, "stoc_parallel_lock",
+                         module.get());
+  llvm::Function::Create(lockType, llvm::Function::ExternalLinkage, "stoc_parallel_unlock",
+                         module.get());
+}
+
+void CodeGeneration::declareTaskRuntimeFunctions() {
+  if (module->getFunction("stoc_spawn") != nullptr) {
+    return;
+  }
+
+  // void stoc_spawn(void (i8*)* function, i8* box) and void stoc_await(i8* box), and free from std
+  // library in c for the box of a task that has been awaited
+  auto voidType = llvm::Type::getVoidTy(context);
+  auto i8ptr = llvm::Type::getInt8PtrTy(context);
+  llvm::FunctionType *taskFunctionType = llvm::FunctionType::get(voidType, {i8ptr}, false);
+  llvm::FunctionType *spawnType =
+      llvm::FunctionType::get(voidType, {taskFunctionType->getPointerTo(), i8ptr}, false);
+  llvm::Function::Create(spawnType, llvm::Function::ExternalLinkage, "stoc_spawn", module.get());
+  llvm::Function::Create(taskFunctionType, llvm::Function::ExternalLinkage, "stoc_await",
+                         module.get());
+  if (module->getFunction("free") == nullptr) {
+    llvm::Function::Create(taskFunctionType, llvm::Function::ExternalLinkage, "free",
+                           module.get());
+  }
+}
+
+llvm::StructType *CodeGeneration::getTaskBoxType(llvm::Function *callee) {
+  // { state (used by the runtime), result, arguments... }
+  std::vector<llvm::Type *> fields = {llvm::Type::getInt64Ty(context), callee->getReturnType()};
+  for (const auto &param : callee->getFunctionType()->params()) {
+    fields.push_back(param);
+  }
+  return llvm::StructType::get(context, fields);
+}
+
+llvm::Function *CodeGeneration::getTaskFunction(llvm::Function *callee) {
+  const std::string name = callee->getName().str() + ".task";
+  if (llvm::Function *function = module->getFunction(name)) {
+    return function;
+  }
+
+  // void <callee>.task(i8* box): calls the function with the arguments of the box and stores the
+  // result in the box
+  auto i8ptr = llvm::Type::getInt8PtrTy(context);
+  auto i32 = llvm::Type::getInt32Ty(context);
+  llvm::FunctionType *functionType =
+      llvm::FunctionType::get(llvm::Type::getVoidTy(context), {i8ptr}, false);
+  llvm::Function *function = llvm::Function::Create(functionType, llvm::Function::InternalLinkage,
+                                                    name, module.get());
+
+  llvm::IRBuilder<> functionBuilder(llvm::BasicBlock::Create(context, "entry", function));
+  llvm::StructType *boxType = getTaskBoxType(callee);
+  llvm::Value *box = functionBuilder.CreateBitCast(&*function->arg_begin(),
+                                                   boxType->getPointerTo(), "box");
+  llvm::Value *zero = llvm::ConstantInt::get(i32, 0);
+  std::vector<llvm::Value *> args;
+  for (unsigned i = 0; i < callee->arg_size(); i++) {
+    llvm::Value *position = llvm::ConstantInt::get(i32, i + 2);
+    llvm::Value *address = functionBuilder.CreateGEP(boxType, box, {zero, position});
+    args.push_back(functionBuilder.CreateLoad(boxType->getElementType(i + 2), address));
+  }
+  llvm::CallInst *result = functionBuilder.CreateCall(callee, args);
+  result->setCallingConv(callee->getCallingConv());
+  llvm::Value *one = llvm::ConstantInt::get(i32, 1);
+  functionBuilder.CreateStore(result, functionBuilder.CreateGEP(boxType, box, {zero, one}));
+  functionBuilder.CreateRetVoid();
+  return function;
+}
+
+llvm::Constant *CodeGeneration::getReductionIdentity(const std::string &op,
+                                                     const std::shared_ptr<Type> &type) {
+  auto basicType = std::dynamic_pointer_cast<BasicType>(type);
+  llvm::Type *llvmType = getLLVMType(type);
+  if (op == "sum") {
+    return getLLVMInit(type);
+  }
+
+  bool isMin = op == "min";
+  if (basicType->isFloat()) {
+    return llvm::ConstantFP::getInfinity(llvmType, !isMin);
+  }
+  unsigned bits = basicType->getBitWidth();
+  if (basicType->isUnsigned()) {
+    return llvm::ConstantInt::get(context, isMin ? llvm::APInt::getMaxValue(bits)
+                                                 : llvm::APInt::getMinValue(bits));
+  }
+  return llvm::ConstantInt::get(context, isMin ? llvm::APInt::getSignedMaxValue(bits)
+                                               : llvm::APInt::getSignedMinValue(bits));
+}
+
+void CodeGeneration::generateDeclarations() {
+  // Functions can be used before they are declared in the source code, so the prototypes of all
+  // the functions and the global variables and constants are generated before the bodies
+  for (const auto &declaration : file->getAst()) {
+    if (declaration->getDeclKind() == Decl::Kind::FUNCDECL) {
+      declareFunction(static_cast<const FuncDecl &>(*declaration));
+    } else {
+      generate(*declaration);
+    }
+  }
+
+  for (const auto &declaration : file->getAst()) {
+    if (declaration->getDeclKind() == Decl::Kind::FUNCDECL) {
+      generate(*declaration);
+    }
+  }
 }
 
 void CodeGeneration::generate() {
   try {
-    for (const auto &declaration : file->getAst()) {
-      generate(declaration);
-    }
+    generateDeclarations();
 
-    bool isBroken = llvm::verifyModule(*module, &llvm::errs(), nullptr);
+    llvm::raw_os_ostream errorStream(this->file->getErrorStream());
+    bool isBroken = llvm::verifyModule(*module, &errorStream, nullptr);
     if(isBroken) {
       this->file->setErrorInCodeGeneration(true);
     }
 
   } catch (std::runtime_error &e) {
-    std::cout << e.what() << std::endl;
+    this->file->getOutputStream() << e.what() << std::endl;
   }
 }
 
-void CodeGeneration::printLLVM() { module->print(llvm::errs(), nullptr); }
+void CodeGeneration::generateIncremental(
+    const std::vector<std::shared_ptr<Decl>> &previousDeclarations,
+    const std::string &initializationFunctionName) {
+  incremental = true;
+  try {
+    // The functions and globals of previous inputs are defined in other modules
+    for (const auto &declaration : previousDeclarations) {
+      declareExternal(*declaration);
+    }
 
-void CodeGeneration::getExecutable() {
-  // get filename of src
-  std::string filename = llvm::sys::path::stem(file->getFilename());
+    generateDeclarations();
 
-  std::error_code EC;
-  std::string tempFilenameBitcode = filename + ".temp_bitcode";
-  std::string tempFilenameObject = filename + ".o";
-  llvm::raw_fd_ostream dest(tempFilenameBitcode, EC);
-  if (EC) {
-    llvm::errs() << "Failed to create temporary file: " << EC.message();
-    return;
+    // The globals of this input are initialized by calling \initializationFunctionName
+    llvm::FunctionType *functionType =
+        llvm::FunctionType::get(llvm::Type::getVoidTy(context), {}, false);
+    llvm::Function *function =
+        llvm::Function::Create(functionType, llvm::Function::ExternalLinkage,
+                               initializationFunctionName, module.get());
+    builder->SetInsertPoint(llvm::BasicBlock::Create(context, "entry", function));
+    for (llvm::Function *initializationFunction : initializationFunctions) {
+      builder->CreateCall(initializationFunction);
+    }
+    builder->CreateRetVoid();
+
+    llvm::raw_os_ostream errorStream(this->file->getErrorStream());
+    bool isBroken = llvm::verifyModule(*module, &errorStream, nullptr);
+    if (isBroken) {
+      this->file->setErrorInCodeGeneration(true);
+    }
+
+  } catch (std::runtime_error &e) {
+    this->file->getOutputStream() << e.what() << std::endl;
   }
-  llvm::WriteBitcodeToFile(*module, dest);
-  dest.close();
+}
 
-  // Program to convert LLVM bitcode to object file, it already creates the file
-  llvm::ErrorOr<std::string> llc = llvm::sys::findProgramByName("llc");
-  if ((EC = llc.getError())) {
-    llvm::errs() << EC.message();
+void CodeGeneration::declareExternal(const Decl &node) {
+  switch (node.getDeclKind()) {
+  case Decl::Kind::VARDECL: {
+    const auto &varDecl = static_cast<const VarDecl &>(node);
+    globalVariables[varDecl.getIdentifierMangled()] = new llvm::GlobalVariable(
+        *module, getLLVMType(varDecl.getType()), false, llvm::GlobalValue::ExternalLinkage,
+        nullptr, varDecl.getIdentifierMangled());
     return;
   }
-  std::string ec;
-  int resultcode = llvm::sys::ExecuteAndWait(
-      llc.get(),
-      {"llc", tempFilenameBitcode, "-filetype=obj", "-addrsig", "-o", tempFilenameObject},
-      llvm::None, {}, 0, 0, &ec);
-  if (resultcode != 0) {
-    llvm::errs() << ec;
+  case Decl::Kind::CONSTDECL: {
+    const auto &constDecl = static_cast<const ConstDecl &>(node);
+    globalVariables[constDecl.getIdentifierMangled()] = new llvm::GlobalVariable(
+        *module, getLLVMType(constDecl.getType()), true, llvm::GlobalValue::ExternalLinkage,
+        nullptr, constDecl.getIdentifierMangled());
+    return;
+  }
+  case Decl::Kind::FUNCDECL:
+    return declareFunction(static_cast<const FuncDecl &>(node));
+  case Decl::Kind::PARAMDECL:
+  case Decl::Kind::STRUCTDECL: // the type of a struct is created when it is used
+    return;
+  }
+}
+
+void CodeGeneration::addInitializationFunction(llvm::Function *function) {
+  if (incremental) {
+    initializationFunctions.push_back(function);
+  } else {
+    llvm::appendToGlobalCtors(*module, function, 0, nullptr);
   }
+}
+
+llvm::Module &CodeGeneration::getModule() { return *module; }
+
+void CodeGeneration::optimize(unsigned optLevel) {
+  optimizationLevel = optLevel;
+
+  // Same pipeline that clang/opt build for -O<optLevel>, using the information of the target
+  // machine so the vectorizers and the inliner can use its cost model
+  llvm::PassManagerBuilder passManagerBuilder;
+  passManagerBuilder.OptLevel = optLevel;
+  passManagerBuilder.SizeLevel = 0;
+  if (optLevel > 1) {
+    passManagerBuilder.Inliner = llvm::createFunctionInliningPass(optLevel, 0, false);
+  } else {
+    passManagerBuilder.Inliner = llvm::createAlwaysInlinerLegacyPass();
+  }
+  passManagerBuilder.LoopVectorize = optLevel > 1;
+  passManagerBuilder.SLPVectorize = optLevel > 1;
+  targetMachine->adjustPassManager(passManagerBuilder);
 
-  // Program to convert object file to executable, it already creates the file
+  llvm::legacy::FunctionPassManager functionPasses(module.get());
+  llvm::legacy::PassManager modulePasses;
+  functionPasses.add(
+      llvm::createTargetTransformInfoWrapperPass(targetMachine->getTargetIRAnalysis()));
+  modulePasses.add(
+      llvm::createTargetTransformInfoWrapperPass(targetMachine->getTargetIRAnalysis()));
+  passManagerBuilder.populateFunctionPassManager(functionPasses);
+  passManagerBuilder.populateModulePassManager(modulePasses);
+
+  functionPasses.doInitialization();
+  for (auto &function : *module) {
+    functionPasses.run(function);
+  }
+  functionPasses.doFinalization();
+  modulePasses.run(*module);
+}
+
+void CodeGeneration::printLLVM() {
+  llvm::raw_os_ostream errorStream(this->file->getErrorStream());
+  module->print(errorStream, nullptr);
+}
+
+unsigned CodeGeneration::getNumberOfPartitions() {
+  // Every partition has at least one function with body, otherwise the threads would be emitting
+  // empty object files
+  unsigned definedFunctions = 0;
+  for (const auto &function : *module) {
+    if (!function.isDeclaration()) {
+      definedFunctions++;
+    }
+  }
+  return std::max(1u, std::min(jobs, definedFunctions));
+}
+
+void CodeGeneration::getExecutable(const std::string &outputDirectory) {
+  // get filename of src
+  std::string filename = llvm::sys::path::stem(file->getFilename()).str();
+  if (!outputDirectory.empty()) {
+    llvm::SmallString<128> path(outputDirectory);
+    llvm::sys::path::append(path, filename);
+    filename = std::string(path.str());
+  }
+  llvm::raw_os_ostream errorStream(this->file->getErrorStream());
+
+  // The module is split in partitions and the instruction selection and register allocation of
+  // each of them is done in its own thread (with its own LLVMContext and TargetMachine), emitting
+  // one object file per partition. Symbols local to the module are promoted to external so they
+  // can be referenced across partitions.
+  unsigned partitions = getNumberOfPartitions();
+  std::vector<std::string> objectFilenames;
+  std::vector<std::unique_ptr<llvm::raw_fd_ostream>> objectFiles;
+  std::vector<llvm::raw_pwrite_stream *> objectStreams;
+  for (unsigned i = 0; i < partitions; i++) {
+    std::error_code EC;
+    std::string objectFilename =
+        partitions == 1 ? filename + ".o" : filename + "." + std::to_string(i) + ".o";
+    objectFiles.push_back(std::make_unique<llvm::raw_fd_ostream>(objectFilename, EC,
+                                                                 llvm::sys::fs::OF_None));
+    if (EC) {
+      errorStream << "Failed to create object file: " << EC.message();
+      return;
+    }
+    objectFilenames.push_back(objectFilename);
+    objectStreams.push_back(objectFiles.back().get());
+  }
+
+  // If no optimization level was requested, the backend uses its default optimization level
+  llvm::CodeGenOpt::Level codeGenOptLevel = llvm::CodeGenOpt::Default;
+  switch (optimizationLevel) {
+  case 0:
+    codeGenOptLevel = llvm::CodeGenOpt::None;
+    break;
+  case 1:
+    codeGenOptLevel = llvm::CodeGenOpt::Less;
+    break;
+  case 3:
+    codeGenOptLevel = llvm::CodeGenOpt::Aggressive;
+    break;
+  default:
+    break;
+  }
+
+  // A TargetMachine can not be shared between threads, so every partition creates its own one
+  // with the same configuration as the one used to optimize the module
+  llvm::TargetOptions options = targetMachine->Options;
+  options.EmitAddrsig = true;
+  auto createTargetMachine = [&]() {
+    return std::unique_ptr<llvm::TargetMachine>(targetMachine->getTarget().createTargetMachine(
+        targetMachine->getTargetTriple().str(), targetMachine->getTargetCPU(),
+        targetMachine->getTargetFeatureString(), options, targetMachine->getRelocationModel(),
+        llvm::None, codeGenOptLevel));
+  };
+
+  // The partitions are made from a copy because splitting the module modifies it
+  llvm::splitCodeGen(*llvm::CloneModule(*module), objectStreams, {}, createTargetMachine,
+                     llvm::CGFT_ObjectFile);
+  for (auto &objectFile : objectFiles) {
+    objectFile->close();
+  }
+
+  // The object files of other targets are left for a linker of that target
+  if (targetTriple != llvm::Triple::normalize(llvm::sys::getDefaultTargetTriple())) {
+    errorStream << "Target " << targetTriple
+                << " is not the host: the object files are not linked\n";
+    return;
+  }
+
+  // Program to link the object files into an executable, it already creates the file
+  std::error_code EC;
   llvm::ErrorOr<std::string> gcc = llvm::sys::findProgramByName("gcc");
   if ((EC = gcc.getError())) {
-    llvm::errs() << EC.message();
+    errorStream << EC.message();
     return;
   }
-  resultcode = llvm::sys::ExecuteAndWait(
-      gcc.get(), {"gcc", "-no-pie", tempFilenameObject, "-o", filename}, llvm::None, {}, 0, 0, &ec);
+  std::string ec;
+  std::vector<llvm::StringRef> gccArgs = {"gcc", "-no-pie"};
+  gccArgs.insert(gccArgs.end(), objectFilenames.begin(), objectFilenames.end());
+  // The runtime of the parallel for loops and the tasks is only linked if the program uses them
+  if (module->getFunction("stoc_parallel_for") != nullptr ||
+      module->getFunction("stoc_spawn") != nullptr) {
+    gccArgs.push_back(STOC_RUNTIME_LIBRARY);
+    gccArgs.push_back("-lstdc++");
+    gccArgs.push_back("-lpthread");
+  }
+  gccArgs.push_back("-o");
+  gccArgs.push_back(filename);
+  int resultcode = llvm::sys::ExecuteAndWait(gcc.get(), gccArgs, llvm::None, {}, 0, 0, &ec);
   if (resultcode != 0) {
-    llvm::errs() << ec;
+    errorStream << ec;
   }
 
-  // llvm::sys::fs::remove(tempFilenameBitcode);
-  // llvm::sys::fs::remove(tempFilenameObject);
+  // for (const auto &objectFilename : objectFilenames) {
+  //   llvm::sys::fs::remove(objectFilename);
+  // }
 }
 
 llvm::Type *CodeGeneration::getLLVMType(std::shared_ptr<Type> type) {
@@ -184,6 +602,19 @@ llvm::Type *CodeGeneration::getLLVMType(std::shared_ptr<Type> type) {
       return llvm::Type::getInt64Ty(context);
     case BasicType::Kind::FLOAT:
       return llvm::Type::getDoubleTy(context);
+    case BasicType::Kind::INT8:
+    case BasicType::Kind::UINT8:
+      return llvm::Type::getInt8Ty(context);
+    case BasicType::Kind::INT16:
+    case BasicType::Kind::UINT16:
+      return llvm::Type::getInt16Ty(context);
+    case BasicType::Kind::INT32:
+    case BasicType::Kind::UINT32:
+      return llvm::Type::getInt32Ty(context);
+    case BasicType::Kind::UINT64:
+      return llvm::Type::getInt64Ty(context);
+    case BasicType::Kind::FLOAT32:
+      return llvm::Type::getFloatTy(context);
     case BasicType::Kind::STRING:
       return llvm::Type::getInt8PtrTy(context);
     case BasicType::Kind::VOID:
@@ -195,12 +626,68 @@ llvm::Type *CodeGeneration::getLLVMType(std::shared_ptr<Type> type) {
       reportError("Internal Error - Basic Type not known");
       return nullptr;
     }
+  } else if (type->getTypeKind() == Type::Kind::ArrayType) {
+    auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
+    llvm::Type *element = getLLVMType(arrayType->getElement());
+    if (arrayType->isDynamic()) {
+      // { elements, length, capacity }
+      return llvm::StructType::get(context, {element->getPointerTo(),
+                                             llvm::Type::getInt64Ty(context),
+                                             llvm::Type::getInt64Ty(context)});
+    }
+    if (isStructOfArrays(arrayType)) {
+      // { [size x field0], [size x field1], ... }
+      std::vector<llvm::Type *> fields;
+      for (const auto &field : std::dynamic_pointer_cast<StructType>(arrayType->getElement())
+                                   ->getFields()) {
+        fields.push_back(llvm::ArrayType::get(getLLVMType(field.type), arrayType->getSize()));
+      }
+      return llvm::StructType::get(context, fields);
+    }
+    return llvm::ArrayType::get(element, arrayType->getSize());
+  } else if (type->getTypeKind() == Type::Kind::VectorType) {
+    auto vectorType = std::dynamic_pointer_cast<VectorType>(type);
+    return llvm::FixedVectorType::get(getLLVMType(vectorType->getElement()),
+                                      vectorType->getLanes());
+  } else if (type->getTypeKind() == Type::Kind::TaskType) {
+    // address of the box of the task (see generate(const SpawnExpr &))
+    return llvm::Type::getInt8PtrTy(context);
+  } else if (type->getTypeKind() == Type::Kind::AtomicType) {
+    // the atomic operations need at least a byte, so an atomic bool is stored in a byte
+    auto element = std::dynamic_pointer_cast<AtomicType>(type)->getElement();
+    return element->isBoolean() ? llvm::Type::getInt8Ty(context) : getLLVMType(element);
+  } else if (type->getTypeKind() == Type::Kind::StructType) {
+    return getLLVMStructType(std::dynamic_pointer_cast<StructType>(type));
   } else {
     reportError("Internal Error - Type not known");
     return nullptr;
   }
 }
 
+llvm::StructType *CodeGeneration::getLLVMStructType(const std::shared_ptr<StructType> &type) {
+  auto found = structTypes.find(type->getName());
+  if (found != structTypes.end()) {
+    return found->second;
+  }
+
+  std::vector<llvm::Type *> fields;
+  for (const auto &field : type->getFields()) {
+    fields.push_back(getLLVMType(field.type));
+  }
+  // The alignment of a vector is its size, so an empty array of a vector of N bytes (after the
+  // fields, so their indices do not change) aligns the struct to N without using any space
+  if (type->getAlignment() > 0) {
+    auto alignment =
+        llvm::FixedVectorType::get(llvm::Type::getInt8Ty(context), type->getAlignment());
+    fields.push_back(llvm::ArrayType::get(alignment, 0));
+  }
+
+  llvm::StructType *structType =
+      llvm::StructType::create(context, fields, "struct." + type->getName(), type->isPacked());
+  structTypes[type->getName()] = structType;
+  return structType;
+}
+
 llvm::Constant *CodeGeneration::getLLVMInit(std::shared_ptr<Type> type) {
   if (type->getTypeKind() == Type::Kind::BasicType) {
     auto basicType = std::dynamic_pointer_cast<BasicType>(type);
@@ -211,6 +698,15 @@ llvm::Constant *CodeGeneration::getLLVMInit(std::shared_ptr<Type> type) {
       return llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), 0);
     case BasicType::Kind::FLOAT:
       return llvm::ConstantFP::get(llvm::Type::getDoubleTy(context), 0);
+    case BasicType::Kind::INT8:
+    case BasicType::Kind::INT16:
+    case BasicType::Kind::INT32:
+    case BasicType::Kind::UINT8:
+    case BasicType::Kind::UINT16:
+    case BasicType::Kind::UINT32:
+    case BasicType::Kind::UINT64:
+    case BasicType::Kind::FLOAT32:
+      return llvm::Constant::getNullValue(getLLVMType(type));
     case BasicType::Kind::STRING:
       return llvm::ConstantPointerNull::get(llvm::Type::getInt8PtrTy(context));
     case BasicType::Kind::VOID:
@@ -223,33 +719,131 @@ llvm::Constant *CodeGeneration::getLLVMInit(std::shared_ptr<Type> type) {
       reportError("Internal Error - Basic Type not known and can not be initialized");
       return nullptr;
     }
+  } else if (type->getTypeKind() == Type::Kind::ArrayType) {
+    // every element to 0 (fixed-size array) or no elements (dynamic array)
+    return llvm::ConstantAggregateZero::get(getLLVMType(type));
+  } else if (type->getTypeKind() == Type::Kind::VectorType) {
+    // every lane to 0
+    return llvm::Constant::getNullValue(getLLVMType(type));
+  } else if (type->getTypeKind() == Type::Kind::TaskType) {
+    // no task (awaiting it is a runtime error)
+    return llvm::ConstantPointerNull::get(llvm::Type::getInt8PtrTy(context));
+  } else if (type->getTypeKind() == Type::Kind::AtomicType) {
+    return llvm::Constant::getNullValue(getLLVMType(type));
+  } else if (type->getTypeKind() == Type::Kind::StructType) {
+    // every field to 0
+    return llvm::Constant::getNullValue(getLLVMType(type));
   } else {
     reportError("Internal Error - Type not known and can not be initialized");
     return nullptr;
   }
 }
 
-std::string CodeGeneration::getIdentifier(const std::shared_ptr<Expr> &node) {
-  if (node->getExprKind() == Expr::Kind::IDENTEXPR) {
-    std::shared_ptr<IdentExpr> identExpr = std::dynamic_pointer_cast<IdentExpr>(node);
+std::shared_ptr<BasicType> CodeGeneration::getScalarType(const std::shared_ptr<Type> &type) {
+  if (type->getTypeKind() == Type::Kind::VectorType) {
+    return std::dynamic_pointer_cast<VectorType>(type)->getElement();
+  }
+  return std::dynamic_pointer_cast<BasicType>(type);
+}
+
+bool CodeGeneration::isFixedSizeArray(const std::shared_ptr<Type> &type) {
+  return type->getTypeKind() == Type::Kind::ArrayType &&
+         !std::dynamic_pointer_cast<ArrayType>(type)->isDynamic();
+}
+
+bool CodeGeneration::isAtomic(const std::shared_ptr<Type> &type) {
+  return type->getTypeKind() == Type::Kind::AtomicType;
+}
+
+bool CodeGeneration::isStructOfArrays(const std::shared_ptr<Type> &type) {
+  if (!isFixedSizeArray(type)) {
+    return false;
+  }
+  auto element = std::dynamic_pointer_cast<StructType>(
+      std::dynamic_pointer_cast<ArrayType>(type)->getElement());
+  return element != nullptr && element->isSoa();
+}
+
+bool CodeGeneration::isPassedByReference(const std::shared_ptr<Type> &type) {
+  return isFixedSizeArray(type) || isAtomic(type);
+}
+
+void CodeGeneration::storeValue(llvm::Value *value, llvm::Value *address,
+                                const std::shared_ptr<Type> &type) {
+  if (isFixedSizeArray(type)) {
+    llvm::Type *arrayType = getLLVMType(type);
+    const llvm::DataLayout &dataLayout = module->getDataLayout();
+    uint64_t size = dataLayout.getTypeAllocSize(arrayType);
+    llvm::Align alignment = dataLayout.getPrefTypeAlign(arrayType);
+    builder->CreateMemCpy(address, alignment, value, alignment, size);
+  } else if (isAtomic(type)) {
+    // an atomic is initialized before it is shared, so it is stored as any other variable (the
+    // value of an atomic bool is stored in a byte, see getLLVMType)
+    builder->CreateStore(builder->CreateZExt(value, getLLVMType(type)), address);
+  } else {
+    builder->CreateStore(value, address);
+  }
+}
+
+llvm::AllocaInst *CodeGeneration::createEntryBlockAlloca(llvm::Type *type,
+                                                         const std::string &name) {
+  llvm::BasicBlock &entryBB = builder->GetInsertBlock()->getParent()->getEntryBlock();
+  llvm::IRBuilder<> entryBuilder(&entryBB, entryBB.begin());
+  return entryBuilder.CreateAlloca(type, nullptr, name);
+}
+
+llvm::Constant *CodeGeneration::generateConstantArray(const Expr &node) {
+  // A struct of arrays is not an LLVM array (see getLLVMType)
+  if (node.getExprKind() != Expr::Kind::ARRAYLITERALEXPR || !isFixedSizeArray(node.getType()) ||
+      isStructOfArrays(node.getType())) {
+    return nullptr;
+  }
+
+  const auto &arrayLiteral = static_cast<const ArrayLiteralExpr &>(node);
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getType());
+  std::vector<llvm::Constant *> elements;
+  for (const auto &element : arrayLiteral.getElements()) {
+    if (element->getExprKind() != Expr::Kind::LITERALEXPR) {
+      return nullptr;
+    }
+    elements.push_back(llvm::cast<llvm::Constant>(generate(*element)));
+  }
+
+  // The elements not written in the literal are initialized to their default value
+  while (static_cast<int64_t>(elements.size()) < arrayType->getSize()) {
+    elements.push_back(getLLVMInit(arrayType->getElement()));
+  }
+  return llvm::ConstantArray::get(llvm::cast<llvm::ArrayType>(getLLVMType(arrayType)), elements);
+}
+
+std::string CodeGeneration::getIdentifier(const Expr &node) {
+  if (node.getExprKind() == Expr::Kind::IDENTEXPR) {
+    const auto &identExpr = static_cast<const IdentExpr &>(node);
     // if it does not have a reference to a declaration is a builtin
-    if(identExpr->getDeclOfIdentifier() == nullptr) {
-      return identExpr->getName();
+    if(identExpr.getDeclOfIdentifier() == nullptr) {
+      return identExpr.getName();
     }
 
     // If it is has a reference to a declaration it has been defined by the user in the src code
-    switch(identExpr->getDeclOfIdentifier()->getDeclKind()) {
-    case Decl::Kind::CONSTDECL:
-      return std::dynamic_pointer_cast<ConstDecl>(identExpr->getDeclOfIdentifier())->getIdentifierMangled();
-    case Decl::Kind::VARDECL:
-      return std::dynamic_pointer_cast<VarDecl>(identExpr->getDeclOfIdentifier())->getIdentifierMangled();
-    case Decl::Kind::PARAMDECL:
-      return std::dynamic_pointer_cast<ParamDecl>(identExpr->getDeclOfIdentifier())->getIdentifierMangled();
-    case Decl::Kind::FUNCDECL:
-      return std::dynamic_pointer_cast<FuncDecl>(identExpr->getDeclOfIdentifier())->getIdentifierMangled();
-    }
+    return getIdentifier(*identExpr.getDeclOfIdentifier());
   } else {
     reportError("Internal Error - Tried to get identifier from expression");
     return "";
   }
+}
+
+std::string CodeGeneration::getIdentifier(const Decl &node) {
+  switch (node.getDeclKind()) {
+  case Decl::Kind::CONSTDECL:
+    return static_cast<const ConstDecl &>(node).getIdentifierMangled();
+  case Decl::Kind::VARDECL:
+    return static_cast<const VarDecl &>(node).getIdentifierMangled();
+  case Decl::Kind::PARAMDECL:
+    return static_cast<const ParamDecl &>(node).getIdentifierMangled();
+  case Decl::Kind::FUNCDECL:
+    return static_cast<const FuncDecl &>(node).getIdentifierMangled();
+  case Decl::Kind::STRUCTDECL:
+    return static_cast<const StructDecl &>(node).getIdentifierToken().value;
+  }
+  return "";
 }
\ No newline at end of file
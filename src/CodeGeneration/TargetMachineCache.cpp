@@ -0,0 +1,224 @@
+//===- src/CodeGeneration/TargetMachineCache.cpp - Impl of TargetMachineCache class -*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the TargetMachineCache class.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "stoc/CodeGeneration/TargetMachineCache.h"
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetOptions.h>
+
+TargetMachineCache &TargetMachineCache::getInstance() {
+  static TargetMachineCache cache;
+  return cache;
+}
+
+/// returns the name of the LLVM target (as in llvm/Config/Targets.def) that generates code for
+/// \arch, or nullptr if the architecture is not known
+static const char *getTargetName(llvm::Triple::ArchType arch) {
+  switch (arch) {
+  case llvm::Triple::aarch64:
+  case llvm::Triple::aarch64_be:
+  case llvm::Triple::aarch64_32:
+    return "AArch64";
+  case llvm::Triple::amdgcn:
+  case llvm::Triple::r600:
+    return "AMDGPU";
+  case llvm::Triple::arm:
+  case llvm::Triple::armeb:
+  case llvm::Triple::thumb:
+  case llvm::Triple::thumbeb:
+    return "ARM";
+  case llvm::Triple::avr:
+    return "AVR";
+  case llvm::Triple::bpfel:
+  case llvm::Triple::bpfeb:
+    return "BPF";
+  case llvm::Triple::hexagon:
+    return "Hexagon";
+  case llvm::Triple::lanai:
+    return "Lanai";
+  case llvm::Triple::m68k:
+    return "M68k";
+  case llvm::Triple::mips:
+  case llvm::Triple::mipsel:
+  case llvm::Triple::mips64:
+  case llvm::Triple::mips64el:
+    return "Mips";
+  case llvm::Triple::msp430:
+    return "MSP430";
+  case llvm::Triple::nvptx:
+  case llvm::Triple::nvptx64:
+    return "NVPTX";
+  case llvm::Triple::ppc:
+  case llvm::Triple::ppcle:
+  case llvm::Triple::ppc64:
+  case llvm::Triple::ppc64le:
+    return "PowerPC";
+  case llvm::Triple::riscv32:
+  case llvm::Triple::riscv64:
+    return "RISCV";
+  case llvm::Triple::sparc:
+  case llvm::Triple::sparcv9:
+  case llvm::Triple::sparcel:
+    return "Sparc";
+  case llvm::Triple::systemz:
+    return "SystemZ";
+  case llvm::Triple::ve:
+    return "VE";
+  case llvm::Triple::wasm32:
+  case llvm::Triple::wasm64:
+    return "WebAssembly";
+  case llvm::Triple::x86:
+  case llvm::Triple::x86_64:
+    return "X86";
+  case llvm::Triple::xcore:
+    return "XCore";
+  default:
+    return nullptr;
+  }
+}
+
+/// returns the function that registers the TargetInfo, Target and TargetMC of \targetName, or
+/// nullptr if LLVM has been built without it
+static void (*getTargetInitializer(const std::string &targetName))() {
+  static const std::unordered_map<std::string, void (*)()> initializers = {
+#define LLVM_TARGET(TargetName)                                                                    \
+  {#TargetName, []() {                                                                             \
+     LLVMInitialize##TargetName##TargetInfo();                                                     \
+     LLVMInitialize##TargetName##Target();                                                         \
+     LLVMInitialize##TargetName##TargetMC();                                                       \
+   }},
+#include <llvm/Config/Targets.def>
+  };
+  auto initializer = initializers.find(targetName);
+  return initializer != initializers.end() ? initializer->second : nullptr;
+}
+
+/// returns the function that registers the asm printer of \targetName, or nullptr if it has none
+static void (*getAsmPrinterInitializer(const std::string &targetName))() {
+  static const std::unordered_map<std::string, void (*)()> initializers = {
+#define LLVM_ASM_PRINTER(TargetName) {#TargetName, LLVMInitialize##TargetName##AsmPrinter},
+#include <llvm/Config/AsmPrinters.def>
+  };
+  auto initializer = initializers.find(targetName);
+  return initializer != initializers.end() ? initializer->second : nullptr;
+}
+
+void TargetMachineCache::initializeTarget(const std::string &triple) {
+  llvm::Triple::ArchType arch = llvm::Triple(triple).getArch();
+  if (arch == llvm::Triple(llvm::sys::getDefaultTargetTriple()).getArch()) {
+    std::call_once(nativeTargetInitialized, []() {
+      llvm::InitializeNativeTarget();
+      llvm::InitializeNativeTargetAsmPrinter();
+    });
+    return;
+  }
+
+  const char *targetName = getTargetName(arch);
+  if (targetName == nullptr) {
+    // The target registry can not tell which target handles \triple until the targets are
+    // registered, so all of them are initialized
+    std::call_once(allTargetsInitialized, []() {
+      llvm::InitializeAllTargetInfos();
+      llvm::InitializeAllTargets();
+      llvm::InitializeAllTargetMCs();
+      llvm::InitializeAllAsmPrinters();
+    });
+    return;
+  }
+
+  // The elements of an unordered_map do not move when others are inserted, so the flag can be used
+  // without holding the lock. If LLVM has been built without the target, lookupTarget reports it
+  std::once_flag *initialized;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    initialized = &targetInitialized[targetName];
+  }
+  std::call_once(*initialized, [targetName]() {
+    if (auto initializeTarget = getTargetInitializer(targetName)) {
+      initializeTarget();
+    }
+    if (auto initializeAsmPrinter = getAsmPrinterInitializer(targetName)) {
+      initializeAsmPrinter();
+    }
+  });
+}
+
+std::string TargetMachineCache::getKey(const std::string &triple, const std::string &cpu,
+                                      const std::string &features) {
+  return triple + "|" + cpu + "|" + features;
+}
+
+std::unique_ptr<llvm::TargetMachine> TargetMachineCache::acquire(const std::string &triple,
+                                                                 const std::string &cpu,
+                                                                 std::string &error) {
+  initializeTarget(triple);
+
+  // The native CPU is the one of the host, with the features it supports (i.e. the vector
+  // extensions SSE4.2, AVX2 or AVX-512)
+  std::string cpuName = cpu;
+  std::string features;
+  if (cpu == "native") {
+    cpuName = llvm::sys::getHostCPUName().str();
+    llvm::StringMap<bool> hostFeatures;
+    if (llvm::sys::getHostCPUFeatures(hostFeatures)) {
+      llvm::SubtargetFeatures subtargetFeatures;
+      for (const auto &feature : hostFeatures) {
+        subtargetFeatures.AddFeature(feature.first(), feature.second);
+      }
+      features = subtargetFeatures.getString();
+    }
+  }
+
+  std::string key = getKey(triple, cpuName, features);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &targetMachines = available[key];
+    if (!targetMachines.empty()) {
+      std::unique_ptr<llvm::TargetMachine> targetMachine = std::move(targetMachines.back());
+      targetMachines.pop_back();
+      return targetMachine;
+    }
+  }
+
+  // This generally occurs if we've forgotten to initialise the TargetRegistry or we have a bogus
+  // target triple.
+  auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+  if (!target) {
+    return nullptr;
+  }
+
+  std::unique_ptr<llvm::MCSubtargetInfo> subtargetInfo(
+      target->createMCSubtargetInfo(triple, "", ""));
+  if (cpuName != "generic" && !subtargetInfo->isCPUStringValid(cpuName)) {
+    error = "Unknown CPU '" + cpuName + "' for target " + triple;
+    return nullptr;
+  }
+
+  llvm::TargetOptions options;
+  auto RM = llvm::Optional<llvm::Reloc::Model>();
+  return std::unique_ptr<llvm::TargetMachine>(
+      target->createTargetMachine(triple, cpuName, features, options, RM));
+}
+
+void TargetMachineCache::release(std::unique_ptr<llvm::TargetMachine> targetMachine) {
+  if (!targetMachine) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::string key = getKey(targetMachine->getTargetTriple().str(),
+                           targetMachine->getTargetCPU().str(),
+                           targetMachine->getTargetFeatureString().str());
+  available[key].push_back(std::move(targetMachine));
+}
@@ -0,0 +1,276 @@
+//===- src/Driver/Driver.cpp - Implementation of the Driver class -------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the Driver class. It reads the arguments and invokes the modules for the
+// different phases.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "stoc/Driver/Driver.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include <cxxopts.hpp>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Path.h>
+
+#include "stoc/AST/ASTPrinter.h"
+#include "stoc/CodeGeneration/CodeGeneration.h"
+#include "stoc/Optimization/BoundsCheckElimination.h"
+#include "stoc/Optimization/ConstantFolding.h"
+#include "stoc/Optimization/FunctionEffects.h"
+#include "stoc/Parser/Parser.h"
+#include "stoc/Repl/Repl.h"
+#include "stoc/SemanticAnalysis/Semantic.h"
+#include "stoc/Server/Protocol.h"
+#include "stoc/Server/Server.h"
+#include "stoc/SrcFile/SrcFile.h"
+
+void initOptions(cxxopts::Options &options) {
+  options.show_positional_help();
+
+  options.add_options("basic")
+      ("h,help", "Print help information")
+      ("i,input", "Path to source code to compile", cxxopts::value<std::string>())
+      ("o,output", "Output file", cxxopts::value<std::string>()->default_value("a.out"))
+      ("tokens-dump", "Show tokens after scannning",
+        cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("ast-dump", "Show AST after parsing",
+      cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("ast-dump-optimized", "Show AST after the optimizations on the AST (constant folding and "
+                             "bounds check elimination)",
+          cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("emit-llvm", "Show LLVM IR generated",
+          cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("O,opt-level", "Optimization level: 0, 1, 2 or 3 (-O2 is accepted as -O 2)",
+          cxxopts::value<unsigned>())
+      ("j,jobs", "Number of threads used by the compiler (default: number of cores)",
+          cxxopts::value<unsigned>())
+      ("target", "Target triple of the code generated (default: the host)",
+          cxxopts::value<std::string>()->default_value(""))
+      ("mcpu", "CPU of the code generated (i.e. skylake), or native for the CPU of the host",
+          cxxopts::value<std::string>()->default_value("generic"))
+      ("ffast-math", "Allow every fast-math optimization of floating-point operations "
+                     "(reassociation, fma contraction, no NaNs nor infinities...)",
+          cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("fp-contract", "Contraction of floating-point operations (i.e. x * y + z into fma): off or "
+                      "fast",
+          cxxopts::value<std::string>()->default_value("off"))
+      ("fno-honor-nans", "Assume that floating-point operations have no NaN operands or results",
+          cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("overflow", "Semantics of integer overflow: wrap (two's complement), nsw (undefined, so it "
+                   "is optimized as if it never happens) or trap (runtime error)",
+          cxxopts::value<std::string>()->default_value("wrap"))
+      ("require-tailcall", "Report the recursive calls of the functions with the attribute tailrec "
+                           "that are not guaranteed tail calls",
+          cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("repl", "Start an interactive session that compiles and executes every input at once",
+          cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
+
+  options.add_options("server")
+      ("server", "Start a compilation server that serves the requests of stoc-client",
+          cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("socket", "Path of the Unix domain socket of the compilation server",
+          cxxopts::value<std::string>()->default_value(protocol::getDefaultSocketPath()));
+
+  options.parse_positional({"input", "output"});
+}
+
+/// rewrites the usual compiler spellings -O<level> (i.e. -O2) and -j<jobs> (i.e. -j4) as
+/// --opt-level=<level> and --jobs=<jobs> because cxxopts would parse them as a group of short
+/// options
+std::vector<std::string> normalizeArguments(std::vector<std::string> arguments) {
+  for (auto &argument : arguments) {
+    if (argument.size() > 2 && argument.compare(0, 2, "-O") == 0) {
+      argument = "--opt-level=" + argument.substr(2);
+    } else if (argument.size() > 2 && argument.compare(0, 2, "-j") == 0) {
+      argument = "--jobs=" + argument.substr(2);
+    }
+  }
+  return arguments;
+}
+
+Driver::Driver() : output(std::cout), error(std::cerr) {}
+
+Driver::Driver(std::ostream &output, std::ostream &error, std::string workingDirectory)
+    : output(output), error(error), workingDirectory(std::move(workingDirectory)) {}
+
+int Driver::run(std::vector<std::string> arguments) {
+  cxxopts::Options options(arguments.at(0), "Compiler for stoc programming language");
+  initOptions(options);
+
+  arguments = normalizeArguments(std::move(arguments));
+  std::vector<char *> argumentsPtrs;
+  for (auto &argument : arguments) {
+    argumentsPtrs.push_back(&argument[0]);
+  }
+  int argumentsCount = argumentsPtrs.size();
+  char **argumentsData = argumentsPtrs.data();
+  auto opt = options.parse(argumentsCount, argumentsData);
+
+  if (opt.count("opt-level") && opt["opt-level"].as<unsigned>() > 3) {
+    error << "Invalid optimization level: it must be 0, 1, 2 or 3" << std::endl;
+    return 1;
+  }
+
+  OverflowMode overflow;
+  const std::string &overflowName = opt["overflow"].as<std::string>();
+  if (overflowName == "wrap") {
+    overflow = OverflowMode::WRAP;
+  } else if (overflowName == "nsw") {
+    overflow = OverflowMode::NSW;
+  } else if (overflowName == "trap") {
+    overflow = OverflowMode::TRAP;
+  } else {
+    error << "Invalid overflow semantics: it must be wrap, nsw or trap" << std::endl;
+    return 1;
+  }
+
+  llvm::FastMathFlags fastMath;
+  if (opt["ffast-math"].as<bool>()) {
+    fastMath.setFast();
+  }
+  const std::string &contract = opt["fp-contract"].as<std::string>();
+  if (contract == "fast") {
+    fastMath.setAllowContract();
+  } else if (contract != "off") {
+    error << "Invalid floating-point contraction: it must be off or fast" << std::endl;
+    return 1;
+  }
+  if (opt["fno-honor-nans"].as<bool>()) {
+    fastMath.setNoNaNs();
+  }
+
+  unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+  if (opt.count("jobs")) {
+    jobs = std::max(1u, opt["jobs"].as<unsigned>());
+  }
+
+  if (opt.count("help")) {
+    output << options.help() << std::endl;
+    return 0;
+  }
+
+  if (opt["server"].as<bool>()) {
+    if (!workingDirectory.empty()) {
+      error << "A compilation server can not be started by a client of the server" << std::endl;
+      return 1;
+    }
+    // Every thread of the server serves one compilation at a time
+    Server server(opt["socket"].as<std::string>(), jobs);
+    return server.run();
+  }
+
+  if (opt["repl"].as<bool>()) {
+    if (!workingDirectory.empty()) {
+      error << "The REPL can not be started by a client of the server" << std::endl;
+      return 1;
+    }
+    Repl repl(jobs);
+    return repl.run();
+  }
+
+  if (!opt.count("input")) {
+    error << "Usage: " << options.get_program() << " <input file>" << std::endl;
+    return 0;
+  }
+
+  try {
+    // Read file. The relative paths of a client are relative to its working directory
+    std::string path = opt["input"].as<std::string>();
+    if (!workingDirectory.empty() && llvm::sys::path::is_relative(path)) {
+      llvm::SmallString<128> absolutePath(workingDirectory);
+      llvm::sys::path::append(absolutePath, path);
+      path = std::string(absolutePath.str());
+    }
+    auto src = std::make_shared<SrcFile>(path);
+    src->setStreams(output, error);
+    // If some option of the compiler is activated like printing tokens, the AST or the LLVM IR, we
+    // assume that the user does not want the executable
+    bool wantsExecutable = true;
+
+    // Parse file (parsing), pulling the tokens from the scanner (lexing) on demand. The tokens are
+    // dumped while the parser pulls them, so the source code is only scanned once
+    Parser parser(src);
+    if (opt["tokens-dump"].as<bool>()) {
+      parser.setTokenListener([&](const Token &token) { output << token << std::endl; });
+      wantsExecutable = false;
+    }
+    parser.parse();
+
+    if (src->isErrorInScanning() || src->isErrorInParsing()) {
+      return 1;
+    }
+
+    // Semantic Analysis
+    Semantic semantic(src, jobs, opt["require-tailcall"].as<bool>());
+    semantic.analyse();
+
+    if (src->isErrorInSemanticAnalysis()) {
+      return 1;
+    }
+
+    auto dumpAst = [&]() {
+      ASTPrinter printer(output);
+      for (const auto &node : src->getAst()) {
+        printer.print(*node);
+      }
+      wantsExecutable = false;
+    };
+
+    if (opt["ast-dump"].as<bool>()) {
+      dumpAst();
+    }
+
+    // Constant folding and propagation (on the AST)
+    ConstantFolding folding(src);
+    folding.fold();
+
+    // Bounds check elimination (on the AST)
+    BoundsCheckElimination boundsCheckElimination(src);
+    boundsCheckElimination.eliminate();
+
+    // Effects of the functions (on the AST), after the bounds checks that remain are known
+    FunctionEffects functionEffects(src, overflow == OverflowMode::TRAP);
+    functionEffects.infer();
+
+    if (opt["ast-dump-optimized"].as<bool>()) {
+      dumpAst();
+    }
+
+    // Code Generation. LLVM is only set up if the LLVM IR or the executable are wanted, so dumping
+    // the tokens or the AST does not pay for it
+    if (!wantsExecutable && !opt["emit-llvm"].as<bool>()) {
+      return 0;
+    }
+
+    CodeGeneration codegen(src, jobs, opt["target"].as<std::string>(),
+                           opt["mcpu"].as<std::string>(), overflow, fastMath);
+    codegen.generate();
+
+    if (opt.count("opt-level") && !src->isErrorInCodeGeneration()) {
+      codegen.optimize(opt["opt-level"].as<unsigned>());
+    }
+
+    if(opt["emit-llvm"].as<bool>()) {
+      codegen.printLLVM();
+      wantsExecutable = false;
+    }
+
+    if(src->isErrorInCodeGeneration()) {
+        return 1;
+    }
+
+    if(wantsExecutable) {
+      codegen.getExecutable(workingDirectory);
+    }
+
+  } catch (std::exception &e) {
+    error << e.what() << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,312 @@
+//===- src/Optimization/BoundsCheckElimination.cpp - Impl of BoundsCheckElimination -*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the BoundsCheckElimination class.
+// Bounds check elimination is an optimization done on the AST after constant folding. It removes
+// the bounds checks of the index expressions whose index is always inside the bounds of the array
+// (i.e. the induction variable of a loop that goes from 0 to the length of the array).
+//
+//===------------------------------------------------------------------------------------------===//
+#include "stoc/Optimization/BoundsCheckElimination.h"
+
+#include <limits>
+
+BoundsCheckElimination::BoundsCheckElimination(std::shared_ptr<SrcFile> file) : file(file) {}
+
+void BoundsCheckElimination::eliminate() {
+  for (const auto &declaration : file->getAst()) {
+    visit(*declaration);
+  }
+}
+
+// HELPER METHODS
+
+const Decl *BoundsCheckElimination::getVariable(const Expr &node) {
+  if (node.getExprKind() != Expr::Kind::IDENTEXPR) {
+    return nullptr;
+  }
+
+  const auto &decl = static_cast<const IdentExpr &>(node).getDeclOfIdentifier();
+  if (decl == nullptr || decl->getDeclKind() == Decl::Kind::FUNCDECL) {
+    return nullptr;
+  }
+  return decl.get();
+}
+
+bool BoundsCheckElimination::getIntLiteral(const Expr &node, std::int64_t &value) {
+  if (node.getExprKind() != Expr::Kind::LITERALEXPR) {
+    return false;
+  }
+
+  const Token &token = static_cast<const LiteralExpr &>(node).getToken();
+  if (token.tokenType != LIT_INT) {
+    return false;
+  }
+  try {
+    value = std::stoll(token.value);
+  } catch (std::exception &e) {
+    return false;
+  }
+  return true;
+}
+
+bool BoundsCheckElimination::isAssigned(const Decl *variable, const Stmt &node) {
+  // Variables can only be modified by an assignment statement (there are no pointers), so it is
+  // enough to look for them
+  switch (node.getStmtKind()) {
+  case Stmt::Kind::ASSIGNMENTSTMT:
+    return getVariable(*static_cast<const AssignmentStmt &>(node).getLhs()) == variable;
+  case Stmt::Kind::BLOCKSTMT:
+    for (const auto &stmt : static_cast<const BlockStmt &>(node).getStmts()) {
+      if (isAssigned(variable, *stmt)) {
+        return true;
+      }
+    }
+    return false;
+  case Stmt::Kind::IFSTMT: {
+    const auto &ifStmt = static_cast<const IfStmt &>(node);
+    return isAssigned(variable, *ifStmt.getThenBranch()) ||
+           (ifStmt.isHasElse() && isAssigned(variable, *ifStmt.getElseBranch()));
+  }
+  case Stmt::Kind::FORSTMT: {
+    const auto &forStmt = static_cast<const ForStmt &>(node);
+    return (forStmt.getInit() != nullptr && isAssigned(variable, *forStmt.getInit())) ||
+           (forStmt.getPost() != nullptr && isAssigned(variable, *forStmt.getPost())) ||
+           isAssigned(variable, *forStmt.getBody());
+  }
+  case Stmt::Kind::WHILESTMT:
+    return isAssigned(variable, *static_cast<const WhileStmt &>(node).getBody());
+  default:
+    return false;
+  }
+}
+
+bool BoundsCheckElimination::getInductionVariable(const ForStmt &node,
+                                                  InductionVariable &inductionVariable) {
+  if (node.getInit() == nullptr || node.getCond() == nullptr || node.getPost() == nullptr) {
+    return false;
+  }
+
+  // Initialization: var int i = <literal >= 0>;
+  if (node.getInit()->getStmtKind() != Stmt::Kind::DECLARATIONSTMT) {
+    return false;
+  }
+  const auto &decl = static_cast<const DeclarationStmt &>(*node.getInit()).getDecl();
+  std::int64_t start;
+  if (decl->getDeclKind() != Decl::Kind::VARDECL ||
+      !getIntLiteral(*static_cast<const VarDecl &>(*decl).getValue(), start) || start < 0) {
+    return false;
+  }
+  const Decl *variable = decl.get();
+
+  // Post statement: i = i + <literal > 0>
+  if (node.getPost()->getStmtKind() != Stmt::Kind::ASSIGNMENTSTMT) {
+    return false;
+  }
+  const auto &post = static_cast<const AssignmentStmt &>(*node.getPost());
+  if (getVariable(*post.getLhs()) != variable ||
+      post.getRhs()->getExprKind() != Expr::Kind::BINARYEXPR) {
+    return false;
+  }
+  const auto &increment = static_cast<const BinaryExpr &>(*post.getRhs());
+  std::int64_t step;
+  if (increment.getOp().tokenType != ADD || getVariable(*increment.getLhs()) != variable ||
+      !getIntLiteral(*increment.getRhs(), step) || step <= 0 ||
+      step > std::numeric_limits<std::int32_t>::max()) {
+    return false;
+  }
+
+  // Condition: i < <literal>, i <= <literal> or i < len(a)
+  if (node.getCond()->getExprKind() != Expr::Kind::BINARYEXPR) {
+    return false;
+  }
+  const auto &cond = static_cast<const BinaryExpr &>(*node.getCond());
+  if (getVariable(*cond.getLhs()) != variable) {
+    return false;
+  }
+  TokenType op = cond.getOp().tokenType;
+  std::int64_t bound;
+  const Decl *lengthOf = nullptr;
+  if ((op == LESS || op == LESS_EQUAL) && getIntLiteral(*cond.getRhs(), bound)) {
+    // i + step can not overflow, so i never becomes negative
+    if (bound > std::numeric_limits<std::int32_t>::max()) {
+      return false;
+    }
+    bound = op == LESS_EQUAL ? bound + 1 : bound;
+  } else if (op == LESS && cond.getRhs()->getExprKind() == Expr::Kind::CALLEXPR) {
+    const auto &call = static_cast<const CallExpr &>(*cond.getRhs());
+    const auto &func = static_cast<const IdentExpr &>(*call.getFunc());
+    // the builtin len has no declaration
+    if (func.getName() != "len" || func.getDeclOfIdentifier() != nullptr ||
+        call.getArgs().size() != 1) {
+      return false;
+    }
+    lengthOf = getVariable(*call.getArgs()[0]);
+    // A global array could be modified by a function called in the loop
+    if (lengthOf == nullptr || (lengthOf->getDeclKind() == Decl::Kind::VARDECL &&
+                                static_cast<const VarDecl *>(lengthOf)->isGlobal())) {
+      return false;
+    }
+    if (isAssigned(lengthOf, *node.getPost()) || isAssigned(lengthOf, *node.getBody())) {
+      return false;
+    }
+    bound = 0;
+  } else {
+    return false;
+  }
+
+  if (isAssigned(variable, *node.getBody())) {
+    return false;
+  }
+
+  inductionVariable = {variable, bound, lengthOf};
+  return true;
+}
+
+// DECLARATIONS
+
+void BoundsCheckElimination::visit(VarDecl &node) { visit(*node.getValue()); }
+
+void BoundsCheckElimination::visit(ConstDecl &node) { visit(*node.getValue()); }
+
+void BoundsCheckElimination::visit(ParamDecl &node) {}
+
+void BoundsCheckElimination::visit(FuncDecl &node) { visit(*node.getBody()); }
+
+void BoundsCheckElimination::visit(StructDecl &node) {}
+
+// STATEMENTS
+
+void BoundsCheckElimination::visit(DeclarationStmt &node) { visit(*node.getDecl()); }
+
+void BoundsCheckElimination::visit(ExpressionStmt &node) { visit(*node.getExpr()); }
+
+void BoundsCheckElimination::visit(BlockStmt &node) {
+  for (const auto &stmt : node.getStmts()) {
+    visit(*stmt);
+  }
+}
+
+void BoundsCheckElimination::visit(IfStmt &node) {
+  visit(*node.getCondition());
+  visit(*node.getThenBranch());
+  if (node.isHasElse()) {
+    visit(*node.getElseBranch());
+  }
+}
+
+void BoundsCheckElimination::visit(ForStmt &node) {
+  if (node.getInit() != nullptr) {
+    visit(*node.getInit());
+  }
+  if (node.getCond() != nullptr) {
+    visit(*node.getCond());
+  }
+  if (node.getPost() != nullptr) {
+    visit(*node.getPost());
+  }
+
+  // The range of the induction variable is only known inside the body, after checking the
+  // condition
+  InductionVariable inductionVariable{};
+  bool hasInductionVariable = getInductionVariable(node, inductionVariable);
+  if (hasInductionVariable) {
+    inductionVariables.push_back(inductionVariable);
+  }
+  visit(*node.getBody());
+  if (hasInductionVariable) {
+    inductionVariables.pop_back();
+  }
+}
+
+void BoundsCheckElimination::visit(WhileStmt &node) {
+  visit(*node.getCond());
+  visit(*node.getBody());
+}
+
+void BoundsCheckElimination::visit(AssignmentStmt &node) {
+  visit(*node.getLhs());
+  visit(*node.getRhs());
+}
+
+void BoundsCheckElimination::visit(ReturnStmt &node) {
+  if (node.getValue() != nullptr) {
+    visit(*node.getValue());
+  }
+}
+
+void BoundsCheckElimination::visit(BreakStmt &node) {}
+
+void BoundsCheckElimination::visit(ContinueStmt &node) {}
+
+// EXPRESSIONS
+
+void BoundsCheckElimination::visit(BinaryExpr &node) {
+  visit(*node.getLhs());
+  visit(*node.getRhs());
+}
+
+void BoundsCheckElimination::visit(UnaryExpr &node) { visit(*node.getRhs()); }
+
+void BoundsCheckElimination::visit(LiteralExpr &node) {}
+
+void BoundsCheckElimination::visit(IdentExpr &node) {}
+
+void BoundsCheckElimination::visit(CallExpr &node) {
+  for (const auto &arg : node.getArgs()) {
+    visit(*arg);
+  }
+}
+
+void BoundsCheckElimination::visit(IndexExpr &node) {
+  visit(*node.getArray());
+  visit(*node.getIndex());
+
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getArray()->getType());
+  if (arrayType == nullptr) {
+    return;
+  }
+
+  // Literal index of a fixed-size array
+  std::int64_t index;
+  if (getIntLiteral(*node.getIndex(), index)) {
+    if (!arrayType->isDynamic() && index >= 0 && index < arrayType->getSize()) {
+      node.setBoundsCheck(false);
+    }
+    return;
+  }
+
+  // Induction variable of a loop whose range is inside the bounds of the array
+  const Decl *variable = getVariable(*node.getIndex());
+  if (variable == nullptr) {
+    return;
+  }
+  for (const auto &inductionVariable : inductionVariables) {
+    if (inductionVariable.variable != variable) {
+      continue;
+    }
+
+    if (inductionVariable.lengthOf == nullptr) {
+      if (!arrayType->isDynamic() && inductionVariable.bound <= arrayType->getSize()) {
+        node.setBoundsCheck(false);
+      }
+    } else if (getVariable(*node.getArray()) == inductionVariable.lengthOf) {
+      node.setBoundsCheck(false);
+    }
+  }
+}
+
+void BoundsCheckElimination::visit(FieldExpr &node) { visit(*node.getOperand()); }
+
+void BoundsCheckElimination::visit(ArrayLiteralExpr &node) {
+  for (const auto &element : node.getElements()) {
+    visit(*element);
+  }
+}
+
+void BoundsCheckElimination::visit(ConversionExpr &node) { visit(*node.getValue()); }
+
+void BoundsCheckElimination::visit(SpawnExpr &node) { visit(*node.getCall()); }
+
+void BoundsCheckElimination::visit(AwaitExpr &node) { visit(*node.getTask()); }
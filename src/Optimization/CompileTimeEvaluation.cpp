@@ -0,0 +1,506 @@
+//===- src/Optimization/CompileTimeEvaluation.cpp - Impl of CompileTimeEvaluation ---*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the CompileTimeEvaluation class.
+// Compile-time evaluation is an interpreter of the AST used by constant folding. The arithmetic
+// follows the rules of constant folding: the operations that can not be folded (i.e. an integer
+// overflow or a division by zero) stop the evaluation, so the call is executed at runtime, where
+// they behave as the options of the compiler request.
+//
+//===------------------------------------------------------------------------------------------===//
+#include "stoc/Optimization/CompileTimeEvaluation.h"
+
+#include <limits>
+
+CompileTimeEvaluation::CompileTimeEvaluation(uint64_t maxSteps, std::size_t maxDepth)
+    : maxSteps(maxSteps), maxDepth(maxDepth), steps(0) {}
+
+bool CompileTimeEvaluation::evaluateCall(const CallExpr &node, Value &result) {
+  steps = 0;
+  frames.clear();
+  try {
+    result = evaluate(node);
+    return true;
+  } catch (std::exception &e) {
+    // EvaluationError or an error converting a literal (i.e. out of range)
+    frames.clear();
+    return false;
+  }
+}
+
+// HELPER METHODS
+
+void CompileTimeEvaluation::step() {
+  if (++steps > maxSteps) {
+    throw EvaluationError();
+  }
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::call(const FuncDecl &function,
+                                                         const std::vector<Value> &args) {
+  step();
+  if (frames.size() >= maxDepth || !function.isHasReturnType()) {
+    throw EvaluationError();
+  }
+
+  Frame frame;
+  for (std::size_t i = 0; i < args.size(); i++) {
+    frame.variables[function.getParams()[i].get()] = args[i];
+  }
+  frames.push_back(std::move(frame));
+  if (execute(*function.getBody()) != Flow::RETURN) {
+    throw EvaluationError();
+  }
+  Value result = frames.back().result;
+  frames.pop_back();
+  return result;
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::lookup(const Decl &decl) {
+  if (decl.getDeclKind() == Decl::Kind::CONSTDECL &&
+      static_cast<const ConstDecl &>(decl).isGlobal()) {
+    const auto &value = static_cast<const ConstDecl &>(decl).getValue();
+    if (value->getExprKind() != Expr::Kind::LITERALEXPR) {
+      throw EvaluationError();
+    }
+    return fromLiteral(static_cast<const LiteralExpr &>(*value));
+  }
+
+  // a call made outside of a function (i.e. in an argument) has no variables
+  if (frames.empty()) {
+    throw EvaluationError();
+  }
+  auto found = frames.back().variables.find(&decl);
+  if (found == frames.back().variables.end()) {
+    throw EvaluationError();
+  }
+  return found->second;
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::fromLiteral(const LiteralExpr &node) {
+  auto type = std::dynamic_pointer_cast<BasicType>(node.getType());
+  if (type == nullptr) {
+    throw EvaluationError();
+  }
+
+  Value value;
+  value.kind = type->getKind();
+  switch (value.kind) {
+  case BasicType::Kind::INT:
+    value.intValue = std::stoll(node.getToken().value);
+    break;
+  case BasicType::Kind::FLOAT:
+    value.floatValue = std::stod(node.getToken().value);
+    break;
+  case BasicType::Kind::BOOL:
+    value.boolValue = node.getToken().value == "true";
+    break;
+  default:
+    throw EvaluationError();
+  }
+  return value;
+}
+
+CompileTimeEvaluation::Value
+CompileTimeEvaluation::evaluateBinaryExprInt(const BinaryExpr &node, const Value &lhs,
+                                             const Value &rhs) {
+  int64_t l = lhs.intValue;
+  int64_t r = rhs.intValue;
+  auto ur = static_cast<uint64_t>(r);
+
+  Value value;
+  value.kind = BasicType::Kind::INT;
+  bool overflow = false;
+  switch (node.getOp().tokenType) {
+  case ADD:
+    overflow = __builtin_add_overflow(l, r, &value.intValue);
+    break;
+  case SUB:
+    overflow = __builtin_sub_overflow(l, r, &value.intValue);
+    break;
+  case STAR:
+    overflow = __builtin_mul_overflow(l, r, &value.intValue);
+    break;
+  case SLASH:
+  case PERCENT:
+    if (r == 0 || (l == std::numeric_limits<int64_t>::min() && r == -1)) {
+      throw EvaluationError();
+    }
+    value.intValue = node.getOp().tokenType == SLASH ? l / r : l % r;
+    break;
+  case AMPERSAND:
+    value.intValue = l & r;
+    break;
+  case PIPE:
+    value.intValue = l | r;
+    break;
+  case CARET:
+    value.intValue = l ^ r;
+    break;
+  case SHIFT_LEFT:
+    // The shift amount is taken modulo 64 like in the generated code
+    value.intValue = static_cast<int64_t>(static_cast<uint64_t>(l) << (ur & 63));
+    break;
+  case SHIFT_RIGHT:
+    value.intValue = l >> (ur & 63);
+    break;
+  default:
+    value.kind = BasicType::Kind::BOOL;
+    switch (node.getOp().tokenType) {
+    case EQUAL:
+      value.boolValue = l == r;
+      break;
+    case NOT_EQUAL:
+      value.boolValue = l != r;
+      break;
+    case LESS:
+      value.boolValue = l < r;
+      break;
+    case GREATER:
+      value.boolValue = l > r;
+      break;
+    case LESS_EQUAL:
+      value.boolValue = l <= r;
+      break;
+    case GREATER_EQUAL:
+      value.boolValue = l >= r;
+      break;
+    default:
+      throw EvaluationError();
+    }
+  }
+
+  if (overflow) {
+    throw EvaluationError();
+  }
+  return value;
+}
+
+CompileTimeEvaluation::Value
+CompileTimeEvaluation::evaluateBinaryExprFloat(const BinaryExpr &node, const Value &lhs,
+                                               const Value &rhs) {
+  double l = lhs.floatValue;
+  double r = rhs.floatValue;
+
+  Value value;
+  value.kind = BasicType::Kind::FLOAT;
+  switch (node.getOp().tokenType) {
+  case ADD:
+    value.floatValue = l + r;
+    return value;
+  case SUB:
+    value.floatValue = l - r;
+    return value;
+  case STAR:
+    value.floatValue = l * r;
+    return value;
+  case SLASH:
+    value.floatValue = l / r;
+    return value;
+  default:
+    break;
+  }
+
+  value.kind = BasicType::Kind::BOOL;
+  switch (node.getOp().tokenType) {
+  case EQUAL:
+    value.boolValue = l == r;
+    break;
+  case NOT_EQUAL:
+    // Same semantics as the generated code (ordered comparison: false if any operand is NaN)
+    value.boolValue = l < r || l > r;
+    break;
+  case LESS:
+    value.boolValue = l < r;
+    break;
+  case GREATER:
+    value.boolValue = l > r;
+    break;
+  case LESS_EQUAL:
+    value.boolValue = l <= r;
+    break;
+  case GREATER_EQUAL:
+    value.boolValue = l >= r;
+    break;
+  default:
+    throw EvaluationError();
+  }
+  return value;
+}
+
+CompileTimeEvaluation::Value
+CompileTimeEvaluation::evaluateBinaryExprBool(const BinaryExpr &node, const Value &lhs,
+                                              const Value &rhs) {
+  bool l = lhs.boolValue;
+  bool r = rhs.boolValue;
+
+  Value value;
+  value.kind = BasicType::Kind::BOOL;
+  switch (node.getOp().tokenType) {
+  case EQUAL:
+    value.boolValue = l == r;
+    break;
+  case NOT_EQUAL:
+    value.boolValue = l != r;
+    break;
+  case LAND:
+    value.boolValue = l && r;
+    break;
+  case LOR:
+    value.boolValue = l || r;
+    break;
+  default:
+    throw EvaluationError();
+  }
+  return value;
+}
+
+// STATEMENTS
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const Stmt &node) {
+  step();
+  switch (node.getStmtKind()) {
+  case Stmt::Kind::DECLARATIONSTMT:
+    return execute(static_cast<const DeclarationStmt &>(node));
+  case Stmt::Kind::EXPRESSIONSTMT:
+    // the expressions of a pure function have no effects, but they can stop the evaluation
+    evaluate(*static_cast<const ExpressionStmt &>(node).getExpr());
+    return Flow::NEXT;
+  case Stmt::Kind::BLOCKSTMT:
+    return execute(static_cast<const BlockStmt &>(node));
+  case Stmt::Kind::IFSTMT:
+    return execute(static_cast<const IfStmt &>(node));
+  case Stmt::Kind::FORSTMT:
+    return execute(static_cast<const ForStmt &>(node));
+  case Stmt::Kind::WHILESTMT:
+    return execute(static_cast<const WhileStmt &>(node));
+  case Stmt::Kind::ASSIGNMENTSTMT:
+    return execute(static_cast<const AssignmentStmt &>(node));
+  case Stmt::Kind::RETURNSTMT:
+    return execute(static_cast<const ReturnStmt &>(node));
+  case Stmt::Kind::BREAKSTMT:
+    return Flow::BREAK;
+  case Stmt::Kind::CONTINUESTMT:
+    return Flow::CONTINUE;
+  }
+  throw EvaluationError();
+}
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const DeclarationStmt &node) {
+  const auto &decl = *node.getDecl();
+  if (decl.getDeclKind() == Decl::Kind::VARDECL) {
+    Value value = evaluate(*static_cast<const VarDecl &>(decl).getValue());
+    frames.back().variables[&decl] = value;
+  } else if (decl.getDeclKind() == Decl::Kind::CONSTDECL) {
+    Value value = evaluate(*static_cast<const ConstDecl &>(decl).getValue());
+    frames.back().variables[&decl] = value;
+  } else {
+    throw EvaluationError();
+  }
+  return Flow::NEXT;
+}
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const BlockStmt &node) {
+  for (const auto &stmt : node.getStmts()) {
+    Flow flow = execute(*stmt);
+    if (flow != Flow::NEXT) {
+      return flow;
+    }
+  }
+  return Flow::NEXT;
+}
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const IfStmt &node) {
+  if (evaluate(*node.getCondition()).boolValue) {
+    return execute(*node.getThenBranch());
+  }
+  if (node.isHasElse()) {
+    return execute(*node.getElseBranch());
+  }
+  return Flow::NEXT;
+}
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const ForStmt &node) {
+  if (node.isParallel()) {
+    throw EvaluationError();
+  }
+
+  if (node.getInit() != nullptr) {
+    execute(*node.getInit());
+  }
+  while (node.getCond() == nullptr || evaluate(*node.getCond()).boolValue) {
+    Flow flow = execute(*node.getBody());
+    if (flow == Flow::BREAK) {
+      break;
+    } else if (flow == Flow::RETURN) {
+      return flow;
+    }
+    if (node.getPost() != nullptr) {
+      execute(*node.getPost());
+    }
+    step();
+  }
+  return Flow::NEXT;
+}
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const WhileStmt &node) {
+  while (evaluate(*node.getCond()).boolValue) {
+    Flow flow = execute(*node.getBody());
+    if (flow == Flow::BREAK) {
+      break;
+    } else if (flow == Flow::RETURN) {
+      return flow;
+    }
+    step();
+  }
+  return Flow::NEXT;
+}
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const AssignmentStmt &node) {
+  // only variables are assigned, a pure function does not modify the elements of an array
+  if (node.getLhs()->getExprKind() != Expr::Kind::IDENTEXPR) {
+    throw EvaluationError();
+  }
+  const auto &decl = static_cast<const IdentExpr &>(*node.getLhs()).getDeclOfIdentifier();
+  Value value = evaluate(*node.getRhs());
+  auto found = frames.back().variables.find(decl.get());
+  if (found == frames.back().variables.end()) {
+    throw EvaluationError();
+  }
+  found->second = value;
+  return Flow::NEXT;
+}
+
+CompileTimeEvaluation::Flow CompileTimeEvaluation::execute(const ReturnStmt &node) {
+  if (node.getValue() == nullptr) {
+    throw EvaluationError();
+  }
+  Value value = evaluate(*node.getValue());
+  frames.back().result = value;
+  return Flow::RETURN;
+}
+
+// EXPRESSIONS
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::evaluate(const Expr &node) {
+  switch (node.getExprKind()) {
+  case Expr::Kind::BINARYEXPR:
+    return evaluate(static_cast<const BinaryExpr &>(node));
+  case Expr::Kind::UNARYEXPR:
+    return evaluate(static_cast<const UnaryExpr &>(node));
+  case Expr::Kind::LITERALEXPR:
+    return fromLiteral(static_cast<const LiteralExpr &>(node));
+  case Expr::Kind::IDENTEXPR:
+    return evaluate(static_cast<const IdentExpr &>(node));
+  case Expr::Kind::CALLEXPR:
+    return evaluate(static_cast<const CallExpr &>(node));
+  case Expr::Kind::CONVERSIONEXPR:
+    return evaluate(static_cast<const ConversionExpr &>(node));
+  default:
+    // arrays, vectors, structs and tasks are not values of the evaluation
+    throw EvaluationError();
+  }
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::evaluate(const BinaryExpr &node) {
+  // Both operands are evaluated, like in the generated code (&& and || do not short-circuit)
+  Value lhs = evaluate(*node.getLhs());
+  Value rhs = evaluate(*node.getRhs());
+  if (lhs.kind != rhs.kind) {
+    throw EvaluationError();
+  }
+
+  switch (lhs.kind) {
+  case BasicType::Kind::INT:
+    return evaluateBinaryExprInt(node, lhs, rhs);
+  case BasicType::Kind::FLOAT:
+    return evaluateBinaryExprFloat(node, lhs, rhs);
+  case BasicType::Kind::BOOL:
+    return evaluateBinaryExprBool(node, lhs, rhs);
+  default:
+    throw EvaluationError();
+  }
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::evaluate(const UnaryExpr &node) {
+  Value value = evaluate(*node.getRhs());
+  TokenType op = node.getOp().tokenType;
+  if (op == ADD && value.kind != BasicType::Kind::BOOL) {
+    return value;
+  }
+
+  switch (value.kind) {
+  case BasicType::Kind::INT:
+    if (op == SUB && value.intValue != std::numeric_limits<int64_t>::min()) {
+      value.intValue = -value.intValue;
+      return value;
+    } else if (op == TILDE) {
+      value.intValue = ~value.intValue;
+      return value;
+    }
+    break;
+  case BasicType::Kind::FLOAT:
+    if (op == SUB) {
+      value.floatValue = -value.floatValue;
+      return value;
+    }
+    break;
+  case BasicType::Kind::BOOL:
+    if (op == NOT) {
+      value.boolValue = !value.boolValue;
+      return value;
+    }
+    break;
+  default:
+    break;
+  }
+  throw EvaluationError();
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::evaluate(const IdentExpr &node) {
+  if (node.getDeclOfIdentifier() == nullptr) {
+    throw EvaluationError();
+  }
+  return lookup(*node.getDeclOfIdentifier());
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::evaluate(const CallExpr &node) {
+  // the builtin functions (without declaration) and the values of structs are not evaluated
+  const auto &decl = static_cast<const IdentExpr &>(*node.getFunc()).getDeclOfIdentifier();
+  if (decl == nullptr || decl->getDeclKind() != Decl::Kind::FUNCDECL) {
+    throw EvaluationError();
+  }
+
+  std::vector<Value> args;
+  for (const auto &arg : node.getArgs()) {
+    args.push_back(evaluate(*arg));
+  }
+  return call(static_cast<const FuncDecl &>(*decl), args);
+}
+
+CompileTimeEvaluation::Value CompileTimeEvaluation::evaluate(const ConversionExpr &node) {
+  Value value = evaluate(*node.getValue());
+  auto to = std::dynamic_pointer_cast<BasicType>(node.getType());
+  if (to == nullptr) {
+    throw EvaluationError();
+  }
+
+  if (to->getKind() == value.kind) {
+    return value;
+  } else if (to->getKind() == BasicType::Kind::FLOAT && value.kind == BasicType::Kind::INT) {
+    value.kind = BasicType::Kind::FLOAT;
+    value.floatValue = static_cast<double>(value.intValue);
+    return value;
+  } else if (to->getKind() == BasicType::Kind::INT && value.kind == BasicType::Kind::FLOAT) {
+    // a float out of the range of int has no defined conversion
+    if (!(value.floatValue >= -0x1p63 && value.floatValue < 0x1p63)) {
+      throw EvaluationError();
+    }
+    value.kind = BasicType::Kind::INT;
+    value.intValue = static_cast<int64_t>(value.floatValue);
+    return value;
+  }
+  // the fixed-width types are not values of the evaluation
+  throw EvaluationError();
+}
@@ -0,0 +1,610 @@
+//===- src/Optimization/ConstantFolding.cpp - Impl of ConstantFolding class ---------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the ConstantFolding class.
+// Constant folding is an optimization done on the AST after the semantic analysis. It evaluates at
+// compile time the expressions whose operands are literals (i.e. 5 + 5 * (7 - 4) / 3 -> 10),
+// replaces the uses of constants initialized with a literal by the literal (constant propagation)
+// and removes the branches of if and while statements whose condition is a constant. The calls to
+// const functions whose arguments are literals are evaluated (see CompileTimeEvaluation), so the
+// initial values of globals and the bounds of loops become literals.
+//
+//===------------------------------------------------------------------------------------------===//
+#include "stoc/Optimization/ConstantFolding.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+ConstantFolding::ConstantFolding(std::shared_ptr<SrcFile> file)
+    : file(file), stmtReplaced(false) {}
+
+void ConstantFolding::fold() {
+  for (const auto &declaration : file->getAst()) {
+    visit(*declaration);
+  }
+}
+
+// HELPER METHODS
+
+std::shared_ptr<LiteralExpr> ConstantFolding::makeLiteral(TokenType tokenType,
+                                                          const std::string &value,
+                                                          const Token &position,
+                                                          const std::shared_ptr<Type> &type) {
+  Token token(tokenType, position.begin, position.line, position.column, value);
+  auto literal = std::make_shared<LiteralExpr>(token);
+  literal->setType(type);
+  literal->setExprValueKind(Expr::ValueKind::RVal);
+  return literal;
+}
+
+std::shared_ptr<LiteralExpr> ConstantFolding::makeIntLiteral(int64_t value,
+                                                             const Token &position) {
+  return makeLiteral(LIT_INT, std::to_string(value), position, BasicType::getIntType());
+}
+
+std::shared_ptr<LiteralExpr> ConstantFolding::makeFloatLiteral(double value,
+                                                               const Token &position) {
+  // The shortest representation that gives back the same value is used, so no precision is lost
+  // and the value is readable when printing the AST
+  char buffer[32];
+  for (int precision = 1; precision <= std::numeric_limits<double>::max_digits10; precision++) {
+    std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    if (std::stod(buffer) == value) {
+      break;
+    }
+  }
+  return makeLiteral(LIT_FLOAT, buffer, position, BasicType::getFloatType());
+}
+
+std::shared_ptr<LiteralExpr> ConstantFolding::makeBoolLiteral(bool value, const Token &position) {
+  return makeLiteral(value ? LIT_TRUE : LIT_FALSE, value ? "true" : "false", position,
+                     BasicType::getBoolType());
+}
+
+int64_t ConstantFolding::getIntValue(const LiteralExpr &node) {
+  return std::stoll(node.getToken().value);
+}
+
+double ConstantFolding::getFloatValue(const LiteralExpr &node) {
+  return std::stod(node.getToken().value);
+}
+
+bool ConstantFolding::getBoolValue(const LiteralExpr &node) {
+  return node.getToken().value == "true";
+}
+
+const LiteralExpr *ConstantFolding::asLiteral(const Expr &node) {
+  if (node.getExprKind() == Expr::Kind::LITERALEXPR) {
+    return static_cast<const LiteralExpr *>(&node);
+  }
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::foldExpr(Expr &node) {
+  replacementExpr = nullptr;
+  visit(node);
+  return std::move(replacementExpr);
+}
+
+bool ConstantFolding::foldStmt(Stmt &node, std::shared_ptr<Stmt> &replacement) {
+  stmtReplaced = false;
+  visit(node);
+  if (!stmtReplaced) {
+    return false;
+  }
+  stmtReplaced = false;
+  replacement = std::move(replacementStmt);
+  return true;
+}
+
+void ConstantFolding::foldArgs(CallExpr &node) {
+  for (std::size_t idx = 0; idx < node.getArgs().size(); idx++) {
+    if (auto arg = foldExpr(*node.getArgs()[idx])) {
+      node.setArg(idx, arg);
+    }
+  }
+}
+
+// DECLARATIONS
+
+void ConstantFolding::visit(VarDecl &node) {
+  if (auto value = foldExpr(*node.getValue())) {
+    node.setValue(value);
+  }
+}
+
+void ConstantFolding::visit(ConstDecl &node) {
+  // The initializer is folded before any use of the constant is visited (constants have to be
+  // declared before being used), so if it becomes a literal, it can be propagated to every use
+  if (auto value = foldExpr(*node.getValue())) {
+    node.setValue(value);
+  }
+}
+
+void ConstantFolding::visit(ParamDecl & /*node*/) {} // parameters do not contain expressions
+
+void ConstantFolding::visit(FuncDecl &node) { visit(*node.getBody()); }
+
+void ConstantFolding::visit(StructDecl & /*node*/) {} // structs do not contain expressions
+
+// STATEMENTS
+
+void ConstantFolding::visit(DeclarationStmt &node) { visit(*node.getDecl()); }
+
+void ConstantFolding::visit(ExpressionStmt &node) {
+  if (auto expr = foldExpr(*node.getExpr())) {
+    node.setExpr(expr);
+  }
+}
+
+void ConstantFolding::visit(BlockStmt &node) {
+  // The list of statements is only rebuilt if a statement is replaced or removed
+  std::vector<std::shared_ptr<Stmt>> stmts;
+  bool changed = false;
+  const auto &oldStmts = node.getStmts();
+  for (std::size_t idx = 0; idx < oldStmts.size(); idx++) {
+    std::shared_ptr<Stmt> replacement;
+    if (foldStmt(*oldStmts[idx], replacement)) {
+      if (!changed) {
+        stmts.assign(oldStmts.begin(), oldStmts.begin() + idx);
+        changed = true;
+      }
+      if (replacement != nullptr) {
+        stmts.push_back(std::move(replacement));
+      }
+    } else if (changed) {
+      stmts.push_back(oldStmts[idx]);
+    }
+  }
+  if (changed) {
+    node.setStmts(stmts);
+  }
+}
+
+void ConstantFolding::visit(IfStmt &node) {
+  if (auto condition = foldExpr(*node.getCondition())) {
+    node.setCondition(condition);
+  }
+  visit(*node.getThenBranch());
+  if (node.isHasElse()) {
+    // An else branch that is an if statement with a false condition and no else branch disappears
+    std::shared_ptr<Stmt> elseBranch;
+    if (foldStmt(*node.getElseBranch(), elseBranch)) {
+      node.setElseBranch(elseBranch);
+    }
+  }
+
+  // If the condition is constant, only the branch that is going to be executed is kept
+  if (auto condition = asLiteral(*node.getCondition())) {
+    stmtReplaced = true;
+    if (getBoolValue(*condition)) {
+      replacementStmt = node.getThenBranch();
+    } else {
+      replacementStmt = node.isHasElse() ? node.getElseBranch() : nullptr;
+    }
+  }
+}
+
+void ConstantFolding::visit(ForStmt &node) {
+  // Some statements are optional (i.e. init and post statements of a for statement). The init and
+  // post statements are declarations, assignments or expressions, that are never replaced
+  if (node.getInit() != nullptr) {
+    visit(*node.getInit());
+  }
+  if (node.getCond() != nullptr) {
+    if (auto cond = foldExpr(*node.getCond())) {
+      node.setCond(cond);
+    }
+  }
+  if (node.getPost() != nullptr) {
+    visit(*node.getPost());
+  }
+  visit(*node.getBody());
+}
+
+void ConstantFolding::visit(WhileStmt &node) {
+  if (auto cond = foldExpr(*node.getCond())) {
+    node.setCond(cond);
+  }
+  visit(*node.getBody());
+
+  // If the condition is false, the body is never executed
+  auto condition = asLiteral(*node.getCond());
+  if (condition != nullptr && !getBoolValue(*condition)) {
+    stmtReplaced = true;
+    replacementStmt = nullptr;
+  }
+}
+
+void ConstantFolding::visit(AssignmentStmt &node) {
+  // The left hand side is not replaced, but the index of an element of an array can be folded
+  if (node.getLhs()->getExprKind() == Expr::Kind::INDEXEXPR ||
+      node.getLhs()->getExprKind() == Expr::Kind::FIELDEXPR) {
+    visit(*node.getLhs());
+  }
+  if (auto rhs = foldExpr(*node.getRhs())) {
+    node.setRhs(rhs);
+  }
+}
+
+void ConstantFolding::visit(ReturnStmt &node) {
+  // The value is optional (i.e. return statement in a void function)
+  if (node.getValue() == nullptr) {
+    return;
+  }
+  if (auto value = foldExpr(*node.getValue())) {
+    node.setValue(value);
+  }
+}
+
+void ConstantFolding::visit(BreakStmt & /*node*/) {}
+
+void ConstantFolding::visit(ContinueStmt & /*node*/) {}
+
+// EXPRESSIONS
+
+std::shared_ptr<Expr> ConstantFolding::foldBinaryExprInt(const BinaryExpr &node,
+                                                         const LiteralExpr &lhs,
+                                                         const LiteralExpr &rhs) {
+  int64_t l = getIntValue(lhs);
+  int64_t r = getIntValue(rhs);
+  auto ul = static_cast<uint64_t>(l);
+  auto ur = static_cast<uint64_t>(r);
+  const Token &op = node.getOp();
+
+  // The overflowing addition, subtraction and multiplication are left to be executed at runtime,
+  // where they behave as requested with --overflow (wrap, undefined or trap)
+  int64_t result;
+  switch (op.tokenType) {
+  case ADD:
+    if (__builtin_add_overflow(l, r, &result)) {
+      return nullptr;
+    }
+    return makeIntLiteral(result, op);
+  case SUB:
+    if (__builtin_sub_overflow(l, r, &result)) {
+      return nullptr;
+    }
+    return makeIntLiteral(result, op);
+  case STAR:
+    if (__builtin_mul_overflow(l, r, &result)) {
+      return nullptr;
+    }
+    return makeIntLiteral(result, op);
+  case SLASH:
+    // Division by zero (and the overflowing division) is left to be executed at runtime
+    if (r == 0 || (l == std::numeric_limits<int64_t>::min() && r == -1)) {
+      return nullptr;
+    }
+    return makeIntLiteral(l / r, op);
+  case PERCENT:
+    if (r == 0 || (l == std::numeric_limits<int64_t>::min() && r == -1)) {
+      return nullptr;
+    }
+    return makeIntLiteral(l % r, op);
+  case AMPERSAND:
+    return makeIntLiteral(l & r, op);
+  case PIPE:
+    return makeIntLiteral(l | r, op);
+  case CARET:
+    return makeIntLiteral(l ^ r, op);
+  case SHIFT_LEFT:
+    // The shift amount is taken modulo 64 like in the generated code
+    return makeIntLiteral(static_cast<int64_t>(ul << (ur & 63)), op);
+  case SHIFT_RIGHT:
+    return makeIntLiteral(l >> (ur & 63), op);
+  case EQUAL:
+    return makeBoolLiteral(l == r, op);
+  case NOT_EQUAL:
+    return makeBoolLiteral(l != r, op);
+  case LESS:
+    return makeBoolLiteral(l < r, op);
+  case GREATER:
+    return makeBoolLiteral(l > r, op);
+  case LESS_EQUAL:
+    return makeBoolLiteral(l <= r, op);
+  case GREATER_EQUAL:
+    return makeBoolLiteral(l >= r, op);
+  default:
+    return nullptr;
+  }
+}
+
+std::shared_ptr<Expr> ConstantFolding::foldBinaryExprFloat(const BinaryExpr &node,
+                                                           const LiteralExpr &lhs,
+                                                           const LiteralExpr &rhs) {
+  double l = getFloatValue(lhs);
+  double r = getFloatValue(rhs);
+  const Token &op = node.getOp();
+
+  double result;
+  switch (op.tokenType) {
+  case ADD:
+    result = l + r;
+    break;
+  case SUB:
+    result = l - r;
+    break;
+  case STAR:
+    result = l * r;
+    break;
+  case SLASH:
+    result = l / r;
+    break;
+  case EQUAL:
+    return makeBoolLiteral(l == r, op);
+  case NOT_EQUAL:
+    // Same semantics as the generated code (ordered comparison: false if any operand is NaN)
+    return makeBoolLiteral(l < r || l > r, op);
+  case LESS:
+    return makeBoolLiteral(l < r, op);
+  case GREATER:
+    return makeBoolLiteral(l > r, op);
+  case LESS_EQUAL:
+    return makeBoolLiteral(l <= r, op);
+  case GREATER_EQUAL:
+    return makeBoolLiteral(l >= r, op);
+  default:
+    return nullptr;
+  }
+
+  // Infinities and NaN can not be written as float literals, so they are computed at runtime
+  if (!std::isfinite(result)) {
+    return nullptr;
+  }
+  return makeFloatLiteral(result, op);
+}
+
+std::shared_ptr<Expr> ConstantFolding::foldBinaryExprBool(const BinaryExpr &node,
+                                                          const LiteralExpr &lhs,
+                                                          const LiteralExpr &rhs) {
+  bool l = getBoolValue(lhs);
+  bool r = getBoolValue(rhs);
+  const Token &op = node.getOp();
+
+  switch (op.tokenType) {
+  case EQUAL:
+    return makeBoolLiteral(l == r, op);
+  case NOT_EQUAL:
+    return makeBoolLiteral(l != r, op);
+  case LAND:
+    return makeBoolLiteral(l && r, op);
+  case LOR:
+    return makeBoolLiteral(l || r, op);
+  default:
+    return nullptr;
+  }
+}
+
+std::shared_ptr<Expr> ConstantFolding::foldBinaryExprString(const BinaryExpr &node,
+                                                            const LiteralExpr &lhs,
+                                                            const LiteralExpr &rhs) {
+  const std::string &l = lhs.getToken().value;
+  const std::string &r = rhs.getToken().value;
+  const Token &op = node.getOp();
+
+  switch (op.tokenType) {
+  case EQUAL:
+    return makeBoolLiteral(l == r, op);
+  case NOT_EQUAL:
+    return makeBoolLiteral(l != r, op);
+  default:
+    return nullptr;
+  }
+}
+
+void ConstantFolding::visit(BinaryExpr &node) {
+  if (auto lhs = foldExpr(*node.getLhs())) {
+    node.setLhs(lhs);
+  }
+  if (auto rhs = foldExpr(*node.getRhs())) {
+    node.setRhs(rhs);
+  }
+
+  auto lhs = asLiteral(*node.getLhs());
+  auto rhs = asLiteral(*node.getRhs());
+  if (lhs == nullptr || rhs == nullptr) {
+    return;
+  }
+
+  // To decide the type, we use one of the child's type because that is the type of the operands
+  auto type = std::dynamic_pointer_cast<BasicType>(lhs->getType());
+  if (type == nullptr) {
+    return;
+  }
+
+  switch (type->getKind()) {
+  case BasicType::Kind::INT:
+    replacementExpr = foldBinaryExprInt(node, *lhs, *rhs);
+    break;
+  case BasicType::Kind::FLOAT:
+    replacementExpr = foldBinaryExprFloat(node, *lhs, *rhs);
+    break;
+  case BasicType::Kind::BOOL:
+    replacementExpr = foldBinaryExprBool(node, *lhs, *rhs);
+    break;
+  case BasicType::Kind::STRING:
+    replacementExpr = foldBinaryExprString(node, *lhs, *rhs);
+    break;
+  default:
+    break;
+  }
+}
+
+std::shared_ptr<Expr> ConstantFolding::foldUnaryExpr(const UnaryExpr &node,
+                                                     const LiteralExpr &rhs) {
+  auto type = std::dynamic_pointer_cast<BasicType>(rhs.getType());
+  if (type == nullptr) {
+    return nullptr;
+  }
+
+  const Token &op = node.getOp();
+  switch (type->getKind()) {
+  case BasicType::Kind::INT:
+    if (op.tokenType == ADD) {
+      return node.getRhs();
+    } else if (op.tokenType == SUB && getIntValue(rhs) != std::numeric_limits<int64_t>::min()) {
+      return makeIntLiteral(-getIntValue(rhs), op);
+    } else if (op.tokenType == TILDE) {
+      return makeIntLiteral(~getIntValue(rhs), op);
+    }
+    break;
+  case BasicType::Kind::FLOAT:
+    if (op.tokenType == ADD) {
+      return node.getRhs();
+    } else if (op.tokenType == SUB) {
+      return makeFloatLiteral(-getFloatValue(rhs), op);
+    }
+    break;
+  case BasicType::Kind::BOOL:
+    if (op.tokenType == NOT) {
+      return makeBoolLiteral(!getBoolValue(rhs), op);
+    }
+    break;
+  case BasicType::Kind::INT8:
+  case BasicType::Kind::INT16:
+  case BasicType::Kind::INT32:
+  case BasicType::Kind::UINT8:
+  case BasicType::Kind::UINT16:
+  case BasicType::Kind::UINT32:
+  case BasicType::Kind::UINT64:
+    // The literal keeps its fixed-width type and it is truncated to its width in code generation,
+    // so the negation wraps around like in the generated code
+    if (op.tokenType == ADD) {
+      return node.getRhs();
+    } else if (op.tokenType == SUB) {
+      auto literal = makeIntLiteral(
+          static_cast<int64_t>(-static_cast<uint64_t>(std::stoull(rhs.getToken().value))), op);
+      literal->setType(type);
+      return literal;
+    } else if (op.tokenType == TILDE) {
+      auto literal = makeIntLiteral(
+          static_cast<int64_t>(~static_cast<uint64_t>(std::stoull(rhs.getToken().value))), op);
+      literal->setType(type);
+      return literal;
+    }
+    break;
+  case BasicType::Kind::FLOAT32:
+    if (op.tokenType == ADD) {
+      return node.getRhs();
+    } else if (op.tokenType == SUB) {
+      auto literal = makeFloatLiteral(-getFloatValue(rhs), op);
+      literal->setType(type);
+      return literal;
+    }
+    break;
+  default:
+    break;
+  }
+  return nullptr;
+}
+
+void ConstantFolding::visit(UnaryExpr &node) {
+  if (auto rhs = foldExpr(*node.getRhs())) {
+    node.setRhs(rhs);
+  }
+
+  if (auto rhs = asLiteral(*node.getRhs())) {
+    replacementExpr = foldUnaryExpr(node, *rhs);
+  }
+}
+
+void ConstantFolding::visit(LiteralExpr & /*node*/) {}
+
+void ConstantFolding::visit(IdentExpr &node) {
+  // Constant propagation: the use of a constant initialized with a literal is replaced by the
+  // literal
+  const auto &decl = node.getDeclOfIdentifier();
+  if (decl == nullptr || decl->getDeclKind() != Decl::Kind::CONSTDECL) {
+    return;
+  }
+
+  auto value = asLiteral(*static_cast<const ConstDecl &>(*decl).getValue());
+  if (value == nullptr) {
+    return;
+  }
+  replacementExpr = makeLiteral(value->getToken().tokenType, value->getToken().value,
+                                node.getIdent(), value->getType());
+}
+
+void ConstantFolding::visit(CallExpr &node) {
+  foldArgs(node);
+
+  // A call to a const function whose arguments are literals is replaced by its result, unless it
+  // can not be evaluated at compile time (i.e. too many steps or a division by zero)
+  const auto &func = static_cast<const IdentExpr &>(*node.getFunc());
+  const auto &decl = func.getDeclOfIdentifier();
+  if (decl == nullptr || decl->getDeclKind() != Decl::Kind::FUNCDECL ||
+      !static_cast<const FuncDecl &>(*decl).isConst()) {
+    return;
+  }
+  for (const auto &arg : node.getArgs()) {
+    if (asLiteral(*arg) == nullptr) {
+      return;
+    }
+  }
+
+  CompileTimeEvaluation::Value result;
+  if (!evaluation.evaluateCall(node, result)) {
+    return;
+  }
+  switch (result.kind) {
+  case BasicType::Kind::INT:
+    replacementExpr = makeIntLiteral(result.intValue, func.getIdent());
+    break;
+  case BasicType::Kind::FLOAT:
+    // Infinities and NaN can not be written as float literals, so they are computed at runtime
+    if (std::isfinite(result.floatValue)) {
+      replacementExpr = makeFloatLiteral(result.floatValue, func.getIdent());
+    }
+    break;
+  case BasicType::Kind::BOOL:
+    replacementExpr = makeBoolLiteral(result.boolValue, func.getIdent());
+    break;
+  default:
+    break;
+  }
+}
+
+void ConstantFolding::visit(IndexExpr &node) {
+  if (auto array = foldExpr(*node.getArray())) {
+    node.setArray(array);
+  }
+  if (auto index = foldExpr(*node.getIndex())) {
+    node.setIndex(index);
+  }
+}
+
+void ConstantFolding::visit(FieldExpr &node) {
+  if (auto operand = foldExpr(*node.getOperand())) {
+    node.setOperand(operand);
+  }
+}
+
+void ConstantFolding::visit(ArrayLiteralExpr &node) {
+  for (std::size_t idx = 0; idx < node.getElements().size(); idx++) {
+    if (auto element = foldExpr(*node.getElements()[idx])) {
+      node.setElement(idx, element);
+    }
+  }
+}
+
+void ConstantFolding::visit(ConversionExpr &node) {
+  // The conversion of a literal is left to LLVM, that folds the single instruction it generates
+  if (auto value = foldExpr(*node.getValue())) {
+    node.setValue(value);
+  }
+}
+
+void ConstantFolding::visit(SpawnExpr &node) {
+  // only the arguments of the call are folded (the call spawned is not replaced by a literal)
+  foldArgs(static_cast<CallExpr &>(*node.getCall()));
+}
+
+void ConstantFolding::visit(AwaitExpr &node) {
+  if (auto task = foldExpr(*node.getTask())) {
+    node.setTask(task);
+  }
+}
@@ -0,0 +1,338 @@
+//===- src/Optimization/FunctionEffects.cpp - Impl of FunctionEffects ---------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the FunctionEffects class.
+// Function effects is an analysis done on the AST after bounds check elimination. The effects of
+// the body of every function are summarized first, and then the effects of the functions called
+// are added until nothing changes (the functions can call each other recursively).
+//
+//===------------------------------------------------------------------------------------------===//
+#include "stoc/Optimization/FunctionEffects.h"
+
+#include <algorithm>
+#include <vector>
+
+FunctionEffects::FunctionEffects(std::shared_ptr<SrcFile> file, bool checkedOverflow)
+    : file(file), checkedOverflow(checkedOverflow), current(nullptr) {}
+
+void FunctionEffects::infer() {
+  std::vector<FuncDecl *> functions;
+  for (const auto &declaration : file->getAst()) {
+    if (declaration->getDeclKind() == Decl::Kind::FUNCDECL) {
+      auto function = static_cast<FuncDecl *>(declaration.get());
+      functions.push_back(function);
+      current = &summaries[function];
+      visit(*function);
+    }
+  }
+  current = nullptr;
+
+  // A recursive call can be repeated any number of times, so it is not known to return
+  for (FuncDecl *function : functions) {
+    const Summary &summary = summaries[function];
+    function->setRecursive(reaches(function, function));
+    function->setMemory(summary.memory);
+    function->setWillReturn(summary.willReturn && !function->isRecursive());
+  }
+
+  // The memory accessed only grows and willReturn only becomes false, so this terminates. The
+  // functions of previous inputs of the REPL already have their effects
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (FuncDecl *function : functions) {
+      FuncDecl::Memory memory = function->getMemory();
+      bool willReturn = function->isWillReturn();
+      for (FuncDecl *callee : summaries[function].callees) {
+        memory = std::max(memory, callee->getMemory());
+        willReturn = willReturn && callee->isWillReturn();
+      }
+      if (memory != function->getMemory() || willReturn != function->isWillReturn()) {
+        function->setMemory(memory);
+        function->setWillReturn(willReturn);
+        changed = true;
+      }
+    }
+  }
+}
+
+// HELPER METHODS
+
+/// returns the type of the integers operated in an operation with operands of type \type (an
+/// integer or a vector of integers), or nullptr if they are not integers
+static std::shared_ptr<BasicType> getIntegerType(std::shared_ptr<Type> type) {
+  if (type->getTypeKind() == Type::Kind::VectorType) {
+    type = std::static_pointer_cast<VectorType>(type)->getElement();
+  }
+  auto basicType = std::dynamic_pointer_cast<BasicType>(type);
+  if (basicType == nullptr || !basicType->isInteger()) {
+    return nullptr;
+  }
+  return basicType;
+}
+
+void FunctionEffects::access(FuncDecl::Memory memory) {
+  current->memory = std::max(current->memory, memory);
+}
+
+void FunctionEffects::sideEffect() {
+  access(FuncDecl::Memory::WRITE);
+  current->willReturn = false;
+}
+
+bool FunctionEffects::reaches(FuncDecl *from, FuncDecl *function) {
+  std::unordered_set<FuncDecl *> visited;
+  std::vector<FuncDecl *> pending = {from};
+  while (!pending.empty()) {
+    FuncDecl *caller = pending.back();
+    pending.pop_back();
+    auto found = summaries.find(caller);
+    if (found == summaries.end()) {
+      continue;
+    }
+    for (FuncDecl *callee : found->second.callees) {
+      if (callee == function) {
+        return true;
+      }
+      if (visited.insert(callee).second) {
+        pending.push_back(callee);
+      }
+    }
+  }
+  return false;
+}
+
+// DECLARATIONS
+
+void FunctionEffects::visit(VarDecl &node) { visit(*node.getValue()); }
+
+void FunctionEffects::visit(ConstDecl &node) { visit(*node.getValue()); }
+
+void FunctionEffects::visit(ParamDecl &node) {
+  // A fixed-size array is received by reference and copied from the memory of the caller
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getType());
+  if (arrayType != nullptr && !arrayType->isDynamic()) {
+    access(FuncDecl::Memory::READ);
+  }
+}
+
+void FunctionEffects::visit(FuncDecl &node) {
+  for (const auto &param : node.getParams()) {
+    visit(*param);
+  }
+  visit(*node.getBody());
+}
+
+void FunctionEffects::visit(StructDecl &node) {}
+
+// STATEMENTS
+
+void FunctionEffects::visit(DeclarationStmt &node) { visit(*node.getDecl()); }
+
+void FunctionEffects::visit(ExpressionStmt &node) { visit(*node.getExpr()); }
+
+void FunctionEffects::visit(BlockStmt &node) {
+  for (const auto &stmt : node.getStmts()) {
+    visit(*stmt);
+  }
+}
+
+void FunctionEffects::visit(IfStmt &node) {
+  visit(*node.getCondition());
+  visit(*node.getThenBranch());
+  if (node.isHasElse()) {
+    visit(*node.getElseBranch());
+  }
+}
+
+void FunctionEffects::visit(ForStmt &node) {
+  // The number of iterations of a loop is not known, so it may never finish. A parallel for
+  // starts threads in the runtime
+  current->willReturn = false;
+  if (node.isParallel()) {
+    sideEffect();
+  }
+
+  if (node.getInit() != nullptr) {
+    visit(*node.getInit());
+  }
+  if (node.getCond() != nullptr) {
+    visit(*node.getCond());
+  }
+  if (node.getPost() != nullptr) {
+    visit(*node.getPost());
+  }
+  visit(*node.getBody());
+}
+
+void FunctionEffects::visit(WhileStmt &node) {
+  current->willReturn = false;
+  visit(*node.getCond());
+  visit(*node.getBody());
+}
+
+void FunctionEffects::visit(AssignmentStmt &node) {
+  visit(*node.getLhs());
+  visit(*node.getRhs());
+
+  // The memory written is the variable at the root of the left hand side, or the elements of a
+  // dynamic array (shared with the caller) if there is one in the way
+  const Expr *lhs = node.getLhs().get();
+  while (lhs->getExprKind() != Expr::Kind::IDENTEXPR) {
+    if (lhs->getExprKind() == Expr::Kind::INDEXEXPR) {
+      const auto &indexExpr = static_cast<const IndexExpr &>(*lhs);
+      auto arrayType = std::dynamic_pointer_cast<ArrayType>(indexExpr.getArray()->getType());
+      if (arrayType != nullptr && arrayType->isDynamic()) {
+        access(FuncDecl::Memory::WRITE);
+        return;
+      }
+      lhs = indexExpr.getArray().get();
+    } else if (lhs->getExprKind() == Expr::Kind::FIELDEXPR) {
+      lhs = static_cast<const FieldExpr &>(*lhs).getOperand().get();
+    } else {
+      return;
+    }
+  }
+
+  const auto &decl = static_cast<const IdentExpr &>(*lhs).getDeclOfIdentifier();
+  if (decl != nullptr && decl->getDeclKind() == Decl::Kind::VARDECL &&
+      static_cast<const VarDecl &>(*decl).isGlobal()) {
+    access(FuncDecl::Memory::WRITE);
+  }
+}
+
+void FunctionEffects::visit(ReturnStmt &node) {
+  if (node.getValue() != nullptr) {
+    visit(*node.getValue());
+  }
+}
+
+void FunctionEffects::visit(BreakStmt &node) {}
+
+void FunctionEffects::visit(ContinueStmt &node) {}
+
+// EXPRESSIONS
+
+void FunctionEffects::visit(BinaryExpr &node) {
+  visit(*node.getLhs());
+  visit(*node.getRhs());
+
+  TokenType op = node.getOp().tokenType;
+  if (getIntegerType(node.getLhs()->getType()) == nullptr) {
+    return;
+  }
+  if (checkedOverflow && (op == ADD || op == SUB || op == STAR)) {
+    sideEffect();
+  }
+  // An integer division by zero (or of the minimum integer by -1) stops the program. A literal
+  // divisor is never negative, the sign is an unary expression
+  if (op == SLASH || op == PERCENT) {
+    const Expr &divisor = *node.getRhs();
+    bool nonZeroLiteral =
+        divisor.getExprKind() == Expr::Kind::LITERALEXPR &&
+        static_cast<const LiteralExpr &>(divisor).getToken().value.find_first_not_of('0') !=
+            std::string::npos;
+    if (!nonZeroLiteral) {
+      current->willReturn = false;
+    }
+  }
+}
+
+void FunctionEffects::visit(UnaryExpr &node) {
+  visit(*node.getRhs());
+
+  if (checkedOverflow && node.getOp().tokenType == SUB) {
+    auto basicType = getIntegerType(node.getRhs()->getType());
+    if (basicType != nullptr && !basicType->isUnsigned()) {
+      sideEffect();
+    }
+  }
+}
+
+void FunctionEffects::visit(LiteralExpr &node) {}
+
+void FunctionEffects::visit(IdentExpr &node) {
+  const auto &decl = node.getDeclOfIdentifier();
+  if (decl == nullptr) {
+    return;
+  }
+  if ((decl->getDeclKind() == Decl::Kind::VARDECL &&
+       static_cast<const VarDecl &>(*decl).isGlobal()) ||
+      (decl->getDeclKind() == Decl::Kind::CONSTDECL &&
+       static_cast<const ConstDecl &>(*decl).isGlobal())) {
+    access(FuncDecl::Memory::READ);
+  }
+}
+
+void FunctionEffects::visit(CallExpr &node) {
+  for (const auto &arg : node.getArgs()) {
+    visit(*arg);
+  }
+
+  const auto &func = static_cast<const IdentExpr &>(*node.getFunc());
+  const auto &decl = func.getDeclOfIdentifier();
+  if (decl != nullptr) {
+    // a call to the name of a struct creates a value of the struct
+    if (decl->getDeclKind() == Decl::Kind::FUNCDECL) {
+      current->callees.insert(static_cast<FuncDecl *>(decl.get()));
+    }
+    return;
+  }
+
+  // The builtin functions have no declaration
+  const std::string &name = func.getName();
+  if (name == "print" || name == "println") {
+    sideEffect();
+  } else if (name == "append") {
+    access(FuncDecl::Memory::WRITE);
+  } else if (!node.getArgs().empty() &&
+             node.getArgs()[0]->getType()->getTypeKind() == Type::Kind::AtomicType) {
+    access(FuncDecl::Memory::WRITE);
+  }
+  // the rest of builtins (len and the builtins on vectors and on bits) are instructions on values
+}
+
+void FunctionEffects::visit(IndexExpr &node) {
+  visit(*node.getArray());
+  visit(*node.getIndex());
+
+  // The lanes of a vector are accessed with a constant index, which is never out of range
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getArray()->getType());
+  if (arrayType == nullptr) {
+    return;
+  }
+  if (arrayType->isDynamic()) {
+    access(FuncDecl::Memory::READ);
+  }
+  // An index out of range stops the program
+  if (node.isBoundsCheck()) {
+    sideEffect();
+  }
+}
+
+void FunctionEffects::visit(FieldExpr &node) { visit(*node.getOperand()); }
+
+void FunctionEffects::visit(ArrayLiteralExpr &node) {
+  for (const auto &element : node.getElements()) {
+    visit(*element);
+  }
+
+  // The elements of a dynamic array are allocated in the heap
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getType());
+  if (arrayType != nullptr && arrayType->isDynamic()) {
+    access(FuncDecl::Memory::WRITE);
+  }
+}
+
+void FunctionEffects::visit(ConversionExpr &node) { visit(*node.getValue()); }
+
+void FunctionEffects::visit(SpawnExpr &node) {
+  visit(*node.getCall());
+  sideEffect();
+}
+
+void FunctionEffects::visit(AwaitExpr &node) {
+  visit(*node.getTask());
+  sideEffect();
+}
@@ -3,7 +3,7 @@
 //===----------------------------------------------------------------------------===//
 //
 // This file implements the Parser class.
-// Parsing is the second phase of a compiler and transforms the list of
+// Parsing is the second phase of a compiler and transforms the stream of
 // tokens into a abstract syntax tree (AST)
 //
 //===---------------------------------------------------------------------------===//
@@ -11,18 +11,29 @@
 #include "stoc/Parser/Parser.h"
 
 #include <iostream>
+#include <utility>
 
-Parser::Parser(const std::shared_ptr<SrcFile> &file) {
-  this->file = file;
+Parser::Parser(const std::shared_ptr<SrcFile> &file) : file(file), scanner(file) {
   this->current = 0;
+  this->scanned = 0;
+}
+
+void Parser::setTokenListener(std::function<void(const Token &)> listener) {
+  this->tokenListener = std::move(listener);
 }
 
 void Parser::parse() {
   while (!isAtEnd()) {
+    int start = current;
     ast.push_back(parseDecl());
+    // After an error, synchronize() can stop at a token that does not start a declaration (i.e. a
+    // '{'), so it is skipped to not report the same error forever
+    if (current == start) {
+      advance();
+    }
   }
 
-  this->file->setAst(ast);
+  this->file->setAst(std::move(ast));
 }
 
 // MAIN PARSING METHODS
@@ -33,10 +44,17 @@ std::shared_ptr<Decl> Parser::parseDecl() {
   try {
     switch (currentToken().tokenType) {
     case VAR:
+      return parseVarConstDecl();
     case CONST:
+      // const func declares a function evaluated at compile time
+      if (tokenAt(current + 1).tokenType == FUNC) {
+        return parseFuncDecl();
+      }
       return parseVarConstDecl();
     case FUNC:
       return parseFuncDecl();
+    case STRUCT:
+      return parseStructDecl();
     default:
       reportError("Expected declaration");
       return nullptr;
@@ -52,7 +70,7 @@ std::shared_ptr<Decl> Parser::parseDecl() {
 std::shared_ptr<Decl> Parser::parseVarConstDecl() {
   // we know current token is VAR or CONST
   Token varConstKeyword = advance();
-  Token type = parseType();
+  TypeSpec type = parseType();
   Token identifier =
       consume(IDENTIFIER, "Expected identifier after '" + to_string(varConstKeyword.tokenType) +
                               "' in variable declaration");
@@ -68,19 +86,51 @@ std::shared_ptr<Decl> Parser::parseVarConstDecl() {
 }
 
 std::shared_ptr<Decl> Parser::parseFuncDecl() {
-  // we know current token is FUNC
+  // we know current token is FUNC or CONST followed by FUNC
+  bool constant = match(CONST);
   Token funcKeyword = advance();
   Token name = consume(IDENTIFIER, "Expected identifier after 'func' in function declaration");
+
+  std::vector<Attribute> attributes = {};
+  while (check(IDENTIFIER)) {
+    attributes.push_back(parseAttribute());
+  }
+
   std::vector<std::shared_ptr<ParamDecl>> params = parseParameters();
 
   if (!check(LBRACE)) {
-    Token returnType = parseReturnType();
+    TypeSpec returnType = parseReturnType();
     std::shared_ptr<BlockStmt> body = parseBlockStmt();
-    return std::make_shared<FuncDecl>(funcKeyword, name, params, returnType, body);
+    return std::make_shared<FuncDecl>(funcKeyword, name, attributes, params, returnType, body,
+                                      constant);
   } else {
     std::shared_ptr<BlockStmt> body = parseBlockStmt();
-    return std::make_shared<FuncDecl>(funcKeyword, name, params, body);
+    return std::make_shared<FuncDecl>(funcKeyword, name, attributes, params, body, constant);
+  }
+}
+
+std::shared_ptr<Decl> Parser::parseStructDecl() {
+  // we know current token is STRUCT
+  Token structKeyword = advance();
+  Token name = consume(IDENTIFIER, "Expected identifier after 'struct' in struct declaration");
+
+  std::vector<Attribute> attributes = {};
+  while (check(IDENTIFIER)) {
+    attributes.push_back(parseAttribute());
+  }
+
+  consume(LBRACE, "Expected '{' before fields of struct declaration");
+  std::vector<FieldDecl> fields = {};
+  while (!check(RBRACE) && !check(T_EOF)) {
+    consume(VAR, "Expected 'var' in field declaration");
+    TypeSpec type = parseType();
+    Token ident = consume(IDENTIFIER, "Expected identifier in field declaration");
+    consume(SEMICOLON, "Expected ';' after field declaration");
+    fields.push_back({type, ident});
   }
+  consume(RBRACE, "Expected '}' after fields of struct declaration");
+
+  return std::make_shared<StructDecl>(structKeyword, name, attributes, fields);
 }
 
 //------- Statements -------
@@ -94,10 +144,16 @@ std::shared_ptr<Stmt> Parser::parseStmt() {
       return parseIfStmt();
     case FOR:
       return parseForStmt();
+    case PARALLEL:
+      return parseParallelForStmt();
     case WHILE:
       return parseWhileStmt();
     case RETURN:
       return parseReturnStmt();
+    case BREAK:
+      return parseBreakStmt();
+    case CONTINUE:
+      return parseContinueStmt();
     default:
       return parseSimpleStmt(true);
     }
@@ -207,6 +263,30 @@ std::shared_ptr<Stmt> Parser::parseForStmt() {
   return std::make_shared<ForStmt>(forKeyword, init, cond, post, body);
 }
 
+std::shared_ptr<Stmt> Parser::parseParallelForStmt() {
+  // we know current token is PARALLEL
+  Token parallelKeyword = advance();
+
+  // reductions: parallel(sum total, max best)
+  std::vector<ForStmt::Reduction> reductions;
+  if (match(LPAREN)) {
+    do {
+      Token op = consume(IDENTIFIER, "Expected reduction (sum, min or max) in parallel for");
+      Token variable =
+          consume(IDENTIFIER, "Expected variable after " + op.value + " in parallel for");
+      reductions.push_back({op, std::make_shared<IdentExpr>(variable)});
+    } while (match(COMMA));
+    consume(RPAREN, "Expected ')' after reductions of parallel for");
+  }
+
+  if (!check(FOR)) {
+    consume(FOR, "Expected 'for' after 'parallel'");
+  }
+  auto forStmt = std::static_pointer_cast<ForStmt>(parseForStmt());
+  forStmt->setParallel(parallelKeyword, reductions);
+  return forStmt;
+}
+
 std::shared_ptr<Stmt> Parser::parseWhileStmt() {
   // we know current token is WHILE
   Token whileKeyword = advance();
@@ -230,6 +310,20 @@ std::shared_ptr<Stmt> Parser::parseReturnStmt() {
   }
 }
 
+std::shared_ptr<Stmt> Parser::parseBreakStmt() {
+  // we know current token is BREAK
+  Token breakKeyword = advance();
+  consume(SEMICOLON, "Expected ';' after break statement");
+  return std::make_shared<BreakStmt>(breakKeyword);
+}
+
+std::shared_ptr<Stmt> Parser::parseContinueStmt() {
+  // we know current token is CONTINUE
+  Token continueKeyword = advance();
+  consume(SEMICOLON, "Expected ';' after continue statement");
+  return std::make_shared<ContinueStmt>(continueKeyword);
+}
+
 //------- Expressions -------
 
 std::shared_ptr<Expr> Parser::parseExpr() { return parseBinaryExpr(PREC_LOWEST + 1); }
@@ -246,7 +340,7 @@ std::shared_ptr<Expr> Parser::parseBinaryExpr(int prec) {
     advance();
     std::shared_ptr<Expr> rhs = parseBinaryExpr(tokenPrec(op.tokenType) + 1);
     e = std::make_shared<BinaryExpr>(e, rhs, op);
-    op = this->file->getTokens()[current];
+    op = currentToken();
   }
 
   return e;
@@ -256,11 +350,22 @@ std::shared_ptr<Expr> Parser::parseUnaryExpr() {
   switch (currentToken().tokenType) {
   case ADD: // we allow ADD(+) as unary operator
   case SUB:
-  case NOT: {
+  case NOT:
+  case TILDE: {
     Token t = advance();
     std::shared_ptr<Expr> rhs = parseBinaryExpr(PREC_UNARY);
     return std::make_shared<UnaryExpr>(rhs, t);
   }
+  case SPAWN: {
+    Token spawnKeyword = advance();
+    std::shared_ptr<Expr> call = parseBinaryExpr(PREC_UNARY);
+    return std::make_shared<SpawnExpr>(spawnKeyword, call);
+  }
+  case AWAIT: {
+    Token awaitKeyword = advance();
+    std::shared_ptr<Expr> task = parseBinaryExpr(PREC_UNARY);
+    return std::make_shared<AwaitExpr>(awaitKeyword, task);
+  }
   default:
     return parsePrimaryExpr();
   }
@@ -269,31 +374,90 @@ std::shared_ptr<Expr> Parser::parseUnaryExpr() {
 std::shared_ptr<Expr> Parser::parsePrimaryExpr() {
   std::shared_ptr<Expr> operand = parseOperand();
 
-  switch (currentToken().tokenType) {
-  case LPAREN: { // it is a function call
+  if (check(LPAREN)) { // it is a function call
     std::vector<std::shared_ptr<Expr>> args = parseArgs();
-    return std::make_shared<CallExpr>(operand, args);
+    operand = std::make_shared<CallExpr>(operand, args);
   }
-  default:
-    return operand;
+
+  // it is an index expression (i.e. a[i] or f()[i]) or a field expression (i.e. p.x or a[i].x)
+  while (check(LBRACK) || check(PERIOD)) {
+    if (check(PERIOD)) {
+      Token period = advance();
+      Token field = consume(IDENTIFIER, "Expected name of field after '.'");
+      operand = std::make_shared<FieldExpr>(operand, period, field);
+      continue;
+    }
+    Token lbrack = advance();
+    std::shared_ptr<Expr> index = parseExpr();
+    Token rbrack = consume(RBRACK, "Expected ']' after index");
+    operand = std::make_shared<IndexExpr>(operand, index, lbrack, rbrack);
   }
+
+  return operand;
 }
 
 // HELPER METHODS
 
-Token Parser::parseType() {
+TypeSpec Parser::parseType() {
   switch (currentToken().tokenType) {
   case BOOL:
   case INT:
   case FLOAT:
   case STRING:
-    return advance();
+  case INT8:
+  case INT16:
+  case INT32:
+  case UINT8:
+  case UINT16:
+  case UINT32:
+  case UINT64:
+  case FLOAT32:
+  case IDENTIFIER: // struct type
+    return TypeSpec(advance());
+  case LBRACK: {
+    Token lbrack = advance();
+    if (match(RBRACK)) { // dynamic array
+      return TypeSpec(lbrack, std::make_shared<TypeSpec>(parseType()));
+    }
+    Token size = consume(LIT_INT, "Expected size of the array after '['");
+    consume(RBRACK, "Expected ']' after size of the array");
+    return TypeSpec(lbrack, size, std::make_shared<TypeSpec>(parseType()));
+  }
+  case LESS: { // vector
+    Token less = advance();
+    Token lanes = consume(LIT_INT, "Expected number of lanes of the vector after '<'");
+    consume(GREATER, "Expected '>' after number of lanes of the vector");
+    return TypeSpec(less, lanes, std::make_shared<TypeSpec>(parseType()));
+  }
+  case TASK: {
+    Token task = advance();
+    return TypeSpec(task, std::make_shared<TypeSpec>(parseType()));
+  }
+  case ATOMIC: {
+    Token atomic = advance();
+    return TypeSpec(atomic, std::make_shared<TypeSpec>(parseType()));
+  }
   default:
     reportError("Expected type: " + to_string(currentToken().tokenType) + " is not a type");
-    return Token();
+    return TypeSpec();
   }
 }
 
+Attribute Parser::parseAttribute() {
+  // we know current token is IDENTIFIER
+  Token name = advance();
+  // The attributes of a function are followed by its parameters, which start with '(' too
+  TokenType next = tokenAt(current + 1).tokenType;
+  if (!check(LPAREN) || next == VAR || next == RPAREN) {
+    return {name, false, Token()};
+  }
+  advance();
+  Token argument =
+      consume(LIT_INT, "Expected integer as argument of attribute '" + name.value + "'");
+  consume(RPAREN, "Expected ')' after argument of attribute");
+  return {name, true, argument};
+}
+
 std::vector<std::shared_ptr<ParamDecl>> Parser::parseParameters() {
   // we know current token is '('
   consume(LPAREN, "Expected '(' before parameter definition");
@@ -301,7 +465,7 @@ std::vector<std::shared_ptr<ParamDecl>> Parser::parseParameters() {
 
   while (!check(RPAREN) && !check(T_EOF)) {
     Token keyword = consume(VAR, "Expected VAR as variable definition in parameters");
-    Token type = parseType();
+    TypeSpec type = parseType();
     Token ident = consume(IDENTIFIER, "Expected IDENTIFIER in variable definition in parameters");
     params.push_back(std::make_shared<ParamDecl>(keyword, type, ident));
     if (check(COMMA)) {
@@ -313,7 +477,7 @@ std::vector<std::shared_ptr<ParamDecl>> Parser::parseParameters() {
   return params;
 }
 
-Token Parser::parseReturnType() { return parseType(); }
+TypeSpec Parser::parseReturnType() { return parseType(); }
 
 std::vector<std::shared_ptr<Expr>> Parser::parseArgs() {
   // we know current token is '('
@@ -350,15 +514,61 @@ std::shared_ptr<Expr> Parser::parseOperand() {
     Token ident = advance();
     return std::make_shared<IdentExpr>(ident);
   }
+  case LBRACK:
+  case LESS:
+    return parseArrayLiteral();
+  case INT:
+  case FLOAT:
+  case INT8:
+  case INT16:
+  case INT32:
+  case UINT8:
+  case UINT16:
+  case UINT32:
+  case UINT64:
+  case FLOAT32:
+    return parseConversion();
   default:
     reportError("Expected expression");
     return nullptr;
   }
 }
 
+std::shared_ptr<Expr> Parser::parseArrayLiteral() {
+  // we know current token is '[' or '<'
+  TypeSpec type = parseType();
+  consume(LBRACE, "Expected '{' after type of array literal");
+  std::vector<std::shared_ptr<Expr>> elements = {};
+
+  while (!check(RBRACE) && !check(T_EOF)) {
+    elements.push_back(parseExpr());
+    if (!check(RBRACE)) {
+      consume(COMMA, "Expected ',' between elements of array literal");
+    }
+  }
+
+  Token rbrace = consume(RBRACE, "Expected '}' after elements of array literal");
+  return std::make_shared<ArrayLiteralExpr>(type, elements, rbrace);
+}
+
+std::shared_ptr<Expr> Parser::parseConversion() {
+  // we know current token is a numeric type
+  Token type = advance();
+  consume(LPAREN, "Expected '(' after type in conversion");
+  std::shared_ptr<Expr> value = parseExpr();
+  Token rparen = consume(RPAREN, "Expected ')' after value in conversion");
+  return std::make_shared<ConversionExpr>(type, value, rparen);
+}
+
 void Parser::reportError(std::string error_msg) {
-  std::cerr << "<" << this->file->getFilename() << ":l." << currentToken().line << ":c"
-            << currentToken().column << "> Parsing error: " << error_msg << std::endl;
+  if (currentToken().tokenType == ILLEGAL) {
+    // the scanner has already reported the error of this token
+    throw Parser::ParsingError();
+  }
+
+  this->file->getErrorStream() << "<" << this->file->getFilename() << ":l." << currentToken().line
+                                << ":c" << currentToken().column << "> Parsing error: " << error_msg
+                                << std::endl;
 
   this->file->setErrorInParsing(true);
   throw Parser::ParsingError();
@@ -372,11 +582,15 @@ void Parser::synchronize() {
     case VAR:
     case CONST:
     case FUNC:
+    case STRUCT:
     // If the start of a new statement is found
     case IF:
     case FOR:
+    case PARALLEL:
     case WHILE:
     case RETURN:
+    case BREAK:
+    case CONTINUE:
     case LBRACE:
       loop = false;
       break;
@@ -391,17 +605,32 @@ void Parser::synchronize() {
   }
 }
 
-bool Parser::isAtEnd() {
-  return (currentToken().tokenType == T_EOF) || (this->current >= this->file->getTokens().size());
+const Token &Parser::tokenAt(int pos) {
+  // pull tokens from the scanner until the token at \pos is in the buffer. The scanner keeps
+  // returning T_EOF at the end of the source code, so this always terminates
+  while (this->scanned <= pos) {
+    const Token &token = this->tokens[this->scanned % LOOKAHEAD_SIZE] = this->scanner.nextToken();
+    // the T_EOF returned again after the first one are not part of the stream
+    bool afterEnd = this->scanned > 0 &&
+                    this->tokens[(this->scanned - 1) % LOOKAHEAD_SIZE].tokenType == T_EOF;
+    if (this->tokenListener && !afterEnd) {
+      this->tokenListener(token);
+    }
+    this->scanned++;
+  }
+
+  return this->tokens[pos % LOOKAHEAD_SIZE];
 }
 
-Token Parser::currentToken() { return this->file->getTokens()[current]; }
+bool Parser::isAtEnd() { return currentToken().tokenType == T_EOF; }
+
+Token Parser::currentToken() { return tokenAt(current); }
 
 Token Parser::previousToken() {
   if (this->current > 0) {
-    return this->file->getTokens()[current - 1];
+    return tokenAt(current - 1);
   } else {
-    return this->file->getTokens()[current];
+    return tokenAt(current);
   }
 }
 
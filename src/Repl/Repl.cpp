@@ -0,0 +1,238 @@
+//===- src/Repl/Repl.cpp - Implementation of the Repl class -------------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the Repl class.
+// Every input is generated in its own LLVM module (and LLVMContext) that is added to the JIT. The
+// functions and globals of the previous inputs are declared as external in the module, and the
+// JIT links them with the definitions in the modules of the previous inputs. The symbols of the
+// process (i.e. printf) are also available.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "stoc/Repl/Repl.h"
+
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "stoc/CodeGeneration/CodeGeneration.h"
+#include "stoc/Optimization/BoundsCheckElimination.h"
+#include "stoc/Optimization/ConstantFolding.h"
+#include "stoc/Optimization/FunctionEffects.h"
+#include "stoc/Parser/Parser.h"
+#include "stoc/Runtime/Parallel.h"
+#include "stoc/Runtime/Task.h"
+#include "stoc/SemanticAnalysis/Semantic.h"
+#include "stoc/SrcFile/SrcFile.h"
+
+Repl::Repl(unsigned jobs) : jobs(jobs), inputs(0) {
+  globalSymbolTable = Semantic::createGlobalSymbolTable();
+}
+
+Repl::~Repl() = default;
+
+bool Repl::isComplete(const std::string &input) {
+  int openBraces = 0;
+  bool inString = false;
+  for (char c : input) {
+    if (c == '"') {
+      inString = !inString;
+    } else if (!inString && c == '{') {
+      openBraces++;
+    } else if (!inString && c == '}') {
+      openBraces--;
+    }
+  }
+  return openBraces <= 0;
+}
+
+std::string Repl::toSourceCode(const std::string &input, const std::string &statementsFunction,
+                               bool &hasStatements) {
+  std::size_t start = input.find_first_not_of(" \t\n");
+  std::size_t end = input.find_last_not_of(" \t\n");
+  std::string code = input.substr(start, end - start + 1);
+
+  // Declarations are global, so they are kept for the next inputs
+  for (const std::string keyword : {"func", "var", "const", "struct"}) {
+    if (code.compare(0, keyword.size(), keyword) == 0 && code.size() > keyword.size() &&
+        std::isspace(code[keyword.size()])) {
+      hasStatements = false;
+      return code;
+    }
+  }
+
+  // An expression (it does not end like a statement) is printed
+  hasStatements = true;
+  if (code.back() != ';' && code.back() != '}') {
+    code = "println(" + code + ");";
+  }
+  return "func " + statementsFunction + "() {\n" + code + "\n}\n";
+}
+
+bool Repl::evaluate(const std::string &input) {
+  std::string id = std::to_string(inputs);
+  std::string statementsFunction = "__stoc_repl_" + id;
+  bool hasStatements;
+  auto src = std::make_shared<SrcFile>("repl", toSourceCode(input, statementsFunction,
+                                                            hasStatements));
+
+  Parser parser(src);
+  parser.parse();
+  if (src->isErrorInScanning() || src->isErrorInParsing()) {
+    return false;
+  }
+
+  // If the input has errors, the globals it has declared are removed
+  SymbolTable previousGlobals = *globalSymbolTable;
+  Semantic semantic(src, globalSymbolTable, jobs);
+  semantic.analyse();
+  if (src->isErrorInSemanticAnalysis()) {
+    *globalSymbolTable = previousGlobals;
+    return false;
+  }
+
+  ConstantFolding folding(src);
+  folding.fold();
+  BoundsCheckElimination boundsCheckElimination(src);
+  boundsCheckElimination.eliminate();
+  FunctionEffects functionEffects(src);
+  functionEffects.infer();
+
+  std::string initializationFunction = "__stoc_repl_init_" + id;
+  CodeGeneration codegen(src, jobs);
+  codegen.generateIncremental(declarations, initializationFunction);
+  if (src->isErrorInCodeGeneration()) {
+    *globalSymbolTable = previousGlobals;
+    return false;
+  }
+
+  // The module is moved to its own LLVMContext, owned by the JIT, through bitcode
+  llvm::SmallVector<char, 0> bitcode;
+  llvm::raw_svector_ostream bitcodeStream(bitcode);
+  llvm::WriteBitcodeToFile(codegen.getModule(), bitcodeStream);
+  auto context = std::make_unique<llvm::LLVMContext>();
+  auto module = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), "repl"), *context);
+  if (!module) {
+    std::cerr << "Internal Error - " << llvm::toString(module.takeError()) << std::endl;
+    *globalSymbolTable = previousGlobals;
+    return false;
+  }
+  if (auto error =
+          jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(*module), std::move(context)))) {
+    std::cerr << "Internal Error - " << llvm::toString(std::move(error)) << std::endl;
+    *globalSymbolTable = previousGlobals;
+    return false;
+  }
+
+  std::string mangledStatementsFunction;
+  for (const auto &declaration : src->getAst()) {
+    declarations.push_back(declaration);
+    if (declaration->getDeclKind() == Decl::Kind::FUNCDECL) {
+      const auto &function = static_cast<const FuncDecl &>(*declaration);
+      if (function.getIdentifierToken().value == statementsFunction) {
+        mangledStatementsFunction = function.getIdentifierMangled();
+      }
+    }
+  }
+  inputs++;
+
+  // The globals are initialized before the statements are executed
+  std::vector<std::string> functionsToRun = {initializationFunction};
+  if (hasStatements) {
+    functionsToRun.push_back(mangledStatementsFunction);
+  }
+  for (const auto &functionName : functionsToRun) {
+    auto symbol = jit->lookup(functionName);
+    if (!symbol) {
+      std::cerr << "Internal Error - " << llvm::toString(symbol.takeError()) << std::endl;
+      return false;
+    }
+    auto *function = reinterpret_cast<void (*)()>(symbol->getAddress());
+    function();
+  }
+
+  // the output of the program (printf) is shown before the next prompt
+  std::fflush(stdout);
+  return true;
+}
+
+int Repl::run() {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+
+  auto jitOrError = llvm::orc::LLJITBuilder().create();
+  if (!jitOrError) {
+    std::cerr << "Failed to create the JIT: " << llvm::toString(jitOrError.takeError())
+              << std::endl;
+    return 1;
+  }
+  jit = std::move(*jitOrError);
+
+  // The functions of the C library (i.e. printf) are resolved in the process
+  auto generator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+      jit->getDataLayout().getGlobalPrefix());
+  if (!generator) {
+    std::cerr << "Failed to create the JIT: " << llvm::toString(generator.takeError())
+              << std::endl;
+    return 1;
+  }
+  jit->getMainJITDylib().addGenerator(std::move(*generator));
+
+  // The runtime of the parallel for loops and the tasks is linked into stoc
+  llvm::orc::SymbolMap runtime;
+  auto addRuntimeSymbol = [&](const char *name, auto *address) {
+    runtime[jit->mangleAndIntern(name)] = llvm::JITEvaluatedSymbol(
+        llvm::pointerToJITTargetAddress(address), llvm::JITSymbolFlags::Exported);
+  };
+  addRuntimeSymbol("stoc_parallel_for", &stoc_parallel_for);
+  addRuntimeSymbol("stoc_parallel_lock", &stoc_parallel_lock);
+  addRuntimeSymbol("stoc_parallel_unlock", &stoc_parallel_unlock);
+  addRuntimeSymbol("stoc_spawn", &stoc_spawn);
+  addRuntimeSymbol("stoc_await", &stoc_await);
+  if (auto error = jit->getMainJITDylib().define(llvm::orc::absoluteSymbols(runtime))) {
+    std::cerr << "Failed to create the JIT: " << llvm::toString(std::move(error)) << std::endl;
+    return 1;
+  }
+
+  std::cout << "Stoc REPL. Enter declarations (func, var, const), statements or expressions. "
+               "Type :quit to exit."
+            << std::endl;
+
+  std::string input;
+  std::string line;
+  while (true) {
+    std::cout << (input.empty() ? "stoc> " : "...   ") << std::flush;
+    if (!std::getline(std::cin, line)) {
+      std::cout << std::endl;
+      break;
+    }
+    if (input.empty() && (line == ":quit" || line == ":q")) {
+      break;
+    }
+    if (input.empty() && line.find_first_not_of(" \t") == std::string::npos) {
+      continue;
+    }
+
+    input += line + "\n";
+    if (isComplete(input)) {
+      try {
+        evaluate(input);
+      } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+      }
+      input.clear();
+    }
+  }
+
+  return 0;
+}
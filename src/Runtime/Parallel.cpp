@@ -0,0 +1,216 @@
+//===- src/Runtime/Parallel.cpp - Implementation of the runtime of parallel for -----*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the runtime of the parallel for loops.
+// Every thread of the pool (the calling thread included) owns a contiguous part of the iteration
+// space. It runs its part from the front in chunks that become smaller as the part shrinks
+// (guided scheduling), so the thread synchronizes little when it has a lot of work left and the
+// work is split finely at the end. A thread that runs out of work steals the back half of the part
+// of another thread.
+//
+//===------------------------------------------------------------------------------------------===//
+#include "stoc/Runtime/Parallel.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// true in the threads that are running the iterations of a parallel for
+thread_local bool insideParallelFor = false;
+
+/// Lock of the reductions (see stoc_parallel_lock)
+std::mutex reductionMutex;
+
+/// Pool of threads that run the parallel for loops, created the first time a parallel for runs
+class ThreadPool {
+private:
+  /// Iterations [begin, end) not run yet of the part of a thread. It is aligned to its own cache
+  /// line so the threads do not invalidate the ranges of each other
+  struct alignas(64) Range {
+    std::mutex mutex;
+    std::int64_t begin = 0;
+    std::int64_t end = 0;
+  };
+
+  std::vector<std::thread> workers;
+  /// One range for each worker and one for the calling thread (the last one)
+  std::vector<std::unique_ptr<Range>> ranges;
+
+  /// Only one parallel for runs in the pool at a time
+  std::mutex busy;
+
+  // Parallel for being run, protected by mutex
+  std::mutex mutex;
+  std::condition_variable start;
+  std::condition_variable finish;
+  stoc_parallel_body body = nullptr;
+  void *context = nullptr;
+  /// Incremented every time a parallel for starts, so the workers know there is a new one
+  unsigned generation = 0;
+  /// Number of workers that have not finished the current parallel for
+  unsigned running = 0;
+
+  /// Loop of the worker \id: waits for a parallel for and runs its iterations
+  void work(unsigned id) {
+    insideParallelFor = true;
+    unsigned lastGeneration = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        start.wait(lock, [&]() { return generation != lastGeneration; });
+        lastGeneration = generation;
+      }
+
+      run(id);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--running == 0) {
+        finish.notify_one();
+      }
+    }
+  }
+
+  /// takes the next chunk of iterations of the part of thread \id: the number of iterations left
+  /// divided by twice the number of threads, so every thread takes several chunks of its part
+  bool takeChunk(unsigned id, std::int64_t &begin, std::int64_t &end) {
+    Range &range = *ranges[id];
+    std::lock_guard<std::mutex> lock(range.mutex);
+    std::int64_t left = range.end - range.begin;
+    if (left <= 0) {
+      return false;
+    }
+    std::int64_t parts = 2 * static_cast<std::int64_t>(ranges.size());
+    begin = range.begin;
+    end = begin + std::max<std::int64_t>(1, (left + parts - 1) / parts);
+    range.begin = end;
+    return true;
+  }
+
+  /// steals the back half of the iterations left in the part of another thread and makes them the
+  /// part of thread \id. Returns false if no thread has iterations left
+  bool steal(unsigned id) {
+    for (std::size_t i = 1; i < ranges.size(); i++) {
+      Range &victim = *ranges[(id + i) % ranges.size()];
+      std::int64_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        std::int64_t left = victim.end - victim.begin;
+        if (left <= 0) {
+          continue;
+        }
+        begin = victim.begin + left / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+
+      Range &range = *ranges[id];
+      std::lock_guard<std::mutex> lock(range.mutex);
+      range.begin = begin;
+      range.end = end;
+      return true;
+    }
+    return false;
+  }
+
+  /// runs the iterations of the part of thread \id and then the ones stolen from other threads
+  void run(unsigned id) {
+    std::int64_t begin, end;
+    do {
+      while (takeChunk(id, begin, end)) {
+        body(context, begin, end);
+      }
+    } while (steal(id));
+  }
+
+public:
+  /// \threads is the number of threads that run a parallel for, including the calling thread
+  explicit ThreadPool(unsigned threads) {
+    for (unsigned i = 0; i < threads; i++) {
+      ranges.push_back(std::make_unique<Range>());
+    }
+    for (unsigned i = 0; i + 1 < threads; i++) {
+      workers.emplace_back(&ThreadPool::work, this, i);
+    }
+  }
+
+  /// returns the pool of the program (see stoc_number_of_threads). The pool is never destroyed
+  /// because the program can exit (i.e. an index out of range) while a parallel for is running
+  static ThreadPool &get() {
+    static ThreadPool *pool = new ThreadPool(stoc_number_of_threads());
+    return *pool;
+  }
+
+  /// runs the iterations [begin, end) of \body in the pool. Returns false, without running them,
+  /// if the pool is running another parallel for
+  bool parallelFor(std::int64_t begin, std::int64_t end, stoc_parallel_body body, void *context) {
+    std::unique_lock<std::mutex> busyLock(busy, std::try_to_lock);
+    if (!busyLock.owns_lock()) {
+      return false;
+    }
+
+    // Every thread starts with an equal part of the iterations
+    std::int64_t threads = static_cast<std::int64_t>(ranges.size());
+    std::int64_t iterations = end - begin;
+    for (std::int64_t i = 0; i < threads; i++) {
+      ranges[i]->begin = begin + iterations * i / threads;
+      ranges[i]->end = begin + iterations * (i + 1) / threads;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->body = body;
+      this->context = context;
+      running = workers.size();
+      generation++;
+    }
+    start.notify_all();
+
+    insideParallelFor = true;
+    run(ranges.size() - 1);
+    insideParallelFor = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finish.wait(lock, [&]() { return running == 0; });
+    return true;
+  }
+
+  [[nodiscard]] unsigned getThreads() const { return ranges.size(); }
+};
+
+} // namespace
+
+void stoc_parallel_for(std::int64_t begin, std::int64_t end, stoc_parallel_body body,
+                       void *context) {
+  if (begin >= end) {
+    return;
+  }
+
+  // A parallel for nested in another one (or run while the pool is busy) runs in this thread: the
+  // threads of the pool are already busy with the outer loop
+  if (!insideParallelFor && end - begin > 1) {
+    ThreadPool &pool = ThreadPool::get();
+    if (pool.getThreads() > 1 && pool.parallelFor(begin, end, body, context)) {
+      return;
+    }
+  }
+  body(context, begin, end);
+}
+
+void stoc_parallel_lock() { reductionMutex.lock(); }
+
+void stoc_parallel_unlock() { reductionMutex.unlock(); }
+
+unsigned stoc_number_of_threads() {
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  if (const char *numThreads = std::getenv("STOC_NUM_THREADS")) {
+    threads = std::max(1, std::atoi(numThreads));
+  }
+  return threads;
+}
@@ -0,0 +1,195 @@
+//===- src/Runtime/Task.cpp - Implementation of the runtime of tasks ----------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the runtime of the tasks.
+// Every worker of the pool has its own queue of tasks: it pushes the tasks it spawns at the back
+// and runs them from the back (the most recent first, whose data is still in its cache), while the
+// workers that run out of tasks steal from the front of the queues of the others (the oldest
+// tasks, which usually spawn the most work). The threads that are not workers (i.e. the main
+// thread) share one more queue. A thread that awaits a task that has not finished runs other tasks
+// instead of blocking.
+//
+//===------------------------------------------------------------------------------------------===//
+#include "stoc/Runtime/Task.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stoc/Runtime/Parallel.h"
+
+namespace {
+
+/// Task spawned: the function that runs it and its box
+struct Task {
+  stoc_task_function function;
+  void *box;
+};
+
+/// State of a task, stored in the first 8 bytes of its box: 0 while running, 1 when finished
+std::atomic<std::int64_t> &getState(void *box) {
+  return *reinterpret_cast<std::atomic<std::int64_t> *>(box);
+}
+
+/// Id of the queue of the current thread. Threads that are not workers use the shared queue
+thread_local int queueId = -1;
+
+/// Pool of threads that run the tasks, created the first time a task is spawned
+class Scheduler {
+private:
+  /// Queue of tasks of a worker. It is aligned to its own cache line so the workers do not
+  /// invalidate the queues of each other
+  struct alignas(64) Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::thread> workers;
+  /// One queue for each worker and the shared queue (the last one)
+  std::vector<std::unique_ptr<Queue>> queues;
+
+  /// Number of tasks in the queues
+  std::atomic<std::int64_t> pending{0};
+
+  // Threads sleeping until a task is spawned or finishes, protected by mutex
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::atomic<unsigned> sleeping{0};
+
+  /// wakes up the sleeping threads, if any, after a task has been spawned or has finished
+  void notify() {
+    if (sleeping.load() > 0) {
+      { std::lock_guard<std::mutex> lock(mutex); }
+      changed.notify_all();
+    }
+  }
+
+  /// sleeps until a task is spawned or \finished returns true
+  template <typename Predicate> void sleep(Predicate finished) {
+    std::unique_lock<std::mutex> lock(mutex);
+    sleeping++;
+    changed.wait(lock, [&]() { return pending.load() > 0 || finished(); });
+    sleeping--;
+  }
+
+  /// takes the most recent task of the queue \id or, if it is empty, the oldest task of the queue
+  /// of another thread. Returns false if there are no tasks
+  bool take(unsigned id, Task &task) {
+    {
+      Queue &queue = *queues[id];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        pending--;
+        return true;
+      }
+    }
+
+    for (std::size_t i = 1; i < queues.size(); i++) {
+      Queue &victim = *queues[(id + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        pending--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// runs \task and marks it as finished
+  void run(const Task &task) {
+    task.function(task.box);
+    getState(task.box).store(1);
+    notify();
+  }
+
+  /// Loop of the worker \id: runs the tasks of its queue or the ones stolen from other threads
+  void work(unsigned id) {
+    queueId = id;
+    Task task{};
+    while (true) {
+      if (take(id, task)) {
+        run(task);
+      } else {
+        sleep([]() { return false; });
+      }
+    }
+  }
+
+  /// returns the queue of the current thread
+  unsigned getQueueId() const { return queueId < 0 ? workers.size() : queueId; }
+
+public:
+  /// \threads is the number of threads that run tasks, including the thread that awaits them
+  explicit Scheduler(unsigned threads) {
+    for (unsigned i = 0; i < threads; i++) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i + 1 < threads; i++) {
+      workers.emplace_back(&Scheduler::work, this, i);
+    }
+  }
+
+  /// returns the scheduler of the program (see stoc_number_of_threads). It is never destroyed
+  /// because the program can exit while the tasks are running
+  static Scheduler &get() {
+    static Scheduler *scheduler = new Scheduler(stoc_number_of_threads());
+    return *scheduler;
+  }
+
+  /// queues \task in the queue of the current thread
+  void spawn(const Task &task) {
+    getState(task.box).store(0);
+    // Without workers, nobody would run the task if it is never awaited
+    if (workers.empty()) {
+      run(task);
+      return;
+    }
+
+    Queue &queue = *queues[getQueueId()];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(task);
+    }
+    pending++;
+    notify();
+  }
+
+  /// runs other tasks until the task of \box finishes
+  void await(void *box) {
+    auto finished = [box]() { return getState(box).load() != 0; };
+    unsigned id = getQueueId();
+    Task task{};
+    while (!finished()) {
+      if (take(id, task)) {
+        run(task);
+      } else {
+        sleep(finished);
+      }
+    }
+  }
+};
+
+} // namespace
+
+void stoc_spawn(stoc_task_function function, void *box) { Scheduler::get().spawn({function, box}); }
+
+void stoc_await(void *box) {
+  if (box == nullptr) {
+    std::printf("Runtime error: await of a task that has not been spawned or has already been "
+                "awaited\n");
+    std::exit(1);
+  }
+  Scheduler::get().await(box);
+}
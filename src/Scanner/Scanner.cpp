@@ -3,7 +3,7 @@
 //===------------------------------------------------------------------------------------------===//
 //
 // This file implements the Scanner class.
-// Scanning is the first phase of a compiler and transforms the raw source code into a list of
+// Scanning is the first phase of a compiler and transforms the raw source code into a stream of
 // tokens such as ADD, SUB, IDENTIFIER, ...
 //
 //===------------------------------------------------------------------------------------------===//
@@ -13,7 +13,7 @@
 #include <iostream>
 #include <utility>
 
-Scanner::Scanner(std::shared_ptr<SrcFile> file) : file(std::move(file)), tokens({}) {
+Scanner::Scanner(std::shared_ptr<SrcFile> file) : file(std::move(file)) {
   this->start = 0;
   this->current = 0;
   this->line = 1;
@@ -22,26 +22,6 @@ Scanner::Scanner(std::shared_ptr<SrcFile> file) : file(std::move(file)), tokens(
   this->columnStart = 1;
 }
 
-void Scanner::scan() {
-  while (!isAtEnd()) {
-    scanNextToken();
-  }
-
-  updateStart(); // needed to correctly add T_EOF
-  tokens.push_back(makeToken(T_EOF));
-  this->file->setTokens(this->tokens);
-}
-
-void Scanner::printTokens() {
-  if (!tokens.empty()) {
-    for (const auto &token : tokens) {
-      std::cout << token << std::endl;
-    }
-  } else {
-    std::cout << "No token has been parsed" << std::endl;
-  }
-}
-
 bool Scanner::isDigit(char c) { return '0' <= c && c <= '9'; }
 
 bool Scanner::isAlpha(char c) {
@@ -51,8 +31,9 @@ bool Scanner::isAlpha(char c) {
 bool Scanner::isAlphaNum(char c) { return isDigit(c) || isAlpha(c); }
 
 void Scanner::reportError(const std::string &msg) {
-  std::cerr << "<" << this->file->getFilename() << ":l." << this->lineStart << ":c."
-            << this->columnStart << "> Scanning error: " << msg << std::endl;
+  this->file->getErrorStream() << "<" << this->file->getFilename() << ":l." << this->lineStart
+                                << ":c." << this->columnStart << "> Scanning error: " << msg
+                                << std::endl;
 
   this->file->setErrorInScanning(true);
 }
@@ -113,6 +94,18 @@ TokenType Scanner::tokenType() {
     return FUNC;
   } else if (identifier == "return") {
     return RETURN;
+  } else if (identifier == "break") {
+    return BREAK;
+  } else if (identifier == "continue") {
+    return CONTINUE;
+  } else if (identifier == "struct") {
+    return STRUCT;
+  } else if (identifier == "parallel") {
+    return PARALLEL;
+  } else if (identifier == "spawn") {
+    return SPAWN;
+  } else if (identifier == "await") {
+    return AWAIT;
   } else if (identifier == "bool") {
     return BOOL;
   } else if (identifier == "int") {
@@ -121,6 +114,26 @@ TokenType Scanner::tokenType() {
     return FLOAT;
   } else if (identifier == "string") {
     return STRING;
+  } else if (identifier == "int8") {
+    return INT8;
+  } else if (identifier == "int16") {
+    return INT16;
+  } else if (identifier == "int32") {
+    return INT32;
+  } else if (identifier == "uint8") {
+    return UINT8;
+  } else if (identifier == "uint16") {
+    return UINT16;
+  } else if (identifier == "uint32") {
+    return UINT32;
+  } else if (identifier == "uint64") {
+    return UINT64;
+  } else if (identifier == "float32") {
+    return FLOAT32;
+  } else if (identifier == "task") {
+    return TASK;
+  } else if (identifier == "atomic") {
+    return ATOMIC;
   } else if (identifier == "true") {
     return LIT_TRUE;
   } else if (identifier == "false") {
@@ -162,7 +175,7 @@ void Scanner::skipWhiteSpaces() {
   }
 }
 
-void Scanner::scanNumber() {
+Token Scanner::scanNumber() {
   // TODO: (Improvement) support numbers as 1_000_000 with underscore _
   // integer part
   while (isDigit(peek())) {
@@ -176,20 +189,20 @@ void Scanner::scanNumber() {
       advance();
     }
 
-    tokens.push_back(makeToken(LIT_FLOAT));
+    return makeToken(LIT_FLOAT);
   } else {
-    tokens.push_back(makeToken(LIT_INT));
+    return makeToken(LIT_INT);
   }
 }
 
-void Scanner::scanIdentifier() {
+Token Scanner::scanIdentifier() {
   // we know first character is alpha from scanNextToken
   while (isAlphaNum(peek())) {
     advance();
   }
 
   TokenType type = tokenType(); // check if the string is a keyword
-  tokens.push_back(makeToken(type));
+  return makeToken(type);
 }
 
 void Scanner::scanLineComment() {
@@ -208,7 +221,7 @@ void Scanner::scanLineComment() {
   }
 }
 
-void Scanner::scanString() {
+Token Scanner::scanString() {
   // TODO: (Improvement) string recognition with escape sequences
   // Multi line strings are supported
   // first quotes defining the string have been treated
@@ -221,118 +234,127 @@ void Scanner::scanString() {
   }
 
   if (isAtEnd()) {
-    tokens.push_back(makeErrorToken("missing \" character for defining strings"));
+    return makeErrorToken("missing \" character for defining strings");
   } else {
     this->start++; // advance start not to add initial quotes
-    tokens.push_back(makeToken(LIT_STRING));
+    Token string = makeToken(LIT_STRING);
     advance(); // advance to process ending quotes
+    return string;
   }
 }
 
-void Scanner::scanNextToken() {
-  skipWhiteSpaces();
-  updateStart();
+Token Scanner::nextToken() {
+  while (true) {
+    skipWhiteSpaces();
+    updateStart();
+
+    if (isAtEnd()) {
+      // once the end of the source code is reached, every call returns T_EOF
+      return makeToken(T_EOF);
+    }
+
+    char c = peek();
+    if (isDigit(c)) {
+      return scanNumber();
+    } else if (isAlpha(c)) { // identifiers must start with alphabet character or underscore
+      return scanIdentifier();
+    }
 
-  char c = peek();
-  if (isDigit(c)) {
-    scanNumber();
-  } else if (isAlpha(c)) { // identifiers must start with alphabet character or underscore
-    scanIdentifier();
-  } else {
     advance(); // make progress
     switch (c) {
     case '+':
-      tokens.push_back(makeToken(ADD));
-      break;
+      return makeToken(ADD);
     case '-':
-      tokens.push_back(makeToken(SUB));
-      break;
+      return makeToken(SUB);
     case '*':
-      tokens.push_back(makeToken(STAR));
-      break;
+      return makeToken(STAR);
     case '/':
       if (peek() == '/') {
         advance();
         scanLineComment();
+        continue; // comments do not produce tokens
       } else {
-        tokens.push_back(makeToken(SLASH));
+        return makeToken(SLASH);
       }
-      break;
+    case '%':
+      return makeToken(PERCENT);
     case '&':
       if (peek() == '&') {
         advance();
-        tokens.push_back(makeToken(LAND));
+        return makeToken(LAND);
       } else {
-        tokens.push_back(makeErrorToken("Operand Bit And not supported yet"));
-        advance();
+        return makeToken(AMPERSAND);
       }
-      break;
     case '|':
       if (peek() == '|') {
         advance();
-        tokens.push_back(makeToken(LOR));
+        return makeToken(LOR);
       } else {
-        tokens.push_back(makeErrorToken("Operand Bit Or not supported yet"));
-        advance();
+        return makeToken(PIPE);
       }
-      break;
+    case '^':
+      return makeToken(CARET);
+    case '~':
+      return makeToken(TILDE);
     case '!':
       if (peek() == '=') {
         advance();
-        tokens.push_back(makeToken(NOT_EQUAL));
+        return makeToken(NOT_EQUAL);
       } else {
-        tokens.push_back(makeToken(NOT));
+        return makeToken(NOT);
       }
-      break;
     case '=':
       if (peek() == '=') {
         advance();
-        tokens.push_back(makeToken(EQUAL));
+        return makeToken(EQUAL);
       } else {
-        tokens.push_back(makeToken(ASSIGN));
+        return makeToken(ASSIGN);
       }
-      break;
     case '<':
       if (peek() == '=') {
         advance();
-        tokens.push_back(makeToken(LESS_EQUAL));
+        return makeToken(LESS_EQUAL);
+      } else if (peek() == '<') {
+        advance();
+        return makeToken(SHIFT_LEFT);
       } else {
-        tokens.push_back(makeToken(LESS));
+        return makeToken(LESS);
       }
-      break;
     case '>':
       if (peek() == '=') {
         advance();
-        tokens.push_back(makeToken(GREATER_EQUAL));
+        return makeToken(GREATER_EQUAL);
+      } else if (peek() == '>') {
+        advance();
+        return makeToken(SHIFT_RIGHT);
       } else {
-        tokens.push_back(makeToken(GREATER));
+        return makeToken(GREATER);
       }
-      break;
     case '(':
-      tokens.push_back(makeToken(LPAREN));
-      break;
+      return makeToken(LPAREN);
     case ')':
-      tokens.push_back(makeToken(RPAREN));
-      break;
+      return makeToken(RPAREN);
     case '{':
-      tokens.push_back(makeToken(LBRACE));
-      break;
+      return makeToken(LBRACE);
     case '}':
-      tokens.push_back(makeToken(RBRACE));
-      break;
+      return makeToken(RBRACE);
+    case '[':
+      return makeToken(LBRACK);
+    case ']':
+      return makeToken(RBRACK);
     case ';':
-      tokens.push_back(makeToken(SEMICOLON));
-      break;
+      return makeToken(SEMICOLON);
     case ',':
-      tokens.push_back(makeToken(COMMA));
-      break;
+      return makeToken(COMMA);
+    case '.':
+      return makeToken(PERIOD);
     case '"':
-      scanString();
-      break;
-    default:
-      tokens.push_back(makeErrorToken("Unrecognized token"));
+      return scanString();
+    default: {
+      Token error = makeErrorToken("Unrecognized token");
       advance(); // if character not recognized it is represented by two characters \xxx\xxx
-      break;
+      return error;
+    }
     }
   }
 }
@@ -14,12 +14,16 @@
 
 std::string to_string(TokenType type) {
   std::vector<std::string> TokenTypeAsString = {
-      "'+'",       "'-'",        "'*'",     "'/'",        "'&&'",     "'||'",      "'!'",
-      "'='",       "'=='",       "'!='",    "'<'",        "'>'",      "'<='",      "'>='",
-      "'('",       "')'",        "'{'",     "'}'",        "';'",      "','",       "var",
-      "const",     "if",         "else",    "for",        "while",    "func",      "return",
-      "bool",      "int",        "float",   "string",     "LIT_TRUE", "LIT_FALSE", "LIT_INT",
-      "LIT_FLOAT", "LIT_STRING", "LIT_NIL", "IDENTIFIER", "ILLEGAL",  "T_EOF"};
+      "'+'",     "'-'",        "'*'",      "'/'",       "'%'",      "'&&'",      "'||'",
+      "'!'",     "'&'",        "'|'",      "'^'",       "'~'",      "'<<'",      "'>>'",
+      "'='",     "'=='",       "'!='",     "'<'",       "'>'",      "'<='",      "'>='",
+      "'('",     "')'",        "'{'",      "'}'",       "'['",      "']'",       "';'",
+      "','",     "'.'",        "var",      "const",     "if",       "else",      "for",
+      "while",   "func",       "return",   "break",     "continue", "struct",    "parallel",
+      "spawn",   "await",      "bool",     "int",       "float",    "string",    "int8",
+      "int16",   "int32",      "uint8",    "uint16",    "uint32",   "uint64",    "float32",
+      "task",    "atomic",     "LIT_TRUE", "LIT_FALSE", "LIT_INT",  "LIT_FLOAT", "LIT_STRING",
+      "LIT_NIL", "IDENTIFIER", "ILLEGAL",  "T_EOF"};
 
   return TokenTypeAsString[type];
 }
@@ -42,11 +46,21 @@ int tokenPrec(TokenType type) {
   case LESS_EQUAL:
   case GREATER_EQUAL:
     return PREC_EQUALITY;
+  case PIPE:
+    return PREC_BITOR;
+  case CARET:
+    return PREC_BITXOR;
+  case AMPERSAND:
+    return PREC_BITAND;
+  case SHIFT_LEFT:
+  case SHIFT_RIGHT:
+    return PREC_SHIFT;
   case ADD:
   case SUB:
     return PREC_TERM;
   case STAR:
   case SLASH:
+  case PERCENT:
     return PREC_FACTOR;
   default:
     return PREC_LOWEST; // non-operators
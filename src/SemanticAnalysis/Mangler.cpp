@@ -13,6 +13,37 @@
 
 namespace mangler {
 
+/// returns the name of \type in a mangled identifier. The name of a basic type is kept
+/// (i.e. int, uint8), arrays are A(size)(element) or D(element) (i.e. [4]int -> A4int,
+/// []int -> Dint), vectors are V(lanes)(element) (i.e. <4>float -> V4float), tasks are T(result)
+/// (i.e. task int -> Tint), atomics are Y(element) (i.e. atomic int -> Yint) and structs are
+/// S(length of name)(name) (i.e. Point -> S5Point, so a struct can not be confused with the other
+/// types). No name of a type starts with a digit, so the names of the parameters can not be
+/// confused once concatenated (i.e. int and 8... can not be read as int8)
+static std::string mangleType(const std::shared_ptr<Type> &type) {
+  if (type->getTypeKind() == Type::Kind::ArrayType) {
+    auto arrayType = std::dynamic_pointer_cast<ArrayType>(type);
+    if (arrayType->isDynamic()) {
+      return "D" + mangleType(arrayType->getElement());
+    }
+    return "A" + std::to_string(arrayType->getSize()) + mangleType(arrayType->getElement());
+  }
+  if (type->getTypeKind() == Type::Kind::VectorType) {
+    auto vectorType = std::dynamic_pointer_cast<VectorType>(type);
+    return "V" + std::to_string(vectorType->getLanes()) + vectorType->getElement()->getName();
+  }
+  if (type->getTypeKind() == Type::Kind::TaskType) {
+    return "T" + mangleType(std::dynamic_pointer_cast<TaskType>(type)->getResult());
+  }
+  if (type->getTypeKind() == Type::Kind::AtomicType) {
+    return "Y" + std::dynamic_pointer_cast<AtomicType>(type)->getElement()->getName();
+  }
+  if (type->getTypeKind() == Type::Kind::StructType) {
+    return "S" + std::to_string(type->getName().size()) + type->getName();
+  }
+  return type->getName();
+}
+
 std::string mangle(std::string functionName, std::shared_ptr<FunctionType> functionType) {
   // Initial name
   std::string functionNameMangled = functionName;
@@ -28,12 +59,12 @@ std::string mangle(std::string functionName, std::shared_ptr<FunctionType> funct
 
   // Type of every parameter
   for (const auto &param : functionType->getParams()) {
-    functionNameMangled += param->getName();
+    functionNameMangled += mangleType(param);
   }
 
   // Add start characters for return type
   functionNameMangled += "_r";
-  functionNameMangled += functionType->getResult()->getName();
+  functionNameMangled += mangleType(functionType->getResult());
   return functionNameMangled;
 }
 
@@ -12,6 +12,10 @@
 //===------------------------------------------------------------------------------------------===//
 #include "stoc/SemanticAnalysis/Semantic.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
 #include <unordered_map>
 
 #include "stoc/AST/Decl.h"
@@ -20,31 +24,263 @@
 #include "stoc/SemanticAnalysis/Mangler.h"
 #include "stoc/SemanticAnalysis/Type.h"
 
-Semantic::Semantic(std::shared_ptr<SrcFile> file)
-    : file(file), scopeLevel(0), scopeType(ScopeType::NONE) {
+Semantic::Semantic(std::shared_ptr<SrcFile> file, unsigned jobs, bool requireTailCall)
+    : file(file), scopeLevel(0), scopeType(ScopeType::NONE), jobs(std::max(1u, jobs)),
+      requireTailCall(requireTailCall), incremental(false) {
   this->symbolTable = std::make_shared<SymbolTable>(0);
 
   returnStatementInBlockStmt = false;
   declareBuiltinFunctions();
 }
 
+Semantic::Semantic(std::shared_ptr<SrcFile> file, std::shared_ptr<SymbolTable> globalSymbolTable)
+    : file(file), symbolTable(globalSymbolTable), scopeLevel(0), scopeType(ScopeType::NONE),
+      jobs(1), requireTailCall(false), incremental(false) {
+  returnStatementInBlockStmt = false;
+}
+
+Semantic::Semantic(std::shared_ptr<SrcFile> file, std::shared_ptr<SymbolTable> globalSymbolTable,
+                   unsigned jobs)
+    : file(file), symbolTable(globalSymbolTable), scopeLevel(0), scopeType(ScopeType::NONE),
+      jobs(std::max(1u, jobs)), requireTailCall(false), incremental(true) {
+  returnStatementInBlockStmt = false;
+}
+
+std::shared_ptr<SymbolTable> Semantic::createGlobalSymbolTable() {
+  auto globalSymbolTable = std::make_shared<SymbolTable>(0);
+  Semantic semantic(nullptr, globalSymbolTable);
+  semantic.declareBuiltinFunctions();
+  return globalSymbolTable;
+}
+
 void Semantic::analyse() {
-  for (const auto &declaration : file->getAst()) {
-    declaration->accept(this);
+  const auto &ast = file->getAst();
+  // The errors of every top-level declaration are kept apart, so they can be printed in source
+  // order even if the bodies of the functions are analysed in parallel
+  std::vector<std::vector<std::string>> diagnosticsOfDecl(ast.size());
+  std::vector<std::pair<std::size_t, FuncDecl *>> functions;
+
+  // The structs are declared first, so they can be used by the declarations before them
+  for (std::size_t i = 0; i < ast.size(); i++) {
+    if (ast[i]->getDeclKind() == Decl::Kind::STRUCTDECL) {
+      analyse(*ast[i]);
+      diagnosticsOfDecl[i] = std::move(diagnostics);
+      diagnostics.clear();
+    }
+  }
+
+  // First pass: declare global variables and constants, and the signatures of the functions
+  for (std::size_t i = 0; i < ast.size(); i++) {
+    if (ast[i]->getDeclKind() == Decl::Kind::STRUCTDECL) {
+      continue;
+    }
+    if (ast[i]->getDeclKind() == Decl::Kind::FUNCDECL) {
+      auto &function = static_cast<FuncDecl &>(*ast[i]);
+      declareFunction(function);
+      functions.emplace_back(i, &function);
+    } else {
+      analyse(*ast[i]);
+    }
+    diagnosticsOfDecl[i] = std::move(diagnostics);
+    diagnostics.clear();
   }
 
   // Check in the end that there is at least one main function
-  std::vector<Symbol> symbols = symbolTable->lookup("main");
-  if (symbols.empty()) {
-    reportError("missing main function");
+  if (!incremental) {
+    try {
+      symbolTable->lookup("main");
+    } catch (std::runtime_error &e) {
+      reportError("missing main function");
+    }
+  }
+
+  // Second pass: the global symbol table is not modified anymore, so the bodies of the functions
+  // can be analysed in parallel
+  symbolTable->freeze();
+  std::vector<BodySummary> bodies(functions.size());
+  analyseFunctionBodies(functions, diagnosticsOfDecl, bodies);
+  if (incremental) {
+    symbolTable->unfreeze();
+  }
+  inferPurity(functions, bodies, diagnosticsOfDecl);
+  checkTailCalls(functions, bodies, diagnosticsOfDecl);
+
+  bool errorFound = !diagnostics.empty();
+  for (const auto &diagnosticsOfOneDecl : diagnosticsOfDecl) {
+    for (const auto &diagnostic : diagnosticsOfOneDecl) {
+      this->file->getErrorStream() << diagnostic << std::endl;
+      errorFound = true;
+    }
+  }
+  for (const auto &diagnostic : diagnostics) {
+    this->file->getErrorStream() << diagnostic << std::endl;
+  }
+
+  if (errorFound) {
+    this->file->setErrorInSemanticAnalysis(true);
+  }
+}
+
+void Semantic::analyseFunctionBodies(
+    const std::vector<std::pair<std::size_t, FuncDecl *>> &functions,
+    std::vector<std::vector<std::string>> &diagnosticsOfDecl, std::vector<BodySummary> &bodies) {
+  // Every thread takes the next function that has not been analysed yet. Each function is analysed
+  // by its own Semantic object, with its own stack of scopes on top of the global symbol table
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]() {
+    for (std::size_t k = next++; k < functions.size(); k = next++) {
+      auto [position, function] = functions[k];
+      Semantic bodyAnalysis(file, symbolTable);
+      try {
+        bodyAnalysis.analyseFunctionBody(*function);
+      } catch (std::exception &e) {
+        bodyAnalysis.reportError(std::string("Internal Error - ") + e.what());
+      }
+
+      // only this thread writes the errors of the declaration in \position
+      auto &diagnosticsOfFunction = diagnosticsOfDecl[position];
+      diagnosticsOfFunction.insert(diagnosticsOfFunction.end(),
+                                   std::make_move_iterator(bodyAnalysis.diagnostics.begin()),
+                                   std::make_move_iterator(bodyAnalysis.diagnostics.end()));
+      bodies[k] = std::move(bodyAnalysis.bodySummary);
+    }
+  };
+
+  std::size_t threads = std::min<std::size_t>(jobs, functions.size());
+  std::vector<std::thread> pool;
+  for (std::size_t i = 1; i < threads; i++) {
+    pool.emplace_back(worker);
+  }
+  worker(); // the current thread also analyses functions
+  for (auto &thread : pool) {
+    thread.join();
+  }
+}
+
+void Semantic::inferPurity(const std::vector<std::pair<std::size_t, FuncDecl *>> &functions,
+                           const std::vector<BodySummary> &bodies,
+                           std::vector<std::vector<std::string>> &diagnosticsOfDecl) {
+  // Every function starts as pure as its body and stops being pure if it calls a function that is
+  // not pure, until nothing changes. The functions that call each other recursively are pure if
+  // nothing else makes them impure. The functions of previous inputs of the REPL are already known
+  std::vector<std::string> impurities;
+  for (std::size_t k = 0; k < functions.size(); k++) {
+    impurities.push_back(bodies[k].impurity);
+    functions[k].second->setPure(bodies[k].impurity.empty());
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (std::size_t k = 0; k < functions.size(); k++) {
+      FuncDecl *function = functions[k].second;
+      if (!function->isPure()) {
+        continue;
+      }
+      for (FuncDecl *callee : bodies[k].callees) {
+        if (!callee->isPure()) {
+          impurities[k] = "it calls " + callee->getIdentifierToken().value + ", which is not pure";
+          function->setPure(false);
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  for (std::size_t k = 0; k < functions.size(); k++) {
+    auto [position, function] = functions[k];
+    for (const auto &attribute : function->getAttributes()) {
+      if (attribute.name.value == "pure" && !function->isPure()) {
+        reportError("The function " + function->getIdentifierToken().value +
+                        " is declared pure but " + impurities[k],
+                    attribute.name.line, attribute.name.column);
+      }
+    }
+    // a const function is evaluated at compile time, so it can not have any effect
+    if (function->isConst() && !function->isPure()) {
+      reportError("The function " + function->getIdentifierToken().value +
+                      " is declared const but " + impurities[k],
+                  function->getFuncKeywordToken().line, function->getFuncKeywordToken().column);
+    }
+    auto &diagnosticsOfFunction = diagnosticsOfDecl[position];
+    diagnosticsOfFunction.insert(diagnosticsOfFunction.end(),
+                                 std::make_move_iterator(diagnostics.begin()),
+                                 std::make_move_iterator(diagnostics.end()));
+    diagnostics.clear();
+  }
+}
+
+void Semantic::checkTailCalls(const std::vector<std::pair<std::size_t, FuncDecl *>> &functions,
+                              const std::vector<BodySummary> &bodies,
+                              std::vector<std::vector<std::string>> &diagnosticsOfDecl) {
+  std::unordered_map<FuncDecl *, const BodySummary *> bodyOf;
+  for (std::size_t k = 0; k < functions.size(); k++) {
+    bodyOf[functions[k].second] = &bodies[k];
+  }
+  // returns true if \function can be called again from a call to \callee
+  auto isRecursiveCall = [&](FuncDecl *callee, FuncDecl *function) {
+    std::unordered_set<FuncDecl *> visited = {callee};
+    std::vector<FuncDecl *> pending = {callee};
+    while (!pending.empty()) {
+      FuncDecl *caller = pending.back();
+      pending.pop_back();
+      if (caller == function) {
+        return true;
+      }
+      auto found = bodyOf.find(caller);
+      if (found == bodyOf.end()) {
+        continue; // a function of a previous input of the REPL
+      }
+      for (FuncDecl *next : found->second->callees) {
+        if (visited.insert(next).second) {
+          pending.push_back(next);
+        }
+      }
+    }
+    return false;
+  };
+
+  for (std::size_t k = 0; k < functions.size(); k++) {
+    auto [position, function] = functions[k];
+    if (!function->hasAttribute("tailrec")) {
+      continue;
+    }
+    for (CallExpr *call : bodies[k].calls) {
+      const auto &func = static_cast<IdentExpr &>(*call->getFunc());
+      auto callee = std::static_pointer_cast<FuncDecl>(func.getDeclOfIdentifier());
+      if (!isRecursiveCall(callee.get(), function)) {
+        continue;
+      }
+      // the frame of the caller is reused by the callee, so they need the same signature
+      if (call->getTailCall() == CallExpr::TailCall::TAIL &&
+          typeIsEqual(callee->getType(), function->getType())) {
+        call->setTailCall(CallExpr::TailCall::MUST_TAIL);
+      } else if (requireTailCall && call->getTailCall() == CallExpr::TailCall::NONE) {
+        reportError("The function " + function->getIdentifierToken().value +
+                        " is declared tailrec but the recursive call to " + func.getName() +
+                        " is not in tail position (the value of a return statement)",
+                    func.getIdent().line, func.getIdent().column);
+      } else if (requireTailCall) {
+        reportError("The function " + function->getIdentifierToken().value +
+                        " is declared tailrec but the recursive call to " + func.getName() +
+                        " can not be a guaranteed tail call: the functions should have the same "
+                        "parameters and result, and no array or atomic received by reference",
+                    func.getIdent().line, func.getIdent().column);
+      }
+    }
+    auto &diagnosticsOfFunction = diagnosticsOfDecl[position];
+    diagnosticsOfFunction.insert(diagnosticsOfFunction.end(),
+                                 std::make_move_iterator(diagnostics.begin()),
+                                 std::make_move_iterator(diagnostics.end()));
+    diagnostics.clear();
   }
 }
 
-void Semantic::analyse(const std::shared_ptr<Expr> &expr) { expr->accept(this); }
+void Semantic::analyse(Expr &expr) { visit(expr); }
 
-void Semantic::analyse(const std::shared_ptr<Stmt> &stmt) { stmt->accept(this); }
+void Semantic::analyse(Stmt &stmt) { visit(stmt); }
 
-void Semantic::analyse(const std::shared_ptr<Decl> &decl) { decl->accept(this); }
+void Semantic::analyse(Decl &decl) { visit(decl); }
 
 void Semantic::analyse(const std::vector<std::shared_ptr<Stmt>> &stmts) {
   bool previousReturnStatementInBlockStmt = returnStatementInBlockStmt;
@@ -53,7 +289,7 @@ void Semantic::analyse(const std::vector<std::shared_ptr<Stmt>> &stmts) {
     if (returnStatementInBlockStmt) {
       reportError("Statement after return statement");
     }
-    analyse(stmt);
+    analyse(*stmt);
   }
   returnStatementInBlockStmt = previousReturnStatementInBlockStmt;
 }
@@ -61,46 +297,217 @@ void Semantic::analyse(const std::vector<std::shared_ptr<Stmt>> &stmts) {
 void Semantic::declareBuiltinFunctions() {
   auto type_void = BasicType::getVoidType();
   // print function for basic types
-  std::vector<std::shared_ptr<BasicType>> params_print_int{BasicType::getIntType()};
+  std::vector<std::shared_ptr<Type>> params_print_int{BasicType::getIntType()};
   auto type_print_int = std::make_shared<FunctionType>(params_print_int, type_void);
   Symbol symbol_print_int("print", Symbol::Kind::FUNCTION, type_print_int);
   symbolTable->insert("print", symbol_print_int);
 
-  std::vector<std::shared_ptr<BasicType>> params_print_float{BasicType::getFloatType()};
+  std::vector<std::shared_ptr<Type>> params_print_float{BasicType::getFloatType()};
   auto type_print_float = std::make_shared<FunctionType>(params_print_float, type_void);
   Symbol symbol_print_float("print", Symbol::Kind::FUNCTION, type_print_float);
   symbolTable->insert("print", symbol_print_float);
 
-  std::vector<std::shared_ptr<BasicType>> params_print_bool{BasicType::getBoolType()};
+  std::vector<std::shared_ptr<Type>> params_print_bool{BasicType::getBoolType()};
   auto type_print_bool = std::make_shared<FunctionType>(params_print_bool, type_void);
   Symbol symbol_print_bool("print", Symbol::Kind::FUNCTION, type_print_bool);
   symbolTable->insert("print", symbol_print_bool);
 
-  std::vector<std::shared_ptr<BasicType>> params_print_string{BasicType::getStringType()};
+  std::vector<std::shared_ptr<Type>> params_print_string{BasicType::getStringType()};
   auto type_print_string = std::make_shared<FunctionType>(params_print_string, type_void);
   Symbol symbol_print_string("print", Symbol::Kind::FUNCTION, type_print_string);
   symbolTable->insert("print", symbol_print_string);
 
   // println function for basic types
-  std::vector<std::shared_ptr<BasicType>> params_println_int{BasicType::getIntType()};
+  std::vector<std::shared_ptr<Type>> params_println_int{BasicType::getIntType()};
   auto type_println_int = std::make_shared<FunctionType>(params_println_int, type_void);
   Symbol symbol_println_int("println", Symbol::Kind::FUNCTION, type_println_int);
   symbolTable->insert("println", symbol_println_int);
 
-  std::vector<std::shared_ptr<BasicType>> params_println_float{BasicType::getFloatType()};
+  std::vector<std::shared_ptr<Type>> params_println_float{BasicType::getFloatType()};
   auto type_println_float = std::make_shared<FunctionType>(params_println_float, type_void);
   Symbol symbol_println_float("println", Symbol::Kind::FUNCTION, type_println_float);
   symbolTable->insert("println", symbol_println_float);
 
-  std::vector<std::shared_ptr<BasicType>> params_println_bool{BasicType::getBoolType()};
+  std::vector<std::shared_ptr<Type>> params_println_bool{BasicType::getBoolType()};
   auto type_println_bool = std::make_shared<FunctionType>(params_println_bool, type_void);
   Symbol symbol_println_bool("println", Symbol::Kind::FUNCTION, type_println_bool);
   symbolTable->insert("println", symbol_println_bool);
 
-  std::vector<std::shared_ptr<BasicType>> params_println_string{BasicType::getStringType()};
+  std::vector<std::shared_ptr<Type>> params_println_string{BasicType::getStringType()};
   auto type_println_string = std::make_shared<FunctionType>(params_println_string, type_void);
   Symbol symbol_println_string("println", Symbol::Kind::FUNCTION, type_println_string);
   symbolTable->insert("println", symbol_println_string);
+
+  // print and println functions for fixed-width numeric types
+  for (const auto &type : fixedWidthTypes()) {
+    std::vector<std::shared_ptr<Type>> params_print{type};
+    auto type_print = std::make_shared<FunctionType>(params_print, type_void);
+    symbolTable->insert("print", Symbol("print", Symbol::Kind::FUNCTION, type_print));
+    symbolTable->insert("println", Symbol("println", Symbol::Kind::FUNCTION, type_print));
+  }
+
+  // len and append functions for dynamic arrays of basic and vector types
+  std::vector<std::shared_ptr<Type>> elements{BasicType::getBoolType(), BasicType::getIntType(),
+                                              BasicType::getFloatType(),
+                                              BasicType::getStringType()};
+  for (const auto &type : fixedWidthTypes()) {
+    elements.push_back(type);
+  }
+  for (const auto &type : vectorTypes()) {
+    elements.push_back(type);
+  }
+  for (const auto &element : elements) {
+    auto type_array = std::make_shared<ArrayType>(element);
+
+    std::vector<std::shared_ptr<Type>> params_len{type_array};
+    auto type_len = std::make_shared<FunctionType>(params_len, BasicType::getIntType());
+    Symbol symbol_len("len", Symbol::Kind::FUNCTION, type_len);
+    symbolTable->insert("len", symbol_len);
+
+    std::vector<std::shared_ptr<Type>> params_append{type_array, element};
+    auto type_append = std::make_shared<FunctionType>(params_append, type_array);
+    Symbol symbol_append("append", Symbol::Kind::FUNCTION, type_append);
+    symbolTable->insert("append", symbol_append);
+  }
+
+  declareVectorBuiltinFunctions();
+  declareAtomicBuiltinFunctions();
+  declareBitBuiltinFunctions();
+}
+
+void Semantic::declareVectorBuiltinFunctions() {
+  auto type_void = BasicType::getVoidType();
+  for (const auto &type : vectorTypes()) {
+    auto element = type->getElement();
+    auto type_mask = std::make_shared<VectorType>(BasicType::getBoolType(), type->getLanes());
+    auto type_indices = std::make_shared<VectorType>(BasicType::getIntType(), type->getLanes());
+
+    std::vector<std::shared_ptr<Type>> params_print{type};
+    auto type_print = std::make_shared<FunctionType>(params_print, type_void);
+    symbolTable->insert("print", Symbol("print", Symbol::Kind::FUNCTION, type_print));
+    symbolTable->insert("println", Symbol("println", Symbol::Kind::FUNCTION, type_print));
+
+    // select(mask, a, b): lane i of a if lane i of mask is true, lane i of b otherwise
+    std::vector<std::shared_ptr<Type>> params_select{type_mask, type, type};
+    auto type_select = std::make_shared<FunctionType>(params_select, type);
+    symbolTable->insert("select", Symbol("select", Symbol::Kind::FUNCTION, type_select));
+
+    // shuffle(a, b, indices): lane i is lane indices[i] of the lanes of a followed by those of b.
+    // The indices have to be known at compile time (see visit(CallExpr))
+    std::vector<std::shared_ptr<Type>> params_shuffle{type, type, type_indices};
+    auto type_shuffle = std::make_shared<FunctionType>(params_shuffle, type);
+    symbolTable->insert("shuffle", Symbol("shuffle", Symbol::Kind::FUNCTION, type_shuffle));
+
+    std::vector<std::shared_ptr<Type>> params_reduce{type};
+    if (element->isNumeric()) {
+      auto type_reduce = std::make_shared<FunctionType>(params_reduce, element);
+      for (const std::string name : {"reduce_add", "reduce_min", "reduce_max"}) {
+        symbolTable->insert(name, Symbol(name, Symbol::Kind::FUNCTION, type_reduce));
+      }
+    } else {
+      auto type_reduce = std::make_shared<FunctionType>(params_reduce, BasicType::getBoolType());
+      symbolTable->insert("any", Symbol("any", Symbol::Kind::FUNCTION, type_reduce));
+      symbolTable->insert("all", Symbol("all", Symbol::Kind::FUNCTION, type_reduce));
+    }
+  }
+}
+
+void Semantic::declareAtomicBuiltinFunctions() {
+  auto type_void = BasicType::getVoidType();
+  auto type_bool = BasicType::getBoolType();
+  auto type_ordering = BasicType::getStringType();
+  std::vector<std::shared_ptr<BasicType>> elements{type_bool, BasicType::getIntType()};
+  for (const auto &type : fixedWidthTypes()) {
+    if (type->isInteger()) {
+      elements.push_back(type);
+    }
+  }
+
+  for (const auto &element : elements) {
+    auto type = std::make_shared<AtomicType>(element);
+    // every function is declared with and without the memory ordering (seq_cst by default)
+    auto insert = [&](const std::string &name, std::vector<std::shared_ptr<Type>> params,
+                      std::shared_ptr<Type> result) {
+      symbolTable->insert(name, Symbol(name, Symbol::Kind::FUNCTION,
+                                       std::make_shared<FunctionType>(params, result)));
+      params.push_back(type_ordering);
+      symbolTable->insert(name, Symbol(name, Symbol::Kind::FUNCTION,
+                                       std::make_shared<FunctionType>(params, result)));
+    };
+
+    insert("load", {type}, element);
+    insert("store", {type, element}, type_void);
+    insert("exchange", {type, element}, element);
+    // compare_exchange(a, expected, desired): stores desired if the value is expected
+    insert("compare_exchange", {type, element, element}, type_bool);
+    // the fetch operations return the value before the operation
+    for (const std::string name : {"fetch_and", "fetch_or", "fetch_xor"}) {
+      insert(name, {type, element}, element);
+    }
+    if (element->isInteger()) {
+      for (const std::string name : {"fetch_add", "fetch_sub", "fetch_min", "fetch_max"}) {
+        insert(name, {type, element}, element);
+      }
+    }
+  }
+}
+
+void Semantic::declareBitBuiltinFunctions() {
+  // \type is an integer type or a vector of them (the functions are applied lane by lane) and
+  // \element is the type of its lanes
+  auto declare = [&](const std::shared_ptr<Type> &type, const std::shared_ptr<BasicType> &element) {
+    std::vector<std::shared_ptr<Type>> params_unary{type};
+    auto type_unary = std::make_shared<FunctionType>(params_unary, type);
+    for (const std::string name : {"popcount", "clz", "ctz"}) {
+      symbolTable->insert(name, Symbol(name, Symbol::Kind::FUNCTION, type_unary));
+    }
+    // the bytes of a single byte can not be swapped
+    if (element->getBitWidth() > 8) {
+      symbolTable->insert("bswap", Symbol("bswap", Symbol::Kind::FUNCTION, type_unary));
+    }
+    // rotl(x, n): x rotated n bits to the left (n modulo the width of x)
+    std::vector<std::shared_ptr<Type>> params_rotl{type, type};
+    auto type_rotl = std::make_shared<FunctionType>(params_rotl, type);
+    symbolTable->insert("rotl", Symbol("rotl", Symbol::Kind::FUNCTION, type_rotl));
+  };
+
+  declare(BasicType::getIntType(), BasicType::getIntType());
+  for (const auto &type : fixedWidthTypes()) {
+    if (type->isInteger()) {
+      declare(type, type);
+    }
+  }
+  for (const auto &type : vectorTypes()) {
+    if (type->getElement()->isInteger()) {
+      declare(type, type->getElement());
+    }
+  }
+}
+
+bool Semantic::isAtomicBuiltinFunction(const std::string &functionName) {
+  static const std::unordered_set<std::string> functions = {
+      "load",      "store",    "exchange",  "compare_exchange", "fetch_and", "fetch_or",
+      "fetch_xor", "fetch_add", "fetch_sub", "fetch_min",        "fetch_max"};
+  return functions.count(functionName) > 0;
+}
+
+std::vector<std::shared_ptr<BasicType>> Semantic::fixedWidthTypes() {
+  return {BasicType::getInt8Type(),   BasicType::getInt16Type(),  BasicType::getInt32Type(),
+          BasicType::getUint8Type(),  BasicType::getUint16Type(), BasicType::getUint32Type(),
+          BasicType::getUint64Type(), BasicType::getFloat32Type()};
+}
+
+std::vector<std::shared_ptr<VectorType>> Semantic::vectorTypes() {
+  auto elements = fixedWidthTypes();
+  elements.insert(elements.begin(),
+                  {BasicType::getBoolType(), BasicType::getIntType(), BasicType::getFloatType()});
+  std::vector<std::shared_ptr<VectorType>> types;
+  for (const auto &element : elements) {
+    for (std::int64_t lanes = 2; lanes <= VectorType::maxLanes; lanes *= 2) {
+      types.push_back(std::make_shared<VectorType>(element, lanes));
+    }
+  }
+  return types;
 }
 
 void Semantic::beginScope() {
@@ -116,23 +523,34 @@ void Semantic::endScope() {
 }
 
 void Semantic::reportError(std::string error_msg, int line, int column) {
-  std::cerr << "<" << this->file->getFilename() << ":l" << line << ":c" << column
-            << "> Semantic analysis error: " << error_msg << std::endl;
-
-  this->file->setErrorInSemanticAnalysis(true);
+  diagnostics.push_back("<" + this->file->getFilename() + ":l" + std::to_string(line) + ":c" +
+                        std::to_string(column) + "> Semantic analysis error: " + error_msg);
 }
 
 void Semantic::reportError(std::string error_msg) {
-  std::cerr << "<" << this->file->getFilename() << "> Semantic analysis error: " << error_msg
-            << std::endl;
-
-  this->file->setErrorInSemanticAnalysis(true);
+  diagnostics.push_back("<" + this->file->getFilename() + "> Semantic analysis error: " +
+                        error_msg);
 }
 
 bool isNumeric(std::shared_ptr<Type> type) {
   switch (type->getTypeKind()) {
   case Type::Kind::BasicType:
     return std::dynamic_pointer_cast<BasicType>(type)->isNumeric();
+  case Type::Kind::VectorType:
+    return std::dynamic_pointer_cast<VectorType>(type)->getElement()->isNumeric();
+  case Type::Kind::Signature:
+    return false;
+  default:
+    return false;
+  }
+}
+
+bool isInteger(std::shared_ptr<Type> type) {
+  switch (type->getTypeKind()) {
+  case Type::Kind::BasicType:
+    return std::dynamic_pointer_cast<BasicType>(type)->isInteger();
+  case Type::Kind::VectorType:
+    return std::dynamic_pointer_cast<VectorType>(type)->getElement()->isInteger();
   case Type::Kind::Signature:
     return false;
   default:
@@ -155,6 +573,8 @@ bool isBoolean(std::shared_ptr<Type> type) {
   switch (type->getTypeKind()) {
   case Type::Kind::BasicType:
     return std::dynamic_pointer_cast<BasicType>(type)->isBoolean();
+  case Type::Kind::VectorType:
+    return std::dynamic_pointer_cast<VectorType>(type)->getElement()->isBoolean();
   case Type::Kind::Signature:
     return false;
   default:
@@ -166,6 +586,8 @@ bool isComparable(std::shared_ptr<Type> type) {
   switch (type->getTypeKind()) {
   case Type::Kind::BasicType:
     return std::dynamic_pointer_cast<BasicType>(type)->isComparable();
+  case Type::Kind::VectorType:
+    return std::dynamic_pointer_cast<VectorType>(type)->getElement()->isComparable();
   case Type::Kind::Signature:
     return false;
   default:
@@ -177,6 +599,8 @@ bool isOrdered(std::shared_ptr<Type> type) {
   switch (type->getTypeKind()) {
   case Type::Kind::BasicType:
     return std::dynamic_pointer_cast<BasicType>(type)->isOrdered();
+  case Type::Kind::VectorType:
+    return std::dynamic_pointer_cast<VectorType>(type)->getElement()->isOrdered();
   case Type::Kind::Signature:
     return false;
   default:
@@ -198,6 +622,33 @@ bool isComparator(TokenType tokenType) {
   }
 }
 
+/// returns the type of comparing two values of type \type: bool, or a vector of bool for vectors
+/// (the lanes are compared one by one)
+std::shared_ptr<Type> getComparisonType(std::shared_ptr<Type> type) {
+  if (type->getTypeKind() == Type::Kind::VectorType) {
+    auto vectorType = std::dynamic_pointer_cast<VectorType>(type);
+    return std::make_shared<VectorType>(BasicType::getBoolType(), vectorType->getLanes());
+  }
+  return BasicType::getBoolType();
+}
+
+/// returns the alignment required by the attribute align(N) of \type if it is a struct or of the
+/// structs in its fields, 0 if there is none
+std::int64_t getRequiredAlignment(std::shared_ptr<Type> type) {
+  auto structType = std::dynamic_pointer_cast<StructType>(type);
+  if (structType == nullptr) {
+    return 0;
+  }
+  std::int64_t alignment = structType->getAlignment();
+  for (const auto &field : structType->getFields()) {
+    alignment = std::max(alignment, getRequiredAlignment(field.type));
+  }
+  return alignment;
+}
+
+/// alignment of the memory allocated in the heap with malloc (dynamic arrays and tasks)
+static constexpr std::int64_t heapAlignment = 16;
+
 bool passRequirements(std::vector<std::function<bool(std::shared_ptr<Type>)>> requirements,
                       std::shared_ptr<Type> type) {
   for (const auto &requirement : requirements) {
@@ -218,11 +669,13 @@ Semantic::isValidBinaryOperatorForType(const Token &op, std::shared_ptr<Type> ty
           {SLASH, {isNumeric}},         {EQUAL, {isComparable}}, {NOT_EQUAL, {isComparable}},
           {LESS, {isOrdered}},          {GREATER, {isOrdered}},  {LESS_EQUAL, {isOrdered}},
           {GREATER_EQUAL, {isOrdered}}, {LAND, {isBoolean}},     {LOR, {isBoolean}},
+          {PERCENT, {isInteger}},       {AMPERSAND, {isInteger}}, {PIPE, {isInteger}},
+          {CARET, {isInteger}},         {SHIFT_LEFT, {isInteger}}, {SHIFT_RIGHT, {isInteger}},
       };
 
   auto requirements = binaryOp.find(op.tokenType);
   if (requirements != binaryOp.end() && passRequirements(requirements->second, typeOperands)) {
-    return {true, isComparator(op.tokenType) ? BasicType::getBoolType() : typeOperands};
+    return {true, isComparator(op.tokenType) ? getComparisonType(typeOperands) : typeOperands};
   } else {
     return {false, nullptr};
   }
@@ -231,11 +684,14 @@ Semantic::isValidBinaryOperatorForType(const Token &op, std::shared_ptr<Type> ty
 std::pair<bool, std::shared_ptr<Type>>
 Semantic::isValidUnaryOperatorForType(const Token &op, std::shared_ptr<Type> typeOperands) {
   static std::unordered_map<TokenType, std::vector<std::function<bool(std::shared_ptr<Type>)>>>
-      unaryOp = {{ADD, {isNumeric}}, {SUB, {isNumeric}}, {NOT, {isBoolean}}};
+      unaryOp = {{ADD, {isNumeric}},
+                 {SUB, {isNumeric}},
+                 {NOT, {isBoolean}},
+                 {TILDE, {isInteger}}};
 
   auto requirements = unaryOp.find(op.tokenType);
   if (requirements != unaryOp.end() && passRequirements(requirements->second, typeOperands)) {
-    return {true, isComparator(op.tokenType) ? BasicType::getBoolType() : typeOperands};
+    return {true, isComparator(op.tokenType) ? getComparisonType(typeOperands) : typeOperands};
   } else {
     return {false, nullptr};
   }
@@ -256,328 +712,996 @@ std::shared_ptr<Type> Semantic::tokenTypeToType(Token token) {
   case LIT_STRING:
   case STRING:
     return BasicType::getStringType();
+  case INT8:
+    return BasicType::getInt8Type();
+  case INT16:
+    return BasicType::getInt16Type();
+  case INT32:
+    return BasicType::getInt32Type();
+  case UINT8:
+    return BasicType::getUint8Type();
+  case UINT16:
+    return BasicType::getUint16Type();
+  case UINT32:
+    return BasicType::getUint32Type();
+  case UINT64:
+    return BasicType::getUint64Type();
+  case FLOAT32:
+    return BasicType::getFloat32Type();
   default:
     reportError("Internal Error - Token type not recognized", token.line, token.line);
     return BasicType::getInvalidType();
   }
 }
 
-void Semantic::visit(std::shared_ptr<VarDecl> node) {
+std::shared_ptr<Type> Semantic::typeSpecToType(const TypeSpec &typeSpec) {
+  if (typeSpec.getKind() == TypeSpec::Kind::BASIC) {
+    return tokenTypeToType(typeSpec.getToken());
+  }
+
+  if (typeSpec.getKind() == TypeSpec::Kind::STRUCT) {
+    const Token &name = typeSpec.getToken();
+    try {
+      std::vector<Symbol> symbols = symbolTable->lookup(name.value);
+      if (symbols[0].getKind() == Symbol::Kind::STRUCT) {
+        return symbols[0].getType();
+      }
+      reportError("Type checking: " + name.value + " is not a type", name.line, name.column);
+    } catch (std::runtime_error &e) {
+      reportError("Undefined type " + name.value, name.line, name.column);
+    }
+    return BasicType::getInvalidType();
+  }
+
+  const auto &elementSpec = *typeSpec.getElement();
+  if (typeSpec.getKind() == TypeSpec::Kind::VECTOR) {
+    return vectorTypeSpecToType(typeSpec);
+  }
+
+  // the value of an atomic has to fit in a register to be accessed atomically
+  if (typeSpec.getKind() == TypeSpec::Kind::ATOMIC) {
+    std::shared_ptr<BasicType> element;
+    if (elementSpec.getKind() == TypeSpec::Kind::BASIC) {
+      element = std::dynamic_pointer_cast<BasicType>(tokenTypeToType(elementSpec.getToken()));
+    }
+    if (element == nullptr || !(element->isInteger() || element->isBoolean())) {
+      reportError("Type checking: the value of an atomic should be of integer or bool type but "
+                  "found " +
+                      elementSpec.getName(),
+                  elementSpec.getToken().line, elementSpec.getToken().column);
+      return BasicType::getInvalidType();
+    }
+    return std::make_shared<AtomicType>(element);
+  }
+
+  // the result of a task is the result of a function, which can not be a fixed-size array
+  if (typeSpec.getKind() == TypeSpec::Kind::TASK) {
+    if (elementSpec.getKind() == TypeSpec::Kind::ARRAY) {
+      reportError("Type checking: the result of a task can not be a fixed-size array (" +
+                      elementSpec.getName() + "), use a dynamic array instead",
+                  elementSpec.getToken().line, elementSpec.getToken().column);
+      return BasicType::getInvalidType();
+    }
+    auto result = typeSpecToType(elementSpec);
+    if (result->isInvalid()) {
+      return BasicType::getInvalidType();
+    }
+    return std::make_shared<TaskType>(result);
+  }
+
+  // the elements of an array have to be of basic, vector or struct type
+  if (elementSpec.getKind() != TypeSpec::Kind::BASIC &&
+      elementSpec.getKind() != TypeSpec::Kind::VECTOR &&
+      elementSpec.getKind() != TypeSpec::Kind::STRUCT) {
+    reportError("Type checking: the elements of an array should be of basic, vector or struct "
+                "type but found " +
+                    elementSpec.getName(),
+                elementSpec.getToken().line, elementSpec.getToken().column);
+    return BasicType::getInvalidType();
+  }
+  auto element = typeSpecToType(elementSpec);
+  if (element->isInvalid()) {
+    return BasicType::getInvalidType();
+  }
+
+  if (typeSpec.getKind() == TypeSpec::Kind::DYNAMICARRAY) {
+    if (getRequiredAlignment(element) > heapAlignment) {
+      reportError("The elements of a dynamic array are allocated with malloc and can not be "
+                  "aligned to more than " +
+                      std::to_string(heapAlignment) + " bytes (" + element->getName() + ")",
+                  elementSpec.getToken().line, elementSpec.getToken().column);
+      return BasicType::getInvalidType();
+    }
+    return std::make_shared<ArrayType>(element);
+  }
+
+  std::int64_t size = 0;
+  try {
+    size = std::stoll(typeSpec.getSize().value);
+  } catch (std::exception &e) {
+    size = 0;
+  }
+  if (size <= 0) {
+    reportError("The size of an array should be a positive integer but found " +
+                    typeSpec.getSize().value,
+                typeSpec.getSize().line, typeSpec.getSize().column);
+    return BasicType::getInvalidType();
+  }
+  return std::make_shared<ArrayType>(element, size);
+}
+
+std::shared_ptr<Type> Semantic::vectorTypeSpecToType(const TypeSpec &typeSpec) {
+  // the lanes of a vector have to be of numeric or bool type
+  const auto &elementSpec = *typeSpec.getElement();
+  std::shared_ptr<BasicType> element;
+  if (elementSpec.getKind() == TypeSpec::Kind::BASIC) {
+    element = std::dynamic_pointer_cast<BasicType>(tokenTypeToType(elementSpec.getToken()));
+  }
+  if (element == nullptr || !(element->isNumeric() || element->isBoolean())) {
+    reportError("Type checking: the lanes of a vector should be of numeric or bool type but "
+                "found " +
+                    elementSpec.getName(),
+                elementSpec.getToken().line, elementSpec.getToken().column);
+    return BasicType::getInvalidType();
+  }
+
+  // the number of lanes has to fit in the vector registers of the targets (up to 512 bits of
+  // AVX-512) and be a power of two so that it can be split in halves
+  std::int64_t lanes = 0;
+  try {
+    lanes = std::stoll(typeSpec.getSize().value);
+  } catch (std::exception &e) {
+    lanes = 0;
+  }
+  if (lanes < 2 || lanes > VectorType::maxLanes || (lanes & (lanes - 1)) != 0) {
+    reportError("The number of lanes of a vector should be a power of two between 2 and " +
+                    std::to_string(VectorType::maxLanes) + " but found " + typeSpec.getSize().value,
+                typeSpec.getSize().line, typeSpec.getSize().column);
+    return BasicType::getInvalidType();
+  }
+  return std::make_shared<VectorType>(element, lanes);
+}
+
+LiteralExpr *Semantic::asNumericLiteral(Expr &expr, bool &negated) {
+  negated = false;
+  Expr *operand = &expr;
+  if (expr.getExprKind() == Expr::Kind::UNARYEXPR) {
+    auto &unary = static_cast<UnaryExpr &>(expr);
+    if (unary.getOp().tokenType != ADD && unary.getOp().tokenType != SUB) {
+      return nullptr;
+    }
+    negated = unary.getOp().tokenType == SUB;
+    operand = unary.getRhs().get();
+  }
+
+  if (operand->getExprKind() != Expr::Kind::LITERALEXPR) {
+    return nullptr;
+  }
+  auto *literal = static_cast<LiteralExpr *>(operand);
+  if (literal->getToken().tokenType != LIT_INT && literal->getToken().tokenType != LIT_FLOAT) {
+    return nullptr;
+  }
+  return literal;
+}
+
+bool Semantic::isConvertibleLiteral(Expr &expr, const std::shared_ptr<Type> &type) {
+  auto basicType = std::dynamic_pointer_cast<BasicType>(type);
+  bool negated;
+  LiteralExpr *literal = asNumericLiteral(expr, negated);
+  if (basicType == nullptr || literal == nullptr || expr.getType() == nullptr ||
+      typeIsEqual(expr.getType(), type)) {
+    return false;
+  }
+
+  // an integer literal can be of any integer type and a float literal of any float type
+  return (literal->getToken().tokenType == LIT_INT && basicType->isInteger()) ||
+         (literal->getToken().tokenType == LIT_FLOAT && basicType->isFloat());
+}
+
+void Semantic::convertLiteral(Expr &expr, const std::shared_ptr<Type> &type) {
+  if (!isConvertibleLiteral(expr, type)) {
+    return;
+  }
+
+  bool negated;
+  LiteralExpr *literal = asNumericLiteral(expr, negated);
+  auto basicType = std::dynamic_pointer_cast<BasicType>(type);
+  if (basicType->isInteger()) {
+    // The value has to fit in the type: [0, 2^N - 1] for uintN and [-2^(N-1), 2^(N-1) - 1] for intN
+    unsigned bits = basicType->getBitWidth();
+    uint64_t max = basicType->isUnsigned() ? (bits == 64 ? UINT64_MAX : (1ULL << bits) - 1)
+                                           : (1ULL << (bits - 1)) - 1;
+    uint64_t value;
+    bool fits;
+    try {
+      value = std::stoull(literal->getToken().value);
+      fits = negated ? (basicType->isUnsigned() ? value == 0 : value <= max + 1) : value <= max;
+    } catch (std::out_of_range &e) {
+      fits = false;
+    }
+    if (!fits) {
+      reportError("Type checking: constant " + std::string(negated ? "-" : "") +
+                      literal->getToken().value + " does not fit in type " + type->getName(),
+                  literal->getToken().line, literal->getToken().column);
+    }
+  }
+
+  literal->setType(type);
+  expr.setType(type);
+}
+
+void Semantic::checkTaskNotCopied(const Expr &value, const Token &token) {
+  if (value.getType()->getTypeKind() == Type::Kind::TaskType &&
+      value.getExprValueKind() != Expr::ValueKind::RVal) {
+    reportError("A task can not be copied (it is freed when it is awaited), take it from a spawn "
+                "or a call instead",
+                token.line, token.column);
+  }
+}
+
+void Semantic::visit(VarDecl &node) {
   // Do semantic analysis of initializer expression (needed to calculate type)
-  analyse(node->getValue());
+  analyse(*node.getValue());
 
-  // Type checking
-  node->setType(tokenTypeToType(node->getTypeToken()));
+  // Type checking. An atomic is initialized with a value of the type of its value
+  node.setType(typeSpecToType(node.getTypeSpec()));
+  auto type = node.getType();
+  if (auto atomicType = std::dynamic_pointer_cast<AtomicType>(type)) {
+    type = atomicType->getElement();
+  }
+  convertLiteral(*node.getValue(), type);
 
-  // if node->getValue() is invalid, the error during initialization has already been reported and
+  // if node.getValue() is invalid, the error during initialization has already been reported and
   // we do not have to do nothing.
-  if (!node->getValue()->getType()->isInvalid()) {
-    if (!typeIsEqual(node->getType(), node->getValue()->getType())) {
-      reportError("Type checking: different types " + node->getType()->getName() + " and " +
-                      node->getValue()->getType()->getName(),
-                  node->getTypeToken().line, node->getTypeToken().column);
+  if (!node.getValue()->getType()->isInvalid()) {
+    if (!typeIsEqual(type, node.getValue()->getType())) {
+      reportError("Type checking: different types " + type->getName() + " and " +
+                      node.getValue()->getType()->getName(),
+                  node.getTypeSpec().getToken().line, node.getTypeSpec().getToken().column);
     }
   }
+  checkTaskNotCopied(*node.getValue(), node.getTypeSpec().getToken());
 
   // Update information about if constant declaration is global
   bool isGlobal = this->scopeLevel == 0;
-  node->setIsGlobal(isGlobal);
+  node.setIsGlobal(isGlobal);
+
+  // A variable declared inside a parallel for is private to every iteration
+  for (auto &parallelLoop : parallelLoops) {
+    parallelLoop.privates.insert(&node);
+  }
 
   // Update symbol table with new variable
-  Symbol symbol(node->getIdentifierToken().value, Symbol::Kind::VARIABLE, node->getType(), node);
+  Symbol symbol(node.getIdentifierToken().value, Symbol::Kind::VARIABLE, node.getType(),
+                node.shared_from_this());
   try {
     symbolTable->insert(symbol.getIdentifier(), symbol);
   } catch (std::runtime_error &e) {
-    reportError(e.what(), node->getIdentifierToken().line, node->getIdentifierToken().column);
+    reportError(e.what(), node.getIdentifierToken().line, node.getIdentifierToken().column);
   }
 }
 
-void Semantic::visit(std::shared_ptr<ConstDecl> node) {
+void Semantic::visit(ConstDecl &node) {
   // Do semantic analysis of initializer expression (needed to calculate type)
-  analyse(node->getValue());
+  analyse(*node.getValue());
 
   // Type checking
-  node->setType(tokenTypeToType(node->getTypeToken()));
+  node.setType(typeSpecToType(node.getTypeSpec()));
+  convertLiteral(*node.getValue(), node.getType());
+
+  // the value of a task is only known when it finishes and an atomic is modified by other
+  // threads, so they can not be constants
+  if (node.getType()->getTypeKind() == Type::Kind::TaskType ||
+      node.getType()->getTypeKind() == Type::Kind::AtomicType) {
+    std::string kind =
+        node.getType()->getTypeKind() == Type::Kind::TaskType ? "a task" : "an atomic";
+    reportError("A constant can not be " + kind + " (" + node.getTypeSpec().getName() +
+                    "), use a variable instead",
+                node.getTypeSpec().getToken().line, node.getTypeSpec().getToken().column);
+  }
 
-  // if node->getValue() is invalid, the error during initialization has been already reported and
+  // if node.getValue() is invalid, the error during initialization has been already reported and
   // we do not have to do nothing.
-  if (!node->getValue()->getType()->isInvalid()) {
-    if (!typeIsEqual(node->getType(), node->getValue()->getType())) {
-      reportError("Type checking: different types " + node->getType()->getName() + " and " +
-                      node->getValue()->getType()->getName(),
-                  node->getTypeToken().line, node->getTypeToken().column);
+  if (!node.getValue()->getType()->isInvalid()) {
+    if (!typeIsEqual(node.getType(), node.getValue()->getType())) {
+      reportError("Type checking: different types " + node.getType()->getName() + " and " +
+                      node.getValue()->getType()->getName(),
+                  node.getTypeSpec().getToken().line, node.getTypeSpec().getToken().column);
     }
   }
 
   // Update information about if constant declaration is global
   bool isGlobal = this->scopeLevel == 0;
-  node->setIsGlobal(isGlobal);
+  node.setIsGlobal(isGlobal);
+
+  // A variable declared inside a parallel for is private to every iteration
+  for (auto &parallelLoop : parallelLoops) {
+    parallelLoop.privates.insert(&node);
+  }
 
   // Update symbol table with new constant
-  Symbol symbol(node->getIdentifierToken().value, Symbol::Kind::CONSTANT, node->getType(), node);
+  Symbol symbol(node.getIdentifierToken().value, Symbol::Kind::CONSTANT, node.getType(),
+                node.shared_from_this());
   try {
     symbolTable->insert(symbol.getIdentifier(), symbol);
   } catch (std::runtime_error &e) {
-    reportError(e.what(), node->getIdentifierToken().line, node->getIdentifierToken().column);
+    reportError(e.what(), node.getIdentifierToken().line, node.getIdentifierToken().column);
   }
 }
 
-void Semantic::visit(std::shared_ptr<ParamDecl> node) {
+void Semantic::visit(ParamDecl &node) {
   // Type checking
-  node->setType(tokenTypeToType(node->getTypeToken()));
+  node.setType(typeSpecToType(node.getTypeSpec()));
 
   // Update symbol table with new parameter
-  Symbol symbol(node->getIdentifierToken().value, Symbol::Kind::PARAMETER, node->getType(), node);
+  Symbol symbol(node.getIdentifierToken().value, Symbol::Kind::PARAMETER, node.getType(),
+                node.shared_from_this());
   try {
     symbolTable->insert(symbol.getIdentifier(), symbol);
   } catch (std::runtime_error &e) {
-    reportError(e.what(), node->getIdentifierToken().line, node->getIdentifierToken().column);
+    reportError(e.what(), node.getIdentifierToken().line, node.getIdentifierToken().column);
   }
 }
 
-std::shared_ptr<FunctionType> Semantic::createSignature(std::shared_ptr<FuncDecl> node) {
-  std::vector<std::shared_ptr<BasicType>> params;
-
-  for (const auto &parameter : node->getParams()) {
-    params.push_back(
-        std::dynamic_pointer_cast<BasicType>(tokenTypeToType(parameter->getTypeToken())));
+std::shared_ptr<FunctionType> Semantic::createSignature(const FuncDecl &node) {
+  std::vector<std::shared_ptr<Type>> params;
+
+  for (const auto &parameter : node.getParams()) {
+    params.push_back(typeSpecToType(parameter->getTypeSpec()));
+    // the argument would be a copy of the task of the caller, and both could be awaited
+    if (parameter->getTypeSpec().getKind() == TypeSpec::Kind::TASK) {
+      reportError("A function can not receive a task (" + parameter->getTypeSpec().getName() +
+                      "), await it and pass its result instead",
+                  parameter->getTypeSpec().getToken().line,
+                  parameter->getTypeSpec().getToken().column);
+    }
   }
 
-  std::shared_ptr<BasicType> returnType = nullptr;
-  if (node->isHasReturnType()) {
-    returnType = std::dynamic_pointer_cast<BasicType>(tokenTypeToType(node->getReturnTypeToken()));
+  std::shared_ptr<Type> returnType = nullptr;
+  if (node.isHasReturnType()) {
+    returnType = typeSpecToType(node.getReturnTypeSpec());
+    // fixed-size arrays are passed by reference, so they can not be returned (they would be
+    // stored in the stack of the function)
+    if (node.getReturnTypeSpec().getKind() == TypeSpec::Kind::ARRAY) {
+      reportError("A function can not return a fixed-size array (" +
+                      node.getReturnTypeSpec().getName() + "), use a dynamic array instead",
+                  node.getReturnTypeSpec().getToken().line,
+                  node.getReturnTypeSpec().getToken().column);
+    }
+    // an atomic is shared by reference, returning it would give a copy of its value
+    if (node.getReturnTypeSpec().getKind() == TypeSpec::Kind::ATOMIC) {
+      reportError("A function can not return an atomic (" + node.getReturnTypeSpec().getName() +
+                      "), use load to return its value",
+                  node.getReturnTypeSpec().getToken().line,
+                  node.getReturnTypeSpec().getToken().column);
+    }
   } else {
     returnType = BasicType::getVoidType();
   }
   return std::make_shared<FunctionType>(params, returnType);
 }
 
-void Semantic::visit(std::shared_ptr<FuncDecl> node) {
-  auto prevScopeType = scopeType;
-  scopeType = Semantic::ScopeType::FUNCTION;
-  signature = createSignature(node);
+void Semantic::declareFunction(FuncDecl &node) {
+  checkFunctionAttributes(node);
+  auto functionSignature = createSignature(node);
+  if (node.isConst()) {
+    checkConstFunction(node, *functionSignature);
+  }
 
   // Insert function identifier in scope
-  Symbol symbol(node->getIdentifierToken().value, Symbol::Kind::FUNCTION, signature, node);
+  Symbol symbol(node.getIdentifierToken().value, Symbol::Kind::FUNCTION, functionSignature,
+                node.shared_from_this());
   try {
     symbolTable->insert(symbol.getIdentifier(), symbol);
   } catch (std::runtime_error &e) {
-    reportError(e.what(), node->getIdentifierToken().line, node->getIdentifierToken().column);
+    reportError(e.what(), node.getIdentifierToken().line, node.getIdentifierToken().column);
   }
-  node->setType(signature);
+  node.setType(functionSignature);
+
+  // Mangle the identifier of the function
+  node.setIdentifierMangled(mangler::mangle(node.getIdentifierToken().value, functionSignature));
+}
+
+void Semantic::checkConstFunction(const FuncDecl &node, FunctionType &signature) {
+  // the values of these types are the literals that replace the calls evaluated
+  auto isLiteralType = [](const std::shared_ptr<Type> &type) {
+    return typeIsEqual(type, BasicType::getIntType()) ||
+           typeIsEqual(type, BasicType::getFloatType()) ||
+           typeIsEqual(type, BasicType::getBoolType()) || type->isInvalid();
+  };
+  bool valid = node.isHasReturnType() && isLiteralType(signature.getResult());
+  for (const auto &param : signature.getParams()) {
+    valid = valid && isLiteralType(param);
+  }
+  if (!valid) {
+    reportError("The parameters and the result of the const function " +
+                    node.getIdentifierToken().value + " should be int, float or bool",
+                node.getIdentifierToken().line, node.getIdentifierToken().column);
+  }
+}
+
+void Semantic::markImpure(const std::string &reason, int line) {
+  // the initial values of the globals are not part of any function
+  if (scopeType == ScopeType::FUNCTION && bodySummary.impurity.empty()) {
+    bodySummary.impurity = reason + " in line " + std::to_string(line);
+  }
+}
+
+void Semantic::checkFunctionAttributes(const FuncDecl &node) {
+  for (const auto &attribute : node.getAttributes()) {
+    const std::string &name = attribute.name.value;
+    if (name != "fastmath" && name != "pure" && name != "tailrec") {
+      reportError("Unknown attribute " + name +
+                      " of function: it should be fastmath, pure or tailrec",
+                  attribute.name.line, attribute.name.column);
+    } else if (attribute.hasArgument) {
+      reportError("The attribute " + name + " has no arguments", attribute.name.line,
+                  attribute.name.column);
+    }
+  }
+}
+
+void Semantic::analyseFunctionBody(FuncDecl &node) {
+  auto prevScopeType = scopeType;
+  scopeType = Semantic::ScopeType::FUNCTION;
+  signature = std::dynamic_pointer_cast<FunctionType>(node.getType());
 
   // Analyse parameters and body of the function
   beginScope();
-  for (const auto &parameter : node->getParams()) {
-    analyse(parameter);
+  for (const auto &parameter : node.getParams()) {
+    analyse(*parameter);
   }
 
   // In FuncDecl, declarations of parameters have to be inside the scope of the body so the scope
   //  it is created in the beginning. Because the scope has been already created, we call directly
   //  to analyse the vector of statements since analyse block of statements creates a new scope
   //  and we do not want a new scope
-  analyse(node->getBody()->getStmts());
+  analyse(node.getBody()->getStmts());
   endScope();
 
   // Restore previous values
   scopeType = prevScopeType;
+}
 
-  // Mangle the identifier of the function
-  node->setIdentifierMangled(mangler::mangle(node->getIdentifierToken().value, signature));
+void Semantic::visit(FuncDecl &node) {
+  declareFunction(node);
+  analyseFunctionBody(node);
+}
+
+std::shared_ptr<StructType> Semantic::createStructType(const StructDecl &node,
+                                                       std::vector<StructType::Field> fields) {
+  bool packed = false;
+  bool soa = false;
+  std::int64_t alignment = 0;
+  for (const auto &attribute : node.getAttributes()) {
+    const std::string &name = attribute.name.value;
+    if (name != "packed" && name != "soa" && name != "align") {
+      reportError("Unknown attribute " + name + " of struct: it should be packed, align(N) or soa",
+                  attribute.name.line, attribute.name.column);
+      continue;
+    }
+    if (attribute.hasArgument != (name == "align")) {
+      reportError(name == "align" ? "The attribute align needs the alignment in bytes (align(N))"
+                                  : "The attribute " + name + " has no arguments",
+                  attribute.name.line, attribute.name.column);
+      continue;
+    }
+
+    if (name == "packed") {
+      packed = true;
+    } else if (name == "soa") {
+      soa = true;
+    } else {
+      // the alignment of LLVM is a power of two, and more than a page is not useful
+      try {
+        alignment = std::stoll(attribute.argument.value);
+      } catch (std::exception &e) {
+        alignment = 0;
+      }
+      if (alignment <= 0 || alignment > 4096 || (alignment & (alignment - 1)) != 0) {
+        reportError("The alignment of a struct should be a power of two between 1 and 4096 but "
+                    "found " +
+                        attribute.argument.value,
+                    attribute.argument.line, attribute.argument.column);
+        alignment = 0;
+      }
+    }
+  }
+  // a packed struct has no padding, so it can not be aligned
+  if (packed && alignment != 0) {
+    reportError("The struct " + node.getIdentifierToken().value + " can not be packed and aligned",
+                node.getIdentifierToken().line, node.getIdentifierToken().column);
+    alignment = 0;
+  }
+  return std::make_shared<StructType>(node.getIdentifierToken().value, std::move(fields), packed,
+                                      alignment, soa);
+}
+
+void Semantic::visit(StructDecl &node) {
+  const Token &name = node.getIdentifierToken();
+  if (node.getFields().empty()) {
+    reportError("The struct " + name.value + " should have at least one field", name.line,
+                name.column);
+  }
+
+  // The fields are of basic, vector or struct type. A struct can only contain the structs declared
+  // before it, so it can not contain itself
+  std::vector<StructType::Field> fields;
+  for (const auto &field : node.getFields()) {
+    const Token &fieldName = field.identifierToken;
+    if (field.typeSpec.getKind() != TypeSpec::Kind::BASIC &&
+        field.typeSpec.getKind() != TypeSpec::Kind::VECTOR &&
+        field.typeSpec.getKind() != TypeSpec::Kind::STRUCT) {
+      reportError("Type checking: the fields of a struct should be of basic, vector or struct "
+                  "type but found " +
+                      field.typeSpec.getName(),
+                  field.typeSpec.getToken().line, field.typeSpec.getToken().column);
+    }
+    for (const auto &previous : fields) {
+      if (previous.name == fieldName.value) {
+        reportError("Redefinition of field '" + fieldName.value + "' of struct " + name.value,
+                    fieldName.line, fieldName.column);
+      }
+    }
+    fields.push_back({fieldName.value, typeSpecToType(field.typeSpec)});
+  }
+
+  auto type = createStructType(node, std::move(fields));
+  node.setType(type);
+
+  // Update symbol table with new struct
+  Symbol symbol(name.value, Symbol::Kind::STRUCT, type, node.shared_from_this());
+  try {
+    symbolTable->insert(symbol.getIdentifier(), symbol);
+  } catch (std::runtime_error &e) {
+    reportError(e.what(), name.line, name.column);
+    return;
+  }
+
+  // len and append functions for the dynamic arrays of the struct
+  auto type_array = std::make_shared<ArrayType>(type);
+  std::vector<std::shared_ptr<Type>> params_len{type_array};
+  auto type_len = std::make_shared<FunctionType>(params_len, BasicType::getIntType());
+  symbolTable->insert("len", Symbol("len", Symbol::Kind::FUNCTION, type_len));
+  std::vector<std::shared_ptr<Type>> params_append{type_array, type};
+  auto type_append = std::make_shared<FunctionType>(params_append, type_array);
+  symbolTable->insert("append", Symbol("append", Symbol::Kind::FUNCTION, type_append));
 }
 
-void Semantic::visit(std::shared_ptr<DeclarationStmt> node) { analyse(node->getDecl()); }
+void Semantic::visit(DeclarationStmt &node) { analyse(*node.getDecl()); }
 
-void Semantic::visit(std::shared_ptr<ExpressionStmt> node) { analyse(node->getExpr()); }
+void Semantic::visit(ExpressionStmt &node) { analyse(*node.getExpr()); }
 
-void Semantic::visit(std::shared_ptr<BlockStmt> node) {
+void Semantic::visit(BlockStmt &node) {
   beginScope();
 
   bool previousReturnStatementInBlockStmt = returnStatementInBlockStmt;
   returnStatementInBlockStmt = false;
-  for (const auto &stmt : node->getStmts()) {
+  for (const auto &stmt : node.getStmts()) {
     if (returnStatementInBlockStmt) {
       reportError("In this block, there is a statement after return statement",
-                  node->getLbrace().line, node->getRbrace().column);
+                  node.getLbrace().line, node.getRbrace().column);
     }
-    analyse(stmt);
+    analyse(*stmt);
   }
   returnStatementInBlockStmt = previousReturnStatementInBlockStmt;
 
   endScope();
 }
 
-void Semantic::visit(std::shared_ptr<IfStmt> node) {
-  analyse(node->getCondition());
+void Semantic::visit(IfStmt &node) {
+  analyse(*node.getCondition());
 
   // Type checking for condition
-  auto t = std::dynamic_pointer_cast<BasicType>(node->getCondition()->getType());
+  auto t = std::dynamic_pointer_cast<BasicType>(node.getCondition()->getType());
   if (t == nullptr || !t->isBoolean()) {
     reportError("Type checking: type of condition in if statement should be 'bool' but "
                 "found " +
-                    node->getCondition()->getType()->getName(),
-                node->getIfKeyword().line, node->getIfKeyword().column);
+                    node.getCondition()->getType()->getName(),
+                node.getIfKeyword().line, node.getIfKeyword().column);
+  }
+
+  analyse(*node.getThenBranch());
+
+  if (node.isHasElse()) {
+    analyse(*node.getElseBranch());
+  }
+}
+
+std::vector<const Decl *> Semantic::analyseReductions(ForStmt &node) {
+  std::vector<const Decl *> reductions;
+  for (const auto &reduction : node.getReductions()) {
+    const Token &op = reduction.op;
+    auto &variable = *reduction.variable;
+    if (op.value != "sum" && op.value != "min" && op.value != "max") {
+      reportError("Unknown reduction '" + op.value +
+                      "' in parallel for (it must be sum, min or max)",
+                  op.line, op.column);
+    }
+
+    analyse(variable);
+    if (variable.getDeclOfIdentifier() == nullptr || variable.getType() == nullptr) {
+      reportError("Reduction of parallel for must be a variable", variable.getIdent().line,
+                  variable.getIdent().column);
+      continue;
+    }
+    if (variable.getType()->isInvalid()) {
+      continue;
+    }
+
+    auto type = std::dynamic_pointer_cast<BasicType>(variable.getType());
+    if (variable.getExprValueKind() != Expr::ValueKind::Mod_LVal) {
+      reportError("Reduction variable '" + variable.getName() + "' can not be a constant",
+                  variable.getIdent().line, variable.getIdent().column);
+    } else if (type == nullptr || !type->isNumeric()) {
+      reportError("Type checking: reduction variable '" + variable.getName() +
+                      "' should be of numeric type but found " + variable.getType()->getName(),
+                  variable.getIdent().line, variable.getIdent().column);
+    }
+
+    const Decl *decl = variable.getDeclOfIdentifier().get();
+    if (std::find(reductions.begin(), reductions.end(), decl) != reductions.end()) {
+      reportError("Variable '" + variable.getName() + "' has more than one reduction",
+                  variable.getIdent().line, variable.getIdent().column);
+    }
+    reductions.push_back(decl);
+  }
+  return reductions;
+}
+
+const Decl *Semantic::getParallelInductionVariable(ForStmt &node) {
+  auto reportNotCanonical = [&]() {
+    reportError("A parallel for must have the form: for var int i = start; i < end; i = i + 1",
+                node.getForKeyword().line, node.getForKeyword().column);
+    return nullptr;
+  };
+  auto isVariable = [](const Expr &expr, const Decl *variable) {
+    return expr.getExprKind() == Expr::Kind::IDENTEXPR &&
+           static_cast<const IdentExpr &>(expr).getDeclOfIdentifier().get() == variable;
+  };
+
+  // Initialization: var int i = start
+  if (node.getInit() == nullptr || node.getCond() == nullptr || node.getPost() == nullptr ||
+      node.getInit()->getStmtKind() != Stmt::Kind::DECLARATIONSTMT) {
+    return reportNotCanonical();
+  }
+  const auto &decl = static_cast<DeclarationStmt &>(*node.getInit()).getDecl();
+  if (decl->getDeclKind() != Decl::Kind::VARDECL ||
+      !typeIsEqual(std::static_pointer_cast<VarDecl>(decl)->getType(), BasicType::getIntType())) {
+    return reportNotCanonical();
+  }
+  const Decl *variable = decl.get();
+
+  // Condition: i < end
+  if (node.getCond()->getExprKind() != Expr::Kind::BINARYEXPR) {
+    return reportNotCanonical();
+  }
+  const auto &cond = static_cast<const BinaryExpr &>(*node.getCond());
+  if (cond.getOp().tokenType != LESS || !isVariable(*cond.getLhs(), variable)) {
+    return reportNotCanonical();
+  }
+
+  // Post statement: i = i + 1
+  if (node.getPost()->getStmtKind() != Stmt::Kind::ASSIGNMENTSTMT) {
+    return reportNotCanonical();
+  }
+  const auto &post = static_cast<const AssignmentStmt &>(*node.getPost());
+  if (!isVariable(*post.getLhs(), variable) ||
+      post.getRhs()->getExprKind() != Expr::Kind::BINARYEXPR) {
+    return reportNotCanonical();
+  }
+  const auto &increment = static_cast<const BinaryExpr &>(*post.getRhs());
+  if (increment.getOp().tokenType != ADD || !isVariable(*increment.getLhs(), variable) ||
+      increment.getRhs()->getExprKind() != Expr::Kind::LITERALEXPR ||
+      static_cast<const LiteralExpr &>(*increment.getRhs()).getToken().value != "1") {
+    return reportNotCanonical();
   }
 
-  analyse(node->getThenBranch());
+  return variable;
+}
 
-  if (node->isHasElse()) {
-    analyse(node->getElseBranch());
+void Semantic::checkParallelAssignment(AssignmentStmt &node) {
+  // The variable modified is the array of the outermost index expression (i.e. a in a[i][j]), or
+  // the struct whose field is modified (i.e. a in a[i].x)
+  Expr *variable = node.getLhs().get();
+  Expr *index = nullptr;
+  while (variable->getExprKind() == Expr::Kind::INDEXEXPR ||
+         variable->getExprKind() == Expr::Kind::FIELDEXPR) {
+    if (variable->getExprKind() == Expr::Kind::FIELDEXPR) {
+      variable = static_cast<FieldExpr *>(variable)->getOperand().get();
+      continue;
+    }
+    auto *indexExpr = static_cast<IndexExpr *>(variable);
+    variable = indexExpr->getArray().get();
+    index = indexExpr->getIndex().get();
+  }
+  if (variable->getExprKind() != Expr::Kind::IDENTEXPR) {
+    return;
+  }
+  const auto &identExpr = static_cast<const IdentExpr &>(*variable);
+  const Decl *decl = identExpr.getDeclOfIdentifier().get();
+  const Decl *indexDecl = nullptr;
+  if (index != nullptr && index->getExprKind() == Expr::Kind::IDENTEXPR) {
+    indexDecl = static_cast<const IdentExpr &>(*index).getDeclOfIdentifier().get();
+  }
+
+  for (const auto &parallelLoop : parallelLoops) {
+    bool isReduction = std::find(parallelLoop.reductions.begin(), parallelLoop.reductions.end(),
+                                 decl) != parallelLoop.reductions.end();
+    if (parallelLoop.privates.count(decl) != 0 || (index == nullptr && isReduction)) {
+      continue;
+    }
+    if (decl == parallelLoop.inductionVariable && index == nullptr) {
+      reportError("The induction variable of a parallel for can not be modified in its body",
+                  node.getEqualToken().line, node.getEqualToken().column);
+      return;
+    }
+    // Every iteration modifies a different element of the array
+    if (index != nullptr && indexDecl == parallelLoop.inductionVariable) {
+      continue;
+    }
+    reportError("Variable '" + identExpr.getName() +
+                    "' is shared by the iterations of the parallel for and can not be modified "
+                    "(only its elements indexed by the induction variable, or with a reduction)",
+                node.getEqualToken().line, node.getEqualToken().column);
+    return;
   }
 }
 
-void Semantic::visit(std::shared_ptr<ForStmt> node) {
+void Semantic::visit(ForStmt &node) {
+  // the reduction variables are declared outside of the loop
+  std::vector<const Decl *> reductions;
+  if (node.isParallel()) {
+    reductions = analyseReductions(node);
+  }
+
   beginScope();
-  analyse(node->getInit());
-  analyse(node->getCond());
+  // initialization, condition and post statement are optional
+  if (node.getInit() != nullptr) {
+    analyse(*node.getInit());
+  }
 
-  // Type checking for condition
-  auto t = std::dynamic_pointer_cast<BasicType>(node->getCond()->getType());
-  if (t == nullptr || !t->isBoolean()) {
-    reportError("Type checking: type of condition in for statement should be 'bool' but "
-                "found " +
-                    node->getCond()->getType()->getName(),
-                node->getForKeyword().line, node->getForKeyword().column);
+  if (node.getCond() != nullptr) {
+    analyse(*node.getCond());
+
+    // Type checking for condition
+    auto t = std::dynamic_pointer_cast<BasicType>(node.getCond()->getType());
+    if (t == nullptr || !t->isBoolean()) {
+      reportError("Type checking: type of condition in for statement should be 'bool' but "
+                  "found " +
+                      node.getCond()->getType()->getName(),
+                  node.getForKeyword().line, node.getForKeyword().column);
+    }
   }
 
-  analyse(node->getPost());
+  if (node.getPost() != nullptr) {
+    analyse(*node.getPost());
+  }
+
+  if (node.isParallel()) {
+    parallelLoops.push_back({&node, getParallelInductionVariable(node), reductions, {}});
+    markImpure("it has a parallel for", node.getForKeyword().line);
+  }
+  loops.push_back(&node);
   // In ForStmt, declarations in init have to be inside the scope of the body so the scope it is
   //  created in the beginning. Because the scope has been already created, we call directly to
   //  analyse the vector of statements since analyse block of statements creates a new scope
   //  and we do not want a new scope
-  analyse(node->getBody()->getStmts());
+  analyse(node.getBody()->getStmts());
+  loops.pop_back();
+  if (node.isParallel()) {
+    parallelLoops.pop_back();
+  }
   endScope();
 }
 
-void Semantic::visit(std::shared_ptr<WhileStmt> node) {
-  analyse(node->getCond());
+void Semantic::visit(WhileStmt &node) {
+  analyse(*node.getCond());
 
   // Type checking for condition
-  auto t = std::dynamic_pointer_cast<BasicType>(node->getCond()->getType());
+  auto t = std::dynamic_pointer_cast<BasicType>(node.getCond()->getType());
   if (t == nullptr || !t->isBoolean()) {
     reportError("Type checking: type of condition in while statement should be 'bool' but "
                 "found " +
-                    node->getCond()->getType()->getName(),
-                node->getWhileKeyword().line, node->getWhileKeyword().column);
+                    node.getCond()->getType()->getName(),
+                node.getWhileKeyword().line, node.getWhileKeyword().column);
   }
 
   beginScope();
-  analyse(node->getBody());
+  loops.push_back(&node);
+  analyse(*node.getBody());
+  loops.pop_back();
   endScope();
 }
 
-void Semantic::visit(std::shared_ptr<AssignmentStmt> node) {
+void Semantic::visit(AssignmentStmt &node) {
   // check that it is assignable
-  analyse(node->getLhs());
-  analyse(node->getRhs());
+  analyse(*node.getLhs());
+  analyse(*node.getRhs());
 
   // Expression on the left hand side can be assigned
-  if (node->getLhs()->getExprValueKind() == Expr::ValueKind::RVal) {
-    reportError("Expression is not assignable", node->getEqualToken().line,
-                node->getEqualToken().column);
-  } else if (node->getLhs()->getExprValueKind() == Expr::ValueKind::NMod_LVal) {
-    reportError("Expression is not assignable (constant)", node->getEqualToken().line,
-                node->getEqualToken().column);
+  if (node.getLhs()->getExprValueKind() == Expr::ValueKind::RVal) {
+    reportError("Expression is not assignable", node.getEqualToken().line,
+                node.getEqualToken().column);
+  } else if (node.getLhs()->getExprValueKind() == Expr::ValueKind::NMod_LVal) {
+    reportError("Expression is not assignable (constant)", node.getEqualToken().line,
+                node.getEqualToken().column);
+  } else if (node.getLhs()->getType()->getTypeKind() == Type::Kind::AtomicType) {
+    reportError("An atomic can only be modified with store, exchange, compare_exchange or the "
+                "fetch operations (i.e. fetch_add)",
+                node.getEqualToken().line, node.getEqualToken().column);
+    return;
+  } else if (!parallelLoops.empty()) {
+    checkParallelAssignment(node);
   }
 
-  // Type checking
-  if (!typeIsEqual(node->getRhs()->getType(), node->getLhs()->getType())) {
-    reportError("Type checking: cannot assign type " + node->getRhs()->getType()->getName() +
-                    " to type " + node->getLhs()->getType()->getName(),
-                node->getEqualToken().line, node->getEqualToken().column);
+  // The elements of a dynamic array are shared with the caller, so modifying them is not pure
+  const Expr *lhs = node.getLhs().get();
+  while (lhs->getExprKind() == Expr::Kind::INDEXEXPR ||
+         lhs->getExprKind() == Expr::Kind::FIELDEXPR) {
+    if (lhs->getExprKind() == Expr::Kind::FIELDEXPR) {
+      lhs = static_cast<const FieldExpr &>(*lhs).getOperand().get();
+      continue;
+    }
+    const auto &indexExpr = static_cast<const IndexExpr &>(*lhs);
+    auto arrayType = std::dynamic_pointer_cast<ArrayType>(indexExpr.getArray()->getType());
+    if (arrayType != nullptr && arrayType->isDynamic()) {
+      markImpure("it modifies an element of a dynamic array", node.getEqualToken().line);
+      break;
+    }
+    lhs = indexExpr.getArray().get();
   }
+
+  // Type checking
+  convertLiteral(*node.getRhs(), node.getLhs()->getType());
+  if (!typeIsEqual(node.getRhs()->getType(), node.getLhs()->getType())) {
+    reportError("Type checking: cannot assign type " + node.getRhs()->getType()->getName() +
+                    " to type " + node.getLhs()->getType()->getName(),
+                node.getEqualToken().line, node.getEqualToken().column);
+  }  checkTaskNotCopied(*node.getRhs(), node.getEqualToken());
 }
 
-void Semantic::visit(std::shared_ptr<ReturnStmt> node) {
+void Semantic::visit(ReturnStmt &node) {
   if (scopeType != Semantic::ScopeType::FUNCTION) {
-    reportError("return statement outside function body", node->getReturnKeyword().line,
-                node->getReturnKeyword().column);
+    reportError("return statement outside function body", node.getReturnKeyword().line,
+                node.getReturnKeyword().column);
+  } else if (node.getValue() == nullptr) {
+    reportError("return statement without value is not supported", node.getReturnKeyword().line,
+                node.getReturnKeyword().column);
+  } else if (!parallelLoops.empty()) {
+    reportError("return statement inside a parallel for", node.getReturnKeyword().line,
+                node.getReturnKeyword().column);
   } else {
-    analyse(node->getValue());
+    analyse(*node.getValue());
 
     // Type checking
-    if (!typeIsEqual(node->getValue()->getType(), this->signature->getResult())) {
+    convertLiteral(*node.getValue(), this->signature->getResult());
+    if (!typeIsEqual(node.getValue()->getType(), this->signature->getResult())) {
       reportError("Type checking: different types of returned value of type " +
-                      node->getValue()->getType()->getName() +
+                      node.getValue()->getType()->getName() +
                       " and function return value of type " + this->signature->getName(),
-                  node->getReturnKeyword().line, node->getReturnKeyword().column);
+                  node.getReturnKeyword().line, node.getReturnKeyword().column);
+    }
+    checkTaskNotCopied(*node.getValue(), node.getReturnKeyword());
+
+    // A call to a function returned directly is in tail position, unless the callee receives an
+    // array or an atomic by reference, that could be in the frame of the caller
+    if (node.getValue()->getExprKind() == Expr::Kind::CALLEXPR) {
+      auto &call = static_cast<CallExpr &>(*node.getValue());
+      const auto &func = static_cast<IdentExpr &>(*call.getFunc());
+      if (func.getDeclOfIdentifier() != nullptr &&
+          func.getDeclOfIdentifier()->getDeclKind() == Decl::Kind::FUNCDECL) {
+        bool byReference = false;
+        auto calleeSignature = std::static_pointer_cast<FunctionType>(func.getType());
+        for (const auto &param : calleeSignature->getParams()) {
+          auto arrayType = std::dynamic_pointer_cast<ArrayType>(param);
+          byReference = byReference || (arrayType != nullptr && !arrayType->isDynamic()) ||
+                        param->getTypeKind() == Type::Kind::AtomicType;
+        }
+        if (!byReference) {
+          call.setTailCall(CallExpr::TailCall::TAIL);
+        }
+      }
     }
 
     returnStatementInBlockStmt = true;
   }
 }
 
-void Semantic::visit(std::shared_ptr<BinaryExpr> node) {
+void Semantic::visit(BreakStmt &node) {
+  if (loops.empty()) {
+    reportError("break statement outside loop", node.getBreakKeyword().line,
+                node.getBreakKeyword().column);
+  } else if (loops.back()->getStmtKind() == Stmt::Kind::FORSTMT &&
+             static_cast<const ForStmt *>(loops.back())->isParallel()) {
+    // The iterations of a parallel for are divided between the threads before running them
+    reportError("break statement inside a parallel for", node.getBreakKeyword().line,
+                node.getBreakKeyword().column);
+  }
+}
+
+void Semantic::visit(ContinueStmt &node) {
+  if (loops.empty()) {
+    reportError("continue statement outside loop", node.getContinueKeyword().line,
+                node.getContinueKeyword().column);
+  }
+}
+
+void Semantic::visit(BinaryExpr &node) {
   // Do semantic analysis of both expressions
-  analyse(node->getLhs());
-  analyse(node->getRhs());
+  analyse(*node.getLhs());
+  analyse(*node.getRhs());
 
   // Type checking if non of the operators are invalid. If any of the operators is invalid, the
   // error has already been reported and we do nothing.
-  if (node->getLhs()->getType()->isInvalid() || node->getRhs()->getType()->isInvalid()) {
-    node->setType(BasicType::getInvalidType());
+  if (node.getLhs()->getType()->isInvalid() || node.getRhs()->getType()->isInvalid()) {
+    node.setType(BasicType::getInvalidType());
     return;
   }
 
-  // Type checking
-  if (!typeIsEqual(node->getLhs()->getType(), node->getRhs()->getType())) {
-    reportError("Type checking: different types " + node->getLhs()->getType()->getName() + " and " +
-                    node->getRhs()->getType()->getName(),
-                node->getOp().line, node->getOp().column);
+  // Type checking. A literal takes the type of the other operand (i.e. x + 1 with x of type int8)
+  convertLiteral(*node.getRhs(), node.getLhs()->getType());
+  convertLiteral(*node.getLhs(), node.getRhs()->getType());
+  if (!typeIsEqual(node.getLhs()->getType(), node.getRhs()->getType())) {
+    reportError("Type checking: different types " + node.getLhs()->getType()->getName() + " and " +
+                    node.getRhs()->getType()->getName(),
+                node.getOp().line, node.getOp().column);
   }
 
   // Type checking that operator is valid for types
-  auto [isValid, type] = isValidBinaryOperatorForType(node->getOp(), node->getRhs()->getType());
+  auto [isValid, type] = isValidBinaryOperatorForType(node.getOp(), node.getRhs()->getType());
 
   if (!isValid) {
     reportError("Operator is not supported for binary expression of type " +
-                    node->getRhs()->getType()->getName(),
-                node->getOp().line, node->getOp().column);
+                    node.getRhs()->getType()->getName(),
+                node.getOp().line, node.getOp().column);
+    type = BasicType::getInvalidType();
   }
-  node->setType(type);
-  node->setExprValueKind(Expr::ValueKind::RVal);
+  node.setType(type);
+  node.setExprValueKind(Expr::ValueKind::RVal);
 }
 
-void Semantic::visit(std::shared_ptr<UnaryExpr> node) {
+void Semantic::visit(UnaryExpr &node) {
   // Do semantic analysis of expression
-  analyse(node->getRhs());
+  analyse(*node.getRhs());
 
   // Type checking if the operator is invalid. If  is invalid, the error has already been reported
   // and we do nothing.
-  if (node->getRhs()->getType()->isInvalid()) {
-    node->setType(BasicType::getInvalidType());
+  if (node.getRhs()->getType()->isInvalid()) {
+    node.setType(BasicType::getInvalidType());
     return;
   }
 
   // Type checking that operator is valid for type
-  auto [isValid, type] = isValidUnaryOperatorForType(node->getOp(), node->getRhs()->getType());
+  auto [isValid, type] = isValidUnaryOperatorForType(node.getOp(), node.getRhs()->getType());
 
   if (!isValid) {
     reportError("Operator is not supported for unary expression of type " +
-                    node->getRhs()->getType()->getName(),
-                node->getOp().line, node->getOp().column);
+                    node.getRhs()->getType()->getName(),
+                node.getOp().line, node.getOp().column);
+    type = BasicType::getInvalidType();
   }
-  node->setType(type);
+  node.setType(type);
   // Right now, all unary operators create a RValue. If we had arrays [] or address operators &,
   // we would have to check the current ExprValueKind and what it results from applying the unary op
-  node->setExprValueKind(Expr::ValueKind::RVal);
+  node.setExprValueKind(Expr::ValueKind::RVal);
 }
 
-void Semantic::visit(std::shared_ptr<LiteralExpr> node) {
+void Semantic::visit(LiteralExpr &node) {
   // Type checking
-  node->setType(tokenTypeToType(node->getToken()));
-  node->setExprValueKind(Expr::ValueKind::RVal);
+  node.setType(tokenTypeToType(node.getToken()));
+  node.setExprValueKind(Expr::ValueKind::RVal);
 }
 
-void Semantic::visit(std::shared_ptr<IdentExpr> node) {
+void Semantic::visit(IdentExpr &node) {
   try {
-    std::vector<Symbol> symbols = symbolTable->lookup(node->getName());
+    std::vector<Symbol> symbols = symbolTable->lookup(node.getName());
 
     // if any of the symbol is a function we do nothing since we have already resolved the symbol
     // and now is the CallExpr node who will processed that
     if (symbols.empty()) {
       reportError("Internal Error - Identifier found but not symbol associated",
-                  node->getIdent().line, node->getIdent().column);
+                  node.getIdent().line, node.getIdent().column);
     }
 
     if (symbols[0].getKind() == Symbol::Kind::FUNCTION) {
@@ -585,45 +1709,89 @@ void Semantic::visit(std::shared_ptr<IdentExpr> node) {
       return;
     }
 
+    // the name of a struct is only used as a type or to create a value (see analyseStructLiteral)
+    if (symbols[0].getKind() == Symbol::Kind::STRUCT) {
+      reportError(node.getName() + " is a struct type, not a value", node.getIdent().line,
+                  node.getIdent().column);
+      node.setType(BasicType::getInvalidType());
+      node.setExprValueKind(Expr::ValueKind::RVal);
+      return;
+    }
+
     if (symbols.size() > 1) {
       reportError("Internal Error - Multiple identifier of kind "
                   "variable/constant/parameter",
-                  node->getIdent().line, node->getIdent().column);
+                  node.getIdent().line, node.getIdent().column);
     }
 
     // is a variable/constant/parameter
-    node->setType(symbols[0].getType());
+    node.setType(symbols[0].getType());
 
     // If identifer is a constant, it can not be modified
     if (symbols[0].getKind() == Symbol::Kind::CONSTANT) {
-      node->setExprValueKind(Expr::ValueKind::NMod_LVal);
+      node.setExprValueKind(Expr::ValueKind::NMod_LVal);
     } else {
-      node->setExprValueKind(Expr::ValueKind::Mod_LVal);
+      node.setExprValueKind(Expr::ValueKind::Mod_LVal);
+    }
+
+    node.setDeclOfIdentifier(symbols[0].getDeclReference());
+
+    // A local variable declared outside of a parallel for is captured by the function in which its
+    // body is outlined
+    const auto &decl = symbols[0].getDeclReference();
+    bool isGlobal = (decl->getDeclKind() == Decl::Kind::VARDECL &&
+                     std::static_pointer_cast<VarDecl>(decl)->isGlobal()) ||
+                    (decl->getDeclKind() == Decl::Kind::CONSTDECL &&
+                     std::static_pointer_cast<ConstDecl>(decl)->isGlobal());
+    for (auto &parallelLoop : parallelLoops) {
+      if (!isGlobal && decl.get() != parallelLoop.inductionVariable &&
+          parallelLoop.privates.count(decl.get()) == 0) {
+        parallelLoop.loop->addCapturedVariable(decl);
+      }
     }
 
-    node->setDeclOfIdentifier(symbols[0].getDeclReference());
+    // The value of a global variable can change between calls (the global constants can not)
+    if (isGlobal && decl->getDeclKind() == Decl::Kind::VARDECL) {
+      markImpure("it uses the global variable " + node.getName(), node.getIdent().line);
+    }
   } catch (std::runtime_error &e) {
-    reportError(e.what(), node->getIdent().line, node->getIdent().column);
-    node->setType(BasicType::getInvalidType());
+    reportError(e.what(), node.getIdent().line, node.getIdent().column);
+    node.setType(BasicType::getInvalidType());
   }
 }
 
-void Semantic::visit(std::shared_ptr<CallExpr> node) {
-  analyse(node->getFunc());
+void Semantic::visit(CallExpr &node) {
+  node.setExprValueKind(Expr::ValueKind::RVal);
+  // A call to the name of a struct creates a value of the struct
+  if (node.getFunc()->getExprKind() == Expr::Kind::IDENTEXPR) {
+    const auto &name = static_cast<IdentExpr &>(*node.getFunc()).getName();
+    std::vector<Symbol> symbols;
+    try {
+      symbols = symbolTable->lookup(name);
+    } catch (std::runtime_error &e) {
+      // the error is reported when analysing the function
+    }
+    if (!symbols.empty() && symbols[0].getKind() == Symbol::Kind::STRUCT) {
+      analyseStructLiteral(node, symbols[0]);
+      return;
+    }
+  }
+
+  analyse(*node.getFunc());
   // Save the identifier symbols of our function
   auto previousResolvedSymbols = resolvedSymbols;
 
-  for (const auto &argument : node->getArgs()) {
-    analyse(argument);
+  for (const auto &argument : node.getArgs()) {
+    analyse(*argument);
   }
 
   // Restore previous resolved symbols
   resolvedSymbols = previousResolvedSymbols;
 
-  // Construct type of our call (basic type because for now we only have this)
-  std::vector<std::shared_ptr<BasicType>> args;
-  for (const auto &arg : node->getArgs()) {
-    args.push_back(std::dynamic_pointer_cast<BasicType>(arg->getType()));
+  // Construct type of our call
+  std::vector<std::shared_ptr<Type>> args;
+  for (const auto &arg : node.getArgs()) {
+    args.push_back(arg->getType());
   }
 
   Symbol resolvedSymbol;
@@ -636,16 +1804,419 @@ void Semantic::visit(std::shared_ptr<CallExpr> node) {
     }
   }
 
+  // If no function has exactly the types of the arguments, the literals in the arguments can take
+  // the type of the parameter (i.e. f(5) with func f(var int8 a)) if only one function matches
+  if (!foundSymbol) {
+    int matches = 0;
+    for (auto const &possibleSymbol : resolvedSymbols) {
+      auto params = std::dynamic_pointer_cast<FunctionType>(possibleSymbol.getType())->getParams();
+      bool match = params.size() == args.size();
+      for (std::size_t i = 0; match && i < args.size(); i++) {
+        match = typeIsEqual(args[i], params[i]) ||
+                isConvertibleLiteral(*node.getArgs()[i], params[i]);
+      }
+      if (match) {
+        resolvedSymbol = possibleSymbol;
+        matches++;
+      }
+    }
+
+    if (matches == 1) {
+      auto params = std::dynamic_pointer_cast<FunctionType>(resolvedSymbol.getType())->getParams();
+      for (std::size_t i = 0; i < args.size(); i++) {
+        convertLiteral(*node.getArgs()[i], params[i]);
+      }
+      foundSymbol = true;
+    }
+  }
+
   if (foundSymbol) {
     auto functionType = std::dynamic_pointer_cast<FunctionType>(resolvedSymbol.getType());
-    node->setType(functionType->getResult());
-    node->getFunc()->setType(resolvedSymbol.getType());
-    std::dynamic_pointer_cast<IdentExpr>(node->getFunc())
-        ->setDeclOfIdentifier(resolvedSymbol.getDeclReference());
+    node.setType(functionType->getResult());
+    node.getFunc()->setType(resolvedSymbol.getType());
+    dynamic_cast<IdentExpr &>(*node.getFunc())
+        .setDeclOfIdentifier(resolvedSymbol.getDeclReference());
+
+    // the builtin shuffle has no declaration and its indices have to be known at compile time
+    if (resolvedSymbol.getDeclReference() == nullptr &&
+        resolvedSymbol.getIdentifier() == "shuffle") {
+      checkShuffleIndices(node);
+    }
+    if (resolvedSymbol.getDeclReference() == nullptr &&
+        isAtomicBuiltinFunction(resolvedSymbol.getIdentifier())) {
+      checkAtomicOrdering(node);
+    }
+
+    // The builtin functions that print or modify memory are not pure
+    const auto &func = static_cast<IdentExpr &>(*node.getFunc());
+    const std::string &name = resolvedSymbol.getIdentifier();
+    if (resolvedSymbol.getDeclReference() != nullptr) {
+      if (scopeType == ScopeType::FUNCTION) {
+        auto callee = static_cast<FuncDecl *>(resolvedSymbol.getDeclReference().get());
+        bodySummary.callees.insert(callee);
+        bodySummary.calls.push_back(&node);
+      }
+    } else if (name == "print" || name == "println") {
+      markImpure("it calls " + name, func.getIdent().line);
+    } else if (name == "append") {
+      markImpure("it modifies a dynamic array with append", func.getIdent().line);
+    } else if (isAtomicBuiltinFunction(name)) {
+      markImpure("it calls the atomic builtin " + name, func.getIdent().line);
+    }
   } else {
     reportError("Undefined reference to " + resolvedSymbols[0].getIdentifier(),
-                std::dynamic_pointer_cast<IdentExpr>(node->getFunc())->getIdent().line,
-                std::dynamic_pointer_cast<IdentExpr>(node->getFunc())->getIdent().column);
-    node->setType(BasicType::getInvalidType());
+                dynamic_cast<IdentExpr &>(*node.getFunc()).getIdent().line,
+                dynamic_cast<IdentExpr &>(*node.getFunc()).getIdent().column);
+    node.setType(BasicType::getInvalidType());
+  }
+}
+void Semantic::analyseStructLiteral(CallExpr &node, const Symbol &structSymbol) {
+  auto &func = static_cast<IdentExpr &>(*node.getFunc());
+  auto structType = std::dynamic_pointer_cast<StructType>(structSymbol.getType());
+  func.setType(structType);
+  func.setExprValueKind(Expr::ValueKind::RVal);
+  func.setDeclOfIdentifier(structSymbol.getDeclReference());
+  node.setType(structType);
+
+  for (const auto &argument : node.getArgs()) {
+    analyse(*argument);
+  }
+
+  // Point() has every field zero
+  const auto &fields = structType->getFields();
+  if (node.getArgs().empty()) {
+    return;
+  }
+  if (node.getArgs().size() != fields.size()) {
+    reportError("The struct " + structType->getName() + " has " + std::to_string(fields.size()) +
+                    " fields but found " + std::to_string(node.getArgs().size()) + " values",
+                func.getIdent().line, func.getIdent().column);
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+
+  for (std::size_t i = 0; i < fields.size(); i++) {
+    const auto &arg = *node.getArgs()[i];
+    if (arg.getType()->isInvalid()) {
+      node.setType(BasicType::getInvalidType());
+      continue;
+    }
+    convertLiteral(*node.getArgs()[i], fields[i].type);
+    if (!typeIsEqual(arg.getType(), fields[i].type)) {
+      reportError("Type checking: the field " + fields[i].name + " of struct " +
+                      structType->getName() + " is of type " + fields[i].type->getName() +
+                      " but found " + arg.getType()->getName(),
+                  func.getIdent().line, func.getIdent().column);
+      node.setType(BasicType::getInvalidType());
+    }
+  }
+}
+
+void Semantic::checkShuffleIndices(CallExpr &node) {
+  auto vectorType = std::dynamic_pointer_cast<VectorType>(node.getType());
+  std::int64_t lanes = 2 * vectorType->getLanes(); // lanes of the two vectors shuffled
+
+  const auto &indices = *node.getArgs()[2];
+  bool valid = indices.getExprKind() == Expr::Kind::ARRAYLITERALEXPR;
+  if (valid) {
+    for (const auto &index : static_cast<const ArrayLiteralExpr &>(indices).getElements()) {
+      if (index->getExprKind() != Expr::Kind::LITERALEXPR) {
+        valid = false;
+        break;
+      }
+      const auto &token = static_cast<const LiteralExpr &>(*index).getToken();
+      if (token.tokenType != LIT_INT || token.value.size() > 18 ||
+          std::stoll(token.value) >= lanes) {
+        valid = false;
+        break;
+      }
+    }
+  }
+
+  if (!valid) {
+    const auto &ident = dynamic_cast<IdentExpr &>(*node.getFunc()).getIdent();
+    reportError("The indices of shuffle should be a vector literal of integer literals between 0 "
+                "and " +
+                    std::to_string(lanes - 1),
+                ident.line, ident.column);
+  }
+}
+
+void Semantic::checkAtomicOrdering(CallExpr &node) {
+  const auto &args = node.getArgs();
+  if (args.empty() || !isString(args.back()->getType())) {
+    return; // seq_cst by default
+  }
+
+  const auto &func = static_cast<IdentExpr &>(*node.getFunc());
+  const Expr &ordering = *args.back();
+  if (ordering.getExprKind() != Expr::Kind::LITERALEXPR) {
+    reportError("The memory ordering of " + func.getName() +
+                    " should be a string literal known at compile time",
+                func.getIdent().line, func.getIdent().column);
+    return;
+  }
+
+  // a load only acquires and a store only releases
+  const std::string &value = static_cast<const LiteralExpr &>(ordering).getToken().value;
+  bool valid = value == "relaxed" || value == "seq_cst" ||
+               (value == "acquire" && func.getName() != "store") ||
+               (value == "release" && func.getName() != "load") ||
+               (value == "acq_rel" && func.getName() != "load" && func.getName() != "store");
+  if (!valid) {
+    reportError("Invalid memory ordering \"" + value + "\" for " + func.getName() +
+                    ": it should be relaxed, acquire, release, acq_rel or seq_cst (a load can not "
+                    "be release and a store can not be acquire)",
+                func.getIdent().line, func.getIdent().column);
+  }
+}
+
+void Semantic::visit(IndexExpr &node) {
+  analyse(*node.getArray());
+  analyse(*node.getIndex());
+
+  // If any of the expressions is invalid, the error has already been reported and we do nothing
+  node.setType(BasicType::getInvalidType());
+  node.setExprValueKind(Expr::ValueKind::RVal);
+  if (node.getArray()->getType() == nullptr || node.getIndex()->getType() == nullptr ||
+      node.getArray()->getType()->isInvalid() || node.getIndex()->getType()->isInvalid()) {
+    return;
+  }
+
+  // The lane of a vector is selected with an integer literal, so that it is checked now
+  auto vectorType = std::dynamic_pointer_cast<VectorType>(node.getArray()->getType());
+  if (vectorType != nullptr) {
+    std::int64_t lane = -1;
+    if (node.getIndex()->getExprKind() == Expr::Kind::LITERALEXPR) {
+      const auto &index = static_cast<LiteralExpr &>(*node.getIndex()).getToken();
+      if (index.tokenType == LIT_INT && index.value.size() <= 18) {
+        lane = std::stoll(index.value);
+      }
+    }
+    if (lane < 0 || lane >= vectorType->getLanes()) {
+      reportError("Type checking: the lane of a vector of type " + vectorType->getName() +
+                      " should be an integer literal between 0 and " +
+                      std::to_string(vectorType->getLanes() - 1),
+                  node.getLbrack().line, node.getLbrack().column);
+      return;
+    }
+
+    node.setType(vectorType->getElement());
+    // A lane can be modified if the vector can be modified
+    node.setExprValueKind(node.getArray()->getExprValueKind());
+    return;
+  }
+
+  // Type checking
+  auto arrayType = std::dynamic_pointer_cast<ArrayType>(node.getArray()->getType());
+  if (arrayType == nullptr) {
+    reportError("Type checking: indexed expression should be an array but found " +
+                    node.getArray()->getType()->getName(),
+                node.getLbrack().line, node.getLbrack().column);
+    return;
+  }
+
+  auto indexType = std::dynamic_pointer_cast<BasicType>(node.getIndex()->getType());
+  if (indexType == nullptr || indexType->getKind() != BasicType::Kind::INT) {
+    reportError("Type checking: type of index should be 'int' but found " +
+                    node.getIndex()->getType()->getName(),
+                node.getLbrack().line, node.getLbrack().column);
+    return;
+  }
+
+  // A constant index of a fixed-size array is checked now instead of at runtime
+  if (!arrayType->isDynamic() && node.getIndex()->getExprKind() == Expr::Kind::LITERALEXPR) {
+    const auto &index = static_cast<LiteralExpr &>(*node.getIndex()).getToken().value;
+    if (index.size() > 18 || std::stoll(index) >= arrayType->getSize()) {
+      reportError("Index " + index + " out of range of array of type " +
+                      arrayType->getName(),
+                  node.getLbrack().line, node.getLbrack().column);
+    }
+  }
+
+  node.setType(arrayType->getElement());
+  // An element can be modified if the array can be modified
+  node.setExprValueKind(node.getArray()->getExprValueKind());
+}
+
+void Semantic::visit(FieldExpr &node) {
+  analyse(*node.getOperand());
+
+  // If the struct is invalid, the error has already been reported and we do nothing
+  node.setType(BasicType::getInvalidType());
+  node.setExprValueKind(Expr::ValueKind::RVal);
+  const auto &operandType = node.getOperand()->getType();
+  if (operandType == nullptr || operandType->isInvalid()) {
+    return;
+  }
+
+  auto structType = std::dynamic_pointer_cast<StructType>(operandType);
+  if (structType == nullptr) {
+    reportError("Type checking: the operand of '.' should be a struct but found " +
+                    operandType->getName(),
+                node.getPeriod().line, node.getPeriod().column);
+    return;
+  }
+
+  int fieldIndex = structType->getFieldIndex(node.getField().value);
+  if (fieldIndex < 0) {
+    reportError("The struct " + structType->getName() + " has no field " +
+                    node.getField().value,
+                node.getField().line, node.getField().column);
+    return;
+  }
+
+  node.setFieldIndex(fieldIndex);
+  node.setType(structType->getFields()[fieldIndex].type);
+  // A field can be modified if the struct can be modified
+  node.setExprValueKind(node.getOperand()->getExprValueKind());
+}
+
+void Semantic::visit(ArrayLiteralExpr &node) {
+  node.setExprValueKind(Expr::ValueKind::RVal);
+  for (const auto &element : node.getElements()) {
+    analyse(*element);
+  }
+
+  auto type = typeSpecToType(node.getTypeSpec());
+  node.setType(type);
+  std::shared_ptr<Type> elementType;
+  std::string literalKind;
+  if (auto vectorType = std::dynamic_pointer_cast<VectorType>(type)) {
+    // A vector literal has a value for every lane, a single value for all the lanes or no value
+    // (all the lanes are zero)
+    auto size = node.getElements().size();
+    if (size > 1 && static_cast<int64_t>(size) != vectorType->getLanes()) {
+      reportError("Wrong number of elements (" + std::to_string(size) +
+                      ") in vector literal of type " + vectorType->getName() +
+                      ": it should have one element or one element for every lane",
+                  node.getRbrace().line, node.getRbrace().column);
+    }
+    elementType = vectorType->getElement();
+    literalKind = "vector";
+  } else if (auto arrayType = std::dynamic_pointer_cast<ArrayType>(type)) {
+    auto size = static_cast<int64_t>(node.getElements().size());
+    if (!arrayType->isDynamic() && size > arrayType->getSize()) {
+      reportError("Too many elements (" + std::to_string(size) +
+                      ") in array literal of type " + arrayType->getName(),
+                  node.getRbrace().line, node.getRbrace().column);
+    }
+    elementType = arrayType->getElement();
+    literalKind = "array";
+  } else {
+    return; // the error has already been reported
+  }
+
+  // Type checking of the elements. If an element is invalid, the error has already been reported
+  for (const auto &element : node.getElements()) {
+    convertLiteral(*element, elementType);
+    if (!element->getType()->isInvalid() && !typeIsEqual(element->getType(), elementType)) {
+      reportError("Type checking: element of type " + element->getType()->getName() + " in " +
+                      literalKind + " literal of type " + type->getName(),
+                  node.getTypeSpec().getToken().line, node.getTypeSpec().getToken().column);
+    }
+  }
+}
+
+void Semantic::visit(ConversionExpr &node) {
+  analyse(*node.getValue());
+
+  node.setType(tokenTypeToType(node.getTypeToken()));
+  node.setExprValueKind(Expr::ValueKind::RVal);
+
+  // If the value is invalid, the error has already been reported
+  if (node.getValue()->getType() == nullptr || node.getValue()->getType()->isInvalid()) {
+    return;
+  }
+
+  // Only numeric values can be converted (to a numeric type, see Parser::parseConversion)
+  auto type = std::dynamic_pointer_cast<BasicType>(node.getValue()->getType());
+  if (type == nullptr || !type->isNumeric()) {
+    reportError("Type checking: cannot convert value of type " +
+                    node.getValue()->getType()->getName() + " to type " +
+                    node.getType()->getName(),
+                node.getTypeToken().line, node.getTypeToken().column);
+  }
+}
+
+void Semantic::visit(SpawnExpr &node) {
+  node.setExprValueKind(Expr::ValueKind::RVal);
+
+  if (node.getCall()->getExprKind() != Expr::Kind::CALLEXPR) {
+    reportError("spawn should be followed by a function call",
+                node.getSpawnKeyword().line, node.getSpawnKeyword().column);
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+
+  // The function spawned is selected like in any other call (overloading included)
+  analyse(*node.getCall());
+  if (node.getCall()->getType()->isInvalid()) {
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+
+  const auto &call = static_cast<CallExpr &>(*node.getCall());
+  const auto &func = static_cast<IdentExpr &>(*call.getFunc());
+  // the builtin functions have no declaration and are not compiled as functions
+  if (func.getDeclOfIdentifier() != nullptr &&
+      func.getDeclOfIdentifier()->getDeclKind() == Decl::Kind::STRUCTDECL) {
+    reportError("spawn should be followed by a function call but found a value of struct " +
+                    func.getName(),
+                func.getIdent().line, func.getIdent().column);
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+  if (func.getDeclOfIdentifier() == nullptr) {
+    reportError("The builtin function " + func.getName() + " can not be spawned",
+                func.getIdent().line, func.getIdent().column);
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+  if (typeIsEqual(call.getType(), BasicType::getVoidType())) {
+    reportError("The function " + func.getName() +
+                    " can not be spawned because it does not return a value",
+                func.getIdent().line, func.getIdent().column);
+    node.setType(BasicType::getInvalidType());
+    return;
   }
-}
\ No newline at end of file
+  // the arguments and the result are stored in a box allocated with malloc
+  std::int64_t alignment = getRequiredAlignment(call.getType());
+  for (const auto &arg : call.getArgs()) {
+    alignment = std::max(alignment, getRequiredAlignment(arg->getType()));
+  }
+  if (alignment > heapAlignment) {
+    reportError("The function " + func.getName() +
+                    " can not be spawned because its arguments or its result are aligned to more "
+                    "than " +
+                    std::to_string(heapAlignment) + " bytes",
+                func.getIdent().line, func.getIdent().column);
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+
+  node.setType(std::make_shared<TaskType>(call.getType()));
+  markImpure("it spawns a task", node.getSpawnKeyword().line);
+}
+
+void Semantic::visit(AwaitExpr &node) {
+  analyse(*node.getTask());
+  node.setExprValueKind(Expr::ValueKind::RVal);
+  markImpure("it awaits a task", node.getAwaitKeyword().line);
+
+  // If the task is invalid, the error has already been reported
+  if (node.getTask()->getType()->isInvalid()) {
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+
+  auto taskType = std::dynamic_pointer_cast<TaskType>(node.getTask()->getType());
+  if (taskType == nullptr) {
+    reportError("Type checking: await expects a task but found " +
+                    node.getTask()->getType()->getName(),
+                node.getAwaitKeyword().line, node.getAwaitKeyword().column);
+    node.setType(BasicType::getInvalidType());
+    return;
+  }
+  node.setType(taskType->getResult());
+}
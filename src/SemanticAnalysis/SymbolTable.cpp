@@ -10,15 +10,15 @@
 #include "stoc/SemanticAnalysis/SymbolTable.h"
 #include "stoc/SemanticAnalysis/Type.h"
 
-SymbolTable::SymbolTable(int level) : level(level) {}
+SymbolTable::SymbolTable(int level) : level(level), frozen(false) {}
 
 SymbolTable::SymbolTable(std::shared_ptr<SymbolTable> previousTable, int level)
-    : previousTable(previousTable), level(level) {}
+    : previousTable(previousTable), level(level), frozen(false) {}
 
 const std::shared_ptr<SymbolTable> &SymbolTable::getPreviousTable() const { return previousTable; }
 int SymbolTable::getLevel() const { return level; }
 
-std::vector<Symbol> SymbolTable::lookup(std::string identifier) {
+std::vector<Symbol> SymbolTable::lookup(std::string identifier) const {
   auto it = table.find(identifier);
   if (it == this->table.end()) { // it has not been found in current scope
     if (level == 0) {            // if it is last scope, \identifier has not been found
@@ -72,9 +72,18 @@ void SymbolTable::insertVariable(std::string identifier, Symbol symbol) {
 }
 
 void SymbolTable::insert(std::string identifier, Symbol symbol) {
+  if (frozen) {
+    throw std::runtime_error("Internal Error - Insertion of '" + identifier +
+                             "' in a read-only symbol table");
+  }
+
   if (symbol.getKind() == Symbol::Kind::FUNCTION) {
     insertFunction(identifier, symbol);
-  } else { // is VARIABLE/CONSTANT/PARAMETER
+  } else { // is VARIABLE/CONSTANT/PARAMETER/STRUCT
     insertVariable(identifier, symbol);
   }
 }
+
+void SymbolTable::freeze() { frozen = true; }
+
+void SymbolTable::unfreeze() { frozen = false; }
@@ -19,6 +19,21 @@ bool typeIsEqual(const std::shared_ptr<Type> lhs, const std::shared_ptr<Type> rh
     case Type::Kind::BasicType:
       return typeIsEqual(std::dynamic_pointer_cast<BasicType>(lhs),
                          std::dynamic_pointer_cast<BasicType>(rhs));
+    case Type::Kind::ArrayType:
+      return typeIsEqual(std::dynamic_pointer_cast<ArrayType>(lhs),
+                         std::dynamic_pointer_cast<ArrayType>(rhs));
+    case Type::Kind::VectorType:
+      return typeIsEqual(std::dynamic_pointer_cast<VectorType>(lhs),
+                         std::dynamic_pointer_cast<VectorType>(rhs));
+    case Type::Kind::TaskType:
+      return typeIsEqual(std::dynamic_pointer_cast<TaskType>(lhs),
+                         std::dynamic_pointer_cast<TaskType>(rhs));
+    case Type::Kind::AtomicType:
+      return typeIsEqual(std::dynamic_pointer_cast<AtomicType>(lhs),
+                         std::dynamic_pointer_cast<AtomicType>(rhs));
+    case Type::Kind::StructType:
+      return typeIsEqual(std::dynamic_pointer_cast<StructType>(lhs),
+                         std::dynamic_pointer_cast<StructType>(rhs));
     case Type::Kind::Signature:
       return typeIsEqual(std::dynamic_pointer_cast<FunctionType>(lhs),
                          std::dynamic_pointer_cast<FunctionType>(rhs));
@@ -55,6 +70,38 @@ std::shared_ptr<BasicType> BasicType::getStringType() {
   return std::make_shared<BasicType>(BasicType::Kind::STRING, "string");
 }
 
+std::shared_ptr<BasicType> BasicType::getInt8Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::INT8, "int8");
+}
+
+std::shared_ptr<BasicType> BasicType::getInt16Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::INT16, "int16");
+}
+
+std::shared_ptr<BasicType> BasicType::getInt32Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::INT32, "int32");
+}
+
+std::shared_ptr<BasicType> BasicType::getUint8Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::UINT8, "uint8");
+}
+
+std::shared_ptr<BasicType> BasicType::getUint16Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::UINT16, "uint16");
+}
+
+std::shared_ptr<BasicType> BasicType::getUint32Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::UINT32, "uint32");
+}
+
+std::shared_ptr<BasicType> BasicType::getUint64Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::UINT64, "uint64");
+}
+
+std::shared_ptr<BasicType> BasicType::getFloat32Type() {
+  return std::make_shared<BasicType>(BasicType::Kind::FLOAT32, "float32");
+}
+
 std::shared_ptr<BasicType> BasicType::getVoidType() {
   return std::make_shared<BasicType>(BasicType::Kind::VOID, "void");
 }
@@ -66,7 +113,49 @@ std::shared_ptr<BasicType> BasicType::getInvalidType() {
 BasicType::Kind BasicType::getKind() { return kind; }
 std::string BasicType::getName() { return name; }
 
-bool BasicType::isNumeric() { return kind == Kind::INT || kind == Kind::FLOAT; }
+bool BasicType::isNumeric() { return isInteger() || isFloat(); }
+bool BasicType::isInteger() {
+  switch (kind) {
+  case Kind::INT:
+  case Kind::INT8:
+  case Kind::INT16:
+  case Kind::INT32:
+  case Kind::UINT8:
+  case Kind::UINT16:
+  case Kind::UINT32:
+  case Kind::UINT64:
+    return true;
+  default:
+    return false;
+  }
+}
+bool BasicType::isFloat() { return kind == Kind::FLOAT || kind == Kind::FLOAT32; }
+bool BasicType::isUnsigned() {
+  return kind == Kind::UINT8 || kind == Kind::UINT16 || kind == Kind::UINT32 ||
+         kind == Kind::UINT64;
+}
+unsigned BasicType::getBitWidth() {
+  switch (kind) {
+  case Kind::BOOL:
+    return 1;
+  case Kind::INT8:
+  case Kind::UINT8:
+    return 8;
+  case Kind::INT16:
+  case Kind::UINT16:
+    return 16;
+  case Kind::INT32:
+  case Kind::UINT32:
+  case Kind::FLOAT32:
+    return 32;
+  case Kind::INT:
+  case Kind::UINT64:
+  case Kind::FLOAT:
+    return 64;
+  default:
+    return 0;
+  }
+}
 bool BasicType::isString() { return kind == Kind::STRING; }
 bool BasicType::isBoolean() { return kind == Kind::BOOL; }
 bool BasicType::isInvalid() { return kind == Kind::INVALID; }
@@ -77,13 +166,93 @@ bool typeIsEqual(std::shared_ptr<BasicType> lhs, std::shared_ptr<BasicType> rhs)
   return lhs->kind == rhs->kind;
 }
 
+// ---- Array Type ----
+ArrayType::ArrayType(std::shared_ptr<Type> element, std::int64_t size)
+    : Type(Type::Kind::ArrayType), element(element), dynamic(false), size(size) {}
+
+ArrayType::ArrayType(std::shared_ptr<Type> element)
+    : Type(Type::Kind::ArrayType), element(element), dynamic(true), size(0) {}
+
+std::shared_ptr<Type> ArrayType::getElement() { return element; }
+bool ArrayType::isDynamic() { return dynamic; }
+std::int64_t ArrayType::getSize() { return size; }
+std::string ArrayType::getName() {
+  return (dynamic ? "[]" : "[" + std::to_string(size) + "]") + element->getName();
+}
+bool ArrayType::isInvalid() { return element->isInvalid(); }
+
+bool typeIsEqual(std::shared_ptr<ArrayType> lhs, std::shared_ptr<ArrayType> rhs) {
+  return typeIsEqual(lhs->element, rhs->element) && lhs->dynamic == rhs->dynamic &&
+         lhs->size == rhs->size;
+}
+
+// ---- Vector Type ----
+VectorType::VectorType(std::shared_ptr<BasicType> element, std::int64_t lanes)
+    : Type(Type::Kind::VectorType), element(element), lanes(lanes) {}
+
+std::shared_ptr<BasicType> VectorType::getElement() { return element; }
+std::int64_t VectorType::getLanes() { return lanes; }
+std::string VectorType::getName() { return "<" + std::to_string(lanes) + ">" + element->getName(); }
+bool VectorType::isInvalid() { return element->isInvalid(); }
+
+bool typeIsEqual(std::shared_ptr<VectorType> lhs, std::shared_ptr<VectorType> rhs) {
+  return typeIsEqual(lhs->element, rhs->element) && lhs->lanes == rhs->lanes;
+}
+
+// ---- Task Type ----
+TaskType::TaskType(std::shared_ptr<Type> result) : Type(Type::Kind::TaskType), result(result) {}
+
+std::shared_ptr<Type> TaskType::getResult() { return result; }
+std::string TaskType::getName() { return "task " + result->getName(); }
+bool TaskType::isInvalid() { return result->isInvalid(); }
+
+bool typeIsEqual(std::shared_ptr<TaskType> lhs, std::shared_ptr<TaskType> rhs) {
+  return typeIsEqual(lhs->result, rhs->result);
+}
+
+// ---- Atomic Type ----
+AtomicType::AtomicType(std::shared_ptr<BasicType> element)
+    : Type(Type::Kind::AtomicType), element(element) {}
+
+std::shared_ptr<BasicType> AtomicType::getElement() { return element; }
+std::string AtomicType::getName() { return "atomic " + element->getName(); }
+bool AtomicType::isInvalid() { return element->isInvalid(); }
+
+bool typeIsEqual(std::shared_ptr<AtomicType> lhs, std::shared_ptr<AtomicType> rhs) {
+  return typeIsEqual(lhs->element, rhs->element);
+}
+
+// ---- Struct Type ----
+StructType::StructType(std::string name, std::vector<Field> fields, bool packed,
+                       std::int64_t alignment, bool soa)
+    : Type(Type::Kind::StructType), name(std::move(name)), fields(std::move(fields)),
+      packed(packed), alignment(alignment), soa(soa) {}
+
+const std::vector<StructType::Field> &StructType::getFields() { return fields; }
+int StructType::getFieldIndex(const std::string &fieldName) {
+  for (std::size_t i = 0; i < fields.size(); i++) {
+    if (fields[i].name == fieldName) {
+      return i;
+    }
+  }
+  return -1;
+}
+bool StructType::isPacked() { return packed; }
+std::int64_t StructType::getAlignment() { return alignment; }
+bool StructType::isSoa() { return soa; }
+std::string StructType::getName() { return name; }
+bool StructType::isInvalid() { return false; }
+
+bool typeIsEqual(std::shared_ptr<StructType> lhs, std::shared_ptr<StructType> rhs) {
+  return lhs->name == rhs->name;
+}
+
 // ---- Signature (for functions) ----
-FunctionType::FunctionType(std::vector<std::shared_ptr<BasicType>> params,
-                           std::shared_ptr<BasicType> result)
+FunctionType::FunctionType(std::vector<std::shared_ptr<Type>> params, std::shared_ptr<Type> result)
     : Type(Type::Kind::Signature), params(params), result(result) {}
 
-std::vector<std::shared_ptr<BasicType>> FunctionType::getParams() { return params; }
-std::shared_ptr<BasicType> FunctionType::getResult() { return result; }
+std::vector<std::shared_ptr<Type>> FunctionType::getParams() { return params; }
+std::shared_ptr<Type> FunctionType::getResult() { return result; }
 std::string FunctionType::getName() {
   std::string name = "(";
   for (int i = 0; i < params.size(); ++i) {
@@ -106,8 +275,8 @@ bool FunctionType::isInvalid() {
   return result->isInvalid();
 }
 
-bool areParametersEqual(std::vector<std::shared_ptr<BasicType>> lhs,
-                        std::vector<std::shared_ptr<BasicType>> rhs) {
+bool areParametersEqual(std::vector<std::shared_ptr<Type>> lhs,
+                        std::vector<std::shared_ptr<Type>> rhs) {
   // check arity of parameters
   if (lhs.size() != rhs.size()) {
     return false;
@@ -0,0 +1,74 @@
+//===- src/Server/Client.cpp - Client of the compilation server ---------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements stoc-client, the thin client of the compilation server (stoc --server). It
+// is used like stoc: it forwards its command line and working directory to the server and prints
+// the output and the diagnostics of the compilation as the server sends them. The exit code is the
+// one of the compilation.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "stoc/Server/Protocol.h"
+
+int main(int argc, char *argv[]) {
+  std::string socketPath = protocol::getDefaultSocketPath();
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+  int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (connection < 0 ||
+      connect(connection, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+    std::cerr << "Could not connect to the stoc server on " << socketPath << " ("
+              << std::strerror(errno) << "). Start it with: stoc --server" << std::endl;
+    return 1;
+  }
+
+  char workingDirectory[PATH_MAX];
+  if (getcwd(workingDirectory, sizeof(workingDirectory)) == nullptr) {
+    std::cerr << "Could not get the working directory: " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  // The server parses the command line as if it was the one of stoc
+  std::vector<std::string> strings = {workingDirectory, "stoc"};
+  strings.insert(strings.end(), argv + 1, argv + argc);
+  if (!protocol::sendMessage(connection, protocol::MessageKind::COMPILE,
+                             protocol::encodeStrings(strings))) {
+    std::cerr << "Could not send the command line to the stoc server" << std::endl;
+    return 1;
+  }
+
+  protocol::MessageKind kind;
+  std::string payload;
+  while (protocol::receiveMessage(connection, kind, payload)) {
+    switch (kind) {
+    case protocol::MessageKind::OUTPUT:
+      std::cout << payload << std::flush;
+      break;
+    case protocol::MessageKind::ERROR:
+      std::cerr << payload << std::flush;
+      break;
+    case protocol::MessageKind::EXIT:
+      close(connection);
+      return std::stoi(payload);
+    default:
+      break;
+    }
+  }
+
+  std::cerr << "The connection with the stoc server was lost" << std::endl;
+  return 1;
+}
@@ -0,0 +1,102 @@
+//===- src/Server/Protocol.cpp - Impl of the client-server protocol -----------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the protocol used by stoc-client and the stoc server to communicate.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "stoc/Server/Protocol.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace protocol {
+
+/// sends the \length bytes of \data, retrying while the socket accepts only part of them
+static bool sendAll(int socket, const char *data, std::size_t length) {
+  while (length > 0) {
+    // MSG_NOSIGNAL: a client that disconnects must not kill the server with SIGPIPE
+    ssize_t sent = send(socket, data, length, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    length -= sent;
+  }
+  return true;
+}
+
+/// receives exactly \length bytes in \data
+static bool receiveAll(int socket, char *data, std::size_t length) {
+  while (length > 0) {
+    ssize_t received = recv(socket, data, length, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    data += received;
+    length -= received;
+  }
+  return true;
+}
+
+std::string getDefaultSocketPath() {
+  if (const char *path = std::getenv("STOC_SOCKET")) {
+    return path;
+  }
+  return "/tmp/stoc-" + std::to_string(getuid()) + ".socket";
+}
+
+bool sendMessage(int socket, MessageKind kind, const std::string &payload) {
+  uint32_t length = payload.size();
+  char header[5] = {static_cast<char>(kind),
+                    static_cast<char>(length & 0xff),
+                    static_cast<char>((length >> 8) & 0xff),
+                    static_cast<char>((length >> 16) & 0xff),
+                    static_cast<char>((length >> 24) & 0xff)};
+  return sendAll(socket, header, sizeof(header)) &&
+         sendAll(socket, payload.data(), payload.size());
+}
+
+bool receiveMessage(int socket, MessageKind &kind, std::string &payload) {
+  unsigned char header[5];
+  if (!receiveAll(socket, reinterpret_cast<char *>(header), sizeof(header))) {
+    return false;
+  }
+  kind = static_cast<MessageKind>(header[0]);
+  uint32_t length = header[1] | (header[2] << 8) | (header[3] << 16) |
+                    (static_cast<uint32_t>(header[4]) << 24);
+  payload.resize(length);
+  return receiveAll(socket, &payload[0], length);
+}
+
+std::string encodeStrings(const std::vector<std::string> &strings) {
+  std::string payload;
+  for (const auto &string : strings) {
+    payload += string;
+    payload.push_back('\0');
+  }
+  return payload;
+}
+
+std::vector<std::string> decodeStrings(const std::string &payload) {
+  std::vector<std::string> strings;
+  std::size_t start = 0;
+  std::size_t end;
+  while ((end = payload.find('\0', start)) != std::string::npos) {
+    strings.push_back(payload.substr(start, end - start));
+    start = end + 1;
+  }
+  return strings;
+}
+
+} // namespace protocol
@@ -0,0 +1,209 @@
+//===- src/Server/Server.cpp - Implementation of the Server class -------------------*- C++ -*-===//
+//
+//===------------------------------------------------------------------------------------------===//
+//
+// This file implements the Server class.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "stoc/Server/Server.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <llvm/Support/Host.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "stoc/CodeGeneration/TargetMachineCache.h"
+#include "stoc/Driver/Driver.h"
+#include "stoc/Server/Protocol.h"
+
+/// Stream buffer that sends the text written in it to the client as messages of kind \kind. The
+/// text is sent every time the stream is flushed (i.e. with std::endl), so the client receives the
+/// diagnostics while the compilation is running
+class MessageStreamBuffer : public std::streambuf {
+private:
+  int connection;
+  protocol::MessageKind kind;
+  std::string buffer;
+
+  static constexpr std::size_t MAX_BUFFER_SIZE = 4096;
+
+protected:
+  int overflow(int c) override {
+    if (c != traits_type::eof()) {
+      buffer.push_back(static_cast<char>(c));
+      if (buffer.size() >= MAX_BUFFER_SIZE) {
+        sync();
+      }
+    }
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    buffer.append(s, n);
+    if (buffer.size() >= MAX_BUFFER_SIZE) {
+      sync();
+    }
+    return n;
+  }
+
+  int sync() override {
+    if (!buffer.empty()) {
+      // If the client has disconnected, the rest of the compilation is not sent
+      protocol::sendMessage(connection, kind, buffer);
+      buffer.clear();
+    }
+    return 0;
+  }
+
+public:
+  MessageStreamBuffer(int connection, protocol::MessageKind kind)
+      : connection(connection), kind(kind) {}
+};
+
+Server::Server(std::string socketPath, unsigned workers)
+    : socketPath(std::move(socketPath)), workers(workers) {}
+
+int Server::run() {
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0) {
+    std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Path of the socket is too long: " << socketPath << std::endl;
+    close(listener);
+    return 1;
+  }
+  std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+  // If a server is already listening on the socket it is not replaced. Otherwise, the socket is a
+  // leftover of a server that was killed and it is removed
+  if (connect(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+    std::cerr << "A stoc server is already listening on " << socketPath << std::endl;
+    close(listener);
+    return 1;
+  }
+  close(listener);
+  unlink(socketPath.c_str());
+
+  listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+      listen(listener, SOMAXCONN) < 0) {
+    std::cerr << "Failed to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  // The targets are initialized and a target machine for the host is created before the first
+  // request, so no compilation pays for them
+  std::string error;
+  TargetMachineCache &targetMachineCache = TargetMachineCache::getInstance();
+  targetMachineCache.release(
+      targetMachineCache.acquire(llvm::sys::getDefaultTargetTriple(), "generic", error));
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < workers; i++) {
+    threads.emplace_back(&Server::work, this);
+  }
+  std::cout << "stoc server listening on " << socketPath << " with " << workers << " threads"
+            << std::endl;
+
+  while (true) {
+    int connection = accept(listener, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      std::cerr << "Failed to accept connection: " << std::strerror(errno) << std::endl;
+      break;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      connections.push(connection);
+    }
+    connectionAccepted.notify_one();
+  }
+
+  // A negative connection tells a worker to stop
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned i = 0; i < workers; i++) {
+      connections.push(-1);
+    }
+  }
+  connectionAccepted.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  close(listener);
+  unlink(socketPath.c_str());
+  return 1;
+}
+
+void Server::work() {
+  while (true) {
+    int connection;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      connectionAccepted.wait(lock, [this]() { return !connections.empty(); });
+      connection = connections.front();
+      connections.pop();
+    }
+
+    if (connection < 0) {
+      return;
+    }
+    serve(connection);
+    close(connection);
+  }
+}
+
+void Server::serve(int connection) {
+  protocol::MessageKind kind;
+  std::string payload;
+  if (!protocol::receiveMessage(connection, kind, payload) ||
+      kind != protocol::MessageKind::COMPILE) {
+    return;
+  }
+
+  // The working directory of the client, followed by its command line
+  std::vector<std::string> strings = protocol::decodeStrings(payload);
+  if (strings.size() < 2) {
+    return;
+  }
+  std::string workingDirectory = strings[0];
+  std::vector<std::string> arguments(strings.begin() + 1, strings.end());
+
+  MessageStreamBuffer outputBuffer(connection, protocol::MessageKind::OUTPUT);
+  MessageStreamBuffer errorBuffer(connection, protocol::MessageKind::ERROR);
+  std::ostream output(&outputBuffer);
+  std::ostream error(&errorBuffer);
+
+  int exitCode;
+  try {
+    Driver driver(output, error, workingDirectory);
+    exitCode = driver.run(std::move(arguments));
+  } catch (std::exception &e) {
+    // i.e. the command line of the client is not valid
+    error << e.what() << std::endl;
+    exitCode = 1;
+  }
+
+  output.flush();
+  error.flush();
+  protocol::sendMessage(connection, protocol::MessageKind::EXIT, std::to_string(exitCode));
+}
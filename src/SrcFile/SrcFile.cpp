@@ -11,6 +11,7 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <utility>
 
 SrcFile::SrcFile(std::string &path) {
   std::ifstream ifs(path, std::ifstream::in);
@@ -27,7 +28,6 @@ SrcFile::SrcFile(std::string &path) {
     this->length = this->data.length();
     ifs.close();
 
-    this->tokens = {};
     this->errorInScanning = false;
     this->ast = {};
     this->errorInParsing = false;
@@ -36,24 +36,41 @@ SrcFile::SrcFile(std::string &path) {
     this->module = nullptr;
     this->builder = nullptr;
     this->errorInCodeGeneration = false;
+    this->outputStream = &std::cout;
+    this->errorStream = &std::cerr;
   } else {
     ifs.close();
     throw std::runtime_error("Failed to open source file " + path);
   }
 }
 
+SrcFile::SrcFile(std::string filename, std::string data)
+    : path(filename), filename(std::move(filename)), data(std::move(data)) {
+  this->length = this->data.length();
+  this->errorInScanning = false;
+  this->ast = {};
+  this->errorInParsing = false;
+  this->errorInSemanticAnalysis = false;
+  this->context = nullptr;
+  this->module = nullptr;
+  this->builder = nullptr;
+  this->errorInCodeGeneration = false;
+  this->outputStream = &std::cout;
+  this->errorStream = &std::cerr;
+}
+
 const std::string &SrcFile::getPath() const { return path; }
 const std::string &SrcFile::getDirectory() const { return directory; }
 const std::string &SrcFile::getFilename() const { return filename; }
 const std::string &SrcFile::getData() const { return data; }
 int SrcFile::getLength() const { return length; }
 
-const std::vector<Token> &SrcFile::getTokens() const { return tokens; }
-void SrcFile::setTokens(const std::vector<Token> &t) { this->tokens = t; }
 bool SrcFile::isErrorInScanning() const { return errorInScanning; }
 void SrcFile::setErrorInScanning(bool error) { this->errorInScanning = error; }
 const std::vector<std::shared_ptr<Decl>> &SrcFile::getAst() const { return ast; }
-void SrcFile::setAst(const std::vector<std::shared_ptr<Decl>> &ast_nodes) { this->ast = ast_nodes; }
+void SrcFile::setAst(std::vector<std::shared_ptr<Decl>> ast_nodes) {
+  this->ast = std::move(ast_nodes);
+}
 bool SrcFile::isErrorInParsing() const { return errorInParsing; }
 void SrcFile::setErrorInParsing(bool error) { this->errorInParsing = error; }
 
@@ -75,3 +92,9 @@ const std::shared_ptr<llvm::IRBuilder<>> &SrcFile::getBuilder() const { return b
 void SrcFile::setBuilder(const std::shared_ptr<llvm::IRBuilder<>> &builder) {
   this->builder = builder;
 }
+std::ostream &SrcFile::getOutputStream() const { return *outputStream; }
+std::ostream &SrcFile::getErrorStream() const { return *errorStream; }
+void SrcFile::setStreams(std::ostream &output, std::ostream &error) {
+  this->outputStream = &output;
+  this->errorStream = &error;
+}
@@ -0,0 +1,22 @@
+# Compiles the program PROGRAM with the compiler STOC (and the arguments in STOC_ARGS) in the
+# directory WORKDIR, runs it and compares its output with the file EXPECTED
+file(MAKE_DIRECTORY ${WORKDIR})
+get_filename_component(name ${PROGRAM} NAME_WE)
+
+execute_process(COMMAND ${STOC} ${STOC_ARGS} ${PROGRAM}
+        WORKING_DIRECTORY ${WORKDIR}
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output)
+if(NOT result EQUAL 0 OR NOT EXISTS ${WORKDIR}/${name})
+  message(FATAL_ERROR "Failed to compile ${PROGRAM}:\n${output}")
+endif()
+
+execute_process(COMMAND ${WORKDIR}/${name}
+        WORKING_DIRECTORY ${WORKDIR}
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output)
+file(READ ${EXPECTED} expected)
+if(NOT output STREQUAL expected)
+  message(FATAL_ERROR "Output of ${name} (exit code ${result}):\n${output}\nExpected:\n${expected}")
+endif()